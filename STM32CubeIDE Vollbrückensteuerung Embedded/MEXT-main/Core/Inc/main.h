@@ -54,6 +54,12 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+void pulse_tim1_isr(void);
+void pulse_tim2_isr(void);
+void prot_break_isr(void);
+void wave_dma_isr(void);
+void wave_tim_isr(void);
+void hr_cycle_isr(uint8_t ch);
 
 /* USER CODE END EFP */
 
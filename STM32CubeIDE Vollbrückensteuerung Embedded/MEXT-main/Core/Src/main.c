@@ -35,18 +35,256 @@
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
 #define RX_SZ 5
+#define RX_MAX 64     // Empfangspuffer: ein Idle-Event kann mehrere Frames enthalten
+#define FRAME_MAX 16  // größter Frame (WAVE_DATA, CHAN)
+#define CMDQ_LEN 8    // Kommando-FIFO zwischen UART-IRQ und Hauptschleife
 #define PREAMBLE 0xFF // START HEX für UART COM
 
 #define PUTCHAR_PROTOTYPE int __io_putchar(int ch)
 
-static uint8_t rx[RX_SZ]={0};
-static uint8_t rx_buf[RX_SZ];
+static uint8_t rx[RX_MAX]={0};
+static uint8_t rx_buf[FRAME_MAX];
+static uint8_t rx_len = 0;
+
+// Kommando-FIFO: IRQ schreibt (head), Hauptschleife liest (tail)
+static uint8_t cmdq[CMDQ_LEN][FRAME_MAX];
+static uint8_t cmdq_len[CMDQ_LEN];
+static volatile uint8_t cmdq_head = 0;
+static volatile uint8_t cmdq_tail = 0;
 
 // CMD-Base
 #define CMD_SET		 0x10
 #define CMD_START	 0x20
 #define CMD_STOP	 0x30
 #define CMD_READBACK 0x40
+#define CMD_CONFIG   0x50
+#define CMD_FIRE     0x60
+#define CMD_STATUS   0x70
+
+// CONFIG-Frame (configure-and-arm), 11 Bytes:
+// [0]=0xFF [1]=0x50 [2..3]=T1 µs [4..5]=T2 ms [6..7]=Pulsanzahl [8]=Flags T1 [9]=Flags T2 [10]=CFG-Flags
+// ACK, 9 Bytes:
+// [0]=0xFF [1]=0x50 [2..3]=T1 µs [4..5]=T2 ms [6..7]=Pulsanzahl [8]=Status (erreichte Werte)
+#define CONFIG_SZ       11
+#define CONFIG_ACK_SZ   9
+#define CFG_F_ARM       0x01    // nach dem Setzen sofort starten
+#define CFG_ST_ARMED    0x01    // ACK-Status: Sequenz läuft
+#define CFG_ST_CLAMPED  0x02    // ACK-Status: mindestens ein Wert wurde begrenzt
+#define CFG_ST_REJECT   0x80    // ACK-Status: Start abgelehnt, Fehler-Latch gesetzt
+
+// FIRE (5 Bytes): value = Anzahl Pulspaare, die jetzt gefeuert werden (0 = nur Zählerstand)
+// ACK, 9 Bytes: [0]=0xFF [1]=0x60 [2..5]=Zykluszähler (LSB zuerst) [6..7]=verbleibende Pulse [8]=Status
+#define FIRE_ACK_SZ     9
+#define FIRE_ST_RUNNING 0x01    // Sequenz läuft
+#define FIRE_ST_BUSY    0x02    // FIRE abgelehnt, es lief bereits eine Sequenz
+#define FIRE_ST_REJECT  0x80    // FIRE abgelehnt, Fehler-Latch gesetzt (erst quittieren)
+
+// STATUS (5 Bytes): flags Bit0 = Spitzenwerte (Latenz) nach dem Lesen zurücksetzen
+// Antwort, 28 Bytes (Little Endian):
+// [0]=0xFF [1]=0x70 [2]=g_state [3]=g_exit [4..7]=Zykluszähler [8..9]=verbleibende Pulse
+// [10..11]=verworfene UART-Frames [12..13]=max. ISR-Latenz (CPU-Takte) [14..15]=Timer-Überläufe
+// [16..19]=Uptime ms [20..21]=max. Laufzeit der Puls-ISRs (CPU-Takte)
+// [22]=Fehler-Latch (PROT_F_*) [23]=Pulsphase beim Auslösen (0 = keine, 1 = Puls+, 2 = Puls-)
+// [24..27]=Zykluszähler beim Auslösen (abgeschlossene Pulspaare davor)
+#define STATUS_SZ         28
+#define STATUS_F_CLR_PEAK 0x01
+
+// EVENT-LOG: ersetzt printf-Ausgaben. Jeder Eintrag ist ein fertiger Binär-Frame, 16 Bytes:
+// [0]=0xFF [1]=0x80 [2]=Event-ID [3]=Sequenz (Lücken = verlorene Events)
+// [4..7]=Zeitstempel µs seit Reset [8..11]=Arg0 [12..15]=Arg1 (Little Endian)
+// Der Text entsteht erst auf dem Host (control/event_log.py).
+#define CMD_EVENT    0x80
+#define EVT_SZ       16
+#define TXQ_SZ       1024u   // Sende-Ring für Antworten + Events (Zweierpotenz)
+#define TXQ_RESERVE  64u     // Platz, den Events für Antwort-Frames freilassen
+
+typedef enum {
+	EVT_BOOT        = 0x01,  // a0 = RCC->CSR (Reset-Ursache), a1 = SystemCoreClock
+	EVT_CMD_SET     = 0x10,  // a0 = Timer, a1 = Periode
+	EVT_CMD_START   = 0x11,  // a0 = Pulsanzahl
+	EVT_CMD_STOP    = 0x12,  // a0 = 1 hart / 0 soft angefordert
+	EVT_CMD_RB      = 0x13,  // a0 = Timer
+	EVT_CMD_UNKNOWN = 0x1F,  // a0 = CMD
+	EVT_RX_FRAME    = 0x20,  // a0 = Bytes [1..4] des Frames, a1 = Länge
+	EVT_SEQ_START   = 0x30,  // a0 = Soll-Pulse, a1 = Zykluszähler
+	EVT_SEQ_DONE    = 0x31,  // a0 = Pulse, a1 = Zykluszähler (Soll erreicht)
+	EVT_SEQ_STOP    = 0x32,  // a0 = EXIT_SOFT/EXIT_HARD, a1 = Zykluszähler
+	EVT_WAVE_START  = 0x33,  // a0 = Schritte, a1 = Wiederholungen
+	EVT_WAVE_DONE   = 0x34,  // a0 = abgespielte Durchläufe, a1 = 1 wenn abgebrochen
+	EVT_CH_START    = 0x35,  // a0 = HRTIM-Kanal, a1 = Soll-Pulspaare (0 = endlos)
+	EVT_CH_DONE     = 0x36,  // a0 = HRTIM-Kanal, a1 = gefeuerte Pulspaare (Soll erreicht)
+	EVT_CH_STOP     = 0x37,  // a0 = HRTIM-Kanal, a1 = gefeuerte Pulspaare (abgebrochen)
+	EVT_RETIME      = 0x38,  // a0 = Umschaltzyklus, a1 = T1 µs | T2 ms << 16 (jetzt aktiv)
+	EVT_RATE_START  = 0x39,  // a0 = Periode ns, a1 = Soll-Pulspaare (0 = endlos)
+	EVT_RATE_DONE   = 0x3A,  // a0 = gefeuerte Pulspaare, a1 = rate_end_t
+	EVT_OVERRUN     = 0x40,  // a0 = Timer (1/2, 3 = Pulsfolge > T2), a1 = Verspätung in CPU-Takten
+	EVT_UART_ERR    = 0x41,  // a0 = huart->ErrorCode
+	EVT_FAULT       = 0x42,  // a0 = PROT_F_*, a1 = Zykluszähler
+	EVT_FAULT_CLR   = 0x43,  // a0 = bisheriger Fehler
+} evt_id_t;
+
+// ADC: Zwischenkreisspannung und Brückenstrom pro Puls (ADC1 per Register, kein ADC-HAL im Projekt)
+// PA0 = ADC1_IN1 (U_DC über Teiler), PA1 = ADC1_IN2 (Strom, Shunt-Verstärker), 0..3.3 V
+// Start per TIM1_TRGO (Update), danach Dauerwandlung U,I,U,I,... per DMA bis Pulsende.
+// ADC-Kommando (5 Bytes): value = Dezimierung (0 = aus, N = jeder N-te Zyklus wird gesendet)
+// Antwort, 5 Bytes: [0]=0xFF [1]=0x90 [2..3]=Dezimierung [4]=Status (ADC_ST_*)
+// Messdaten, unaufgefordert, 34 Bytes (Little Endian, Rohwerte 12 Bit):
+// [0]=0xFF [1]=0x98 [2..5]=Zykluszähler [6..7]=Samples Puls+ [8..9]=Samples Puls-
+// [10..21]=Puls+: U_mean U_min U_max I_mean I_min I_max [22..33]=Puls-: dito
+#define CMD_ADC       0x90
+#define CMD_ADC_REC   0x98
+#define ADC_REC_SZ    34
+#define ADC_ST_READY  0x01     // ADC kalibriert, DMA läuft
+#define ADC_ST_ON     0x02     // Aufzeichnung aktiv (Dezimierung > 0)
+#define ADC_PAIRS     1536u    // DMA-Ring in Wertepaaren; 2.82 µs/Paar -> 4.3 ms > 3*T1_max
+#define ADC_EXTSEL_TIM1_TRGO  9u
+
+// SCHUTZ: Überstrom/Überspannung ohne Software im Abschaltpfad.
+// COMP1: PA1 (Strom) gegen DAC3_CH1, COMP3: PA0 (U_DC) gegen DAC1_CH1 -> TIM8-Break.
+// Die Enable-Leitungen der Halbbrücken liegen auf TIM8_CH1 (PB6, rechts) / TIM8_CH2 (PC7, links)
+// im Forced-Mode; der Break löscht MOE in Hardware -> beide Enables low (OSSI, OIS=0).
+// Danach bleibt MOE aus (kein AOE), bis der Host den Fehler quittiert.
+// PROT (5 Bytes): 0xA0 = Stromschwelle, 0xA1 = Spannungsschwelle, value = DAC-Wert 12 Bit
+// (gleiche Skala wie der ADC, 0 = unverändert), flags Bit0 = Fehler quittieren
+// Antwort, 5 Bytes: [0]=0xFF [1]=0xA0/0xA1 [2..3]=Schwelle [4]=Fehler-Latch nach dem Kommando
+#define CMD_PROT        0xA0
+#define PROT_F_RESET    0x01
+#define PROT_F_OC       0x01    // Fehler: Überstrom (COMP1)
+#define PROT_F_OV       0x02    // Fehler: Überspannung (COMP3)
+#define PROT_F_BRK      0x80    // Break ohne anstehenden Komparator (kurzer Impuls)
+#define PROT_THR_DEFAULT 3900u  // ~3.14 V am Pin, bis der Host echte Schwellen setzt
+#define PROT_BKF        2u      // Break-Filter: 4 Samples bei f_CK_INT (~24 ns)
+
+// WAVE: frei programmierbare Folgen von Brückenzuständen, abgespielt ohne CPU je Schritt.
+// TIM8 ist der Schrittakt (0.1 µs/Tick) und treibt die Enables; CH1/CH2 laufen dafür in PWM1
+// mit Preload (CCR = 0xFFFF -> an, 0 -> aus), der Break wirkt unverändert.
+//  - TIM8_CH3 (CCR3 = 1, ein Tick nach Schrittbeginn) -> DMA-Burst über DMAR: ARR, RCR, CCR1,
+//    CCR2 des FOLGE-Schritts in die Preload-Register, wirksam genau mit dem nächsten Update
+//  - TIM8_UP -> DMA schreibt GPIOA->BSRR (Drive links/rechts) des beginnenden Schritts
+// Nach dem letzten Schritt hält TIM8 an (OPM, gesetzt im DMA-TC-IRQ), Enables aus.
+// WAVE_DATA (14 Bytes): [0]=0xFF [1]=0xB0 [2..3]=Startindex [4]=Anzahl (1..3)
+// [5..13]=je Schritt: Zustand (WS_*) und Dauer in Ticks (2 Bytes)
+// Antwort, 5 Bytes: [0]=0xFF [1]=0xB0 [2..3]=Tabellenlänge [4]=Status (WAVE_ST_*)
+// WAVE_CTRL (5 Bytes): flags = WAVE_F_*, value = Durchläufe für RUN (0 = 1)
+// Antwort, 7 Bytes: [0]=0xFF [1]=0xB1 [2..3]=Tabellenlänge [4..5]=CRC16 der Tabelle [6]=Status
+// Flash: letzte 2 KB ab 0x0807F800, Kopf {Magic, Länge, CRC} + 4 Bytes je Schritt. Das Linker-Skript
+// spart 4 KB aus: bei Single-Bank (DBANK = 0) löscht wave_flash_save die 4-KB-Seite ab 0x0807F000.
+#define CMD_WAVE        0xB0
+#define CMD_WAVE_CTRL   0xB1
+#define WAVE_DATA_SZ    14
+#define WAVE_ACK_SZ     7
+#define WAVE_MAX_STEPS  256u
+#define WAVE_F_CLEAR    0x01    // Tabelle leeren
+#define WAVE_F_LOAD     0x02    // Tabelle aus dem Flash laden
+#define WAVE_F_SAVE     0x04    // Tabelle in den Flash schreiben
+#define WAVE_F_RUN      0x08    // abspielen
+#define WAVE_F_STOP     0x10    // sofort abbrechen
+#define WAVE_ST_RUNNING 0x01    // Tabelle wird abgespielt
+#define WAVE_ST_STORED  0x02    // Flash enthält genau diese Tabelle
+#define WAVE_ST_REJECT  0x80    // Kommando (teilweise) abgelehnt
+#define WS_DRIVE_L      0x01    // Zustand: Halbbrücke links High Side
+#define WS_DRIVE_R      0x02    // Zustand: Halbbrücke rechts High Side
+#define WS_ENABLE       0x04    // Zustand: beide Enables an (sonst Brücke aus)
+#define WAVE_PSC        16u     // TIM8: 170 MHz / 17 = 10 MHz
+#define WAVE_MIN_TICKS  3u      // Burst (ab Tick 1) muss vor dem Schrittende fertig sein
+#define WAVE_DBA_ARR    11u     // DMAR-Burst ab TIMx_ARR (Offset 0x2C / 4)
+#define WAVE_FLASH_ADDR 0x0807F800u
+#define WAVE_MAGIC      0x45564157u   // "WAVE"
+
+// HRTIM: Mehrkanalbetrieb, bis zu 3 Vollbrücken (DUTs) parallel mit eigenem T1/T2/Pulszahl.
+// Je Kanal zwei Timer-Einheiten mit gleichem Takt, gestartet im selben Register-Zugriff:
+//  - Einheit A/B/C: Ausgang 1 = Drive links (Puls+), Ausgang 2 = Drive rechts (Puls-)
+//  - Einheit D/E/F: beide Ausgänge = Enables, an über beide Pulse
+// Flanken kommen aus den Compare-Registern (184 ps << CKPSC), die CPU startet nur das
+// Pulspaar je Zyklus (TIM3/TIM4/TIM5, 0.25 ms/Tick). Pins (Adapterplatine, AF13 bzw. AF3):
+//  Kanal 0: PA8/PA9 + PB14/PB15   Kanal 1: PA10/PA11 + PC8/PC9   Kanal 2: PB12/PB13 + PC6/PC7
+// PA8/PA9 und PC7 gehören sonst der Einzelbrücke: der Mehrkanalbetrieb ist ein eigener
+// Zustand (ST_MULTI), STOP hart/CONFIG/Fehler beenden ihn. Schutz: COMP1/COMP3 wirken als
+// HRTIM-Fault 4/5 auf alle Kanäle (Ausgänge inaktiv), Buchhaltung über den TIM8-Break.
+// CHAN (12 Bytes): [0]=0xFF [1]=0xC0 [2]=Kanal [3..6]=T1 ps [7..8]=T2 ms [9..10]=Pulspaare
+// (0 = endlos) [11]=Flags (CHAN_F_START) -> Antwort, 12 Bytes: gleiche Felder mit den
+// erreichten Werten, [11]=Status (CHAN_ST_*)
+// CHAN_CTRL (5 Bytes): value = Kanal, flags = CHAN_F_* -> Antwort, 10 Bytes:
+// [0]=0xFF [1]=0xC1 [2]=Kanal [3]=Status [4..7]=gefeuerte Pulspaare [8..9]=verbleibende
+#define CMD_CHAN        0xC0
+#define CMD_CHAN_CTRL   0xC1
+#define CHAN_SZ         12
+#define CHAN_ST_SZ      10
+#define CHAN_F_START    0x01    // (nach dem Setzen) starten
+#define CHAN_F_STOP     0x02    // sofort anhalten
+#define CHAN_F_EXIT     0x80    // Mehrkanalbetrieb verlassen (alle Kanäle), Pins zurück
+#define CHAN_ST_RUNNING 0x01
+#define CHAN_ST_CLAMPED 0x02    // T1/T2 auf den zulässigen Bereich begrenzt
+#define CHAN_ST_MULTI   0x04    // Mehrkanalbetrieb aktiv
+#define CHAN_ST_REJECT  0x80
+#define HR_CH           3u
+#define HR_T1_PS_MIN    1000000u     // 1 µs
+#define HR_T1_PS_MAX    750000000u   // 750 µs: Pulspaar mit Vorlauf passt bei CKPSC = 7 in 16 Bit
+#define HR_PER_MAX      0xFFDFu
+#define HR_CMP_MIN      0x60u        // kleinster Compare-Wert (3 t_HRTIM)
+#define HR_LEAD         5440u        // ~1 µs Vorlauf vor Puls+ (in 184-ps-Ticks)
+#define HR_T2_PSC       42499u       // TIM3/4/5: 170 MHz / 42500 = 4 kHz
+#define HR_T2_TICKS_MS  4u
+
+// RETIME: neue T1/T2 während einer laufenden Sequenz, ohne Stopp und ohne gestörten Zyklus.
+// Übernommen wird in der TIM1-ISR direkt nach einem Pulspaar: TIM1 steht bis zum nächsten
+// Zyklusstart (ARR direkt), TIM2 bekommt ARR über das Preload-Register (ARPE) und lädt es
+// selbst beim nächsten Update. Erstes Pulspaar mit den neuen Werten = gemeldeter Zyklus.
+// RETIME (6 Bytes): [0]=0xFF [1]=0xD0 [2..3]=T1 µs [4..5]=T2 ms (0 = unverändert)
+// Antwort, 11 Bytes: [0]=0xFF [1]=0xD0 [2..3]=T1 µs [4..5]=T2 ms (erreichte Werte)
+// [6..9]=Umschaltzyklus (Zählerstand vor dem ersten Pulspaar mit neuen Werten) [10]=Status
+#define CMD_RETIME      0xD0
+#define RETIME_SZ       6
+#define RETIME_ACK_SZ   11
+#define RT_ST_PENDING   0x01    // Sequenz läuft, Umschaltung an der Zyklusgrenze steht aus
+#define RT_ST_CLAMPED   0x02    // T1/T2 auf den zulässigen Bereich begrenzt
+
+// RATE: Schnellmodus der Einzelbrücke, 1..50 kHz Wiederholrate ohne CPU je Zyklus.
+//  - TIM1 (170 MHz, PSC nur bei langen Perioden) = Zyklus: CH1 = Drive links (PA8),
+//    CH2 = Drive rechts (PA9) als PWM, Polaritätswechsel bei Vorlauf + T1. OC3REF steigt
+//    einen Tick nach jedem Zyklusbeginn und ist TRGO.
+//  - TIM8 (Enables PB6/PC7, Break-Schutz bleibt) startet je Zyklus per ITR0 im
+//    Reset+Trigger-Modus, One-Pulse: an von Vorlauf bis Vorlauf + 2*T1.
+//  - TIM2 zählt die Zyklen (External Clock auf TIM1_TRGO), Pulszahl N per TIM1-Repetition-
+//    Counter + One-Pulse: TIM1 hält nach genau N Zyklen selbst an, ein einziger IRQ am Ende.
+// Schutz: Tastgrad 2*T1/Periode <= RATE_DUTY_MAX_PCT (T1 wird begrenzt), dazu ein
+// Wärmebudget: Einschaltzeit minus RATE_COOL_US_PER_MS wird aufsummiert, über
+// RATE_HEAT_MAX_US endet der Lauf (Guard), Neustart erst unter der halben Schwelle.
+// STOP hart = sofort, STOP soft = nach dem laufenden Pulspaar (Hauptschleife hält TIM1 im
+// Aus-Fenster des Zyklus an). SET/RETIME im Schnellmodus gelten ab dessen Ende.
+// RATE (13 Bytes): [0]=0xFF [1]=0xE0 [2..5]=T1 ns [6..9]=Periode ns [10..11]=Pulspaare
+// (0 = endlos) [12]=Flags (RATE_F_START) -> Antwort, 13 Bytes: gleiche Felder mit den
+// erreichten Werten (5.9 ns Raster), [12]=Status (RATE_ST_*)
+#define CMD_RATE            0xE0
+#define RATE_SZ             13
+#define RATE_F_START        0x01
+#define RATE_ST_RUNNING     0x01
+#define RATE_ST_CLAMPED     0x02
+#define RATE_ST_GUARD       0x04    // Wärmebudget erschöpft, Start gesperrt
+#define RATE_ST_REJECT      0x80
+#define RATE_PER_NS_MIN     20000u      // 50 kHz
+#define RATE_PER_NS_MAX     1000000u    // 1 kHz, darunter Timer-Betrieb (T2 >= 1 ms)
+#define RATE_T1_NS_MIN      500u
+#define RATE_LEAD_NS        500u        // Drives stehen vor dem Einschalten der Enables
+#define RATE_DUTY_MAX_PCT   50u
+#define RATE_COOL_US_PER_MS 100u        // dauerhaft zulässig: 10 % mittlerer Tastgrad
+#define RATE_HEAT_MAX_US    2000000u    // Überschuss bis zum Guard: 2 s Einschaltzeit
+typedef enum { RATE_END_DONE = 0, RATE_END_STOP = 1, RATE_END_GUARD = 2 } rate_end_t;
+
+// SET-Flags (Byte 4 im SET-Frame bzw. F_T1/F_T2 im CONFIG-Frame), abgelegt in Tcfg[].flags
+#define TF_HW_SYNC   0x02   // nur T1: TIM2-Update startet TIM1 per Hardware (TRGO -> ITR1)
+
+// NVIC: Gruppe 4 (16 Preemption-Stufen, keine Subpriorität), kleiner = wichtiger.
+// Pulstiming hat Vorrang vor allem anderen; der Sende-Pfad sperrt nur bis IRQ_PRIO_TX.
+#define IRQ_PRIO_BREAK   0u    // TIM8-Break: nur Buchhaltung, abgeschaltet ist schon in Hardware
+#define IRQ_PRIO_TIM1    0u    // Puls-Flanken
+#define IRQ_PRIO_TIM2    1u    // Zyklusende / Neustart TIM1
+#define IRQ_PRIO_HR      1u    // HRTIM-Kanäle: Zyklusstart (TIM3/TIM4/TIM5)
+#define IRQ_PRIO_WAVE    2u    // WAVE: Ende eines Durchlaufs (nicht je Schritt)
+#define IRQ_PRIO_TX      5u    // DMA USART2_TX (Event-Log, Antworten)
+#define IRQ_PRIO_UART    6u    // USART2 RX-Idle / TC
+#define IRQ_PRIO_BUTTON  12u   // EXTI15_10 (B1)
+// SysTick: TICK_INT_PRIORITY (15) in stm32g4xx_hal_conf.h
 
 // TIMER GRENZEN
 #define T1_US_MIN   10u
@@ -62,22 +300,97 @@ uint8_t tim1_state_cnt = 0;
 uint8_t tim2_pulse_cnt = 0;
 uint8_t state = 0;
 
-uint8_t pulse_count = 0;
-uint8_t soll_pulse_count = 10;
-
-uint8_t volatile command_rcv = 0;
+uint16_t pulse_count = 0;
+uint16_t soll_pulse_count = 10;
 
 // einfache Ablage der zuletzt gesetzten Werte
 typedef struct { uint16_t value; uint8_t flags; } tcfg_t;
 static volatile tcfg_t Tcfg[2] = {0};   // [0]=TIM1, [1]=TIM2
 
 /* ====== STATE ====== */
-typedef enum { ST_IDLE = 0, ST_RUN = 1 } run_state_t;
+typedef enum { ST_IDLE = 0, ST_RUN = 1, ST_WAVE = 2, ST_MULTI = 3, ST_RATE = 4 } run_state_t;
 typedef enum { EXIT_NONE = 0, EXIT_SOFT, EXIT_HARD } exit_mode_t;
 
 static volatile run_state_t g_state = ST_IDLE;
 static volatile uint8_t     g_t1_cnt = 0;
 static volatile exit_mode_t g_exit   = EXIT_NONE;
+static volatile uint32_t    g_cycle_cnt = 0;   // seit Reset abgeschlossene Pulspaare (Host-Abgleich)
+
+/* ====== DIAGNOSE (STATUS) ====== */
+static volatile uint16_t g_rx_dropped = 0;    // verworfene/unvollständige UART-Frames
+static volatile uint16_t g_overruns   = 0;    // Zyklus/Puls nicht rechtzeitig fertig
+static volatile uint32_t g_lat_max    = 0;    // max. ISR-Latenz in CPU-Takten (DWT)
+static volatile uint32_t g_isr_max    = 0;    // max. Laufzeit TIM1/TIM2-ISR in CPU-Takten
+// Soll-Zeitpunkte der nächsten Update-Events (DWT-Takte), für die Latenzmessung
+static volatile uint32_t g_t1_due = 0, g_t1_period = 0;
+static volatile uint32_t g_t2_due = 0, g_t2_period = 0;
+
+/* ====== RETIME (Umschaltung an der Zyklusgrenze) ====== */
+static volatile bool     g_rt_pending = false;  // Werte liegen bereit, TIM1-ISR übernimmt
+static uint32_t          g_rt_arr[2];           // neue ARR für TIM1/TIM2
+static uint16_t          g_rt_val[2];           // dazu T1 µs / T2 ms (READBACK)
+
+/* ====== SENDE-RING (USART2 TX per DMA) ====== */
+// Alle Ausgaben (Antworten, Events, printf) landen hier; der DMA liest ab tail.
+static uint8_t txq[TXQ_SZ];
+static volatile uint16_t txq_head = 0;
+static volatile uint16_t txq_tail = 0;
+static volatile uint16_t txq_dma_len = 0;   // != 0: DMA-Transfer ab tail läuft
+static volatile uint8_t  g_evt_seq = 0;
+
+/* ====== ADC (U_DC, I) ====== */
+static volatile uint16_t adc_buf[ADC_PAIRS][2];   // [k][0] = U, [k][1] = I
+static bool              g_adc_ok = false;        // Init erfolgreich
+static volatile uint16_t g_adc_dec = 0;           // 0 = aus
+static uint16_t          g_adc_div = 0;
+static volatile bool     g_adc_armed = false;     // wartet auf TIM1_TRGO bzw. wandelt
+static volatile bool     g_adc_done  = false;     // Pulspaar erfasst, Auswertung in der Hauptschleife
+static volatile uint16_t g_adc_i0, g_adc_i1, g_adc_i2;   // Ring-Index Puls+ / Puls- / Ende
+static volatile uint32_t g_adc_cycle = 0;
+
+/* ====== SCHUTZ ====== */
+static volatile uint8_t  g_fault = 0;             // PROT_F_*, bleibt bis zur Quittierung
+static volatile uint8_t  g_fault_phase = 0;
+static volatile uint32_t g_fault_cycle = 0;
+static uint16_t          g_prot_thr[2] = { PROT_THR_DEFAULT, PROT_THR_DEFAULT };   // [0]=I, [1]=U
+
+/* ====== WAVE ====== */
+typedef struct { uint8_t state; uint8_t rsv; uint16_t ticks; } wave_step_t;
+static wave_step_t       wave_tab[WAVE_MAX_STEPS];
+static uint16_t          wave_len = 0;
+// DMA-Quellen, aus wave_tab aufbereitet; Eintrag k gehört zum Übergang in Schritt k+1,
+// der letzte zum Endzustand (Brücke aus)
+static uint32_t          wave_burst[WAVE_MAX_STEPS][4];   // ARR, RCR, CCR1, CCR2
+static uint32_t          wave_bsrr[WAVE_MAX_STEPS];
+static bool              g_wave_ok = false;
+static volatile uint16_t g_wave_rep = 0;                  // verbleibende Durchläufe
+static volatile uint16_t g_wave_passes = 0;
+
+// HRTIM-Kanäle
+typedef struct {
+	uint32_t t1_ps;                 // erreichtes T1 (gerundet auf das Tick-Raster)
+	uint16_t t2_ms;
+	uint16_t n;                     // Soll-Pulspaare, 0 = endlos
+	bool     cfg;
+	volatile bool     run;
+	volatile uint32_t fired;        // gefeuerte Pulspaare seit dem Start
+} hr_ch_t;
+static hr_ch_t           hr_ch[HR_CH];
+static bool              g_hr_ok = false;
+
+// RATE: Timer-Register, die der Schnellmodus umstellt (beim Verlassen zurück)
+typedef struct {
+	uint32_t cr1, cr2, smcr, dier, ccmr1, ccmr2, ccer, psc, arr, rcr, ccr1, ccr2, ccr3, bdtr;
+} tim_regs_t;
+static tim_regs_t        g_rate_save[3];          // TIM1, TIM2, TIM8
+static uint16_t          g_rate_n = 0;            // Soll-Pulspaare, 0 = endlos
+static uint32_t          g_rate_t1_ns = 0, g_rate_per_ns = 0;
+typedef struct { uint32_t psc, per, t1, lead; } rate_cfg_t;   // in Timer-Ticks, per = 0: nicht gesetzt
+static rate_cfg_t        g_rate = {0};
+static uint32_t          g_rate_on_us_ms = 0;     // Einschaltzeit je ms (Wärmebudget)
+static uint32_t          g_rate_heat = 0;         // Überschuss in µs Einschaltzeit
+static uint32_t          g_rate_tick = 0;
+static bool              g_rate_guard = false;
 
 
 /* USER CODE END PD */
@@ -95,6 +408,10 @@ TIM_HandleTypeDef htim2;
 UART_HandleTypeDef huart2;
 
 /* USER CODE BEGIN PV */
+DMA_HandleTypeDef hdma_usart2_tx;   // Init in HAL_UART_MspInit (USER CODE)
+DMA_HandleTypeDef hdma_adc1;        // Init in adc_init()
+DMA_HandleTypeDef hdma_wave_up;     // Init in wave_init()
+DMA_HandleTypeDef hdma_wave_cc3;
 
 /* USER CODE END PV */
 
@@ -107,39 +424,123 @@ static void MX_TIM2_Init(void);
 /* USER CODE BEGIN PFP */
 
 /* ====== GPIO SHORTCUTS (ersetze Ports/Pins durch deine Cube-Makros!) ====== */
-static inline void Enable_Right(bool on){ HAL_GPIO_WritePin(GPIOB, GPIO_PIN_6, on?GPIO_PIN_SET:GPIO_PIN_RESET); }
-static inline void Enable_Left (bool on){ HAL_GPIO_WritePin(GPIOC, GPIO_PIN_7, on?GPIO_PIN_SET:GPIO_PIN_RESET); }
-static inline void Drive_Right (bool on){ HAL_GPIO_WritePin(GPIOA, GPIO_PIN_9, on?GPIO_PIN_SET:GPIO_PIN_RESET); }
-static inline void Drive_Left  (bool on){ HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, on?GPIO_PIN_SET:GPIO_PIN_RESET); }
+// Direkt über BSRR (ein Store, atomar) – werden in der TIM1-ISR aufgerufen
+#define PIN_WRITE(port, pin, on)  ((port)->BSRR = (on) ? (uint32_t)(pin) : ((uint32_t)(pin) << 16))
+static inline void Drive_Right (bool on){ PIN_WRITE(GPIOA, GPIO_PIN_9, on); }
+static inline void Drive_Left  (bool on){ PIN_WRITE(GPIOA, GPIO_PIN_8, on); }
+
+// Enables über TIM8 CH1 (rechts) / CH2 (links) im Forced-Mode, ebenfalls ein Store.
+// Nur so kann der Break sie ohne CPU abschalten (siehe prot_init).
+#define EN_OCM(on)  ((on) ? TIM_OCMODE_FORCED_ACTIVE : TIM_OCMODE_FORCED_INACTIVE)
+static inline void Enable_Bridge(bool on){ TIM8->CCMR1 = EN_OCM(on) | (EN_OCM(on) << 8); }
 
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
 
+/*++++++++++++ Sende-Ring + Event-Log ++++++++++++ */
+static inline uint16_t txq_free(void)
+{
+	return (uint16_t)(TXQ_SZ - 1u - ((txq_head - txq_tail) & (TXQ_SZ - 1u)));
+}
+
+/* Kopiert n Bytes in den Ring (IRQ-fest). Passt es nicht, wird verworfen. */
+static bool txq_put(const uint8_t *p, uint16_t n, uint16_t reserve)
+{
+	const uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	const bool ok = (txq_free() >= n + reserve);
+	if (ok) {
+		uint16_t h = txq_head;
+		for (uint16_t k = 0; k < n; ++k) {
+			txq[h] = p[k];
+			h = (uint16_t)((h + 1u) & (TXQ_SZ - 1u));
+		}
+		txq_head = h;
+	}
+	__set_PRIMASK(primask);
+	return ok;
+}
+
+/* Startet den nächsten DMA-Transfer (zusammenhängendes Stück ab tail),
+ * falls keiner läuft. Aufruf aus Hauptschleife und TxCplt-Callback.
+ * Gesperrt werden nur UART/DMA (BASEPRI), die Puls-Timer laufen weiter;
+ * sie schreiben nur head, das hier einmal gelesen wird. */
+static void txq_kick(void)
+{
+	const uint32_t basepri = __get_BASEPRI();
+	__set_BASEPRI_MAX(IRQ_PRIO_TX << (8u - __NVIC_PRIO_BITS));
+	if (txq_dma_len == 0 && txq_head != txq_tail) {
+		const uint16_t t = txq_tail;
+		const uint16_t len = (txq_head > t) ? (uint16_t)(txq_head - t) : (uint16_t)(TXQ_SZ - t);
+		txq_dma_len = len;
+		if (HAL_UART_Transmit_DMA(&huart2, &txq[t], len) != HAL_OK) {
+			txq_dma_len = 0;	// UART belegt -> beim nächsten Kick erneut
+		}
+	}
+	__set_BASEPRI(basepri);
+}
+
+/* Antwort-Frame: sofort senden, darf den reservierten Platz nutzen. */
+static void tx_reply(const uint8_t *p, uint16_t n)
+{
+	txq_put(p, n, 0);
+	txq_kick();
+}
+
+/* µs seit Reset aus HAL-Tick (1 ms) und SysTick-Zähler; mit gesperrten IRQs aufrufen. */
+static inline uint32_t evt_time_us(void)
+{
+	uint32_t ms  = HAL_GetTick();
+	uint32_t val = SysTick->VAL;
+	if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {	// Tick übergelaufen, IRQ noch nicht gelaufen
+		ms++;
+		val = SysTick->VAL;
+	}
+	const uint32_t load = SysTick->LOAD;
+	return ms * 1000u + ((load - val) * 1000u) / (load + 1u);
+}
+
+/* Event in den Sende-Ring schreiben (Hauptschleife und ISRs). Kostet nur
+ * ein paar Dutzend Takte; gesendet wird im Leerlauf der Hauptschleife. */
+static void evt_log(uint8_t id, uint32_t a0, uint32_t a1)
+{
+	uint8_t e[EVT_SZ];
+	const uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	const uint32_t ts = evt_time_us();
+	e[0] = PREAMBLE;
+	e[1] = CMD_EVENT;
+	e[2] = id;
+	e[3] = g_evt_seq++;		// zählt auch verworfene Events -> Lücke beim Host sichtbar
+	memcpy(&e[4],  &ts, 4);	// Cortex-M4: Little Endian
+	memcpy(&e[8],  &a0, 4);
+	memcpy(&e[12], &a1, 4);
+	txq_put(e, EVT_SZ, TXQ_RESERVE);
+	__set_PRIMASK(primask);
+}
+
 /*++++++++++++ Puls Form Helfer ++++++++++++ */
 /* Aktionen für Puls 1/2 – hier nur Beispiel, setz was du brauchst */
 static inline void positive_pulse_actions(void){
 	// ----- Halbbrücke links High Side aktiv -----
 	Drive_Left(true);
-	Enable_Left(true);
 	// ----- Halbbrücke rechts Low Side aktiv -----
 	Drive_Right(false);
-    Enable_Right(true);
+	Enable_Bridge(true);		// beide Enables (links + rechts)
 }
 static inline void negative_pulse_actions(void){
-	// ----- Halbbrücke links High Side aktiv -----
+	// ----- Halbbrücke links Low Side aktiv -----
 	Drive_Left(false);
-	Enable_Left(true);
-	// ----- Halbbrücke rechts Low Side aktiv -----
+	// ----- Halbbrücke rechts High Side aktiv -----
 	Drive_Right(true);
-    Enable_Right(true);
+	Enable_Bridge(true);
 }
 
 static inline void all_off(void){
 	// alle aus
-    Enable_Right(false);
-    Enable_Left(false);
+    Enable_Bridge(false);
     Drive_Right(false);
     Drive_Left(false);
 }
@@ -150,19 +551,56 @@ static inline TIM_HandleTypeDef* tim_by_id(uint8_t timer)
 	return (timer == 2) ? &htim2 : &htim1; // if timer == 2 return &htim2 else return &htim1
 }
 
-static void apply_set(uint8_t timer, uint16_t period_field, uint8_t flags)
+/* Timer direkt über Register starten/stoppen: ISR-tauglich und ohne den
+ * HAL-Zustand (htim->State), den die ISRs nicht mehr pflegen. */
+static inline void tim_run(TIM_TypeDef *tim)
 {
+	tim->CNT   = 0;
+	tim->SR    = ~TIM_SR_UIF;		// UIF löschen (rc_w0)
+	tim->DIER |= TIM_DIER_UIE;
+	tim->CR1  |= TIM_CR1_CEN;
+}
 
-	TIM_HandleTypeDef *ht =  tim_by_id(timer); // Timer Handle ermitteln
+static inline void tim_halt(TIM_TypeDef *tim)
+{
+	tim->CR1  &= ~TIM_CR1_CEN;
+	tim->DIER &= ~TIM_DIER_UIE;
+	tim->SR    = ~TIM_SR_UIF;
+}
 
-	HAL_TIM_Base_Stop(ht); // Timer stopppen für sichere konfiguration
-	__HAL_TIM_CLEAR_FLAG(ht, TIM_FLAG_UPDATE); // (UIF=)Update Interrupt Flag - Bit löschen
+/* Hardware-Verkettung: TIM2 (Master) gibt sein Update als TRGO aus, TIM1 (Slave)
+ * wird darüber im Combined-Reset+Trigger-Modus zurückgesetzt UND gestartet.
+ * Der Start jeder Pulsfolge hängt damit nicht mehr an der ISR-Latenz.
+ * G474: TIM1-ITR1 = TIM2_TRGO. */
+static inline bool hw_sync(void)
+{
+	return (Tcfg[0].flags & TF_HW_SYNC) != 0;
+}
 
+static void tim_sync_config(bool on)
+{
+	if (on) {
+		TIM2->CR2  = (TIM2->CR2 & ~TIM_CR2_MMS) | TIM_TRGO_UPDATE;
+		TIM1->SMCR = (TIM1->SMCR & ~(TIM_SMCR_TS | TIM_SMCR_SMS))
+				   | TIM_TS_ITR1 | TIM_SLAVEMODE_COMBINED_RESETTRIGGER;
+		TIM1->CR1 |= TIM_CR1_URS;		// Reset per Trigger erzeugt keinen Update-IRQ
+		TIM2->CR1 |= TIM_CR1_URS;		// UG beim Start: TRGO ohne Update-IRQ
+	} else {
+		TIM1->SMCR &= ~(TIM_SMCR_TS | TIM_SMCR_SMS);
+		TIM1->CR1  &= ~TIM_CR1_URS;
+		TIM2->CR1  &= ~TIM_CR1_URS;
+		TIM2->CR2  &= ~TIM_CR2_MMS;
+	}
+}
+
+/* Periode auf den zulässigen Bereich begrenzen (Wert in *v, für READBACK) und in Timer-Ticks umrechnen */
+static uint32_t period_ticks(uint8_t timer, uint16_t *v)
+{
 	uint32_t ticks = 1;
 
 	if (timer == 1){
         // --- FAST: period_field in µs ---
-        uint32_t us = period_field;
+        uint32_t us = *v;
         if (us < T1_US_MIN) us = T1_US_MIN;
         if (us > T1_US_MAX) us = T1_US_MAX;
 
@@ -170,10 +608,10 @@ static void apply_set(uint8_t timer, uint16_t period_field, uint8_t flags)
         ticks = (us + 5u) / 10u;            // 10..100 -> 1..10..100
         if (ticks == 0) ticks = 1;          // Schutz
 
-        Tcfg[timer-1].value = (uint16_t)us;   // READBACK in µs
+        *v = (uint16_t)us;                  // READBACK in µs
 	} else {
 		 // --- SLOW: period_field in ms ---
-		uint32_t ms = period_field;
+		uint32_t ms = *v;
 		if (ms < T2_MS_MIN) ms = T2_MS_MIN;     // Protokoll: min 1 ms (Timer könnte 0.5 ms)
 		if (ms > T2_MS_MAX) ms = T2_MS_MAX;
 
@@ -182,28 +620,38 @@ static void apply_set(uint8_t timer, uint16_t period_field, uint8_t flags)
 		if (ticks < 5u) ticks = 5u;             // Timer-Kapazität: min 0.5 ms (ARR>=4), nur falls 0.5 ms noch gewünscht ist
 		if (ticks > 100000u) ticks = 100000u;   // 10 s Grenze
 
-		Tcfg[timer-1].value = (uint16_t)ms;    // READBACK in ms
+		*v = (uint16_t)ms;                      // READBACK in ms
 	}
+	return ticks;
+}
+
+static void apply_set(uint8_t timer, uint16_t period_field, uint8_t flags)
+{
+
+	TIM_HandleTypeDef *ht =  tim_by_id(timer); // Timer Handle ermitteln
 
+	tim_halt(ht->Instance); // Timer stoppen für sichere Konfiguration, UIF löschen
+
+	uint16_t v = period_field;
+	const uint32_t ticks = period_ticks(timer, &v);
+	Tcfg[timer-1].value = v;
+
+	ht->Instance->CR1 &= ~TIM_CR1_ARPE;         // ARR sofort wirksam (Preload nur für RETIME)
 	__HAL_TIM_SET_AUTORELOAD(ht, (ticks - 1u)); // TImer zählt von 0 bis ARR = period - 1 (period-Anzahl an ticks)
     __HAL_TIM_SET_COUNTER(ht, 0u);
 
-	Tcfg[timer-1].flags = flags;	// FLAGS (Soft / Hard-Exit)
+	Tcfg[timer-1].flags = flags;	// FLAGS (Soft / Hard-Exit, TF_HW_SYNC)
+	if (timer == 1) tim_sync_config(hw_sync());
 }
 
 static void do_start(uint8_t timer)
 {
-    TIM_HandleTypeDef *ht = tim_by_id(timer); 	// Timer-Handle ermitteln
-    __HAL_TIM_SET_COUNTER(ht, 0);				// Counter auf 0 setzen
-    __HAL_TIM_CLEAR_FLAG(ht, TIM_FLAG_UPDATE);	// UIF-Bit löschen
-    HAL_TIM_Base_Start_IT(ht);					// Interrupt-Timer armen
+    tim_run(tim_by_id(timer)->Instance);		// Counter 0, UIF löschen, Interrupt-Timer armen
 }
 
 static void do_stop(uint8_t timer)
 {
-    TIM_HandleTypeDef *ht = tim_by_id(timer);	// Timer-Handle ermitteln
-    HAL_TIM_Base_Stop_IT(ht);					// Interrupt-Timer stoppen
-    __HAL_TIM_CLEAR_FLAG(ht, TIM_FLAG_UPDATE);	// UIF-Bit löschen
+    tim_halt(tim_by_id(timer)->Instance);		// Interrupt-Timer stoppen, UIF löschen
 }
 
 static void send_readback(uint8_t timer)
@@ -215,46 +663,1414 @@ static void send_readback(uint8_t timer)
     tx[2] = (uint8_t)(p & 0xFF);                  // LSB
     tx[3] = (uint8_t)(p >> 8);                    // MSB
     tx[4] = Tcfg[timer-1].flags;
-    HAL_UART_Transmit(&huart2, tx, sizeof tx, 100);	// TODO: hier über printf testen
-    // HAL_UART_Transmit(&huart2, (uint8_t *)&ch, 1, 100); => hierdurch unten, geht UART_Transmit auch über printf, drüber testen
+    tx_reply(tx, sizeof tx);
+}
+
+
+
+
+
+
+/*++++++++++++ Latenzmessung (DWT) ++++++++++++ */
+static void dwt_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t tim_period_cycles(const TIM_TypeDef *tim)
+{
+	return (tim->ARR + 1u) * (tim->PSC + 1u);	// TIMCLK = SYSCLK
+}
+
+/* Timer wurde gerade gestartet: erstes Update-Event ist eine Periode später fällig. */
+static inline void lat_arm(volatile uint32_t *due, volatile uint32_t *period, const TIM_TypeDef *tim)
+{
+	*period = tim_period_cycles(tim);
+	*due = DWT->CYCCNT + *period;
+}
+
+/* t_in = CYCCNT beim ISR-Eintritt: Abstand zum Soll-Zeitpunkt des Update-Events = Latenz. */
+static inline void lat_sample(uint8_t timer, volatile uint32_t *due, volatile uint32_t period,
+		uint32_t t_in)
+{
+	const uint32_t lat = t_in - *due;
+	if (lat < period) {
+		if (lat > g_lat_max) g_lat_max = lat;
+	} else {
+		g_overruns++;							// Event verpasst / ISR länger als eine Periode blockiert
+		evt_log(EVT_OVERRUN, timer, lat);
+	}
+	*due += period;
+}
+
+/* Am ISR-Ende: Laufzeit seit Eintritt (Budget-Kontrolle der Puls-ISRs). */
+static inline void isr_budget(uint32_t t_in)
+{
+	const uint32_t run = DWT->CYCCNT - t_in;
+	if (run > g_isr_max) g_isr_max = run;
+}
+
+/* Prioritäten nach IRQ_PRIO_* (Cube setzt alle auf 0) */
+static void nvic_config(void)
+{
+	HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+	HAL_NVIC_SetPriority(TIM8_BRK_IRQn,      IRQ_PRIO_BREAK, 0);
+	HAL_NVIC_SetPriority(TIM1_UP_TIM16_IRQn, IRQ_PRIO_TIM1, 0);
+	HAL_NVIC_SetPriority(TIM2_IRQn,          IRQ_PRIO_TIM2, 0);
+	HAL_NVIC_SetPriority(TIM3_IRQn,          IRQ_PRIO_HR, 0);
+	HAL_NVIC_SetPriority(TIM4_IRQn,          IRQ_PRIO_HR, 0);
+	HAL_NVIC_SetPriority(TIM5_IRQn,          IRQ_PRIO_HR, 0);
+	HAL_NVIC_SetPriority(TIM8_UP_IRQn,       IRQ_PRIO_WAVE, 0);
+	HAL_NVIC_SetPriority(DMA1_Channel4_IRQn, IRQ_PRIO_WAVE, 0);
+	HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, IRQ_PRIO_TX, 0);
+	HAL_NVIC_SetPriority(USART2_IRQn,        IRQ_PRIO_UART, 0);
+	HAL_NVIC_SetPriority(EXTI15_10_IRQn,     IRQ_PRIO_BUTTON, 0);
+}
+
+/*++++++++++++ ADC: U_DC und Brückenstrom ++++++++++++ */
+/* ADC_CR hat rs-Bits: nie eine 1 zurückschreiben, nur das gewünschte Bit setzen */
+static inline void adc_cr_set(uint32_t bit)
+{
+	ADC1->CR = (ADC1->CR & ~(ADC_CR_ADCAL | ADC_CR_JADSTP | ADC_CR_ADSTP | ADC_CR_JADSTART
+			| ADC_CR_ADSTART | ADC_CR_ADDIS | ADC_CR_ADEN)) | bit;
+}
+
+static bool adc_wait(volatile uint32_t *reg, uint32_t mask, uint32_t want)
+{
+	const uint32_t t0 = HAL_GetTick();
+	while ((*reg & mask) != want) {
+		if (HAL_GetTick() - t0 > 5u) return false;
+	}
+	return true;
+}
+
+/* ADC1: 2 Kanäle, 12 Bit, 47.5 Takte Sample-Zeit bei HCLK/4 = 42.5 MHz -> 1.41 µs je
+ * Wandlung, 2.82 µs je Paar. Synchroner Takt: feste Latenz zwischen TIM1_TRGO und Sample.
+ * TIM1 gibt sein Update als TRGO aus (MMS; der Slave-Modus für HW-Sync liegt in SMCR).
+ * Bei einem Fehler bleibt die ADC-Funktion aus, das Pulstiming ist nicht betroffen. */
+static void adc_init(void)
+{
+	GPIO_InitTypeDef gi = {0};
+
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_ADC12_CLK_ENABLE();
+	__HAL_RCC_DMAMUX1_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	gi.Pin  = GPIO_PIN_0 | GPIO_PIN_1;
+	gi.Mode = GPIO_MODE_ANALOG;
+	gi.Pull = GPIO_NOPULL;
+	HAL_GPIO_Init(GPIOA, &gi);
+
+	ADC12_COMMON->CCR = (ADC12_COMMON->CCR & ~ADC_CCR_CKMODE) | (3u << ADC_CCR_CKMODE_Pos);
+
+	// Deep-Power-Down verlassen, Regler an (t_ADCVREG_STUP = 20 µs), Kalibrierung single-ended
+	ADC1->CR = 0;
+	ADC1->CR = ADC_CR_ADVREGEN;
+	HAL_Delay(1);
+	adc_cr_set(ADC_CR_ADCAL);
+	if (!adc_wait(&ADC1->CR, ADC_CR_ADCAL, 0)) return;
+	for (volatile uint8_t d = 0; d < 16u; d++) { }	// >= 4 ADC-Takte vor ADEN
+	ADC1->ISR = ADC_ISR_ADRDY;
+	adc_cr_set(ADC_CR_ADEN);
+	if (!adc_wait(&ADC1->ISR, ADC_ISR_ADRDY, ADC_ISR_ADRDY)) return;
+
+	ADC1->SMPR1 = (4u << ADC_SMPR1_SMP1_Pos) | (4u << ADC_SMPR1_SMP2_Pos);	// 47.5 Takte
+	ADC1->SQR1  = (1u << ADC_SQR1_L_Pos)			// 2 Wandlungen
+				| (1u << ADC_SQR1_SQ1_Pos)			// IN1 = U_DC
+				| (2u << ADC_SQR1_SQ2_Pos);			// IN2 = I
+	ADC1->CFGR  = ADC_CFGR_JQDIS | ADC_CFGR_DMAEN | ADC_CFGR_DMACFG | ADC_CFGR_OVRMOD
+				| ADC_CFGR_CONT
+				| (ADC_EXTSEL_TIM1_TRGO << ADC_CFGR_EXTSEL_Pos)
+				| (1u << ADC_CFGR_EXTEN_Pos);		// steigende Flanke
+
+	TIM1->CR2 = (TIM1->CR2 & ~TIM_CR2_MMS) | TIM_TRGO_UPDATE;
+
+	hdma_adc1.Instance = DMA1_Channel2;
+	hdma_adc1.Init.Request = DMA_REQUEST_ADC1;
+	hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	hdma_adc1.Init.Mode = DMA_CIRCULAR;
+	hdma_adc1.Init.Priority = DMA_PRIORITY_HIGH;
+	if (HAL_DMA_Init(&hdma_adc1) != HAL_OK) return;
+	if (HAL_DMA_Start(&hdma_adc1, (uint32_t)&ADC1->DR, (uint32_t)adc_buf, ADC_PAIRS * 2u) != HAL_OK) return;
+
+	g_adc_ok = true;
+}
+
+/* Aktueller Schreib-Index im Ring (in Wertepaaren) */
+static inline uint16_t adc_pos(void)
+{
+	return (uint16_t)(((ADC_PAIRS * 2u - DMA1_Channel2->CNDTR) / 2u) % ADC_PAIRS);
+}
+
+/* Für das nächste Pulspaar scharf machen: DMA auf Ringanfang, damit jede Aufnahme
+ * paarweise ausgerichtet (U, I) bei Index 0 beginnt; gewandelt wird erst ab TIM1_TRGO. */
+static void adc_arm(void)
+{
+	if (!g_adc_ok || g_adc_dec == 0 || g_adc_armed || g_adc_done) return;
+	if (ADC1->CR & (ADC_CR_ADSTART | ADC_CR_ADSTP)) return;	// Stopp noch nicht fertig
+	DMA1_Channel2->CCR  &= ~DMA_CCR_EN;
+	DMA1_Channel2->CNDTR = ADC_PAIRS * 2u;
+	DMA1_Channel2->CCR  |= DMA_CCR_EN;
+	g_adc_i0 = g_adc_i1 = 0;
+	g_adc_armed = true;
+	adc_cr_set(ADC_CR_ADSTART);
+}
+
+static inline void adc_halt(void)
+{
+	if (ADC1->CR & ADC_CR_ADSTART) adc_cr_set(ADC_CR_ADSTP);
+}
+
+/* Aus der TIM1-ISR am Ende des Pulspaars: Wandlung stoppen, Auswertung anstoßen. */
+static inline void adc_pulse_done(void)
+{
+	if (!g_adc_armed) return;
+	adc_halt();
+	g_adc_i2 = adc_pos();
+	g_adc_cycle = g_cycle_cnt;
+	g_adc_armed = false;
+	g_adc_done = true;
+}
+
+typedef struct { uint16_t n, u_mean, u_min, u_max, i_mean, i_min, i_max; } adc_stat_t;
+
+static void adc_stats(uint16_t a, uint16_t b, adc_stat_t *st)
+{
+	uint32_t su = 0, si = 0;
+	uint16_t n = 0, umin = 0xFFFFu, umax = 0, imin = 0xFFFFu, imax = 0;
+
+	for (uint16_t k = a; k != b; k = (uint16_t)((k + 1u) % ADC_PAIRS)) {
+		const uint16_t u = adc_buf[k][0];
+		const uint16_t i = adc_buf[k][1];
+		su += u;
+		si += i;
+		if (u < umin) umin = u;
+		if (u > umax) umax = u;
+		if (i < imin) imin = i;
+		if (i > imax) imax = i;
+		n++;
+	}
+	if (n == 0) {
+		*st = (adc_stat_t){0};
+		return;
+	}
+	st->n = n;
+	st->u_mean = (uint16_t)((su + n / 2u) / n);
+	st->u_min = umin;
+	st->u_max = umax;
+	st->i_mean = (uint16_t)((si + n / 2u) / n);
+	st->i_min = imin;
+	st->i_max = imax;
+}
+
+static inline uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)(v & 0xFF);
+	p[1] = (uint8_t)(v >> 8);
+	return p + 2;
+}
+
+static void adc_send_record(void)
+{
+	adc_stat_t st[2];
+	uint8_t tx[ADC_REC_SZ];
+	const uint32_t cyc = g_adc_cycle;
+
+	adc_stats(g_adc_i0, g_adc_i1, &st[0]);
+	adc_stats(g_adc_i1, g_adc_i2, &st[1]);
+
+	tx[0] = PREAMBLE;
+	tx[1] = CMD_ADC_REC;
+	tx[2] = (uint8_t)(cyc & 0xFF);
+	tx[3] = (uint8_t)(cyc >> 8);
+	tx[4] = (uint8_t)(cyc >> 16);
+	tx[5] = (uint8_t)(cyc >> 24);
+	uint8_t *p = put_u16(&tx[6], st[0].n);
+	p = put_u16(p, st[1].n);
+	for (uint8_t k = 0; k < 2; k++) {
+		p = put_u16(p, st[k].u_mean);
+		p = put_u16(p, st[k].u_min);
+		p = put_u16(p, st[k].u_max);
+		p = put_u16(p, st[k].i_mean);
+		p = put_u16(p, st[k].i_min);
+		p = put_u16(p, st[k].i_max);
+	}
+	txq_put(tx, sizeof tx, TXQ_RESERVE);	// wie Events: bei vollem Ring verwerfen
+}
+
+/* Hauptschleife: erfasstes Pulspaar auswerten (jeden N-ten senden), neu scharf machen */
+static void adc_poll(void)
+{
+	if (g_adc_done) {
+		if (++g_adc_div >= g_adc_dec) {
+			g_adc_div = 0;
+			adc_send_record();
+		}
+		g_adc_done = false;
+	}
+	if (g_state == ST_RUN) adc_arm();
+}
+
+static void adc_set_decimation(uint16_t dec)
+{
+	g_adc_dec = dec;
+	g_adc_div = 0;
+	if (dec == 0) {
+		adc_halt();
+		g_adc_armed = false;
+		g_adc_done = false;
+	}
+
+	uint8_t tx[5];
+	tx[0] = PREAMBLE;
+	tx[1] = CMD_ADC;
+	tx[2] = (uint8_t)(dec & 0xFF);
+	tx[3] = (uint8_t)(dec >> 8);
+	tx[4] = (g_adc_ok ? ADC_ST_READY : 0) | (dec ? ADC_ST_ON : 0);
+	tx_reply(tx, sizeof tx);
+}
+
+/*++++++++++++ Schutz: Komparatoren -> TIM8-Break ++++++++++++ */
+static inline void prot_dac_write(uint8_t which, uint16_t thr)
+{
+	if (thr > 4095u) thr = 4095u;
+	g_prot_thr[which] = thr;
+	if (which == 0) DAC3->DHR12R1 = thr;	// Strom
+	else            DAC1->DHR12R1 = thr;	// Spannung
+}
+
+/* Register-Setup (kein COMP/DAC-HAL im Projekt). Reihenfolge: Schwellen stehen,
+ * Komparatoren laufen, TIM8 gibt "aus" aus – erst dann gehen PB6/PC7 auf TIM8. */
+static void prot_init(void)
+{
+	GPIO_InitTypeDef gi = {0};
+
+	__HAL_RCC_SYSCFG_CLK_ENABLE();			// COMP
+	__HAL_RCC_DAC1_CLK_ENABLE();
+	__HAL_RCC_DAC3_CLK_ENABLE();
+	__HAL_RCC_TIM8_CLK_ENABLE();
+	__HAL_RCC_GPIOB_CLK_ENABLE();
+	__HAL_RCC_GPIOC_CLK_ENABLE();
+
+	// DACs nur intern (Mode 011), HFSEL für AHB > 160 MHz
+	DAC1->MCR = (2u << DAC_MCR_HFSEL_Pos) | (3u << DAC_MCR_MODE1_Pos);
+	DAC3->MCR = (2u << DAC_MCR_HFSEL_Pos) | (3u << DAC_MCR_MODE1_Pos);
+	prot_dac_write(0, g_prot_thr[0]);
+	prot_dac_write(1, g_prot_thr[1]);
+	DAC1->CR = DAC_CR_EN1;
+	DAC3->CR = DAC_CR_EN1;
+	HAL_Delay(1);							// t_WAKEUP DAC
+
+	// INP0: COMP1 = PA1, COMP3 = PA0 (gleiche Pins wie der ADC, analog schon konfiguriert)
+	// INM: COMP1 = DAC3_CH1 (100), COMP3 = DAC1_CH1 (101); Hysterese 20 mV
+	COMP1->CSR = (4u << COMP_CSR_INMSEL_Pos) | (2u << COMP_CSR_HYST_Pos);
+	COMP3->CSR = (5u << COMP_CSR_INMSEL_Pos) | (2u << COMP_CSR_HYST_Pos);
+	COMP1->CSR |= COMP_CSR_EN;
+	COMP3->CSR |= COMP_CSR_EN;
+	HAL_Delay(1);							// t_START COMP
+
+	// TIM8: CH1/CH2 forced inactive, aktiv high, Idle low; Break aus COMP1/COMP3, aktiv high
+	TIM8->CCMR1 = EN_OCM(false) | (EN_OCM(false) << 8);
+	TIM8->CR2  &= ~(TIM_CR2_OIS1 | TIM_CR2_OIS2);
+	TIM8->CCER  = TIM_CCER_CC1E | TIM_CCER_CC2E;
+	TIM8->AF1   = TIM1_AF1_BKCMP1E | TIM1_AF1_BKCMP3E;
+	TIM8->BDTR  = TIM_BDTR_OSSI | TIM_BDTR_OSSR | TIM_BDTR_BKE | TIM_BDTR_BKP
+				| (PROT_BKF << TIM_BDTR_BKF_Pos);
+	TIM8->SR    = ~TIM_SR_BIF;
+	TIM8->DIER |= TIM_DIER_BIE;
+	if (!(COMP1->CSR & COMP_CSR_VALUE) && !(COMP3->CSR & COMP_CSR_VALUE)) {
+		TIM8->BDTR |= TIM_BDTR_MOE;
+	} else {
+		g_fault = (uint8_t)(((COMP1->CSR & COMP_CSR_VALUE) ? PROT_F_OC : 0)
+				| ((COMP3->CSR & COMP_CSR_VALUE) ? PROT_F_OV : 0));
+	}
+
+	gi.Pin = Enable_Right_Pin;				// PB6 = TIM8_CH1
+	gi.Mode = GPIO_MODE_AF_PP;
+	gi.Pull = GPIO_PULLDOWN;				// auch bei Hi-Z sicher aus
+	gi.Speed = GPIO_SPEED_FREQ_HIGH;
+	gi.Alternate = GPIO_AF5_TIM8;
+	HAL_GPIO_Init(Enable_Right_GPIO_Port, &gi);
+	gi.Pin = Enable_Left_Pin;				// PC7 = TIM8_CH2
+	gi.Alternate = GPIO_AF4_TIM8;
+	HAL_GPIO_Init(Enable_Left_GPIO_Port, &gi);
+
+	HAL_NVIC_EnableIRQ(TIM8_BRK_IRQn);
+}
+
+/* Fehler quittieren: nur wenn kein Komparator mehr anliegt, sonst bleibt der Latch. */
+static void prot_clear(void)
+{
+	if ((COMP1->CSR & COMP_CSR_VALUE) || (COMP3->CSR & COMP_CSR_VALUE)) return;
+	const uint8_t old = g_fault;
+	Enable_Bridge(false);
+	TIM8->SR    = ~TIM_SR_BIF;
+	TIM8->DIER |= TIM_DIER_BIE;
+	TIM8->BDTR |= TIM_BDTR_MOE;
+	g_fault = 0;
+	if (old) evt_log(EVT_FAULT_CLR, old, 0);
+}
+
+static void prot_command(uint8_t which, uint16_t thr, uint8_t flags)
+{
+	if (thr != 0) prot_dac_write(which, thr);
+	if (flags & PROT_F_RESET) prot_clear();
+
+	uint8_t tx[5];
+	tx[0] = PREAMBLE;
+	tx[1] = CMD_PROT + which;					// 0xA0/0xA1
+	tx[2] = (uint8_t)(g_prot_thr[which] & 0xFF);
+	tx[3] = (uint8_t)(g_prot_thr[which] >> 8);
+	tx[4] = g_fault;
+	tx_reply(tx, sizeof tx);
+}
+
+/*++++++++++++ WAVE: Zustandsfolgen per TIM8 + DMA ++++++++++++ */
+#define WAVE_CCMR1  ((TIM_OCMODE_PWM1 | TIM_CCMR1_OC1PE) | ((TIM_OCMODE_PWM1 | TIM_CCMR1_OC1PE) << 8))
+
+/* TIM8->DIER teilen sich WAVE und Break-ISR: nur atomar ändern */
+static inline void tim8_dier(uint32_t clr, uint32_t set)
+{
+	const uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	TIM8->DIER = (TIM8->DIER & ~clr) | set;
+	__set_PRIMASK(primask);
+}
+
+static inline uint32_t wave_bsrr_of(uint8_t st)
+{
+	return ((st & WS_DRIVE_L) ? GPIO_PIN_8 : (uint32_t)GPIO_PIN_8 << 16)
+		 | ((st & WS_DRIVE_R) ? GPIO_PIN_9 : (uint32_t)GPIO_PIN_9 << 16);
+}
+
+static inline uint32_t wave_ccr_of(uint8_t st)
+{
+	return (st & WS_ENABLE) ? 0xFFFFu : 0u;		// PWM1: aktiv solange CNT < CCR
+}
+
+/* CRC16-CCITT über Zustand + Dauer (LSB, MSB) je Schritt, wie im WAVE_DATA-Frame */
+static uint16_t wave_crc_step(uint16_t crc, uint8_t state, uint16_t ticks)
+{
+	const uint8_t b[3] = { state, (uint8_t)(ticks & 0xFF), (uint8_t)(ticks >> 8) };
+	for (uint8_t j = 0; j < 3; j++) {
+		crc ^= (uint16_t)b[j] << 8;
+		for (uint8_t i = 0; i < 8; i++) {
+			crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static uint16_t wave_crc(const wave_step_t *tab, uint16_t n)
+{
+	uint16_t crc = 0xFFFFu;
+	for (uint16_t k = 0; k < n; k++) crc = wave_crc_step(crc, tab[k].state, tab[k].ticks);
+	return crc;
+}
+
+typedef struct { uint32_t magic; uint16_t len; uint16_t crc; } wave_hdr_t;
+
+static inline const wave_hdr_t *wave_flash_hdr(void)
+{
+	const wave_hdr_t *h = (const wave_hdr_t *)WAVE_FLASH_ADDR;
+	return (h->magic == WAVE_MAGIC && h->len > 0 && h->len <= WAVE_MAX_STEPS) ? h : NULL;
+}
+
+/* true, wenn der Flash genau die aktuelle Tabelle enthält */
+static bool wave_stored(void)
+{
+	const wave_hdr_t *h = wave_flash_hdr();
+	return h && h->len == wave_len && h->crc == wave_crc(wave_tab, wave_len);
+}
+
+static bool wave_flash_load(void)
+{
+	const wave_hdr_t *h = wave_flash_hdr();
+	if (!h || g_state == ST_WAVE) return false;
+	const uint32_t *src = (const uint32_t *)(WAVE_FLASH_ADDR + sizeof *h);
+	uint16_t crc = 0xFFFFu;
+	for (uint16_t k = 0; k < h->len; k++) {
+		crc = wave_crc_step(crc, (uint8_t)(src[k] & 0xFF), (uint16_t)(src[k] >> 16));
+	}
+	if (crc != h->crc) return false;		// halb geschriebene Seite: RAM-Tabelle behalten
+	for (uint16_t k = 0; k < h->len; k++) {
+		wave_tab[k] = (wave_step_t){ (uint8_t)(src[k] & 0xFF), 0, (uint16_t)(src[k] >> 16) };
+	}
+	wave_len = h->len;
+	return true;
+}
+
+/* Letzte Flash-Seite löschen und neu schreiben (nur im Leerlauf: ~20 ms ohne Antwort).
+ * Dual-Bank (Werkseinstellung): Bank 2, Seite 127 = 2 KB; Single-Bank: Seite 127 = 4 KB ab
+ * 0x0807F000 -- beides liegt im vom Linker-Skript ausgesparten Bereich (LENGTH = 508K). */
+static bool wave_flash_save(void)
+{
+	if (g_state != ST_IDLE || wave_len == 0) return false;
+	if (wave_stored()) return true;
+
+	FLASH_EraseInitTypeDef er = {0};
+	uint32_t page_err = 0;
+	er.TypeErase = FLASH_TYPEERASE_PAGES;
+	er.Banks     = (FLASH->OPTR & FLASH_OPTR_DBANK) ? FLASH_BANK_2 : FLASH_BANK_1;
+	er.Page      = 127;
+	er.NbPages   = 1;
+
+	const uint16_t crc = wave_crc(wave_tab, wave_len);
+	HAL_FLASH_Unlock();
+	bool ok = (HAL_FLASHEx_Erase(&er, &page_err) == HAL_OK);
+	const uint64_t hdr = WAVE_MAGIC | ((uint64_t)wave_len << 32) | ((uint64_t)crc << 48);
+	ok = ok && HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, WAVE_FLASH_ADDR, hdr) == HAL_OK;
+	for (uint16_t k = 0; ok && k < wave_len; k += 2u) {
+		const uint32_t lo = wave_tab[k].state | ((uint32_t)wave_tab[k].ticks << 16);
+		const uint32_t hi = (k + 1u < wave_len)
+				? wave_tab[k + 1u].state | ((uint32_t)wave_tab[k + 1u].ticks << 16) : 0xFFFFFFFFu;
+		ok = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, WAVE_FLASH_ADDR + 8u + 4u * k,
+				lo | ((uint64_t)hi << 32)) == HAL_OK;
+	}
+	HAL_FLASH_Lock();
+	return ok && wave_stored();
+}
+
+/* TIM8-Zeitbasis und zwei DMA-Kanäle; die Enables bleiben bis zum ersten Abspielen im
+ * Forced-Mode aus prot_init. Gespeicherte Tabelle wird übernommen. */
+static void wave_init(void)
+{
+	__HAL_RCC_DMAMUX1_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	hdma_wave_up.Instance = DMA1_Channel3;
+	hdma_wave_up.Init.Request = DMA_REQUEST_TIM8_UP;
+	hdma_wave_up.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	hdma_wave_up.Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma_wave_up.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_wave_up.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+	hdma_wave_up.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+	hdma_wave_up.Init.Mode = DMA_NORMAL;
+	hdma_wave_up.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+	hdma_wave_cc3 = hdma_wave_up;
+	hdma_wave_cc3.Instance = DMA1_Channel4;
+	hdma_wave_cc3.Init.Request = DMA_REQUEST_TIM8_CH3;
+	if (HAL_DMA_Init(&hdma_wave_up) != HAL_OK) return;
+	if (HAL_DMA_Init(&hdma_wave_cc3) != HAL_OK) return;
+	DMA1_Channel3->CPAR = (uint32_t)&GPIOA->BSRR;
+	DMA1_Channel4->CPAR = (uint32_t)&TIM8->DMAR;
+
+	TIM8->PSC  = WAVE_PSC;
+	TIM8->CR1  = TIM_CR1_ARPE | TIM_CR1_URS;	// UG lädt nur die Preloads, ohne DMA/IRQ
+	TIM8->CCR3 = 1u;
+	TIM8->DCR  = (WAVE_DBA_ARR << TIM_DCR_DBA_Pos) | (3u << TIM_DCR_DBL_Pos);	// 4 Register
+
+	HAL_NVIC_EnableIRQ(TIM8_UP_IRQn);
+	HAL_NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+	g_wave_ok = true;
+	wave_flash_load();
+}
+
+/* DMA-Quellen aus der Tabelle aufbauen (Hauptschleife, vor dem Start) */
+static void wave_prepare(void)
+{
+	for (uint16_t k = 1; k <= wave_len; k++) {
+		const bool end = (k == wave_len);
+		const uint8_t  st = end ? 0u : wave_tab[k].state;
+		const uint16_t ti = end ? WAVE_MIN_TICKS : wave_tab[k].ticks;
+		wave_bsrr[k - 1u]     = wave_bsrr_of(st);
+		wave_burst[k - 1u][0] = ti - 1u;
+		wave_burst[k - 1u][1] = 0;
+		wave_burst[k - 1u][2] = wave_ccr_of(st);
+		wave_burst[k - 1u][3] = wave_ccr_of(st);
+	}
 }
 
+/* Einen Durchlauf starten: Schritt 0 direkt laden, ab Schritt 1 übernimmt die DMA.
+ * Auch aus wave_tim_isr (Folge-Durchlauf). */
+static void wave_start_pass(void)
+{
+	const wave_step_t *s0 = &wave_tab[0];
+
+	TIM8->CR1 &= ~(TIM_CR1_CEN | TIM_CR1_OPM);
+	tim8_dier(TIM_DIER_UDE | TIM_DIER_CC3DE | TIM_DIER_UIE, 0);	// alte Requests verwerfen
+	TIM8->ARR  = s0->ticks - 1u;
+	TIM8->CCR1 = wave_ccr_of(s0->state);
+	TIM8->CCR2 = wave_ccr_of(s0->state);
+	TIM8->CNT  = 0;
+	TIM8->EGR  = TIM_EGR_UG;
+	GPIOA->BSRR = wave_bsrr_of(s0->state);	// Drives vor den Enables
+	TIM8->CCMR1 = WAVE_CCMR1;
+
+	DMA1_Channel3->CCR  &= ~DMA_CCR_EN;
+	DMA1_Channel3->CMAR  = (uint32_t)wave_bsrr;
+	DMA1_Channel3->CNDTR = wave_len;
+	DMA1_Channel3->CCR  |= DMA_CCR_EN;
+	DMA1_Channel4->CCR  &= ~DMA_CCR_EN;
+	DMA1->IFCR           = DMA_IFCR_CGIF4;
+	DMA1_Channel4->CMAR  = (uint32_t)wave_burst;
+	DMA1_Channel4->CNDTR = wave_len * 4u;
+	DMA1_Channel4->CCR  |= DMA_CCR_TCIE | DMA_CCR_EN;
+
+	TIM8->SR = ~(TIM_SR_UIF | TIM_SR_CC3IF);
+	tim8_dier(0, TIM_DIER_UDE | TIM_DIER_CC3DE);
+	TIM8->CR1 |= TIM_CR1_CEN;
+}
+
+/* Timer und DMA anhalten; Enables setzt der Aufrufer (all_off -> Forced-Mode). */
+static void wave_halt(void)
+{
+	TIM8->CR1 &= ~(TIM_CR1_CEN | TIM_CR1_OPM);
+	tim8_dier(TIM_DIER_UDE | TIM_DIER_CC3DE | TIM_DIER_UIE, 0);
+	DMA1_Channel3->CCR &= ~DMA_CCR_EN;
+	DMA1_Channel4->CCR &= ~(DMA_CCR_EN | DMA_CCR_TCIE);
+}
+
+static bool wave_run(uint16_t reps)
+{
+	if (!g_wave_ok || g_state != ST_IDLE || g_fault || wave_len == 0) return false;
+	wave_prepare();
+	g_wave_rep = reps ? reps : 1u;
+	g_wave_passes = 0;
+	g_state = ST_WAVE;
+	evt_log(EVT_WAVE_START, wave_len, g_wave_rep);
+	wave_start_pass();
+	return true;
+}
+
+/* WAVE_DATA: bis zu 3 Schritte ab Index schreiben (nicht während des Abspielens) */
+static void wave_data(const uint8_t *f)
+{
+	const uint16_t idx = (uint16_t)f[2] | ((uint16_t)f[3] << 8);
+	const uint8_t  n   = f[4];
+	uint8_t status = 0;
+
+	if (g_state == ST_WAVE || n == 0 || n > 3u || idx + n > WAVE_MAX_STEPS || idx > wave_len) {
+		status |= WAVE_ST_REJECT;
+	} else {
+		for (uint8_t k = 0; k < n; k++) {
+			const uint8_t *p = &f[5u + 3u * k];
+			uint16_t ticks = (uint16_t)p[1] | ((uint16_t)p[2] << 8);
+			if (ticks < WAVE_MIN_TICKS) ticks = WAVE_MIN_TICKS;
+			wave_tab[idx + k] = (wave_step_t){ (uint8_t)(p[0] & (WS_DRIVE_L | WS_DRIVE_R | WS_ENABLE)), 0, ticks };
+		}
+		if (idx + n > wave_len) wave_len = (uint16_t)(idx + n);
+	}
+	if (g_state == ST_WAVE) status |= WAVE_ST_RUNNING;
+
+	uint8_t tx[5];
+	tx[0] = PREAMBLE;
+	tx[1] = CMD_WAVE;
+	tx[2] = (uint8_t)(wave_len & 0xFF);
+	tx[3] = (uint8_t)(wave_len >> 8);
+	tx[4] = status;
+	tx_reply(tx, sizeof tx);
+}
+
+/* WAVE_CTRL: Reihenfolge STOP, CLEAR, LOAD, SAVE, RUN – mehrere Flags in einem Frame möglich */
+static void wave_ctrl(uint16_t value, uint8_t flags)
+{
+	bool ok = true;
+
+	if ((flags & WAVE_F_STOP) && g_state == ST_WAVE) {
+		wave_halt();
+		all_off();
+		g_state = ST_IDLE;
+		evt_log(EVT_WAVE_DONE, g_wave_passes, 1);
+	}
+	if (flags & WAVE_F_CLEAR) {
+		if (g_state == ST_WAVE) ok = false; else wave_len = 0;
+	}
+	if (flags & WAVE_F_LOAD) ok = wave_flash_load() && ok;
+	if (flags & WAVE_F_SAVE) ok = wave_flash_save() && ok;
+	if (flags & WAVE_F_RUN)  ok = wave_run(value) && ok;
+
+	const uint16_t crc = wave_crc(wave_tab, wave_len);
+	uint8_t tx[WAVE_ACK_SZ];
+	tx[0] = PREAMBLE;
+	tx[1] = CMD_WAVE_CTRL;
+	tx[2] = (uint8_t)(wave_len & 0xFF);
+	tx[3] = (uint8_t)(wave_len >> 8);
+	tx[4] = (uint8_t)(crc & 0xFF);
+	tx[5] = (uint8_t)(crc >> 8);
+	tx[6] = (g_state == ST_WAVE ? WAVE_ST_RUNNING : 0) | (wave_stored() ? WAVE_ST_STORED : 0)
+		  | (ok ? 0 : WAVE_ST_REJECT);
+	tx_reply(tx, sizeof tx);
+}
+
+/*++++++++++++ HRTIM: Mehrkanalbetrieb ++++++++++++ */
+typedef struct { GPIO_TypeDef *port; uint8_t pin; uint8_t af; uint8_t idle; } hr_pin_t;
+#define PIN_OUT 0xFFu		// Ausgang low statt Alternate Function
+
+// [Kanal][Drive L, Drive R, Enable L, Enable R]: AF im Mehrkanalbetrieb, sonst "idle"
+static const hr_pin_t hr_pin_tab[HR_CH][4] = {
+	{ { GPIOA,  8, GPIO_AF13_HRTIM1, PIN_OUT }, { GPIOA,  9, GPIO_AF13_HRTIM1, PIN_OUT },
+	  { GPIOB, 14, GPIO_AF13_HRTIM1, PIN_OUT }, { GPIOB, 15, GPIO_AF13_HRTIM1, PIN_OUT } },
+	{ { GPIOA, 10, GPIO_AF13_HRTIM1, PIN_OUT }, { GPIOA, 11, GPIO_AF13_HRTIM1, PIN_OUT },
+	  { GPIOC,  8, GPIO_AF3_HRTIM1,  PIN_OUT }, { GPIOC,  9, GPIO_AF3_HRTIM1,  PIN_OUT } },
+	{ { GPIOB, 12, GPIO_AF13_HRTIM1, PIN_OUT }, { GPIOB, 13, GPIO_AF13_HRTIM1, PIN_OUT },
+	  { GPIOC,  6, GPIO_AF13_HRTIM1, PIN_OUT }, { GPIOC,  7, GPIO_AF13_HRTIM1, GPIO_AF4_TIM8 } },
+};
+static TIM_TypeDef *const hr_t2_tim[HR_CH] = { TIM3, TIM4, TIM5 };
+
+/* Pin-Umschaltung per Register (auch aus seq_hard_stop im Break-IRQ) */
+static void pin_mode(GPIO_TypeDef *port, uint8_t pin, uint8_t af)
+{
+	const uint32_t sh = 2u * pin;
+	if (af == PIN_OUT) {
+		port->BSRR  = (uint32_t)1u << (pin + 16u);
+		port->MODER = (port->MODER & ~(3u << sh)) | (1u << sh);
+		return;
+	}
+	const uint32_t ah = 4u * (pin & 7u);
+	port->AFR[pin >> 3] = (port->AFR[pin >> 3] & ~(0xFu << ah)) | ((uint32_t)af << ah);
+	port->OSPEEDR |= 3u << sh;
+	port->MODER = (port->MODER & ~(3u << sh)) | (2u << sh);
+}
+
+static void hr_pins(bool on)
+{
+	for (uint8_t ch = 0; ch < HR_CH; ch++) {
+		for (uint8_t k = 0; k < 4u; k++) {
+			const hr_pin_t *p = &hr_pin_tab[ch][k];
+			pin_mode(p->port, p->pin, on ? p->af : p->idle);
+		}
+	}
+}
+
+/* Einheit ch (Drives) und ch + 3 (Enables) als Bitmaske A..F */
+static inline uint32_t hr_units(uint8_t ch) { return (1u << ch) | (1u << (ch + 3u)); }
+static inline uint32_t hr_oen(uint8_t ch)   { return (3u << (2u * ch)) | (3u << (2u * (ch + 3u))); }
+
+/* MCR teilen sich Hauptschleife und IRQs: nur atomar ändern */
+static inline void hr_mcr(uint32_t clr, uint32_t set)
+{
+	const uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	HRTIM1->sMasterRegs.MCR = (HRTIM1->sMasterRegs.MCR & ~clr) | set;
+	__set_PRIMASK(primask);
+}
+
+/* DLL kalibrieren, Fault 4/5 = COMP1/COMP3 (intern, aktiv high), Zyklus-Timer vorbereiten.
+ * Alle Kanal-Pins bleiben Ausgänge low bzw. bei der Einzelbrücke. Nach prot_init. */
+static void hr_init(void)
+{
+	__HAL_RCC_HRTIM1_CLK_ENABLE();
+	__HAL_RCC_TIM3_CLK_ENABLE();
+	__HAL_RCC_TIM4_CLK_ENABLE();
+	__HAL_RCC_TIM5_CLK_ENABLE();
+	hr_pins(false);
+
+	HRTIM1->sCommonRegs.DLLCR = HRTIM_DLLCR_CAL | HRTIM_DLLCR_CALEN | HRTIM_DLLCR_CALRTE_0;
+	if (!adc_wait(&HRTIM1->sCommonRegs.ISR, HRTIM_ISR_DLLRDY, HRTIM_ISR_DLLRDY)) return;
+	HRTIM1->sCommonRegs.FLTINR1 = HRTIM_FLTINR1_FLT4E | HRTIM_FLTINR1_FLT4P | HRTIM_FLTINR1_FLT4SRC_0;
+	HRTIM1->sCommonRegs.FLTINR2 = HRTIM_FLTINR2_FLT5E | HRTIM_FLTINR2_FLT5P | HRTIM_FLTINR2_FLT5SRC_0;
+
+	for (uint8_t ch = 0; ch < HR_CH; ch++) {
+		TIM_TypeDef *tim = hr_t2_tim[ch];
+		tim->PSC = HR_T2_PSC;
+		tim->ARR = T2_MS_MIN * HR_T2_TICKS_MS - 1u;
+		tim->CR1 = TIM_CR1_URS;
+		tim->EGR = TIM_EGR_UG;				// Prescaler laden, ohne Update-IRQ
+		tim->SR  = 0;
+	}
+	HAL_NVIC_EnableIRQ(TIM3_IRQn);
+	HAL_NVIC_EnableIRQ(TIM4_IRQn);
+	HAL_NVIC_EnableIRQ(TIM5_IRQn);
+	g_hr_ok = true;
+}
+
+/* T1 in ps auf das HRTIM-Raster legen: kleinster Prescaler, bei dem Vorlauf + Puls+ + Puls-
+ * + Nachlauf in die 16-Bit-Periode passen. Register nur bei stehendem Kanal schreiben. */
+static uint8_t hr_setup(uint8_t ch, uint32_t t1_ps, uint16_t t2_ms, uint16_t n)
+{
+	hr_ch_t *c = &hr_ch[ch];
+	uint32_t ps = t1_ps;
+	if (ps < HR_T1_PS_MIN) ps = HR_T1_PS_MIN;
+	if (ps > HR_T1_PS_MAX) ps = HR_T1_PS_MAX;
+
+	const uint32_t hr = (uint32_t)(((uint64_t)ps * 544u + 50000u) / 100000u);	// 5.44 GHz
+	uint32_t psc = 0, t1t, lead;
+	for (;;) {
+		t1t  = (hr + ((1u << psc) >> 1)) >> psc;
+		lead = HR_LEAD >> psc;
+		if (lead < HR_CMP_MIN) lead = HR_CMP_MIN;
+		if (2u * (lead + t1t) <= HR_PER_MAX || psc == 7u) break;
+		psc++;
+	}
+	const uint32_t per = 2u * (lead + t1t);
+	c->t1_ps = (uint32_t)((((uint64_t)t1t << psc) * 100000u + 272u) / 544u);
+
+	// T2 muss das ganze Pulspaar fassen (retriggerbar: sonst schneidet der Neustart ab)
+	const uint32_t pair_ms = (uint32_t)((((uint64_t)per << psc) * 100000u / 544u) / 1000000000u) + 1u;
+	uint32_t ms = t2_ms;
+	if (ms < T2_MS_MIN) ms = T2_MS_MIN;
+	if (ms < pair_ms)   ms = pair_ms;
+	if (ms > T2_MS_MAX) ms = T2_MS_MAX;
+	c->t2_ms = (uint16_t)ms;
+	c->n     = n;
+
+	for (uint8_t u = ch; u < 6u; u += 3u) {
+		HRTIM_Timerx_TypeDef *t = &HRTIM1->sTimerxRegs[u];
+		t->TIMxCR = HRTIM_TIMCR_RETRIG | (psc << HRTIM_TIMCR_CK_PSC_Pos);	// Single-Shot
+		t->PERxR  = per;
+		t->CMP1xR = lead;
+		t->CMP2xR = lead + t1t;
+		t->CMP3xR = lead + 2u * t1t;
+		t->OUTxR  = (2u << HRTIM_OUTR_FAULT1_Pos) | (2u << HRTIM_OUTR_FAULT2_Pos);	// Fault: inaktiv
+		t->FLTxR  = HRTIM_FLTR_FLT4EN | HRTIM_FLTR_FLT5EN;
+	}
+	HRTIM_Timerx_TypeDef *drv = &HRTIM1->sTimerxRegs[ch];
+	HRTIM_Timerx_TypeDef *en  = &HRTIM1->sTimerxRegs[ch + 3u];
+	drv->SETx1R = HRTIM_SET1R_CMP1;		// links High Side: Puls+
+	drv->RSTx1R = HRTIM_RST1R_CMP2;
+	drv->SETx2R = HRTIM_SET2R_CMP2;		// rechts High Side: Puls-
+	drv->RSTx2R = HRTIM_RST2R_CMP3;
+	en->SETx1R  = HRTIM_SET1R_CMP1;		// Enables über beide Pulse
+	en->RSTx1R  = HRTIM_RST1R_CMP3;
+	en->SETx2R  = HRTIM_SET2R_CMP1;
+	en->RSTx2R  = HRTIM_RST2R_CMP3;
+	hr_t2_tim[ch]->ARR = ms * HR_T2_TICKS_MS - 1u;
+	c->cfg = true;
+
+	return (ps != t1_ps || ms != t2_ms) ? CHAN_ST_CLAMPED : 0;
+}
+
+/* Kanal sofort anhalten (ISR-tauglich): Zyklus-Timer aus, Ausgänge idle (low) */
+static void hr_halt(uint8_t ch)
+{
+	hr_ch_t *c = &hr_ch[ch];
+	if (c->run) evt_log(EVT_CH_STOP, ch, c->fired);
+	tim_halt(hr_t2_tim[ch]);
+	HRTIM1->sCommonRegs.ODISR = hr_oen(ch);
+	hr_mcr(hr_units(ch) << HRTIM_MCR_TACEN_Pos, 0);
+	c->run = false;
+}
+
+/* Soll erreicht: nur der Zyklus-Timer stoppt, das letzte Pulspaar läuft im HRTIM zu Ende */
+static void hr_finish(uint8_t ch)
+{
+	hr_ch_t *c = &hr_ch[ch];
+	tim_halt(hr_t2_tim[ch]);
+	c->run = false;
+	evt_log(EVT_CH_DONE, ch, c->fired);
+}
+
+/* Alle Kanäle aus, Pins zurück an die Einzelbrücke (auch aus seq_hard_stop) */
+static void hr_exit(void)
+{
+	for (uint8_t ch = 0; ch < HR_CH; ch++) hr_halt(ch);
+	hr_pins(false);
+	g_state = ST_IDLE;
+}
+
+/* Erstes Pulspaar sofort, weitere per Zyklus-Timer. Betritt bei Bedarf den Mehrkanalbetrieb. */
+static bool hr_start(uint8_t ch)
+{
+	hr_ch_t *c = &hr_ch[ch];
+	if (!g_hr_ok || !c->cfg || c->run || g_fault) return false;
+	if (g_state == ST_IDLE) {
+		hr_pins(true);
+		g_state = ST_MULTI;
+	}
+	if (g_state != ST_MULTI) return false;
+
+	for (uint8_t u = ch; u < 6u; u += 3u) {
+		HRTIM1->sTimerxRegs[u].RSTx1R |= HRTIM_RST1R_SRT;	// interne Ausgangszustände low
+		HRTIM1->sTimerxRegs[u].RSTx2R |= HRTIM_RST2R_SRT;
+	}
+	HRTIM1->sCommonRegs.OENR = hr_oen(ch);
+	c->fired = 1;
+	c->run = true;
+	evt_log(EVT_CH_START, ch, c->n);
+	hr_mcr(0, hr_units(ch) << HRTIM_MCR_TACEN_Pos);
+	HRTIM1->sCommonRegs.CR2 = hr_units(ch) << HRTIM_CR2_TARST_Pos;	// beide Einheiten zugleich
+	if (c->n == 1u) hr_finish(ch);
+	else            tim_run(hr_t2_tim[ch]);
+	return true;
+}
+
+static uint8_t hr_status(uint16_t ch)
+{
+	return (ch < HR_CH && hr_ch[ch].run ? CHAN_ST_RUNNING : 0)
+		 | (g_state == ST_MULTI ? CHAN_ST_MULTI : 0);
+}
+
+/* CHAN: Kanal setzen (hält ihn vorher an), optional starten, ein ACK mit den erreichten Werten */
+static void hr_config(const uint8_t *f)
+{
+	const uint8_t  ch = f[2];
+	const uint32_t t1 = (uint32_t)f[3] | ((uint32_t)f[4] << 8) | ((uint32_t)f[5] << 16)
+					  | ((uint32_t)f[6] << 24);
+	const uint16_t t2 = (uint16_t)f[7] | ((uint16_t)f[8] << 8);
+	const uint16_t n  = (uint16_t)f[9] | ((uint16_t)f[10] << 8);
+	uint8_t status = 0;
+
+	if (!g_hr_ok || ch >= HR_CH || (g_state != ST_IDLE && g_state != ST_MULTI)) {
+		status |= CHAN_ST_REJECT;
+	} else {
+		hr_halt(ch);
+		status |= hr_setup(ch, t1, t2, n);
+		if ((f[11] & CHAN_F_START) && !hr_start(ch)) status |= CHAN_ST_REJECT;
+	}
+
+	const hr_ch_t *c = (ch < HR_CH) ? &hr_ch[ch] : NULL;
+	const uint32_t t1r = c ? c->t1_ps : 0;
+	uint8_t tx[CHAN_SZ];
+	tx[0]  = PREAMBLE;
+	tx[1]  = CMD_CHAN;
+	tx[2]  = ch;
+	tx[3]  = (uint8_t)(t1r & 0xFF);
+	tx[4]  = (uint8_t)(t1r >> 8);
+	tx[5]  = (uint8_t)(t1r >> 16);
+	tx[6]  = (uint8_t)(t1r >> 24);
+	tx[7]  = (uint8_t)((c ? c->t2_ms : 0) & 0xFF);
+	tx[8]  = (uint8_t)((c ? c->t2_ms : 0) >> 8);
+	tx[9]  = (uint8_t)((c ? c->n : 0) & 0xFF);
+	tx[10] = (uint8_t)((c ? c->n : 0) >> 8);
+	tx[11] = status | hr_status(ch);
+	tx_reply(tx, sizeof tx);
+}
+
+/* CHAN_CTRL: Reihenfolge EXIT, STOP, START; Antwort = Zählerstand des Kanals */
+static void hr_ctrl(uint16_t ch, uint8_t flags)
+{
+	bool ok = true;
+
+	if (flags & CHAN_F_EXIT) {
+		if (g_state == ST_MULTI) hr_exit();
+	} else if (ch >= HR_CH) {
+		ok = false;
+	} else {
+		if (flags & CHAN_F_STOP)  hr_halt(ch);
+		if (flags & CHAN_F_START) ok = hr_start((uint8_t)ch);
+	}
+
+	const hr_ch_t *c = (ch < HR_CH) ? &hr_ch[ch] : NULL;
+	const uint32_t fired = c ? c->fired : 0;
+	const uint16_t rem = (c && c->run && c->n) ? (uint16_t)(c->n - fired) : 0;
+	uint8_t tx[CHAN_ST_SZ];
+	tx[0] = PREAMBLE;
+	tx[1] = CMD_CHAN_CTRL;
+	tx[2] = (uint8_t)ch;
+	tx[3] = hr_status(ch) | (ok ? 0 : CHAN_ST_REJECT);
+	tx[4] = (uint8_t)(fired & 0xFF);
+	tx[5] = (uint8_t)(fired >> 8);
+	tx[6] = (uint8_t)(fired >> 16);
+	tx[7] = (uint8_t)(fired >> 24);
+	tx[8] = (uint8_t)(rem & 0xFF);
+	tx[9] = (uint8_t)(rem >> 8);
+	tx_reply(tx, sizeof tx);
+}
+
+/*++++++++++++ RETIME: T1/T2 an der Zyklusgrenze umschalten ++++++++++++ */
+/* Bereitliegende Werte in die Timer schreiben. at_boundary: aus der TIM1-ISR nach dem
+ * Pulspaar, TIM2 läuft weiter und übernimmt ARR erst mit dem nächsten Update (Preload).
+ * Sonst stehen beide Timer und ARR wirkt sofort. */
+static void retime_commit(bool at_boundary)
+{
+	if (!g_rt_pending) return;
+	g_rt_pending = false;
+
+	TIM1->ARR = g_rt_arr[0] - 1u;			// TIM1 steht zwischen den Pulspaaren
+	if (at_boundary) TIM2->CR1 |=  TIM_CR1_ARPE;
+	else             TIM2->CR1 &= ~TIM_CR1_ARPE;
+	TIM2->ARR = g_rt_arr[1] - 1u;
+	Tcfg[0].value = g_rt_val[0];
+	Tcfg[1].value = g_rt_val[1];
+
+	// Latenzmessung: der laufende Zyklus endet noch mit der alten Periode (g_t2_due steht schon)
+	g_t1_period = tim_period_cycles(TIM1);
+	g_t2_period = tim_period_cycles(TIM2);
+	evt_log(EVT_RETIME, g_cycle_cnt, (uint32_t)g_rt_val[0] | ((uint32_t)g_rt_val[1] << 16));
+}
 
+/* RETIME-Frame: Werte begrenzen, bereitlegen und den Umschaltzyklus melden.
+ * Läuft eine Sequenz, übernimmt die TIM1-ISR nach dem laufenden bzw. nächsten Pulspaar;
+ * das erste Pulspaar mit den neuen Werten ist damit immer Zykluszähler + 1. */
+static void do_retime(const uint8_t *f)
+{
+	const uint16_t t1 = (uint16_t)f[2] | ((uint16_t)f[3] << 8);
+	const uint16_t t2 = (uint16_t)f[4] | ((uint16_t)f[5] << 8);
+	uint8_t status = 0;
+	uint32_t cyc;
+
+	const bool pend = g_rt_pending;			// zweites RETIME vor der Umschaltung: darauf aufsetzen
+	uint16_t v1 = t1 ? t1 : (pend ? g_rt_val[0] : Tcfg[0].value);
+	uint16_t v2 = t2 ? t2 : (pend ? g_rt_val[1] : Tcfg[1].value);
+	const uint32_t k1 = period_ticks(1, &v1);
+	const uint32_t k2 = period_ticks(2, &v2);
+	if ((t1 && v1 != t1) || (t2 && v2 != t2)) status |= RT_ST_CLAMPED;
+
+	const uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	g_rt_arr[0] = k1;
+	g_rt_arr[1] = k2;
+	g_rt_val[0] = v1;
+	g_rt_val[1] = v2;
+	g_rt_pending = true;
+	if (g_state == ST_RUN) {
+		cyc = g_cycle_cnt + 1u;
+		status |= RT_ST_PENDING;
+	} else if (g_state == ST_RATE) {
+		cyc = g_cycle_cnt + TIM2->CNT;		// TIM1/TIM2 gehören dem Schnellmodus: Übernahme an dessen Ende
+		status |= RT_ST_PENDING;
+	} else {
+		cyc = g_cycle_cnt;
+		retime_commit(false);
+	}
+	__set_PRIMASK(primask);
+
+	uint8_t tx[RETIME_ACK_SZ];
+	tx[0]  = PREAMBLE;
+	tx[1]  = CMD_RETIME;
+	tx[2]  = (uint8_t)(v1 & 0xFF);
+	tx[3]  = (uint8_t)(v1 >> 8);
+	tx[4]  = (uint8_t)(v2 & 0xFF);
+	tx[5]  = (uint8_t)(v2 >> 8);
+	tx[6]  = (uint8_t)(cyc & 0xFF);
+	tx[7]  = (uint8_t)(cyc >> 8);
+	tx[8]  = (uint8_t)(cyc >> 16);
+	tx[9]  = (uint8_t)(cyc >> 24);
+	tx[10] = status;
+	tx_reply(tx, sizeof tx);
+}
 
+/*++++++++++++ RATE: Schnellmodus, Zyklus komplett in Hardware ++++++++++++ */
+static void tim_save(const TIM_TypeDef *t, tim_regs_t *r, bool adv)
+{
+	r->cr1   = t->CR1;
+	r->cr2   = t->CR2;
+	r->smcr  = t->SMCR;
+	r->dier  = t->DIER;
+	r->ccmr1 = t->CCMR1;
+	r->ccmr2 = t->CCMR2;
+	r->ccer  = t->CCER;
+	r->psc   = t->PSC;
+	r->arr   = t->ARR;
+	r->ccr1  = t->CCR1;
+	r->ccr2  = t->CCR2;
+	r->ccr3  = t->CCR3;
+	r->rcr   = adv ? t->RCR : 0;
+	r->bdtr  = adv ? t->BDTR : 0;
+}
 
+/* Register zurück, PSC/RCR per UG laden (URS: ohne IRQ). BDTR von TIM8 bleibt, MOE gehört
+ * dem Break-Schutz; ebenso dessen BIE (nach einem Fehler bis zur Quittierung aus). */
+static void tim_restore(TIM_TypeDef *t, const tim_regs_t *r, bool adv)
+{
+	const uint32_t bie = (t == TIM8) ? (t->DIER & TIM_DIER_BIE) : 0;
+	t->CR1   = (r->cr1 & ~TIM_CR1_CEN) | TIM_CR1_URS;
+	t->DIER  = bie;
+	t->SMCR  = r->smcr;
+	t->CR2   = r->cr2;
+	t->CCMR1 = r->ccmr1;
+	t->CCMR2 = r->ccmr2;
+	t->CCER  = r->ccer;
+	t->PSC   = r->psc;
+	t->ARR   = r->arr;
+	t->CCR1  = r->ccr1;
+	t->CCR2  = r->ccr2;
+	t->CCR3  = r->ccr3;
+	if (adv) {
+		t->RCR = r->rcr;
+		if (t != TIM8) t->BDTR = r->bdtr;
+	}
+	t->EGR  = TIM_EGR_UG;
+	t->SR   = 0;
+	t->CNT  = 0;
+	t->DIER = (t == TIM8) ? ((r->dier & ~TIM_DIER_BIE) | bie) : r->dier;
+	t->CR1  = r->cr1 & ~TIM_CR1_CEN;
+}
 
+/* bisher gefeuerte Pulspaare des laufenden Schnellmodus (TIM2 zählt TIM1_TRGO) */
+static inline uint32_t rate_fired(void)
+{
+	return (g_state == ST_RATE) ? TIM2->CNT : 0u;
+}
+
+static inline uint32_t rate_ticks(uint32_t ns, uint32_t div) { return (ns * 17u + div / 2u) / div; }
+static inline uint32_t rate_ns(uint32_t ticks, uint32_t div) { return (ticks * div + 8u) / 17u; }
+
+/* Periode/T1 auf das Timer-Raster legen (5.9 ns << PSC), Tastgrad begrenzen. Nur Rechnen,
+ * die Timer gehören bis zum Start der Einzelbrücke. */
+static uint8_t rate_setup(uint32_t t1_ns, uint32_t per_ns, uint16_t n)
+{
+	uint32_t per = per_ns;
+	if (per < RATE_PER_NS_MIN) per = RATE_PER_NS_MIN;
+	if (per > RATE_PER_NS_MAX) per = RATE_PER_NS_MAX;
+	uint32_t t1 = t1_ns;
+	if (t1 < RATE_T1_NS_MIN) t1 = RATE_T1_NS_MIN;
+	if (t1 > per)            t1 = per;
+
+	const uint32_t psc = (rate_ticks(per, 100u) - 1u) >> 16;	// 16-Bit-ARR, ab ~385 µs PSC > 0
+	const uint32_t div = 100u * (psc + 1u);
+	g_rate.psc  = psc;
+	g_rate.per  = rate_ticks(per, div);
+	g_rate.t1   = rate_ticks(t1, div);
+	g_rate.lead = rate_ticks(RATE_LEAD_NS, div);
+	if (g_rate.lead < 2u) g_rate.lead = 2u;
+
+	bool clamped = (per != per_ns) || (t1 != t1_ns);
+	const uint32_t t1_max = g_rate.per * RATE_DUTY_MAX_PCT / 200u;
+	if (g_rate.t1 > t1_max) {
+		g_rate.t1 = t1_max;
+		clamped = true;
+	}
+	g_rate_t1_ns    = rate_ns(g_rate.t1, div);
+	g_rate_per_ns   = rate_ns(g_rate.per, div);
+	g_rate_n        = n;
+	g_rate_on_us_ms = 2000u * g_rate.t1 / g_rate.per;
+	return clamped ? RATE_ST_CLAMPED : 0;
+}
+
+/* TIM1/TIM2/TIM8 auf den Schnellmodus umstellen und starten. Reihenfolge: erst die
+ * Slaves (TIM8, TIM2), dann TIM1, dessen Start alles Weitere in Hardware auslöst. */
+static bool rate_start(void)
+{
+	if (g_state != ST_IDLE || g_fault || g_rate_guard || g_rate.per == 0) return false;
+
+	tim_save(TIM1, &g_rate_save[0], true);
+	tim_save(TIM2, &g_rate_save[1], false);
+	tim_save(TIM8, &g_rate_save[2], true);
+
+	// TIM8: Enables an von Vorlauf bis Vorlauf + 2*T1 (TRGO kommt einen Tick nach Zyklusbeginn)
+	TIM8->CR1   = TIM_CR1_URS | TIM_CR1_OPM;
+	TIM8->DIER &= TIM_DIER_BIE;
+	TIM8->SMCR  = 0;
+	TIM8->PSC   = g_rate.psc;
+	TIM8->ARR   = g_rate.lead + 2u * g_rate.t1 - 2u;
+	TIM8->CCR1  = g_rate.lead - 1u;
+	TIM8->CCR2  = g_rate.lead - 1u;
+	TIM8->CCMR1 = TIM_OCMODE_PWM2 | (TIM_OCMODE_PWM2 << 8);
+	TIM8->EGR   = TIM_EGR_UG;
+	TIM8->SR    = ~TIM_SR_BIF;
+	TIM8->SMCR  = TIM_TS_ITR0 | TIM_SLAVEMODE_COMBINED_RESETTRIGGER;	// ITR0 = TIM1_TRGO
+
+	// TIM2: zählt Zyklen (steigende Flanken von TIM1_TRGO)
+	TIM2->CR1  = TIM_CR1_URS;
+	TIM2->DIER = 0;
+	TIM2->SMCR = 0;
+	TIM2->CR2  = 0;
+	TIM2->PSC  = 0;
+	TIM2->ARR  = 0xFFFFFFFFu;
+	TIM2->EGR  = TIM_EGR_UG;
+	TIM2->CNT  = 0;
+	TIM2->SR   = 0;
+	TIM2->SMCR = TIM_TS_ITR0 | TIM_SLAVEMODE_EXTERNAL1;
+	TIM2->CR1 |= TIM_CR1_CEN;
+
+	// TIM1: Zyklus, Drives als PWM; N Zyklen per Repetition-Counter + One-Pulse
+	TIM1->CR1   = TIM_CR1_URS | (g_rate_n ? TIM_CR1_OPM : 0);
+	TIM1->DIER  = 0;
+	TIM1->SMCR  = 0;
+	TIM1->CR2   = TIM_TRGO_OC3REF;
+	TIM1->PSC   = g_rate.psc;
+	TIM1->ARR   = g_rate.per - 1u;
+	TIM1->RCR   = g_rate_n ? g_rate_n - 1u : 0u;
+	TIM1->CCR1  = g_rate.lead + g_rate.t1;		// links High bis Vorlauf + T1 (Puls+)
+	TIM1->CCR2  = g_rate.lead + g_rate.t1;		// rechts High ab Vorlauf + T1 (Puls-)
+	TIM1->CCR3  = 1u;
+	TIM1->CCMR1 = TIM_OCMODE_PWM1 | (TIM_OCMODE_PWM2 << 8);
+	TIM1->CCMR2 = TIM_OCMODE_PWM2;
+	TIM1->CCER  = TIM_CCER_CC1E | TIM_CCER_CC2E;
+	TIM1->BDTR  = TIM_BDTR_MOE;
+	TIM1->EGR   = TIM_EGR_UG;
+	TIM1->SR    = 0;
+	if (g_rate_n) TIM1->DIER = TIM_DIER_UIE;	// ein IRQ nach dem letzten Zyklus
+	pin_mode(GPIOA, 8, GPIO_AF6_TIM1);
+	pin_mode(GPIOA, 9, GPIO_AF6_TIM1);
+
+	g_exit  = EXIT_NONE;
+	g_state = ST_RATE;
+	evt_log(EVT_RATE_START, g_rate_per_ns, g_rate_n);
+	TIM1->CR1 |= TIM_CR1_CEN;
+	return true;
+}
+
+/* Schnellmodus beenden (ISR-tauglich): Enables sofort aus, Timer zurück an die Einzelbrücke */
+static void rate_end(rate_end_t why)
+{
+	if (g_state != ST_RATE) return;
+	TIM8->CCMR1 = EN_OCM(false) | (EN_OCM(false) << 8);
+	TIM1->CR1  &= ~TIM_CR1_CEN;
+	TIM8->CR1  &= ~TIM_CR1_CEN;
+	const uint32_t fired = TIM2->CNT;
+	TIM2->CR1  &= ~TIM_CR1_CEN;
+	pin_mode(GPIOA, 8, PIN_OUT);
+	pin_mode(GPIOA, 9, PIN_OUT);
+
+	tim_restore(TIM8, &g_rate_save[2], true);	// Slaves zuerst: UG von TIM1 triggert nichts mehr
+	tim_restore(TIM2, &g_rate_save[1], false);
+	tim_restore(TIM1, &g_rate_save[0], true);
+
+	g_cycle_cnt += fired;
+	g_state = ST_IDLE;
+	g_exit  = EXIT_NONE;
+	evt_log(EVT_RATE_DONE, fired, why);
+	retime_commit(false);
+}
+
+/* Hauptschleife: Soft-Stop im Aus-Fenster des Zyklus, Wärmebudget (ms-Raster) */
+static void rate_poll(void)
+{
+	if (g_state == ST_RATE && g_exit == EXIT_SOFT) {
+		const uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		const uint32_t c = TIM1->CNT;
+		if (c >= g_rate.lead + 2u * g_rate.t1 + 2u && c + 8u < g_rate.per) rate_end(RATE_END_STOP);
+		__set_PRIMASK(primask);
+	}
+
+	const uint32_t now = HAL_GetTick();
+	const uint32_t dt  = now - g_rate_tick;
+	if (dt == 0) return;
+	g_rate_tick = now;
+	const uint32_t cool = dt * RATE_COOL_US_PER_MS;
+	if (g_state == ST_RATE) g_rate_heat += dt * g_rate_on_us_ms;
+	g_rate_heat = (g_rate_heat > cool) ? g_rate_heat - cool : 0u;
+	if (g_rate_heat > RATE_HEAT_MAX_US) {
+		g_rate_guard = true;
+		rate_end(RATE_END_GUARD);
+	} else if (g_rate_guard && g_rate_heat <= RATE_HEAT_MAX_US / 2u) {
+		g_rate_guard = false;
+	}
+}
+
+/* RATE-Frame: (laufenden Schnellmodus beenden,) setzen, optional starten, ein ACK */
+static void rate_config(const uint8_t *f)
+{
+	const uint32_t t1  = (uint32_t)f[2] | ((uint32_t)f[3] << 8) | ((uint32_t)f[4] << 16)
+					   | ((uint32_t)f[5] << 24);
+	const uint32_t per = (uint32_t)f[6] | ((uint32_t)f[7] << 8) | ((uint32_t)f[8] << 16)
+					   | ((uint32_t)f[9] << 24);
+	const uint16_t n   = (uint16_t)f[10] | ((uint16_t)f[11] << 8);
+	uint8_t status = 0;
+
+	if (g_state != ST_IDLE && g_state != ST_RATE) {
+		status |= RATE_ST_REJECT;
+	} else {
+		rate_end(RATE_END_STOP);
+		status |= rate_setup(t1, per, n);
+		if ((f[12] & RATE_F_START) && !rate_start()) status |= RATE_ST_REJECT;
+	}
+	if (g_rate_guard)        status |= RATE_ST_GUARD;
+	if (g_state == ST_RATE)  status |= RATE_ST_RUNNING;
+
+	uint8_t tx[RATE_SZ];
+	tx[0]  = PREAMBLE;
+	tx[1]  = CMD_RATE;
+	tx[2]  = (uint8_t)(g_rate_t1_ns & 0xFF);
+	tx[3]  = (uint8_t)(g_rate_t1_ns >> 8);
+	tx[4]  = (uint8_t)(g_rate_t1_ns >> 16);
+	tx[5]  = (uint8_t)(g_rate_t1_ns >> 24);
+	tx[6]  = (uint8_t)(g_rate_per_ns & 0xFF);
+	tx[7]  = (uint8_t)(g_rate_per_ns >> 8);
+	tx[8]  = (uint8_t)(g_rate_per_ns >> 16);
+	tx[9]  = (uint8_t)(g_rate_per_ns >> 24);
+	tx[10] = (uint8_t)(g_rate_n & 0xFF);
+	tx[11] = (uint8_t)(g_rate_n >> 8);
+	tx[12] = status;
+	tx_reply(tx, sizeof tx);
+}
 
 /* =============== API Funktionen =============== */
 void seq_start(void)
 {
     if (g_state != ST_IDLE) return;
+    if (g_fault) return;             // Schutz ausgelöst: erst quittieren (PROT, Flag RESET)
     g_exit   = EXIT_NONE;
     g_t1_cnt = 0;
 
-    __HAL_TIM_SET_COUNTER(&htim1, 0);
-    __HAL_TIM_SET_COUNTER(&htim2, 0);
-    __HAL_TIM_CLEAR_FLAG(&htim1, TIM_FLAG_UPDATE);
-    __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
-
-    HAL_TIM_Base_Start_IT(&htim1);   // "Fast" – triggert Puls 1 und Puls 2
-    HAL_TIM_Base_Start_IT(&htim2);   // "Slow" – Zyklusende
-
-    g_state = ST_RUN;
+    g_adc_done = false;              // alte, nicht ausgewertete Aufnahme verwerfen
+    adc_arm();                       // vor den Timern: erstes TRGO startet die Wandlung
+
+    g_state = ST_RUN;                // vor dem Start: erste ISR darf sofort kommen
+
+    if (hw_sync()) {
+        // TIM1 nur scharf machen, der Start kommt taktgenau per TRGO von TIM2
+        TIM1->CNT   = 0;
+        TIM1->SR    = ~TIM_SR_UIF;
+        TIM1->DIER |= TIM_DIER_UIE;
+        tim_run(TIM2);
+        TIM2->EGR   = TIM_EGR_UG;    // URS=1: nur TRGO, kein Update-IRQ
+    } else {
+        tim_run(TIM1);               // "Fast" – triggert Puls 1 und Puls 2
+        tim_run(TIM2);               // "Slow" – Zyklusende
+    }
+    lat_arm(&g_t1_due, &g_t1_period, TIM1);
+    lat_arm(&g_t2_due, &g_t2_period, TIM2);
+
+    evt_log(EVT_SEQ_START, soll_pulse_count, g_cycle_cnt);
 }
 
 void seq_request_soft_stop(void) { g_exit = EXIT_SOFT; }   // stoppen nach Puls2 / Zyklusende
 void seq_hard_stop(void)
 {
-    HAL_TIM_Base_Stop_IT(&htim1);
-    HAL_TIM_Base_Stop_IT(&htim2);
-    __HAL_TIM_CLEAR_FLAG(&htim1, TIM_FLAG_UPDATE);
-    __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+    if (g_state == ST_RUN) evt_log(EVT_SEQ_STOP, EXIT_HARD, g_cycle_cnt);
+    if (g_state == ST_WAVE) evt_log(EVT_WAVE_DONE, g_wave_passes, 1);
+    if (g_state == ST_MULTI) hr_exit();
+    if (g_state == ST_RATE) rate_end(RATE_END_STOP);
+    tim_halt(TIM1);
+    tim_halt(TIM2);
+    retime_commit(false);            // bereitliegende T1/T2 nicht verlieren
+    wave_halt();
     all_off();
+    adc_halt();
+    g_adc_armed = false;
     g_state = ST_IDLE;
     g_t1_cnt = 0;
     g_exit   = EXIT_NONE;
 }
 
+static inline uint16_t pulses_remaining(void)
+{
+	if (g_state == ST_RATE) return g_rate_n ? (uint16_t)(g_rate_n - rate_fired()) : 0;
+	if (g_state != ST_RUN || soll_pulse_count == 0) return 0;
+	return (uint16_t)(soll_pulse_count - pulse_count);
+}
+
+/* Feuert genau n Pulspaare mit den aktuellen T1/T2 (Host armt vorher das Scope).
+ * n = 0 startet nichts und liefert nur den Zählerstand für den Abgleich. */
+static void do_fire(uint16_t n)
+{
+	uint8_t status = 0;
+
+	if (n > 0) {
+		if (g_state == ST_IDLE) {
+			soll_pulse_count = n;
+			pulse_count = 0;
+			seq_start();
+			if (g_state != ST_RUN) status |= FIRE_ST_REJECT;
+		} else {
+			status |= FIRE_ST_BUSY;
+		}
+	}
+	if (g_state == ST_RUN) status |= FIRE_ST_RUNNING;
+
+	const uint32_t cyc = g_cycle_cnt + rate_fired();
+	const uint16_t rem = pulses_remaining();
+	uint8_t tx[FIRE_ACK_SZ];
+	tx[0] = PREAMBLE;
+	tx[1] = CMD_FIRE;
+	tx[2] = (uint8_t)(cyc & 0xFF);
+	tx[3] = (uint8_t)(cyc >> 8);
+	tx[4] = (uint8_t)(cyc >> 16);
+	tx[5] = (uint8_t)(cyc >> 24);
+	tx[6] = (uint8_t)(rem & 0xFF);
+	tx[7] = (uint8_t)(rem >> 8);
+	tx[8] = status;
+	tx_reply(tx, sizeof tx);
+}
+
+/* Momentaufnahme aller Zähler, ohne printf und ohne die Timer anzuhalten.
+ * Die IRQs sind nur für das Kopieren weniger Worte gesperrt. */
+static void send_status(uint8_t flags)
+{
+	uint8_t tx[STATUS_SZ];
+
+	const uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	const uint8_t  st   = (uint8_t)g_state;
+	const uint8_t  ex   = (uint8_t)g_exit;
+	const uint32_t cyc  = g_cycle_cnt + rate_fired();
+	const uint16_t rem  = pulses_remaining();
+	const uint16_t drop = g_rx_dropped;
+	const uint32_t lat  = g_lat_max;
+	const uint32_t run  = g_isr_max;
+	const uint16_t ovr  = g_overruns;
+	const uint8_t  flt  = g_fault;
+	const uint8_t  fph  = g_fault_phase;
+	const uint32_t fcyc = g_fault_cycle;
+	if (flags & STATUS_F_CLR_PEAK) {
+		g_lat_max = 0;
+		g_isr_max = 0;
+	}
+	__set_PRIMASK(primask);
+
+	const uint16_t lat16 = (lat > 0xFFFFu) ? 0xFFFFu : (uint16_t)lat;
+	const uint16_t run16 = (run > 0xFFFFu) ? 0xFFFFu : (uint16_t)run;
+	const uint32_t up    = HAL_GetTick();
+
+	tx[0]  = PREAMBLE;
+	tx[1]  = CMD_STATUS;
+	tx[2]  = st;
+	tx[3]  = ex;
+	tx[4]  = (uint8_t)(cyc & 0xFF);
+	tx[5]  = (uint8_t)(cyc >> 8);
+	tx[6]  = (uint8_t)(cyc >> 16);
+	tx[7]  = (uint8_t)(cyc >> 24);
+	tx[8]  = (uint8_t)(rem & 0xFF);
+	tx[9]  = (uint8_t)(rem >> 8);
+	tx[10] = (uint8_t)(drop & 0xFF);
+	tx[11] = (uint8_t)(drop >> 8);
+	tx[12] = (uint8_t)(lat16 & 0xFF);
+	tx[13] = (uint8_t)(lat16 >> 8);
+	tx[14] = (uint8_t)(ovr & 0xFF);
+	tx[15] = (uint8_t)(ovr >> 8);
+	tx[16] = (uint8_t)(up & 0xFF);
+	tx[17] = (uint8_t)(up >> 8);
+	tx[18] = (uint8_t)(up >> 16);
+	tx[19] = (uint8_t)(up >> 24);
+	tx[20] = (uint8_t)(run16 & 0xFF);
+	tx[21] = (uint8_t)(run16 >> 8);
+	tx[22] = flt;
+	tx[23] = fph;
+	tx[24] = (uint8_t)(fcyc & 0xFF);
+	tx[25] = (uint8_t)(fcyc >> 8);
+	tx[26] = (uint8_t)(fcyc >> 16);
+	tx[27] = (uint8_t)(fcyc >> 24);
+	tx_reply(tx, sizeof tx);
+}
+
+static inline uint8_t frame_len(uint8_t cmd)
+{
+	if (cmd == CMD_CONFIG) return CONFIG_SZ;
+	if (cmd == CMD_WAVE)   return WAVE_DATA_SZ;
+	if (cmd == CMD_CHAN)   return CHAN_SZ;
+	if (cmd == CMD_RETIME) return RETIME_SZ;
+	if (cmd == CMD_RATE)   return RATE_SZ;
+	return RX_SZ;
+}
+
+/* Übernimmt T1, T2, Pulsanzahl und Flags in einem Schritt:
+ * Timer stoppen, alle Register setzen, optional starten, dann genau ein ACK
+ * mit den tatsächlich übernommenen (ggf. begrenzten) Werten. Kein printf,
+ * damit die Antwort ohne Verzögerung rausgeht. */
+static void apply_config(const uint8_t *f)
+{
+	const uint16_t t1 = (uint16_t)f[2] | ((uint16_t)f[3] << 8);
+	const uint16_t t2 = (uint16_t)f[4] | ((uint16_t)f[5] << 8);
+	const uint16_t n  = (uint16_t)f[6] | ((uint16_t)f[7] << 8);
+	uint8_t status = 0;
+
+	seq_hard_stop();
+	apply_set(1, t1, f[8]);
+	apply_set(2, t2, f[9]);
+	soll_pulse_count = n;
+	pulse_count = 0;
+
+	if (Tcfg[0].value != t1 || Tcfg[1].value != t2) status |= CFG_ST_CLAMPED;
+	if (f[10] & CFG_F_ARM) {
+		seq_start();
+		status |= (g_state == ST_RUN) ? CFG_ST_ARMED : CFG_ST_REJECT;
+	}
+
+	uint8_t tx[CONFIG_ACK_SZ];
+	tx[0] = PREAMBLE;
+	tx[1] = CMD_CONFIG;
+	tx[2] = (uint8_t)(Tcfg[0].value & 0xFF);
+	tx[3] = (uint8_t)(Tcfg[0].value >> 8);
+	tx[4] = (uint8_t)(Tcfg[1].value & 0xFF);
+	tx[5] = (uint8_t)(Tcfg[1].value >> 8);
+	tx[6] = (uint8_t)(soll_pulse_count & 0xFF);
+	tx[7] = (uint8_t)(soll_pulse_count >> 8);
+	tx[8] = status;
+	tx_reply(tx, sizeof tx);
+}
+
 
 /* USER CODE END 0 */
 
@@ -293,7 +2109,14 @@ int main(void)
   MX_TIM1_Init();
   MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
-
+  dwt_init();	// Zyklenzähler für Latenzmessung (STATUS)
+  nvic_config();	// Pulstiming vor UART/DMA/Taster
+  adc_init();	// U_DC/I je Puls (PA0/PA1), nach MX_TIM1_Init wegen TRGO
+  prot_init();	// Komparatoren -> TIM8-Break, Enables ab hier auf TIM8 (nach MX_GPIO_Init)
+  wave_init();	// TIM8 als Schrittakt für Zustandsfolgen, Tabelle aus dem Flash
+  hr_init();	// HRTIM für bis zu 3 Brücken parallel, Fault über COMP1/COMP3 (nach prot_init)
+  evt_log(EVT_BOOT, RCC->CSR, SystemCoreClock);
+  __HAL_RCC_CLEAR_RESET_FLAGS();
 
   /* USER CODE END 2 */
 
@@ -301,13 +2124,15 @@ int main(void)
   /* USER CODE BEGIN WHILE */
 
   // Diese Funktion empfängt über Interrupt UART Signale aus dem Python Skript
-  HAL_UARTEx_ReceiveToIdle_IT(&huart2, rx, RX_SZ); // Prozessstart
+  HAL_UARTEx_ReceiveToIdle_IT(&huart2, rx, RX_MAX); // Prozessstart
 
 
 while (1)
 {
-	if(command_rcv == 1){
-		command_rcv = 0;
+	while (cmdq_tail != cmdq_head) {
+		rx_len = cmdq_len[cmdq_tail];
+		memcpy(rx_buf, cmdq[cmdq_tail], rx_len);
+		cmdq_tail = (uint8_t)((cmdq_tail + 1u) % CMDQ_LEN);
 
         const uint8_t  cmd   = rx_buf[1];
         const uint8_t  base  = cmd & 0xF0;            // 0x10/0x20/0x30/0x40
@@ -321,23 +2146,28 @@ while (1)
         	//  - TIM1: interpretiert value als µs (10..1000, Tick=10µs)
 			//  - TIM2: interpretiert value als ms  (1..10000, Tick=0.1ms)
 			apply_set(timer, value, flags);
-			printf("CMD: SET %s OK (period=%u)\r\n", (timer==1?"T1":"T2"), (unsigned)value);
+			evt_log(EVT_CMD_SET, timer, value);
 			break;
 
 		case CMD_START:    /* 0x20 / 0x21 */
 			//alternativ für nur einen Timer => do_start(timer);
 			// Anzahl Pulse setzen
 			soll_pulse_count = value;
+			pulse_count = 0;
 			// Start beider Timer + State Machine
 			seq_start();
-            printf("CMD: START (seq) OK\r\n");
+			evt_log(EVT_CMD_START, value, 0);
             break;
 
 		case CMD_STOP:     /* 0x30 / 0x31 */
-            // Immer SOFT-STOP: am Zyklusende (TIM2-IRQ) in all_off() beenden
-		  if (g_exit == EXIT_HARD) { seq_hard_stop(); return; }
+            // flags Bit0 = HARD: sofort alles aus, sonst SOFT: am Zyklusende (TIM2-IRQ) beenden
+            if (flags & 0x01) {
+                seq_hard_stop();
+                evt_log(EVT_CMD_STOP, 1, 0);
+                break;
+            }
             seq_request_soft_stop();
-            printf("CMD: STOP (soft) requested\r\n");
+            evt_log(EVT_CMD_STOP, 0, 0);
             break;
 
 		case CMD_READBACK: /* 0x40 / 0x41 */
@@ -345,23 +2175,75 @@ while (1)
             //  - T1: µs
             //  - T2: ms
             send_readback(timer);
-            printf("CMD: READBACK %s OK\r\n", (timer==1?"T1":"T2"));
+            evt_log(EVT_CMD_RB, timer, 0);
             break;
 
+		case CMD_CONFIG:   /* 0x50 */
+			// T1/T2/Pulsanzahl/Flags atomar setzen (+ optional starten), Antwort = ein ACK-Frame
+			apply_config(rx_buf);
+			continue;       // kein Event-Echo, Round-Trip bleibt ein Frame
+
+		case CMD_FIRE:     /* 0x60 */
+			// n Pulspaare feuern (Scope ist vom Host bereits scharf), Antwort = ein ACK-Frame
+			do_fire(value);
+			continue;
+
+		case CMD_STATUS:   /* 0x70 */
+			// Telemetrie für den Host (bis 100 Hz), reiner Binär-Frame
+			send_status(flags);
+			continue;
+
+		case CMD_PROT:     /* 0xA0 / 0xA1 */
+			// Schwelle Strom (T1-Code) bzw. Spannung (T2-Code), optional Fehler quittieren
+			prot_command(timer - 1u, value, flags);
+			continue;
+
+		case CMD_ADC:      /* 0x90 */
+			// ADC-Messdaten je Pulspaar ein/aus, value = Dezimierung
+			adc_set_decimation(value);
+			continue;
+
+		case CMD_WAVE:     /* 0xB0 / 0xB1 */
+			// Zustandsfolge hochladen (0xB0, 14 Bytes) bzw. laden/speichern/abspielen (0xB1)
+			if (cmd == CMD_WAVE) wave_data(rx_buf);
+			else                 wave_ctrl(value, flags);
+			continue;
+
+		case CMD_CHAN:     /* 0xC0 / 0xC1 */
+			// HRTIM-Kanal setzen/starten (0xC0, 12 Bytes) bzw. starten/stoppen/verlassen (0xC1)
+			if (cmd == CMD_CHAN) hr_config(rx_buf);
+			else                 hr_ctrl(value, flags);
+			continue;
+
+		case CMD_RETIME:   /* 0xD0 */
+			// neue T1/T2 ohne Stopp, wirksam ab der gemeldeten Zyklusgrenze
+			do_retime(rx_buf);
+			continue;
+
+		case CMD_RATE:     /* 0xE0 */
+			// Schnellmodus setzen (+ starten), beenden über STOP hart/soft
+			rate_config(rx_buf);
+			continue;
+
 		default:
-			printf("Unknown CMD: 0x%02X\r\n", cmd);
+			evt_log(EVT_CMD_UNKNOWN, cmd, 0);
 			break;
 		}
 
-        printf("RX:");
-        for (uint8_t i = 0; i < RX_SZ; ++i) printf(" %02X", rx_buf[i]);
-        printf("\r\n");
+        // ersetzt den Hex-Dump: Frame-Inhalt als Event, formatiert wird auf dem Host
+        evt_log(EVT_RX_FRAME, (uint32_t)rx_buf[1] | ((uint32_t)rx_buf[2] << 8)
+        		| ((uint32_t)rx_buf[3] << 16) | ((uint32_t)rx_buf[4] << 24), rx_len);
 
 	 // SET GPIO 1 - 4
 	 // switch mit Mode Variable
 
 
 	}
+
+	// Leerlauf: ADC-Aufnahme auswerten, gesammelte Frames per DMA ausgeben
+	adc_poll();
+	rate_poll();
+	txq_kick();
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -626,93 +2508,242 @@ static void MX_GPIO_Init(void)
 void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size){
 
 	if(huart->Instance == USART2){
-        if (Size == RX_SZ && rx[0] == PREAMBLE) {
-    		memcpy(rx_buf, rx, Size); // Daten sichern
-            command_rcv = 1;		  // Kommando erhalten Flag setzen
-        }
+		// Puffer in Frames zerlegen (Host darf mehrere Kommandos direkt hintereinander senden)
+		uint16_t i = 0;
+		bool junk = false;
+		while (i < Size) {
+			if (rx[i] != PREAMBLE) { i++; junk = true; continue; }	// Resync auf Preamble
+			if (i + 1u >= Size) { g_rx_dropped++; break; }
+			const uint8_t len = frame_len(rx[i + 1u]);
+			if (i + len > Size) { g_rx_dropped++; break; }			// unvollständiger Frame -> verwerfen
+			const uint8_t next = (uint8_t)((cmdq_head + 1u) % CMDQ_LEN);
+			if (next != cmdq_tail) {
+				memcpy(cmdq[cmdq_head], &rx[i], len);	// Daten sichern
+				cmdq_len[cmdq_head] = len;
+				cmdq_head = next;						// Kommando an Hauptschleife übergeben
+			} else {
+				g_rx_dropped++;							// FIFO voll
+			}
+			i += len;
+		}
+		if (junk) g_rx_dropped++;
 
 		// 2) Optional: Quellpuffer leeren (hilft beim Debugging)
 		// memset(rx, 0, RX_SZ);
 
-	HAL_UARTEx_ReceiveToIdle_IT(&huart2, rx, RX_SZ); // immer wieder neu armen
+	HAL_UARTEx_ReceiveToIdle_IT(&huart2, rx, RX_MAX); // immer wieder neu armen
+
+	}
+}
+
+/* Überlauf/Rauschen/Framing: Empfang verwerfen, zählen und neu armen,
+ * sonst bleibt die UART nach einem Fehler stumm. */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	if (huart->Instance == USART2) {
+		g_rx_dropped++;
+		evt_log(EVT_UART_ERR, huart->ErrorCode, 0);
+		if (huart->gState == HAL_UART_STATE_READY) txq_dma_len = 0;	// TX abgebrochen -> Stück neu senden
+		HAL_UARTEx_ReceiveToIdle_IT(&huart2, rx, RX_MAX);
+	}
+}
 
+/* DMA-Stück gesendet: Ring freigeben und sofort das nächste Stück starten. */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	if (huart->Instance == USART2) {
+		txq_tail = (uint16_t)((txq_tail + txq_dma_len) & (TXQ_SZ - 1u));
+		txq_dma_len = 0;
+		txq_kick();
 	}
 }
 
 PUTCHAR_PROTOTYPE
 {
-  /* Place your implementation of fputc here */
-  /* e.g. write a character to the USART2 and Loop until the end of transmission */
-  HAL_UART_Transmit(&huart2, (uint8_t *)&ch, 1, 100);
+  /* Nicht blockierend: Zeichen in den Sende-Ring, Ausgabe per DMA im Leerlauf.
+   * Der normale Betrieb nutzt printf nicht mehr (Event-Log), nur noch zum Debuggen. */
+  uint8_t c = (uint8_t)ch;
+  txq_put(&c, 1, TXQ_RESERVE);
 
   return ch;
 }
 
-// Callback
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+/* ============== TIM8-Break: Schutz hat ausgelöst ==============
+ * Die Enables sind zu diesem Zeitpunkt schon per Hardware aus (MOE = 0). Hier nur
+ * Ursache/Zyklus festhalten und die Sequenz beenden; kein Einfluss auf normale Pulse.
+ * Direkt aus TIM8_BRK_IRQHandler. */
+void prot_break_isr(void)
 {
-  /* ============== TIM1: schnelle Ereignisse im Zyklus ============== */
-  if (htim->Instance == TIM1)
-  {
-	  if (g_state != ST_RUN) return; // damit das abfängt muss in Start-Sequenz g_state = ST_RUN gesetzt werden
-
-	  switch (g_t1_cnt)
-	  {
-		  case 0:     // erstes fast-Event -> Positiver Puls 1
-			  positive_pulse_actions();
-			  g_t1_cnt = 1;
-			  break;
-
-		  case 1:     // zweites fast-Event -> Negativer Puls 2
-			  negative_pulse_actions();
-			  g_t1_cnt = 2;
-			  break;
-
-		  case 2:
-			  // ab jetzt keine weiteren Fast-Events im laufenden Zyklus
-			  all_off();
-			  HAL_TIM_Base_Stop_IT(&htim1);
-			  __HAL_TIM_CLEAR_FLAG(&htim1, TIM_FLAG_UPDATE);
-
-		  default:
-			  // ignorieren (TIM1 ist eigentlich schon gestoppt)
-			  break;
-	  }
-  }
+	if (!(TIM8->SR & TIM_SR_BIF)) return;
+	TIM8->DIER &= ~TIM_DIER_BIE;			// Pegel steht evtl. noch an: kein IRQ-Sturm
+	TIM8->SR    = ~TIM_SR_BIF;
+
+	uint8_t f = 0;
+	if (COMP1->CSR & COMP_CSR_VALUE) f |= PROT_F_OC;
+	if (COMP3->CSR & COMP_CSR_VALUE) f |= PROT_F_OV;
+	if (f == 0) f = PROT_F_BRK;
+
+	g_fault_phase = (g_state == ST_RUN && (g_t1_cnt == 1 || g_t1_cnt == 2)) ? g_t1_cnt : 0;
+	g_fault_cycle = g_cycle_cnt;
+	g_fault       = f;
+	seq_hard_stop();
+	evt_log(EVT_FAULT, f, g_fault_cycle);
+}
 
-  /* ============== TIM2: Zyklusende ============== */
-  else if (htim->Instance == TIM2)
-  {
-	  if (g_state != ST_RUN) return;
-
-//	  if (soll_pulse_count != 0 && pulse_count >= soll_pulse_count-1){
-//		  g_exit = EXIT_SOFT;
-//	  }
-
-	  // Softstop behandeln
-	  if (g_exit == EXIT_SOFT) {
-		  // nur an Zyklusende aussteigen
-		  HAL_TIM_Base_Stop_IT(&htim2);
-		  __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
-		  g_state = ST_IDLE;
-		  g_t1_cnt = 0;
-		  g_exit = EXIT_NONE;
-		  return;
-	  }
-
-	  // Weiterlaufen: neuen Zyklus vorbereiten
-	  g_t1_cnt = 0;
-	  pulse_count++;
-	  __HAL_TIM_SET_COUNTER(&htim1, 0);
-	  __HAL_TIM_CLEAR_FLAG(&htim1, TIM_FLAG_UPDATE);
-	  HAL_TIM_Base_Start_IT(&htim1);   // nächste Puls-Folge im neuen Zyklus
-  	  }
+/* ============== WAVE: Ende eines Durchlaufs ==============
+ * DMA1_Channel4 (Burst) fertig: der letzte Tabellenschritt läuft, als nächstes lädt TIM8
+ * den Endzustand (Brücke aus). OPM hält den Timer genau dort an; das Update weckt
+ * wave_tim_isr, das den nächsten Durchlauf startet oder abschließt. Direkt aus den IRQHandlern. */
+void wave_dma_isr(void)
+{
+	if (!(DMA1->ISR & DMA_ISR_TCIF4)) return;
+	DMA1->IFCR = DMA_IFCR_CGIF4;
+	if (g_state != ST_WAVE) return;
+	TIM8->CR1 |= TIM_CR1_OPM;
+	TIM8->SR   = ~TIM_SR_UIF;
+	tim8_dier(0, TIM_DIER_UIE);
+}
 
-  }
+void wave_tim_isr(void)
+{
+	if (!(TIM8->SR & TIM_SR_UIF)) return;
+	TIM8->SR = ~TIM_SR_UIF;
+	tim8_dier(TIM_DIER_UIE, 0);
+	if (g_state != ST_WAVE) return;
+
+	g_wave_passes++;
+	if (g_wave_rep > 1u) {
+		g_wave_rep--;
+		wave_start_pass();		// Lücke zwischen Durchläufen: IRQ-Latenz, ~1 µs
+		return;
+	}
+	wave_halt();
+	all_off();
+	g_state = ST_IDLE;
+	evt_log(EVT_WAVE_DONE, g_wave_passes, 0);
+}
 
+/* ============== HRTIM-Kanal: Zyklusstart ==============
+ * TIM3/TIM4/TIM5-Update = T2 des Kanals: Software-Reset startet Drive- und Enable-Einheit
+ * gemeinsam, alle Flanken des Pulspaars kommen danach aus dem HRTIM. Die IRQ-Latenz
+ * verschiebt nur den Zyklusbeginn, nicht T1. Direkt aus den IRQHandlern. */
+void hr_cycle_isr(uint8_t ch)
+{
+	TIM_TypeDef *tim = hr_t2_tim[ch];
+	if (!(tim->SR & TIM_SR_UIF)) return;
+	tim->SR = ~TIM_SR_UIF;
+	hr_ch_t *c = &hr_ch[ch];
+	if (!c->run) return;
+
+	HRTIM1->sCommonRegs.CR2 = hr_units(ch) << HRTIM_CR2_TARST_Pos;
+	c->fired++;
+	if (c->n != 0 && c->fired >= c->n) hr_finish(ch);
+}
 
+/* ============== TIM1: schnelle Ereignisse im Zyklus ==============
+ * Direkt aus TIM1_UP_TIM16_IRQHandler (ohne HAL_TIM_IRQHandler). */
+void pulse_tim1_isr(void)
+{
+	const uint32_t t_in = DWT->CYCCNT;		// zuerst: Eintrittszeit für Latenz/Budget
+	if (!(TIM1->SR & TIM_SR_UIF)) return;	// geteilter Vektor mit TIM16
+	TIM1->SR = ~TIM_SR_UIF;
+	if (g_state == ST_RATE) {				// Schnellmodus: TIM1 hat nach N Zyklen selbst angehalten
+		rate_end(RATE_END_DONE);
+		return;
+	}
+	if (g_state != ST_RUN) return;			// damit das abfängt muss in Start-Sequenz g_state = ST_RUN gesetzt werden
+	lat_sample(1, &g_t1_due, g_t1_period, t_in);
+
+	// HW-Sync: TIM2 hat die neue Folge schon gestartet, seine ISR aber noch nicht gebucht
+	if (g_t1_cnt == 3 && hw_sync()) g_t1_cnt = 0;
+
+	switch (g_t1_cnt)
+	{
+		case 0:     // erstes fast-Event -> Positiver Puls 1
+			positive_pulse_actions();
+			g_adc_i0 = adc_pos();
+			g_t1_cnt = 1;
+			break;
 
+		case 1:     // zweites fast-Event -> Negativer Puls 2
+			negative_pulse_actions();
+			g_adc_i1 = adc_pos();
+			g_t1_cnt = 2;
+			break;
 
+		case 2:
+			// ab jetzt keine weiteren Fast-Events im laufenden Zyklus
+			all_off();
+			if (hw_sync()) {
+				TIM1->CR1 &= ~TIM_CR1_CEN;	// nur anhalten, UIE bleibt: TRGO startet die nächste Folge
+			} else {
+				tim_halt(TIM1);
+			}
+			g_t1_cnt = 3;
+			g_cycle_cnt++;
+			pulse_count++;
+			adc_pulse_done();
+
+			// Soll-Anzahl erreicht: direkt nach dem Pulspaar beenden, nicht erst am Zyklusende
+			if (soll_pulse_count != 0 && pulse_count >= soll_pulse_count) {
+				tim_halt(TIM2);
+				g_state = ST_IDLE;
+				g_exit = EXIT_NONE;
+				evt_log(EVT_SEQ_DONE, pulse_count, g_cycle_cnt);
+			}
+			// RETIME: TIM1 steht, das nächste Pulspaar beginnt mit den neuen Werten
+			retime_commit(g_state == ST_RUN);
+			break;
+
+		default:
+			// ignorieren (TIM1 ist eigentlich schon gestoppt)
+			break;
+	}
+	isr_budget(t_in);
+}
+
+/* ============== TIM2: Zyklusende ==============
+ * Direkt aus TIM2_IRQHandler (ohne HAL_TIM_IRQHandler). */
+void pulse_tim2_isr(void)
+{
+	const uint32_t t_in = DWT->CYCCNT;
+	if (!(TIM2->SR & TIM_SR_UIF)) return;
+	TIM2->SR = ~TIM_SR_UIF;
+	if (g_state != ST_RUN) return;
+	const uint32_t t_evt = g_t2_due;		// Soll-Zeitpunkt dieses Updates (= HW-Start TIM1)
+	lat_sample(2, &g_t2_due, g_t2_period, t_in);
+	const bool sync = hw_sync();
+
+	// Pulsfolge des alten Zyklus nicht fertig (3*T1 > T2) -> Überlauf
+	if (g_t1_cnt < 3) {
+		g_overruns++;
+		evt_log(EVT_OVERRUN, 3, g_t1_cnt);
+		if (sync) all_off();				// TIM1 wurde mitten in der Folge neu gestartet
+	}
+
+	// Softstop behandeln
+	if (g_exit == EXIT_SOFT) {
+		// nur an Zyklusende aussteigen
+		tim_halt(TIM2);
+		if (sync) tim_halt(TIM1);			// TRGO hat TIM1 bereits wieder gestartet
+		g_state = ST_IDLE;
+		g_t1_cnt = 0;
+		g_exit = EXIT_NONE;
+		retime_commit(false);				// kein Pulspaar mehr, das umschalten könnte
+		evt_log(EVT_SEQ_STOP, EXIT_SOFT, g_cycle_cnt);
+	} else if (sync) {
+		// TIM1 läuft schon (Hardware-Start über TRGO) -> nur Buchhaltung.
+		// Hat die TIM1-ISR die neue Folge schon bedient (diese ISR > T1 verspätet), Zähler lassen.
+		if (t_in - t_evt < g_t1_period) g_t1_cnt = 0;
+		g_t1_due = t_evt + g_t1_period;
+	} else {
+		// Weiterlaufen: neuen Zyklus vorbereiten
+		g_t1_cnt = 0;
+		tim_run(TIM1);   // nächste Puls-Folge im neuen Zyklus
+		lat_arm(&g_t1_due, &g_t1_period, TIM1);
+	}
+	isr_budget(t_in);
+}
 
 /* USER CODE END 4 */
 
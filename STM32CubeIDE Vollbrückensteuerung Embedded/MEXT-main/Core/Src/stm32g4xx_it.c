@@ -59,6 +59,7 @@ extern TIM_HandleTypeDef htim1;
 extern TIM_HandleTypeDef htim2;
 extern UART_HandleTypeDef huart2;
 /* USER CODE BEGIN EV */
+extern DMA_HandleTypeDef hdma_usart2_tx;
 
 /* USER CODE END EV */
 
@@ -206,7 +207,8 @@ void SysTick_Handler(void)
 void TIM1_UP_TIM16_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_UP_TIM16_IRQn 0 */
-
+  pulse_tim1_isr();	// schlanke Register-ISR in main.c
+  return;			// HAL_TIM_IRQHandler bewusst übersprungen (Latenz)
   /* USER CODE END TIM1_UP_TIM16_IRQn 0 */
   HAL_TIM_IRQHandler(&htim1);
   /* USER CODE BEGIN TIM1_UP_TIM16_IRQn 1 */
@@ -220,7 +222,8 @@ void TIM1_UP_TIM16_IRQHandler(void)
 void TIM2_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM2_IRQn 0 */
-
+  pulse_tim2_isr();	// schlanke Register-ISR in main.c
+  return;			// HAL_TIM_IRQHandler bewusst übersprungen (Latenz)
   /* USER CODE END TIM2_IRQn 0 */
   HAL_TIM_IRQHandler(&htim2);
   /* USER CODE BEGIN TIM2_IRQn 1 */
@@ -257,5 +260,60 @@ void EXTI15_10_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles DMA1 channel1 global interrupt (USART2_TX).
+  */
+void DMA1_Channel1_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_usart2_tx);
+}
+
+/**
+  * @brief This function handles TIM8 break interrupt (COMP1/COMP3 protection).
+  */
+void TIM8_BRK_IRQHandler(void)
+{
+  prot_break_isr();
+}
+
+/**
+  * @brief This function handles TIM8 update interrupt (end of a waveform pass).
+  */
+void TIM8_UP_IRQHandler(void)
+{
+  wave_tim_isr();
+}
+
+/**
+  * @brief This function handles DMA1 channel4 interrupt (waveform burst complete).
+  */
+void DMA1_Channel4_IRQHandler(void)
+{
+  wave_dma_isr();
+}
+
+/**
+  * @brief This function handles TIM3 global interrupt (cycle start of HRTIM channel 0).
+  */
+void TIM3_IRQHandler(void)
+{
+  hr_cycle_isr(0);
+}
+
+/**
+  * @brief This function handles TIM4 global interrupt (cycle start of HRTIM channel 1).
+  */
+void TIM4_IRQHandler(void)
+{
+  hr_cycle_isr(1);
+}
+
+/**
+  * @brief This function handles TIM5 global interrupt (cycle start of HRTIM channel 2).
+  */
+void TIM5_IRQHandler(void)
+{
+  hr_cycle_isr(2);
+}
 
 /* USER CODE END 1 */
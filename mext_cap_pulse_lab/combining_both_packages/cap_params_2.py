@@ -16,6 +16,9 @@ import json
 import numpy as np
 from typing import Tuple
 import matplotlib.pyplot as plt
+from spectral_cache import Spectrum, SpectralCache, compute_spectrum
+from circuit_fit import MODELS, CircuitFitter, benchmark
+from cap_voltage import estimate_c_of_u
 
 # ===================== CONTROL =====================
 BASE_DIR     = r"C:\Users\mext\Desktop\Messreihen"
@@ -26,6 +29,18 @@ U_DC_BIAS_V  = 400.0         # DC-Bias der Spannung (wenn AC-gekoppelt gemessen)
 
 OVERLAY_IDS  = [1,2,3]       # z.B. [1,2,5] -> zusätzliche Pulse überlagern
 SHOW_FFT     = False         # FFT des Hauptpulses
+N_BANDS      = 8             # ESR(f)/C(f) in N log. Bändern -> <RUN>.bands.csv (0 = aus)
+ANALYZE_ALL  = False         # True: alle pulse_id des Laufs auswerten (statt USE_LAST/OVERLAY_IDS)
+
+USE_SPEC_CACHE   = True          # Spektren je Puls in Runs/<RUN>/Cache wiederverwenden
+FIT_BAND_HZ      = (1e3, 500e3)  # Hz, jeder FFT-Punkt; außerhalb log. ausgedünnt (muss endlich sein)
+CACHE_PER_DECADE = 20            # Punkte je Dekade außerhalb des Fit-Bands
+
+NL_MODEL     = None          # None | "rlc" | "rlc_leak" | "randles" -> <RUN>.circuit.csv
+NL_BENCHMARK = False         # zusätzlich Warm- gegen Kaltstart über alle ausgewerteten Pulse
+
+CU_BINS      = 0             # C(U)/ESR(U) in N Spannungsbins -> <RUN>.cu.csv (0 = aus, braucht Rohdaten)
+CU_RANGE_V   = None          # (U_min, U_max) feste Bins für Vergleiche über den Lauf, None = je Puls
 FIG_SIZE     = (13, 8)       # großes Fenster
 LINEWIDTH    = 1.1
 GRID_ALPHA   = 0.25
@@ -35,8 +50,12 @@ GRID_ALPHA   = 0.25
 RUN_DIR        = os.path.join(BASE_DIR, "Runs", RUN_NAME)
 PER_PULSE_DIR  = os.path.join(RUN_DIR, "Pulses")
 PARAMS_CSV_PATH = os.path.join(RUN_DIR, f"{RUN_NAME}.params.csv")
+BANDS_CSV_PATH  = os.path.join(RUN_DIR, f"{RUN_NAME}.bands.csv")
+CIRCUIT_CSV_PATH = os.path.join(RUN_DIR, f"{RUN_NAME}.circuit.csv")
+CU_CSV_PATH      = os.path.join(RUN_DIR, f"{RUN_NAME}.cu.csv")
 print(RUN_DIR)
 CSV_PATH       = os.path.join(RUN_DIR, f"{RUN_NAME}.csv")
+CACHE_PREFIX   = os.path.join(RUN_DIR, "Cache", RUN_NAME)
 META_PATH      = os.path.join(RUN_DIR, f"{RUN_NAME}.meta.json")
 
 
@@ -71,7 +90,7 @@ def _source_mode_str() -> str:
     return "unknown"
 
 def append_params_row(
-    *, pulse_id: int, t: np.ndarray, esr: float, cap: float,
+    *, pulse_id: int, t_mid: float, esr: float, cap: float,
     res: dict, i_colname: str, source: str
 ):
     """
@@ -79,8 +98,6 @@ def append_params_row(
     t_mid_s: Mittelpunkt-Zeit des Pulsfensters (relativ zum Puls-CSV)
     """
     _params_exists_write_header()
-    # mittlere Pulszeit als einfacher Zeitstempel für Trends
-    t_mid = float(0.5*(t[0] + t[-1])) if t.size else float("nan")
 
     def _num(x):
         # robust: NaNs → leer schreiben (CSV bleibt numerisch)
@@ -105,6 +122,63 @@ def append_params_row(
         f.write(line)
 
 
+def append_bands_rows(*, pulse_id: int, bands: dict):
+    """
+    Hängt die ESR(f)/C(f)-Tabelle eines Pulses an <RUN_NAME>.bands.csv an
+    (eine Zeile je Band, gleiche pulse_id wie in params.csv).
+    """
+    if not os.path.exists(BANDS_CSV_PATH):
+        with open(BANDS_CSV_PATH, "w", encoding="utf-8") as f:
+            f.write("# columns: pulse_id,band,f_lo_Hz,f_hi_Hz,f_c_Hz,esr_ohm,cap_F,esl_H,n_bins\n")
+
+    def _num(x):
+        return f"{float(x):.9e}" if np.isfinite(x) else ""
+
+    with open(BANDS_CSV_PATH, "a", encoding="utf-8") as f:
+        for b in range(len(bands["esr"])):
+            f.write(",".join([
+                str(int(pulse_id)), str(b),
+                _num(bands["f_lo"][b]), _num(bands["f_hi"][b]), _num(bands["f_c"][b]),
+                _num(bands["esr"][b]), _num(bands["cap"][b]), _num(bands["esl"]),
+                str(int(bands["n_bins"][b]))
+            ]) + "\n")
+
+
+def append_circuit_row(*, pulse_id: int, fit):
+    """
+    Hängt einen LM-Fit (circuit_fit.FitResult) an <RUN_NAME>.circuit.csv an.
+    Eine Datei je Modell-Spaltensatz: bei Modellwechsel neue Datei anlegen.
+    """
+    names = MODELS[fit.model]
+    if not os.path.exists(CIRCUIT_CSV_PATH):
+        with open(CIRCUIT_CSV_PATH, "w", encoding="utf-8") as f:
+            f.write(f"# model: {fit.model}\n")
+            f.write("# columns: pulse_id," + ",".join(names) + ",cost,n_iter,converged,warm\n")
+    with open(CIRCUIT_CSV_PATH, "a", encoding="utf-8") as f:
+        f.write(",".join([str(int(pulse_id))]
+                         + [f"{fit.params[n]:.9e}" for n in names]
+                         + [f"{fit.cost:.3e}", str(fit.n_iter), str(int(fit.converged)),
+                            str(int(fit.warm))]) + "\n")
+
+
+def append_cu_rows(*, pulse_id: int, cu: dict):
+    """Hängt die C(U)-Kurve eines Pulses an <RUN_NAME>.cu.csv an (eine Zeile je Spannungsbin)."""
+    if not os.path.exists(CU_CSV_PATH):
+        with open(CU_CSV_PATH, "w", encoding="utf-8") as f:
+            f.write("# columns: pulse_id,bin,u_lo_V,u_hi_V,u_c_V,cap_F,esr_ohm,n_samples\n")
+
+    def _num(x):
+        return f"{float(x):.9e}" if np.isfinite(x) else ""
+
+    with open(CU_CSV_PATH, "a", encoding="utf-8") as f:
+        for b in range(len(cu["u_c"])):
+            f.write(",".join([
+                str(int(pulse_id)), str(b),
+                _num(cu["u_lo"][b]), _num(cu["u_hi"][b]), _num(cu["u_c"][b]),
+                _num(cu["cap"][b]), _num(cu["esr"][b]), str(int(cu["n"][b]))
+            ]) + "\n")
+
+
 def list_pulse_ids_auto() -> list[int]:
     """
     Liefert alle verfügbaren pulse_id (aufsteigend), egal ob combined oder per_pulse.
@@ -255,52 +329,40 @@ def estimate_cap_params(t: np.ndarray, u: np.ndarray, i: np.ndarray) -> Tuple[fl
     Einfaches Serien-Ersatzschaltbild: ESR + C
     U(ω) = ESR * I(ω) + (1/jωC) * I(ω)
     """
-    # Eingabevalidierung
-    t = np.asarray(t, dtype=float)
-    u = np.asarray(u, dtype=complex)
-    i = np.asarray(i, dtype=complex)
-
-    if len(t) != len(u) or len(t) != len(i):
-        raise ValueError("Arrays t, u, i müssen gleiche Länge haben")
-
-    # Zeitvektor prüfen: muss streng monoton steigend sein
-    dt = np.diff(t)
-    if np.any(dt <= 0):
-        raise ValueError("Zeitvektor muss streng monoton steigend sein")
-
-    # Abtastfrequenz aus mittlerem Zeitabstand berechnen
-    fs = 1.0 / np.mean(dt)
-    N = t.size
-
-    # FFT berechnen (shifted für symmetrische Darstellung)
-    fU = np.fft.fftshift(np.fft.fft(u))
-    fI = np.fft.fftshift(np.fft.fft(i))
-
-    # Frequenzachse generieren (shifted)
-    f = np.fft.fftshift(np.fft.fftfreq(N, d=1.0 / fs))
-    omega = 2.0 * np.pi * f
-
-    # Nur positive Frequenzen verwenden (DC ausschließen)
-    pos_idx = np.where(f > 0)[0]
-    if pos_idx.size == 0:
-        raise ValueError("Keine positiven Frequenzen gefunden (N zu klein?)")
-
-    # Erste positive Frequenz überspringen
-    if pos_idx.size > 1:
-        idx = pos_idx[1:]
+    return estimate_cap_params_spec(compute_spectrum(t, u, i))
+
+
+def _fit_rows(spec: Spectrum, f_band=None):
+    """
+    Frequenzpunkte für die Fits: erste positive Frequenz übersprungen,
+    Zeilengewicht sqrt(w) für ausgedünnte Bereiche des Spektrums.
+    Mit f_band (Hz) nur die Punkte darin, im Cache also jeder FFT-Punkt (w = 1).
+    """
+    if f_band is not None:
+        sl = (spec.f >= f_band[0]) & (spec.f <= f_band[1])
     else:
-        idx = pos_idx
+        sl = slice(1, None) if len(spec.f) > 1 else slice(None)
+    om = 2.0 * np.pi * spec.f[sl]
+    sw = np.sqrt(spec.w[sl].astype(float))
+    return om, spec.U[sl].astype(complex), spec.I[sl].astype(complex), sw
 
-    FI = fI[idx]
-    OM = omega[idx]
+
+def estimate_cap_params_spec(spec: Spectrum, f_band=None) -> Tuple[float, float]:
+    """
+    ESR und C aus einem (ggf. gecachten) Spektrum, siehe estimate_cap_params.
+
+    f_band (Hz) beschränkt den Fit auf das Fit-Band des Caches: dort liegt jeder
+    FFT-Punkt vor, das Ergebnis hängt also nicht von der Ausdünnung ab.
+    """
+    OM, FU, FI, sw = _fit_rows(spec, f_band)
 
     # Design-Matrix: A * x = b
     # x = [ESR, 1/C]
     A = np.column_stack([
         FI,
         (-1j / OM) * FI
-    ])
-    b = fU[idx]
+    ]) * sw[:, None]
+    b = FU * sw
 
     # Least-Squares-Lösung
     x, *_ = np.linalg.lstsq(A, b, rcond=None)
@@ -323,43 +385,12 @@ def estimate_cap_params_with_esl(
     Erweitertes Ersatzschaltbild:
         Z(ω) = ESR + jω L_ESL + 1/(jω C)
     """
-    # Eingabevalidierung
-    t = np.asarray(t, dtype=float)
-    u = np.asarray(u, dtype=complex)
-    i = np.asarray(i, dtype=complex)
-
-    if len(t) != len(u) or len(t) != len(i):
-        raise ValueError("Arrays t, u, i müssen gleiche Länge haben")
-
-    # Zeitvektor prüfen
-    dt = np.diff(t)
-    if np.any(dt <= 0):
-        raise ValueError("Zeitvektor muss streng monoton steigend sein")
-
-    # Abtastfrequenz und Anzahl Samples
-    fs = 1.0 / np.mean(dt)
-    N = t.size
-
-    # FFT berechnen (mit shift)
-    fU = np.fft.fftshift(np.fft.fft(u))
-    fI = np.fft.fftshift(np.fft.fft(i))
-
-    # Frequenzachse
-    f = np.fft.fftshift(np.fft.fftfreq(N, d=1.0 / fs))
-    omega = 2.0 * np.pi * f
-
-    # Nur positive Frequenzen
-    pos_idx = np.where(f > 0)[0]
-    if pos_idx.size == 0:
-        raise ValueError("Keine positiven Frequenzen gefunden (N zu klein?)")
-
-    if pos_idx.size > 1:
-        idx = pos_idx[1:]
-    else:
-        idx = pos_idx
+    return estimate_cap_params_with_esl_spec(compute_spectrum(t, u, i))
 
-    FI = fI[idx]
-    OM = omega[idx]
+
+def estimate_cap_params_with_esl_spec(spec: Spectrum) -> Tuple[float, float, float]:
+    """ESR, C und ESL aus einem (ggf. gecachten) Spektrum."""
+    OM, FU, FI, sw = _fit_rows(spec)
 
     # Design-Matrix:
     # A(ω) = [ I(ω),  jω I(ω),  (-j/ω) I(ω) ]
@@ -367,8 +398,8 @@ def estimate_cap_params_with_esl(
         FI,
         1j * OM * FI,
         (-1j / OM) * FI
-    ])
-    b = fU[idx]
+    ]) * sw[:, None]
+    b = FU * sw
 
     # Least-Squares-Lösung
     x, *_ = np.linalg.lstsq(A, b, rcond=None)
@@ -380,6 +411,46 @@ def estimate_cap_params_with_esl(
     return esr_ohm, capacitance_f, esl_h
 
 
+# ======= ESR(f)/C(f) in Frequenzbändern (ein Spektrum je Puls) =======
+def estimate_band_params(t, u, i, n_bands=8, f_min=None, f_max=None, esl_h=0.0) -> dict:
+    """
+    ESR und C getrennt in n_bands logarithmisch verteilten Bändern.
+
+    Gleiches Verfahren wie pico_pulse_lab.processing.cap_params.estimate_band_params:
+    reelle Kleinste-Quadrate je Band über Summen je Frequenzpunkt
+    (np.bincount, alle Bänder zugleich). Eine bekannte ESL
+    (z.B. aus estimate_cap_params_with_esl) wird vorher abgezogen.
+    """
+    return estimate_band_params_spec(compute_spectrum(t, u, i), n_bands, f_min, f_max, esl_h)
+
+
+def estimate_band_params_spec(spec: Spectrum, n_bands=8, f_min=None, f_max=None,
+                              esl_h=0.0) -> dict:
+    """ESR(f)/C(f) aus einem (ggf. gecachten) Spektrum, Punkte gewichtet mit w."""
+    f = spec.f
+    f_min = f[1] if f_min is None else f_min
+    f_max = f[-1] if f_max is None else f_max
+    edges = np.geomspace(f_min, f_max, n_bands + 1)
+
+    sel = (f >= f_min) & (f <= f_max)
+    FU, FI = spec.U[sel].astype(complex), spec.I[sel].astype(complex)
+    wt = spec.w[sel].astype(float)
+    om = 2.0 * np.pi * f[sel]
+    band = np.clip(np.searchsorted(edges, f[sel], side="right") - 1, 0, n_bands - 1)
+
+    cross = np.conj(FI) * FU
+    p = np.abs(FI) ** 2
+    sums = lambda x: np.bincount(band, weights=wt * x, minlength=n_bands)
+    s_ii = sums(p)
+    s_im = sums(cross.imag / om) - esl_h * s_ii     # jωL·I abgezogen
+    n_bins = np.bincount(band, weights=wt, minlength=n_bands).astype(int)
+    with np.errstate(divide="ignore", invalid="ignore"):
+        esr = np.where(n_bins > 0, sums(cross.real) / s_ii, np.nan)
+        cap = np.where(n_bins > 0, -sums(p / om ** 2) / s_im, np.nan)
+    return {"f_lo": edges[:-1], "f_hi": edges[1:], "f_c": np.sqrt(edges[:-1] * edges[1:]),
+            "esr": esr, "cap": cap, "esl": esl_h, "n_bins": n_bins}
+
+
 def pulse_energy_and_power(
     t, u, i, *,
     i_unit: str = "A",
@@ -477,7 +548,9 @@ if __name__ == "__main__":
     print(f"Erkannte I-Spalte: {i_colname}")
 
     # Ziel-IDs bestimmen
-    if USE_LAST:
+    if ANALYZE_ALL:
+        ids_to_analyze = available_ids
+    elif USE_LAST:
         ids_to_analyze = [available_ids[-1]]
     elif OVERLAY_IDS:
         ids_to_analyze = [pid for pid in OVERLAY_IDS if pid in available_ids]
@@ -487,29 +560,61 @@ if __name__ == "__main__":
     if not ids_to_analyze:
         raise ValueError("Keine gültigen pulse_id für die Auswertung gefunden.")
 
+    # Spektren-Cache: Schlüssel aus allem, was das Spektrum und die mitgespeicherte
+    # Energie bestimmt (der DC-Bias geht nur in die Energie ein).
+    # meta.json wird bei jedem neuen Messlauf gleichen Namens neu geschrieben.
+    cache = None
+    if USE_SPEC_CACHE:
+        cache = SpectralCache(CACHE_PREFIX, {
+            "run": RUN_NAME,
+            "meta_mtime": os.path.getmtime(META_PATH),
+            "i_col": i_colname,
+            "fit_band": FIT_BAND_HZ,
+            "per_decade": CACHE_PER_DECADE,
+            "u_dc_bias_V": U_DC_BIAS_V,
+        })
+        print(f"Spektren-Cache: {len(cache)} Pulse in {cache.path}")
+
+    # Nichtlinearer Fit: Warmstart aus dem vorigen Puls, Spektren ggf. für den Benchmark
+    fitter = CircuitFitter(NL_MODEL, f_band=FIT_BAND_HZ) if NL_MODEL else None
+    nl_iters, nl_specs = [], []
+
     for pulse_id in ids_to_analyze:
         print(f"\n--- Analysiere Pulse-ID: {pulse_id} ---")
 
-        i_colname = detect_i_unit_auto(pulse_id)
-        t, u, i_sig = read_pulse_auto(pulse_id)
-        print(f"Pulsdaten geladen: {len(t)} Samples")
-
-        rogowski_scale = meta.get("ch_b", {}).get("rogowski_v_per_a", None)
-        print(f"Rogowski-Skala: {rogowski_scale} V/A")
-
-        res = pulse_energy_and_power(
-            t, u, i_sig,
-            i_unit="A" if i_colname == "i_A" else "V",
-            rogowski_per_a=rogowski_scale,
-            u_is_ac_coupled=True,
-            u_dc_bias_V=U_DC_BIAS_V,
-            baseline_correction=True,
-            pre_pct=0.05
-        )
-
-        # --- Parameter-Fits ---
-        esr_simple, c_simple = estimate_cap_params(t, u, i_sig)
-        esr_esl, c_esl, l_esl = estimate_cap_params_with_esl(t, u, i_sig)
+        spec = cache.get(pulse_id) if cache is not None else None
+        res = {}
+        have_raw = spec is None or CU_BINS > 0
+        if have_raw:
+            i_colname = detect_i_unit_auto(pulse_id)
+            t, u, i_sig = read_pulse_auto(pulse_id)
+            print(f"Pulsdaten geladen: {len(t)} Samples")
+
+            rogowski_scale = meta.get("ch_b", {}).get("rogowski_v_per_a", None)
+            print(f"Rogowski-Skala: {rogowski_scale} V/A")
+
+            res = pulse_energy_and_power(
+                t, u, i_sig,
+                i_unit="A" if i_colname == "i_A" else "V",
+                rogowski_per_a=rogowski_scale,
+                u_is_ac_coupled=True,
+                u_dc_bias_V=U_DC_BIAS_V,
+                baseline_correction=True,
+                pre_pct=0.05
+            )
+
+            if spec is None:
+                spec = compute_spectrum(t, u, i_sig, fit_band=FIT_BAND_HZ,
+                                        per_decade=CACHE_PER_DECADE)._replace(
+                    E_J=res["E_J"], P_peak_W=res["P_peak_W"], P_avg_W=res["P_avg_W"])
+                if cache is not None:
+                    cache.put(pulse_id, spec)   # je 500 Pulse ein Block auf der Platte
+        else:                               # Treffer: E/P aus dem Cache-Eintrag
+            res = {"E_J": spec.E_J, "P_peak_W": spec.P_peak_W, "P_avg_W": spec.P_avg_W}
+
+        # --- Parameter-Fits (ein Spektrum für alle Modelle) ---
+        esr_simple, c_simple = estimate_cap_params_spec(spec, f_band=FIT_BAND_HZ)
+        esr_esl, c_esl, l_esl = estimate_cap_params_with_esl_spec(spec)
 
         # in Arrays sammeln
         esr_simple_arr.append(esr_simple)
@@ -528,15 +633,16 @@ if __name__ == "__main__":
         print(f"    C   (mit  ESL): {c_esl*1e6:.3f} µF (Δ = {d_c_pct:+.2f} %)")
         print(f"    L_ESL (fit):    {l_esl*1e9:.2f} nH")
 
-        print(f"    Energie: {res['E_J']:.3f} J | "
-              f"P_peak: {res['P_peak_W']:.1f} W | "
-              f"P_avg: {res['P_avg_W']:.1f} W")
+        if res:
+            print(f"    Energie: {res['E_J']:.3f} J | "
+                  f"P_peak: {res['P_peak_W']:.1f} W | "
+                  f"P_avg: {res['P_avg_W']:.1f} W")
 
         # CSV-Logging: weiterhin das einfache Modell (ohne ESL),
         # damit bestehende Auswerteskripte unverändert laufen.
         append_params_row(
             pulse_id=pulse_id,
-            t=t,
+            t_mid=spec.t_mid,
             esr=esr_simple,
             cap=c_simple,
             res=res,
@@ -544,6 +650,37 @@ if __name__ == "__main__":
             source=_source_mode_str()
         )
 
+        if fitter is not None:
+            fit = fitter.fit(spec)
+            nl_iters.append(fit.n_iter)
+            if NL_BENCHMARK:
+                nl_specs.append(spec)
+            append_circuit_row(pulse_id=pulse_id, fit=fit)
+            print(f"    {fit.model}: " + ", ".join(f"{k}={v:.4g}" for k, v in fit.params.items())
+                  + f" | {fit.n_iter} Schritte, {'warm' if fit.warm else 'kalt'}"
+                  + ("" if fit.converged else ", NICHT konvergiert"))
+
+        # C(U): absolute Spannung wie in pulse_energy_and_power (Grundlinie + DC-Bias), I in A
+        if CU_BINS > 0 and have_raw:
+            n_pre = max(1, int(len(t) * 0.05))
+            u_abs = u - np.median(u[:n_pre]) + U_DC_BIAS_V
+            i_A = i_sig if i_colname == "i_A" else i_sig / float(rogowski_scale)
+            i_A = i_A - np.median(i_A[:n_pre])
+            cu = estimate_c_of_u(t, u_abs, i_A, n_bins=CU_BINS, u_range=CU_RANGE_V)
+            append_cu_rows(pulse_id=pulse_id, cu=cu)
+            for uc, c_b in zip(cu["u_c"], cu["cap"]):
+                print(f"      {uc:8.1f} V: C {c_b*1e6:9.3f} µF")
+
+        # ESR(f)/C(f) neben den skalaren Parametern, ESL aus dem Fit oben
+        if N_BANDS > 0:
+            bands = estimate_band_params_spec(spec, n_bands=N_BANDS, esl_h=l_esl)
+            append_bands_rows(pulse_id=pulse_id, bands=bands)
+            for fc, esr_b, c_b in zip(bands["f_c"], bands["esr"], bands["cap"]):
+                print(f"      {fc/1e3:9.1f} kHz: ESR {esr_b*1e3:8.3f} mΩ, C {c_b*1e6:9.3f} µF")
+
+    if cache is not None:
+        cache.save()
+
     # === Zusammenfassung ===
     print("\n=== Zusammenfassung (Mittelwerte) ===")
     mean_esr_simple = np.mean(esr_simple_arr)
@@ -564,3 +701,13 @@ if __name__ == "__main__":
 
     print(f"Durchschnittliche Abweichung ESR: {mean_d_esr:+.2f} %")
     print(f"Durchschnittliche Abweichung C:   {mean_d_c:+.2f} %")
+
+    if nl_iters:
+        print(f"\n{NL_MODEL}: LM-Schritte je Puls Mittel {np.mean(nl_iters):.1f}, "
+              f"max {np.max(nl_iters)}")
+    if nl_specs:
+        bm = benchmark(nl_specs, NL_MODEL, FIT_BAND_HZ)
+        print(f"Benchmark {len(nl_specs)} Pulse: "
+              f"kalt {bm['cold']['time_s']*1e3:.1f} ms / {bm['cold']['iter_mean']:.1f} Schritte, "
+              f"warm {bm['warm']['time_s']*1e3:.1f} ms / {bm['warm']['iter_mean']:.1f} Schritte "
+              f"(x{bm['speedup']:.1f}), max. Abweichung {bm['max_rel_diff']:.1e}")
@@ -0,0 +1,132 @@
+"""
+Spannungsabhängige Kapazität C(U) aus dem Zeitverlauf eines Pulses
+
+- Modell je Spannungsbin b (lokal linearisiert):
+      u(t) = a_b + ESR_b · i(t) + q(t) / C_b,    q(t) = ∫ i dt  (Präfix-Integral)
+  d.h. C_b ist die differentielle Kapazität dQ/dU im Bin
+- Einteilung nach der Kondensatorspannung u_C = u - ESR·i (ESR aus einem
+  Fit über den ganzen Puls), damit der ohmsche Sprung nicht die Bins wechselt
+- Normalgleichungen aller Bins (und aller Pulse eines Stapels) über
+  np.bincount, Lösung in einem Aufruf von np.linalg.solve
+- u muss die absolute Spannung sein (AC-gekoppelt: Grundlinie + DC-Bias)
+
+Vorzeichen wie estimate_cap_params: U = ESR·I + I/(jωC).
+"""
+
+import numpy as np
+
+
+def prefix_charge(t, i):
+    """Ladung q(t) = ∫ i dt (Trapez, kumulativ), letzte Achse = Zeit."""
+    t = np.asarray(t, float)
+    i = np.asarray(i, float)
+    dt = np.diff(t, axis=-1)
+    dq = 0.5 * (i[..., 1:] + i[..., :-1]) * dt
+    return np.concatenate([np.zeros(i.shape[:-1] + (1,)), np.cumsum(dq, axis=-1)], axis=-1)
+
+
+def _solve_bins(idx, valid, n_groups, u, cols):
+    """
+    Kleinste Quadrate u ≈ Σ x_k·cols_k getrennt je Gruppe idx (flach, 0..n_groups-1).
+
+    Returns
+    -------
+    x : (n_groups, n_cols), NaN für unterbestimmte Gruppen
+    n : (n_groups,) Samples je Gruppe
+    """
+    m = len(cols)
+    idx = idx[valid]
+    cols = [c[valid] for c in cols]
+    u = u[valid]
+    n = np.bincount(idx, minlength=n_groups)
+    # Spalten je Gruppe skalieren (1, A, A·s): bessere Kondition der 3x3-Systeme,
+    # und jede Gruppe hängt nur von ihren eigenen Samples ab (Stapel = Einzelaufrufe)
+    scl = np.stack([np.sqrt(np.bincount(idx, c * c, minlength=n_groups) / np.maximum(n, 1))
+                    for c in cols], axis=-1)
+    scl = np.maximum(scl, 1e-300)
+    cols = [c / scl[idx, k] for k, c in enumerate(cols)]
+
+    G = np.empty((n_groups, m, m))
+    for a in range(m):
+        for b in range(a, m):
+            G[:, a, b] = G[:, b, a] = np.bincount(idx, cols[a] * cols[b], minlength=n_groups)
+    r = np.stack([np.bincount(idx, c * u, minlength=n_groups) for c in cols], axis=-1)
+
+    # unterbestimmte/singuläre Gruppen durch Einheitsmatrix ersetzen, danach NaN
+    ok = n >= 2 * m
+    ok[ok] = np.linalg.cond(G[ok]) < 1e12
+    G[~ok] = np.eye(m)
+    r[~ok] = 0.0
+    x = np.linalg.solve(G, r[..., None])[..., 0] / scl
+    x[~ok] = np.nan
+    return x, n
+
+
+def estimate_c_of_u(t, u, i, *, n_bins=16, u_range=None, min_samples=50) -> dict:
+    """
+    C(U) und ESR(U) in n_bins Spannungsbins, für einen Puls oder einen Stapel.
+
+    Parameters
+    ----------
+    t : (n,) oder (P, n)
+        Zeit in s
+    u : (n,) oder (P, n)
+        absolute Spannung in V
+    i : (n,) oder (P, n)
+        Strom in A
+    n_bins : int
+        Anzahl gleich breiter Spannungsbins
+    u_range : (U_min, U_max) oder None
+        Binbereich; None = Bereich von u_C über alle Pulse (gemeinsame Bins)
+    min_samples : int
+        Bins mit weniger Samples -> NaN
+
+    Returns
+    -------
+    dict mit u_lo, u_hi, u_c (n_bins,) sowie cap, esr, n (P, n_bins) bzw. (n_bins,)
+    und esr_total (P,) bzw. Skalar (ESR-Fit über den ganzen Puls).
+    """
+    u = np.asarray(u, float)
+    i = np.asarray(i, float)
+    single = u.ndim == 1
+    u, i = np.atleast_2d(u), np.atleast_2d(i)
+    t = np.broadcast_to(np.asarray(t, float), u.shape)
+    if u.shape != i.shape:
+        raise ValueError("u und i müssen gleiche Form haben")
+    P, N = u.shape
+    q = prefix_charge(t, i)
+    ones = np.ones_like(u)
+    pulse = np.repeat(np.arange(P), N)
+
+    # 1) ganzer Puls: ESR für die Kondensatorspannung
+    x0, _ = _solve_bins(pulse, np.ones(P * N, bool), P,
+                        u.ravel(), [ones.ravel(), i.ravel(), q.ravel()])
+    esr_total = x0[:, 1]
+    uc = u - np.nan_to_num(esr_total)[:, None] * i
+
+    # 2) Spannungsbins (gemeinsame Grenzen für den ganzen Stapel)
+    lo, hi = u_range if u_range is not None else (np.nanmin(uc), np.nanmax(uc))
+    edges = np.linspace(lo, hi, n_bins + 1)
+    b = np.searchsorted(edges, uc, side="right") - 1
+    b[uc == hi] = n_bins - 1
+    valid = ((b >= 0) & (b < n_bins)).ravel()
+    flat = (pulse * n_bins + np.clip(b, 0, n_bins - 1).ravel())
+
+    x, n = _solve_bins(flat, valid, P * n_bins, u.ravel(),
+                       [ones.ravel(), i.ravel(), q.ravel()])
+    x = x.reshape(P, n_bins, 3)
+    n = n.reshape(P, n_bins)
+    with np.errstate(divide="ignore", invalid="ignore"):
+        cap = 1.0 / x[..., 2]
+    few = n < min_samples
+    cap[few] = np.nan
+    esr = x[..., 1]
+    esr[few] = np.nan
+
+    out = {"u_lo": edges[:-1], "u_hi": edges[1:], "u_c": 0.5 * (edges[:-1] + edges[1:]),
+           "cap": cap, "esr": esr, "n": n, "esr_total": esr_total}
+    if single:
+        for k in ("cap", "esr", "n"):
+            out[k] = out[k][0]
+        out["esr_total"] = float(esr_total[0])
+    return out
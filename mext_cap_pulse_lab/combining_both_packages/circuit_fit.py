@@ -0,0 +1,255 @@
+"""
+Nichtlineare Ersatzschaltbild-Fits (Levenberg-Marquardt) auf Puls-Spektren
+
+- Modelle (alle in Serie mit ESR und ESL):
+    "rlc"       C
+    "rlc_leak"  C parallel Leckwiderstand R_leak
+    "randles"   C parallel (R_ct + Warburg σ(1-j)/sqrt(ω))   (Elkos)
+- Residuum im Spannungsbereich: U(ω) - Z(ω)·I(ω), Gewichte sqrt(w) aus dem
+  Spektren-Cache, nur Frequenzpunkte im Fit-Band
+- Parameter logarithmisch (immer positiv), Jacobi-Matrix analytisch
+- CircuitFitter startet jeden Puls mit der Lösung des vorigen (Warmstart);
+  der erste Puls (und ein nicht konvergierter Warmstart) beginnt beim
+  linearen R-L-C-Fit
+- benchmark(): Warm- gegen Kaltstart über eine Liste von Spektren
+  (Messdaten: cap_params_2.py, synthetische Pulse: test_circuit_fit.py)
+
+Arbeitet auf spectral_cache.Spectrum (f, U, I, w).
+"""
+
+import time
+from typing import NamedTuple
+import numpy as np
+
+MAX_LOG_STEP = 2.0      # max. Änderung je Parameter und LM-Schritt (Faktor e²)
+# Stillstand (λ läuft weg) gilt nur als Minimum, wenn das Residuum auf allen
+# freien Jacobi-Spalten senkrecht steht: max |cos| <= GTOL
+GTOL = 1e-6
+# Parametergrenzen: ein Element, das die Daten nicht brauchen (z.B. R_leak bei
+# einer Folie), läuft an die Grenze statt ohne Ende weiter
+LOG_BOUNDS = (np.log(1e-15), np.log(1e12))
+
+MODELS = {
+    "rlc":      ("esr", "esl", "cap"),
+    "rlc_leak": ("esr", "esl", "cap", "r_leak"),
+    "randles":  ("esr", "esl", "cap", "r_ct", "sigma"),
+}
+
+
+class FitResult(NamedTuple):
+    model: str
+    params: dict         # Name -> Wert (Ohm, H, F, Ohm/sqrt(s))
+    cost: float          # Restfehler relativ zu Σ|U|² (0 = perfekt)
+    n_iter: int          # LM-Schritte inkl. verworfener
+    converged: bool      # Toleranz erreicht bzw. Stillstand im Minimum (siehe GTOL)
+    warm: bool           # Start aus dem vorigen Puls
+
+
+def model_impedance(model: str, om: np.ndarray, theta: np.ndarray):
+    """
+    Impedanz Z(ω) und Ableitungen nach den log-Parametern.
+
+    Returns
+    -------
+    Z : np.ndarray (n_freq,)
+    dZ : np.ndarray (n_par, n_freq), dZ/d ln(theta_k) = theta_k · dZ/dtheta_k
+    """
+    jw = 1j * om
+    R, L, C = theta[:3]
+    dZ = np.empty((len(theta), om.size), dtype=complex)
+    dZ[0] = R
+    dZ[1] = jw * L
+
+    if model == "rlc":
+        Zp = 1.0 / (jw * C)
+        dZ[2] = -Zp
+    elif model == "rlc_leak":
+        Rp = theta[3]
+        den = 1.0 + jw * Rp * C
+        Zp = Rp / den
+        dZ[2] = -jw * Rp * Rp * C / den ** 2
+        dZ[3] = Rp / den ** 2
+    elif model == "randles":
+        Rct, sig = theta[3], theta[4]
+        war = (1 - 1j) / np.sqrt(om)
+        Zf = Rct + sig * war
+        Y = jw * C + 1.0 / Zf
+        Zp = 1.0 / Y
+        dZ[2] = -jw * C / Y ** 2
+        q = 1.0 / (Y * Zf) ** 2
+        dZ[3] = Rct * q
+        dZ[4] = sig * war * q
+    else:
+        raise ValueError(f"Unbekanntes Modell: {model!r} (erlaubt: {list(MODELS)})")
+
+    return R + jw * L + Zp, dZ
+
+
+def _rows(spec, f_band):
+    """Frequenzpunkte im Fit-Band (ohne erste positive Frequenz), Zeilengewicht sqrt(w)."""
+    f = spec.f.astype(float)
+    sel = np.ones(f.size, dtype=bool)
+    sel[0] = f.size == 1
+    f_lo, f_hi = f_band
+    if f_lo is not None:
+        sel &= f >= f_lo
+    if f_hi is not None:
+        sel &= f <= f_hi
+    if np.count_nonzero(sel) < 6:
+        raise ValueError("Zu wenige Frequenzpunkte im Fit-Band")
+    return (2.0 * np.pi * f[sel], spec.U[sel].astype(complex), spec.I[sel].astype(complex),
+            np.sqrt(spec.w[sel].astype(float)))
+
+
+def initial_guess(model: str, om, U, I, sw) -> np.ndarray:
+    """Kaltstart: linearer R-L-C-Fit (reelle Unbekannte), Zusatzelemente hochohmig."""
+    w = sw ** 2
+    cross = np.conj(I) * U
+    p = np.abs(I) ** 2 * w
+    R = np.sum(cross.real * w) / np.sum(p)
+    # Normalgleichungen für [L, 1/C] (ESR ist im Reellen entkoppelt)
+    g = np.array([[np.sum(p * om ** 2), -np.sum(p)], [-np.sum(p), np.sum(p / om ** 2)]])
+    rhs = np.array([np.sum(cross.imag * om * w), -np.sum(cross.imag / om * w)])
+    L, K = np.linalg.solve(g, rhs)
+    C = 1.0 / K if K > 0 else 1.0 / (om[0] * np.sum(np.abs(cross) * w) / np.sum(p))
+    theta = [max(R, 1e-6), max(L, 1e-12), C]
+
+    zc = 1.0 / (om.min() * C)               # |Zc| an der unteren Bandgrenze
+    if model == "rlc_leak":
+        theta += [10.0 * zc]
+    elif model == "randles":
+        theta += [10.0 * zc, 0.1 * zc * np.sqrt(om.min())]
+    return np.array(theta, dtype=float)
+
+
+def levenberg_marquardt(model, om, U, I, sw, theta0, *, max_iter=100, tol=1e-10, gtol=GTOL):
+    """
+    Levenberg-Marquardt in ln(theta) mit Marquardt-Skalierung (diag(JᵀJ)).
+
+    Konvergiert heißt: relative Kostenänderung <= tol, oder kein Abstieg mehr
+    möglich (λ > 1e12) bei erfüllter Optimalitätsbedingung (Gradient <= gtol).
+    Ein Stillstand abseits des Minimums und max_iter ergeben converged=False.
+
+    Returns
+    -------
+    theta, cost, n_iter, converged
+    """
+    scale = 1.0 / np.sqrt(np.sum(np.abs(U * sw) ** 2))
+    Is = I * sw * scale
+    Us = U * sw * scale
+
+    def evaluate(p):
+        with np.errstate(all="ignore"):     # Ausreißer-Schritte werden über cost verworfen
+            Z, dZ = model_impedance(model, om, np.exp(p))
+            r = Us - Z * Is
+            return r, -dZ * Is, float(np.real(np.vdot(r, r)))
+
+    p = np.clip(np.log(theta0), *LOG_BOUNDS)
+    r, J, cost = evaluate(p)
+    lam = 1e-3
+    converged = False
+    n_iter = 0
+    while n_iter < max_iter:
+        n_iter += 1
+        # reelle Normalgleichungen des gestapelten [Re; Im]-Problems
+        A = np.real(J @ J.conj().T)
+        g = np.real(J @ r.conj())
+        # Parameter an einer Grenze, die weiter hinaus wollen, bleiben fest
+        free = ~(((p <= LOG_BOUNDS[0]) & (g > 0)) | ((p >= LOG_BOUNDS[1]) & (g < 0)))
+        Af = A[np.ix_(free, free)]
+        step = np.zeros_like(p)
+        try:
+            step[free] = np.linalg.solve(Af + lam * np.diag(np.diag(Af)), -g[free])
+        except np.linalg.LinAlgError:
+            lam *= 10.0
+            continue
+        step = np.clip(p + np.clip(step, -MAX_LOG_STEP, MAX_LOG_STEP), *LOG_BOUNDS) - p
+        r_new, J_new, cost_new = evaluate(p + step)
+        if np.isfinite(cost_new) and cost_new < cost:
+            done = (cost - cost_new) <= tol * cost or np.max(np.abs(step)) < 1e-9
+            p, r, J, cost = p + step, r_new, J_new, cost_new
+            lam = max(lam / 3.0, 1e-12)
+            if done:
+                converged = True
+                break
+        else:
+            lam *= 4.0
+            if lam > 1e12:
+                # kein Abstieg mehr möglich: Minimum nur, wenn der Gradient verschwindet
+                with np.errstate(all="ignore"):
+                    cos = np.abs(g[free]) / np.sqrt(np.diag(A)[free] * cost)
+                converged = bool(np.all(np.nan_to_num(cos, nan=0.0) <= gtol))
+                break
+    return np.exp(p), cost, n_iter, converged
+
+
+class CircuitFitter:
+    """
+    Ersatzschaltbild-Fit Puls für Puls mit Warmstart.
+
+    Parameters
+    ----------
+    model : str
+        "rlc", "rlc_leak" oder "randles"
+    f_band : tuple
+        (f_min, f_max) in Hz, None = Rand des gespeicherten Spektrums
+    warm_start : bool
+        Startwert aus dem vorigen (konvergierten) Puls
+    """
+
+    def __init__(self, model="rlc_leak", f_band=(None, None), warm_start=True,
+                 max_iter=100, tol=1e-10):
+        if model not in MODELS:
+            raise ValueError(f"Unbekanntes Modell: {model!r} (erlaubt: {list(MODELS)})")
+        self.model = model
+        self.f_band = f_band
+        self.warm_start = warm_start
+        self.max_iter = max_iter
+        self.tol = tol
+        self._last = None
+
+    def reset(self):
+        self._last = None
+
+    def fit(self, spec) -> FitResult:
+        om, U, I, sw = _rows(spec, self.f_band)
+        warm = self.warm_start and self._last is not None
+        theta0 = self._last if warm else initial_guess(self.model, om, U, I, sw)
+        theta, cost, n_iter, ok = levenberg_marquardt(self.model, om, U, I, sw, theta0,
+                                                      max_iter=self.max_iter, tol=self.tol)
+        if warm and not ok:
+            # Warmstart hängt (z.B. Sprung zwischen Pulsen): kalt wiederholen
+            theta, cost, n_cold, ok = levenberg_marquardt(
+                self.model, om, U, I, sw, initial_guess(self.model, om, U, I, sw),
+                max_iter=self.max_iter, tol=self.tol)
+            n_iter += n_cold
+            warm = False
+        if ok:
+            self._last = theta
+        return FitResult(self.model, dict(zip(MODELS[self.model], map(float, theta))),
+                         cost, n_iter, ok, warm)
+
+
+def benchmark(specs, model="rlc_leak", f_band=(None, None)) -> dict:
+    """
+    Warm- gegen Kaltstart über dieselben Spektren.
+
+    Returns
+    -------
+    dict
+        Je Variante Gesamtzeit, LM-Schritte (Summe/Mittel), nicht konvergierte
+        Pulse sowie die größte relative Parameterabweichung zwischen beiden.
+    """
+    out, params = {}, {}
+    for name, warm in (("cold", False), ("warm", True)):
+        fitter = CircuitFitter(model, f_band, warm_start=warm)
+        t0 = time.perf_counter()
+        results = [fitter.fit(s) for s in specs]
+        dt = time.perf_counter() - t0
+        iters = np.array([r.n_iter for r in results])
+        out[name] = {"time_s": dt, "iter_sum": int(iters.sum()), "iter_mean": float(iters.mean()),
+                     "not_converged": sum(not r.converged for r in results)}
+        params[name] = np.array([list(r.params.values()) for r in results])
+    out["max_rel_diff"] = float(np.max(np.abs(params["warm"] / params["cold"] - 1.0)))
+    out["speedup"] = out["cold"]["time_s"] / max(out["warm"]["time_s"], 1e-12)
+    return out
@@ -0,0 +1,182 @@
+"""
+Spektren-Cache je Puls für die Parameter-Fits (cap_params_2.py)
+
+- Ein Spektrum je Puls: positive Frequenzen von U und I (rFFT, ohne DC)
+- Im Fit-Band jeder Frequenzpunkt, außerhalb logarithmisch ausgedünnt;
+  das Gewicht w zählt die vertretenen FFT-Punkte (gewichtete Kleinste Quadrate)
+- Gespeichert als float32/complex64 in Runs/<RUN_NAME>/Cache/<RUN_NAME>.spec-<key>/,
+  je 500 Pulse eine Datei shard-NNNNNN.npz (nur angehängt, nie neu geschrieben)
+- Energie und Leistung des Pulses (E_J, P_peak_W, P_avg_W) stehen mit im Eintrag,
+  damit params.csv bei einem Treffer vollständig bleibt
+- <key> ist ein Hash über Lauf (inkl. Zeitstempel der meta.json), I-Spalte und
+  Vorverarbeitung: geänderte Einstellungen oder neu aufgenommener Lauf -> neuer Cache
+
+Ein Neu-Fit mit anderem Modell (mit/ohne ESL, Bänder) liest nur noch den
+Cache statt aller Roh-CSVs und FFTs.
+"""
+
+import os
+import json
+import hashlib
+from typing import NamedTuple
+import numpy as np
+
+CACHE_VERSION = 3
+
+
+class Spectrum(NamedTuple):
+    f: np.ndarray        # Hz (float32)
+    U: np.ndarray        # complex64
+    I: np.ndarray        # complex64
+    w: np.ndarray        # vertretene FFT-Punkte je Eintrag (float32)
+    t_mid: float         # Mitte des Pulsfensters in s (für params.csv)
+    E_J: float = float("nan")        # Energie/Leistung aus den Rohdaten (für params.csv)
+    P_peak_W: float = float("nan")
+    P_avg_W: float = float("nan")
+
+
+def _log_picks(f: np.ndarray, start: int, stop: int, per_decade: int) -> np.ndarray:
+    """Indizes in [start, stop), logarithmisch in f verteilt, start immer enthalten."""
+    if stop - start <= 1:
+        return np.arange(start, stop)
+    n = max(2, int(np.ceil(per_decade * np.log10(f[stop - 1] / f[start]))) + 1)
+    grid = np.geomspace(f[start], f[stop - 1], n)
+    picks = np.searchsorted(f, grid, side="left")
+    return np.unique(np.clip(picks, start, stop - 1))
+
+
+def compute_spectrum(t, u, i, *, fit_band=(None, None), per_decade=20) -> Spectrum:
+    """
+    Positives Spektrum von U und I, außerhalb fit_band (Hz) ausgedünnt.
+
+    Die Frequenzpunkte entsprechen den positiven Frequenzen der vollen FFT
+    (ohne Nyquist), wie bisher in den Schätzfunktionen.
+    """
+    t = np.asarray(t, dtype=float)
+    u = np.asarray(u, dtype=float)
+    i = np.asarray(i, dtype=float)
+    if len(t) != len(u) or len(t) != len(i):
+        raise ValueError("Arrays t, u, i müssen gleiche Länge haben")
+    dt = np.diff(t)
+    if np.any(dt <= 0):
+        raise ValueError("Zeitvektor muss streng monoton steigend sein")
+
+    N = t.size
+    k = np.arange(1, (N - 1) // 2 + 1)             # positive Frequenzen der FFT
+    if k.size == 0:
+        raise ValueError("Keine positiven Frequenzen gefunden (N zu klein?)")
+    f = k / (N * np.mean(dt))
+    FU = np.fft.rfft(u)[k]
+    FI = np.fft.rfft(i)[k]
+
+    f_lo, f_hi = fit_band
+    a = 0 if f_lo is None else int(np.searchsorted(f, f_lo, side="left"))
+    b = f.size if f_hi is None else int(np.searchsorted(f, f_hi, side="right"))
+    a, b = min(a, f.size), max(b, a)
+    idx = np.concatenate([_log_picks(f, 0, a, per_decade), np.arange(a, b),
+                          _log_picks(f, b, f.size, per_decade)])
+    w = np.diff(np.append(idx, f.size)).astype(np.float32)
+
+    return Spectrum(f[idx].astype(np.float32), FU[idx].astype(np.complex64),
+                    FI[idx].astype(np.complex64), w, float(0.5 * (t[0] + t[-1])))
+
+
+def settings_key(settings: dict) -> str:
+    """Kurzer Hash über die Einstellungen, die das Spektrum bestimmen."""
+    blob = json.dumps({"version": CACHE_VERSION, **settings}, sort_keys=True, default=str)
+    return hashlib.sha1(blob.encode("utf-8")).hexdigest()[:12]
+
+
+class SpectralCache:
+    """
+    Spektren eines Messlaufs für einen Satz Einstellungen.
+
+    get() liefert das Spektrum oder None, put() merkt ein neues vor.
+    Neue Spektren gehen in Blöcken zu je shard_size Pulsen in eigene Dateien
+    (nur anhängen, nie umschreiben); save() schreibt den angefangenen Block.
+    Beim Öffnen wird nur das Inhaltsverzeichnis gelesen, die Spektren eines
+    Blocks erst beim ersten get() daraus (zuletzt benutzter Block bleibt geladen).
+
+    Das Fit-Band muss endlich sein: außerhalb wird ausgedünnt, sonst hätte
+    jeder Puls alle FFT-Punkte im Cache (480k Samples -> ~6 MB je Puls).
+    """
+
+    def __init__(self, prefix: str, settings: dict, shard_size: int = 500):
+        f_lo, f_hi = settings["fit_band"]
+        if f_lo is None or f_hi is None or not 0 < f_lo < f_hi:
+            raise ValueError(f"Spektren-Cache braucht ein endliches Fit-Band, nicht {(f_lo, f_hi)}")
+        self.settings = dict(settings)
+        self.path = f"{prefix}.spec-{settings_key(self.settings)}"
+        self.shard_size = int(shard_size)
+        self._index: dict[int, tuple] = {}      # pulse_id -> (Blockdatei, Position)
+        self._pending: dict[int, Spectrum] = {}
+        self._loaded = (None, {})               # (Blockdatei, pulse_id -> Spectrum)
+        self._n_shards = 0
+        if os.path.isdir(self.path):
+            self._load_index()
+
+    def _load_index(self):
+        shards = sorted(fn for fn in os.listdir(self.path)
+                        if fn.startswith("shard-") and fn.endswith(".npz"))
+        for fn in shards:                       # spätere Blöcke überschreiben frühere
+            with np.load(os.path.join(self.path, fn)) as d:
+                ids = d["pulse_id"]             # npz liest nur diesen Eintrag
+            for n, pid in enumerate(ids):
+                self._index[int(pid)] = (fn, n)
+        if shards:
+            self._n_shards = int(shards[-1][6:-4]) + 1
+
+    def _load_shard(self, fn: str) -> dict:
+        if self._loaded[0] != fn:
+            with np.load(os.path.join(self.path, fn)) as d:
+                ids, off = d["pulse_id"], d["offset"]
+                f, U, I, w, t_mid = d["f"], d["U"], d["I"], d["w"], d["t_mid"]
+                energy = d["energy"]                # (n, 3): E_J, P_peak_W, P_avg_W
+            specs = {}
+            for n, pid in enumerate(ids):
+                s = slice(off[n], off[n + 1])
+                specs[int(pid)] = Spectrum(f[s], U[s], I[s], w[s], float(t_mid[n]),
+                                           *map(float, energy[n]))
+            self._loaded = (fn, specs)
+        return self._loaded[1]
+
+    def __len__(self):
+        return len(self._index.keys() | self._pending.keys())
+
+    def __contains__(self, pulse_id: int):
+        return int(pulse_id) in self._pending or int(pulse_id) in self._index
+
+    def get(self, pulse_id: int):
+        pid = int(pulse_id)
+        if pid in self._pending:
+            return self._pending[pid]
+        if pid not in self._index:
+            return None
+        return self._load_shard(self._index[pid][0]).get(pid)
+
+    def put(self, pulse_id: int, spec: Spectrum):
+        self._pending[int(pulse_id)] = spec
+        if len(self._pending) >= self.shard_size:
+            self.save()
+
+    def save(self):
+        """Schreibt die vorgemerkten Spektren als neuen Block, atomar über eine Temp-Datei."""
+        if not self._pending:
+            return
+        os.makedirs(self.path, exist_ok=True)
+        ids = sorted(self._pending)
+        specs = [self._pending[p] for p in ids]
+        off = np.cumsum([0] + [len(s.f) for s in specs])
+        cat = lambda name, dtype: np.concatenate([getattr(s, name) for s in specs]).astype(dtype)
+        fn = f"shard-{self._n_shards:06d}.npz"
+        tmp = os.path.join(self.path, "tmp-" + fn)
+        np.savez(tmp, pulse_id=np.array(ids, dtype=np.int64), offset=off,
+                 f=cat("f", np.float32), U=cat("U", np.complex64), I=cat("I", np.complex64),
+                 w=cat("w", np.float32), t_mid=np.array([s.t_mid for s in specs]),
+                 energy=np.array([(s.E_J, s.P_peak_W, s.P_avg_W) for s in specs], dtype=float),
+                 settings=json.dumps(self.settings, default=str))
+        os.replace(tmp, os.path.join(self.path, fn))
+        for n, pid in enumerate(ids):
+            self._index[pid] = (fn, n)
+        self._n_shards += 1
+        self._pending = {}
@@ -0,0 +1,171 @@
+"""
+Test-Funktionen für die spannungsabhängige Kapazität C(U) (cap_voltage.py).
+
+Diese Tests treiben einen mittelwertfreien, bipolaren Strom in einen
+synthetischen Kondensator mit C(U) = C0·(1 + k·(U - U0)) und prüfen C und
+ESR je Spannungsbin, leere bzw. zu dünn besetzte Bins (NaN) und dass ein
+Stapel von Pulsen dasselbe liefert wie die Einzelaufrufe.
+"""
+
+import os
+import sys
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from cap_voltage import estimate_c_of_u
+
+N = 20000
+DT = 1e-7               # 2 ms: zwei Perioden bei 1 kHz
+U0 = 400.0
+C0 = 100e-6
+K = -1e-3               # C fällt um 10 % je 100 V
+ESR = 0.05
+
+
+def _c_true(u: np.ndarray, c0: float = C0) -> np.ndarray:
+    return c0 * (1 + K * (u - U0))
+
+
+def _capacitor(esr: float = ESR, c0: float = C0, amp: float = 50.0) -> tuple:
+    """Sinusstrom ±amp (mittelwertfrei) in ESR + C(U), Ladung analytisch: (t, u, i)."""
+    t = np.arange(N) * DT
+    w = 2 * np.pi * 1e3
+    i = amp * np.sin(w * t)
+    q = -amp / w * np.cos(w * t)                    # mittelwertfrei um U0
+    # q = C0·((U-U0) + K/2·(U-U0)²) nach U aufgelöst
+    uc = U0 + (np.sqrt(1 + 2 * K * q / c0) - 1) / K
+    return t, uc + esr * i, i
+
+
+def test_c_of_u():
+    """
+    Test: C und ESR je Spannungsbin stimmen mit dem synthetischen C(U) überein.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: C(U) aus bipolarem Puls ===")
+    try:
+        t, u, i = _capacitor()
+        cu = estimate_c_of_u(t, u, i, n_bins=8)
+        assert abs(cu["esr_total"] / ESR - 1) < 0.02, f"ESR gesamt {cu['esr_total']:.4g}"
+        assert np.all(cu["n"] >= 50) and cu["n"].sum() == N, f"Samples je Bin: {cu['n']}"
+        ref = _c_true(cu["u_c"])
+        err_c = np.max(np.abs(cu["cap"] / ref - 1))
+        err_r = np.max(np.abs(cu["esr"] / ESR - 1))
+        assert err_c < 0.01, f"C(U): {cu['cap']} statt {ref}"
+        assert err_r < 0.02, f"ESR(U): {cu['esr']}"
+        assert cu["cap"][0] > cu["cap"][-1], "C(U) fällt nicht mit der Spannung"
+        print(f"✓ {cu['u_lo'][0]:.0f}..{cu['u_hi'][-1]:.0f} V: C {cu['cap'][0]*1e6:.1f} -> "
+              f"{cu['cap'][-1]*1e6:.1f} µF (max. {err_c:.1e}), ESR max. {err_r:.1e}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_sparse_bins():
+    """
+    Test: leere Bins (fester Bereich über die Daten hinaus) und Bins mit weniger als
+    min_samples Samples sind NaN, die übrigen bleiben gültig.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: C(U) leere und dünne Bins ===")
+    try:
+        t, u, i = _capacitor()
+        uc = u - ESR * i
+        step = (uc.max() - uc.min()) / 8
+        cu = estimate_c_of_u(t, u, i, n_bins=12,
+                             u_range=(uc.min() - 2 * step, uc.max() + 2 * step))
+        empty = np.array([0, 11])
+        assert np.all(cu["n"][empty] == 0), f"Randbins nicht leer: {cu['n']}"
+        assert np.all(np.isnan(cu["cap"][empty])) and np.all(np.isnan(cu["esr"][empty]))
+        assert np.all(np.isfinite(cu["cap"][2:10])), f"C(U): {cu['cap']}"
+
+        inner = estimate_c_of_u(t, u, i, n_bins=8)
+        thin = int(np.argmin(inner["n"]))
+        cu = estimate_c_of_u(t, u, i, n_bins=8, min_samples=int(inner["n"][thin]) + 1)
+        few = cu["n"] < inner["n"][thin] + 1
+        assert few[thin] and np.all(np.isnan(cu["cap"][few])) and np.all(np.isnan(cu["esr"][few]))
+        assert np.allclose(cu["cap"][~few], inner["cap"][~few]), "gültige Bins verändert"
+        print(f"✓ leere Randbins und {few.sum()} Bin(s) unter min_samples = NaN")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_batch():
+    """
+    Test: Stapel (P, n) liefert dasselbe wie Einzelaufrufe je Puls.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: C(U) Stapel gegen Einzelpulse ===")
+    try:
+        pulses = [_capacitor(esr, c0, amp) for esr, c0, amp in
+                  ((0.05, 100e-6, 50.0), (0.08, 90e-6, 40.0), (0.03, 110e-6, 60.0))]
+        t = pulses[0][0]
+        u = np.stack([p[1] for p in pulses])
+        i = np.stack([p[2] for p in pulses])
+        u_range = (300.0, 500.0)
+        batch = estimate_c_of_u(t, u, i, n_bins=8, u_range=u_range)
+        assert batch["cap"].shape == (3, 8) and batch["esr_total"].shape == (3,)
+        for p, (_, up, ip) in enumerate(pulses):
+            one = estimate_c_of_u(t, up, ip, n_bins=8, u_range=u_range)
+            for key in ("cap", "esr"):
+                assert np.allclose(batch[key][p], one[key], rtol=1e-12, equal_nan=True), \
+                    f"Puls {p} {key}: {batch[key][p]} / {one[key]}"
+            assert np.array_equal(batch["n"][p], one["n"])
+            assert np.isclose(batch["esr_total"][p], one["esr_total"], rtol=1e-12)
+        print(f"✓ 3 Pulse im Stapel wie einzeln ({np.isnan(batch['cap']).sum()} leere Bins)")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_c_of_u())
+    results.append(test_sparse_bins())
+    results.append(test_batch())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,176 @@
+"""
+Test-Funktionen für die nichtlinearen Ersatzschaltbild-Fits (circuit_fit.py).
+
+Diese Tests prüfen an synthetischen Pulsspektren, dass jedes Modell seine
+Parameter wiederfindet, dass der Warmstart bei driftenden Pulsen weniger
+LM-Schritte braucht als der Kaltstart, dass ein Parametersprung den kalten
+Wiederholungsversuch auslöst und dass ein Stillstand des LM nur mit erfüllter
+Optimalitätsbedingung als konvergiert gilt.
+"""
+
+import os
+import sys
+
+import numpy as np
+
+# Pfad für Import hinzufügen (Pulsform aus der Steuer-Suite)
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, HERE)
+sys.path.insert(0, os.path.join(HERE, '..', 'mext_pulse_lab_control_suite'))
+
+from circuit_fit import (MODELS, CircuitFitter, _rows, benchmark, initial_guess,
+                         levenberg_marquardt, model_impedance)
+from spectral_cache import compute_spectrum
+from pico_pulse_lab.processing.synthetic import pulse_pair
+
+BAND = (2e3, 3e6)
+TRUTH = {"rlc": [0.02, 2e-8, 1e-4], "rlc_leak": [0.02, 2e-8, 1e-4, 30.0],
+         "randles": [0.02, 2e-8, 1e-4, 0.5, 20.0]}
+
+
+def synthetic_spectra(model, theta, n_pulses, drift=0.002, f_band=BAND, seed=0):
+    """
+    Spektren synthetischer Pulse (Pulspaar ±50 A durch das Modell, mit Rauschen).
+
+    Parameter wachsen je Puls um den Faktor (1 + drift).
+    """
+    n, dt = 4000, 50e-9
+    t = np.arange(n) * dt
+    i = pulse_pair(n, 400, 1000, amp=100)
+    om = 2 * np.pi * np.fft.rfftfreq(n, dt)
+    rng = np.random.default_rng(seed)
+    specs = []
+    for k in range(n_pulses):
+        Z = np.zeros(om.size, dtype=complex)
+        Z[1:] = model_impedance(model, om[1:], np.asarray(theta, float) * (1 + drift * k))[0]
+        u = np.fft.irfft(Z * np.fft.rfft(i), n) + rng.normal(0, 0.005, n)
+        specs.append(compute_spectrum(t, u, i + rng.normal(0, 0.05, n), fit_band=f_band))
+    return specs
+
+
+def test_models_recover():
+    """
+    Test: jedes Modell findet die Parameter des synthetischen Pulses wieder.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Modelle finden ihre Parameter ===")
+    try:
+        for model, theta in TRUTH.items():
+            fit = CircuitFitter(model, BAND).fit(synthetic_spectra(model, theta, 1)[0])
+            assert fit.converged and not fit.warm, f"{model}: {fit}"
+            for n, (name, ref) in enumerate(zip(MODELS[model], theta)):
+                tol = 0.01 if n < 3 else 0.05        # Zusatzelemente schwächer bestimmt
+                assert abs(fit.params[name] / ref - 1) < tol, \
+                    f"{model}.{name}: {fit.params[name]:.4g} statt {ref:.4g}"
+            print(f"  {model:9s} {fit.n_iter:3d} Schritte, Restfehler {fit.cost:.1e}")
+        print("✓ rlc, rlc_leak und randles innerhalb 1 % (Zusatzelemente 5 %)")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_warm_start():
+    """
+    Test: bei driftenden Pulsen braucht der Warmstart weniger Schritte, gleiches Ergebnis.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Warm- gegen Kaltstart ===")
+    try:
+        for model, theta in TRUTH.items():
+            bm = benchmark(synthetic_spectra(model, theta, 30), model, BAND)
+            cold, warm = bm["cold"], bm["warm"]
+            assert cold["not_converged"] == 0 and warm["not_converged"] == 0, f"{model}: {bm}"
+            assert warm["iter_mean"] < cold["iter_mean"], \
+                f"{model}: warm {warm['iter_mean']:.1f} >= kalt {cold['iter_mean']:.1f}"
+            assert bm["max_rel_diff"] < 1e-4, f"{model}: Abweichung {bm['max_rel_diff']:.1e}"
+            print(f"  {model:9s} kalt {cold['iter_mean']:5.1f}, warm {warm['iter_mean']:4.1f} Schritte "
+                  f"(x{bm['speedup']:.1f} schneller)")
+        print("✓ Warmstart spart Schritte bei allen Modellen")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_jump_and_stall():
+    """
+    Test: Sprung der Parameter -> Warmstart scheitert, kalter Versuch (warm=False) passt;
+    λ-Stillstand ohne erfüllte Optimalitätsbedingung -> nicht konvergiert.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Parametersprung und LM-Stillstand ===")
+    try:
+        theta = np.array(TRUTH["rlc"])
+        jumped = theta * [25.0, 1.0, 1.0]           # ESR springt (z.B. Kontakt)
+        fitter = CircuitFitter("rlc", BAND, max_iter=8)
+        drift = [fitter.fit(s) for s in synthetic_spectra("rlc", theta, 5, seed=2)]
+        assert all(r.converged for r in drift) and all(r.warm for r in drift[1:]), drift
+        fit = fitter.fit(synthetic_spectra("rlc", jumped, 1, seed=3)[0])
+        assert fit.converged and not fit.warm, f"kein kalter Wiederholungsversuch: {fit}"
+        assert fit.n_iter > fitter.max_iter, f"Warmversuch nicht mitgezählt: {fit.n_iter}"
+        assert abs(fit.params["esr"] / jumped[0] - 1) < 0.01, fit.params
+        assert fitter.fit(synthetic_spectra("rlc", jumped, 1, seed=4)[0]).warm, \
+            "kein Warmstart nach dem Sprung"
+
+        # Dieser Puls endet im λ-Stillstand: nur mit Gradientenprüfung konvergiert
+        om, U, I, sw = _rows(synthetic_spectra("rlc", theta, 1)[0], BAND)
+        theta0 = initial_guess("rlc", om, U, I, sw)
+        _, _, n_ok, ok = levenberg_marquardt("rlc", om, U, I, sw, theta0, tol=0.0,
+                                             max_iter=1000)
+        _, _, n_bad, bad = levenberg_marquardt("rlc", om, U, I, sw, theta0, tol=0.0, gtol=0.0,
+                                               max_iter=1000)
+        assert ok and n_ok < 1000, f"Stillstand im Minimum nicht konvergiert ({n_ok} Schritte)"
+        assert not bad and n_bad == n_ok, f"Stillstand ohne Prüfung konvergiert ({n_bad})"
+        print(f"✓ Sprung: {fit.n_iter} Schritte inkl. kaltem Versuch; "
+              f"Stillstand nach {n_ok} Schritten nur mit Gradientenprüfung konvergiert")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_models_recover())
+    results.append(test_warm_start())
+    results.append(test_jump_and_stall())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,208 @@
+"""
+Test-Funktionen für den Spektren-Cache von cap_params_2.py.
+
+Diese Tests prüfen das Schreiben in Blöcken und Wiederlesen der Spektren,
+dass geänderte Einstellungen (meta.json, I-Spalte, Fit-Band) einen neuen
+Cache ergeben, und dass ESR/C aus dem Fit-Band des gecachten Spektrums bei
+verrauschten Messdaten zum Fit über alle FFT-Punkte passen.
+"""
+
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from spectral_cache import SpectralCache, compute_spectrum, settings_key
+from cap_params_2 import estimate_band_params_spec, estimate_cap_params_spec
+
+N = 20001               # ungerade: kein Nyquist-Punkt
+DT = 1e-7
+BAND = (5e3, 5e5)
+ESR, C_F = 0.02, 50e-6
+SETTINGS = {"run": "TEST", "meta_mtime": 1700000000.0, "i_col": "i_A",
+            "fit_band": BAND, "per_decade": 20}
+
+
+def _capacitor(seed: int = 0, noise: float = 0.0) -> tuple:
+    """
+    Breitbandiger Strom durch ESR-C, Spannung exakt über das Spektrum: (t, u, i).
+    noise: Messrauschen auf U und I, relativ zu deren Effektivwert.
+    """
+    rng = np.random.default_rng(seed)
+    t = np.arange(N) * DT
+    i = rng.normal(0, 10, N)
+    w = 2 * np.pi * np.fft.rfftfreq(N, DT)
+    z = np.zeros(len(w), dtype=complex)
+    z[1:] = ESR + 1 / (1j * w[1:] * C_F)
+    u = np.fft.irfft(z * np.fft.rfft(i), N)
+    if noise:
+        u = u + rng.normal(0, noise * u.std(), N)
+        i = i + rng.normal(0, noise * i.std(), N)
+    return t, u, i
+
+
+def test_round_trip():
+    """
+    Test: Spektren in Blöcken schreiben, nur angehängt, beim Öffnen wieder da.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Spektren-Cache schreiben und lesen ===")
+    try:
+        specs = {pid: compute_spectrum(*_capacitor(seed=pid), fit_band=BAND)._replace(
+                     E_J=0.1 * pid, P_peak_W=100.0 * pid, P_avg_W=10.0 * pid)
+                 for pid in (1, 2, 3)}
+        with tempfile.TemporaryDirectory() as tmpdir:
+            prefix = os.path.join(tmpdir, "Cache", "TEST")
+            cache = SpectralCache(prefix, SETTINGS, shard_size=2)
+            cache.put(1, specs[1])
+            cache.put(2, specs[2])                  # voller Block -> erste Datei
+            shards = sorted(os.listdir(cache.path))
+            assert shards == ["shard-000000.npz"], f"Blockdateien: {shards}"
+            first = os.path.join(cache.path, shards[0])
+            stamp = os.stat(first).st_mtime_ns
+            cache.put(3, specs[3])
+            assert cache.get(3) is specs[3] and 3 in cache and len(cache) == 3
+            cache.save()
+            cache.save()                            # nichts Neues -> keine Datei
+            assert sorted(os.listdir(cache.path)) == ["shard-000000.npz", "shard-000001.npz"]
+            assert os.stat(first).st_mtime_ns == stamp, "erster Block neu geschrieben"
+
+            again = SpectralCache(prefix, SETTINGS, shard_size=2)
+            assert len(again) == 3 and again.get(4) is None, f"{len(again)} Pulse gelesen"
+            for pid, ref in specs.items():
+                got = again.get(pid)
+                assert np.array_equal(got.f, ref.f) and np.array_equal(got.w, ref.w)
+                assert np.array_equal(got.U, ref.U) and np.array_equal(got.I, ref.I)
+                assert got.t_mid == ref.t_mid
+                assert (got.E_J, got.P_peak_W, got.P_avg_W) == (ref.E_J, ref.P_peak_W, ref.P_avg_W)
+            n_full = (N - 1) // 2
+            print(f"✓ 3 Pulse in 2 Blöcken, {len(specs[1].f)} von {n_full} Frequenzpunkten je Puls")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_key_invalidation():
+    """
+    Test: neuer Lauf (meta.json), andere I-Spalte oder anderes Fit-Band -> eigener Cache;
+    ein Fit-Band ohne Grenze wird abgelehnt.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Spektren-Cache Schlüssel ===")
+    try:
+        spec = compute_spectrum(*_capacitor(), fit_band=BAND)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            prefix = os.path.join(tmpdir, "TEST")
+            cache = SpectralCache(prefix, SETTINGS)
+            cache.put(1, spec)
+            cache.save()
+            assert 1 in SpectralCache(prefix, dict(SETTINGS)), "gleiche Einstellungen, kein Treffer"
+            for name, value in (("meta_mtime", 1700000001.0), ("i_col", "i_V"),
+                                ("fit_band", (5e3, 1e6))):
+                other = SpectralCache(prefix, {**SETTINGS, name: value})
+                assert other.path != cache.path and len(other) == 0, f"{name} nicht im Schlüssel"
+            assert settings_key(SETTINGS) == settings_key(dict(reversed(SETTINGS.items())))
+            for band in ((None, None), (5e3, None), (5e5, 5e3)):
+                try:
+                    SpectralCache(prefix, {**SETTINGS, "fit_band": band})
+                    raise AssertionError(f"Fit-Band {band} nicht abgelehnt")
+                except ValueError:
+                    pass
+        print("✓ meta.json, I-Spalte und Fit-Band im Schlüssel, offenes Band abgelehnt")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_weighted_fit():
+    """
+    Test: verrauschter Puls, ESR/C aus dem Fit-Band des gecachten Spektrums passen zum
+    Fit über alle FFT-Punkte; Bänder im Fit-Band sind identisch.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: gewichteter Fit auf ausgedünntem Spektrum ===")
+    try:
+        t, u, i = _capacitor(noise=0.02)
+        full = compute_spectrum(t, u, i)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            cache = SpectralCache(os.path.join(tmpdir, "TEST"), SETTINGS)
+            cache.put(1, compute_spectrum(t, u, i, fit_band=BAND))
+            cache.save()
+            thin = SpectralCache(os.path.join(tmpdir, "TEST"), SETTINGS).get(1)
+        assert len(thin.f) < len(full.f) // 5, f"nicht ausgedünnt: {len(thin.f)}"
+        assert thin.w.sum() == full.w.sum(), "Gewichte decken nicht alle FFT-Punkte ab"
+
+        # Fit-Band: im Cache jeder FFT-Punkt, also derselbe Fit wie auf dem vollen Spektrum;
+        # gegen den Fit über alle Punkte bleibt nur der Einfluss des Rauschens außerhalb
+        esr_t, c_t = estimate_cap_params_spec(thin, f_band=BAND)
+        esr_b, c_b = estimate_cap_params_spec(full, f_band=BAND)
+        esr_f, c_f = estimate_cap_params_spec(full)
+        for name, a, b, ref, val in (("ESR", esr_t, esr_b, esr_f, ESR), ("C", c_t, c_b, c_f, C_F)):
+            assert abs(a / b - 1) < 1e-5, f"{name}: Cache {a:.6g}, volles Spektrum {b:.6g}"
+            assert abs(a / ref - 1) < 0.01, f"{name}: Fit-Band {a:.6g}, alle Punkte {ref:.6g}"
+            assert abs(a / val - 1) < 0.01, f"{name}: {a:.6g} statt {val:.6g}"
+
+        # Bänder im Fit-Band: dieselben FFT-Punkte, also dieselben Werte
+        b_f = estimate_band_params_spec(full, n_bands=4, f_min=BAND[0], f_max=BAND[1])
+        b_t = estimate_band_params_spec(thin, n_bands=4, f_min=BAND[0], f_max=BAND[1])
+        assert np.array_equal(b_f["n_bins"], b_t["n_bins"]), f"{b_f['n_bins']} / {b_t['n_bins']}"
+        assert np.allclose(b_t["esr"], b_f["esr"], rtol=1e-6) and \
+            np.allclose(b_t["cap"], b_f["cap"], rtol=1e-6), "Bänder weichen ab"
+        print(f"✓ {len(thin.f)} statt {len(full.f)} Punkte: ESR {esr_t*1e3:.3f} mΩ "
+              f"(alle Punkte {esr_f*1e3:.3f}), C {c_t*1e6:.3f} µF (alle Punkte {c_f*1e6:.3f})")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_round_trip())
+    results.append(test_key_invalidation())
+    results.append(test_weighted_fit())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
@@ -42,6 +42,7 @@ from pico_pulse_lab.storage.csv_writer import (
     append_pulse_to_csv,
     write_meta,
 )
+from pico_pulse_lab.processing.sensor_filter import build_filters, filters_meta
 
 
 # ============================================================
@@ -90,6 +91,10 @@ ROGOWSKI_V_PER_A    = 0.02          # V/A -- wenn None oder 0 -> CSV in Volt
 # 1A = 0.02 V => i_real = 1/rogowski_v_per_a * u_measured
 
 
+# PS3000A_TIME_UNITS (FS, PS, NS, US, MS, S) in Sekunden
+TIME_UNIT_S = (1e-15, 1e-12, 1e-9, 1e-6, 1e-3, 1.0)
+
+
 # Basisordner & Run-Verzeichnis
 BASE_DIR   = r"C:\Users\mext\Documents\02 Python Schnittstelle STM32 serielle Steuerung\mext_cap_testbench_control_code\picoscope"
 RUN_DIR    = os.path.join(BASE_DIR, "Runs", RUN_NAME) 
@@ -234,6 +239,49 @@ def pick_timebase(handle, target_fs: float, n_samples: int):
     return tb, dt, fs
 
 
+def locate_roi(env_max: np.ndarray, env_min: np.ndarray, ratio: int, n_samples: int,
+               pre_samples: int, margin_samples: int, threshold: float = 0.1,
+               min_counts: int = 256):
+    """
+    Bestimmt den Pulsbereich aus einer Min/Max-Grobansicht (ROI-Modus).
+
+    Parameters
+    ----------
+    env_max, env_min : np.ndarray
+        Maximum und Minimum je ``ratio`` Samples (Aggregat-Modus des Treibers), ADC-Werte
+    ratio : int
+        Samples je Grobwert
+    n_samples : int
+        Länge des Erfassungsfensters
+    pre_samples : int
+        Trigger-Position; sie liegt immer im Bereich
+    margin_samples : int
+        Rand vor und nach dem aktiven Bereich (Ein-/Ausschwingen)
+    threshold : float, optional
+        Aktiv = Abweichung von der Grundlinie über diesem Anteil der Spitze, by default 0.1
+    min_counts : int, optional
+        Kleinere Spitzen gelten als Rauschen -> ganzes Fenster, by default 256
+
+    Returns
+    -------
+    tuple
+        (start, length) in Samples des Erfassungsfensters.
+    """
+    env_max = np.asarray(env_max, dtype=np.int32)
+    env_min = np.asarray(env_min, dtype=np.int32)
+    base = np.median(env_max + env_min) / 2     # Grundlinie (AC-Kopplung: ~0)
+    amp = np.maximum(env_max - base, base - env_min)
+    peak = amp.max() if len(amp) else 0
+    if peak < min_counts:
+        return 0, n_samples
+    active = np.flatnonzero(amp >= threshold * peak)
+    first = min(int(active[0]) * ratio, pre_samples)
+    last = max(min((int(active[-1]) + 1) * ratio, n_samples), pre_samples)
+    start = max(0, first - margin_samples)
+    end = min(n_samples, last + margin_samples)
+    return start, end - start
+
+
 # ============================================================
 # 3) HAUPTFUNKTION
 # ============================================================
@@ -504,6 +552,12 @@ class PicoReader:
     - Start/Stop aus GUI
     - Callbacks pro Puls für Live-Plots
     - Thread-sichere Datenübergabe an GUI
+    - Geräte-Session über mehrere Messläufe: das Gerät bleibt nach einer
+      Messung offen, beim nächsten Start werden nur geänderte Einstellungen
+      (Kanäle, Timebase, Trigger, Puffer) gesendet. Eine USB-Trennung wird
+      über ``ps3000aPingUnit`` erkannt und die Session neu aufgebaut.
+    - ROI-Modus: statt des ganzen Fensters wird nur der Bereich um den Puls
+      über USB geholt und gespeichert (siehe `configure(roi=True)`).
     
     Examples
     --------
@@ -511,8 +565,8 @@ class PicoReader:
     >>> reader.configure(run_name="test_01", target_fs=20e6, ...)
     >>> reader.set_callback(lambda pulse_id, t, u, i: print(f"Pulse {pulse_id}"))
     >>> reader.start_measurement(n_pulses=5)
-    >>> # Warten bis fertig...
-    >>> reader.stop()
+    >>> reader.configure(run_name="test_02", range_b="5V")
+    >>> reader.start_measurement(n_pulses=5)     # ohne OpenUnit, nur Kanal B neu
     >>> reader.close()
     """
     
@@ -543,6 +597,19 @@ class PicoReader:
         self.base_samples = 400_000
         self.n_samples = None  # Wird aus base_samples + pretrig berechnet
         self.oversample = 1
+        self.window = None             # (fs, pre, post) aus set_window(), sonst None
+        self._pending_window = None    # wartet auf den nächsten Block
+        
+        # ROI-Modus: nur den Pulsbereich übertragen
+        self.roi = False
+        self.roi_margin_s = 50e-6      # Rand um den aktiven Bereich
+        self.roi_decimation = 256      # Samples je Wert der Grobansicht
+        self.roi_last = None           # (start, length) des letzten Pulses
+        self._agg_bufs = None          # Min/Max-Puffer der Grobansicht
+        
+        # Frequenzgang-Korrektur der Sensoren (Overlap-Save-FIR je Kanal)
+        self.filters = None            # Konfiguration, siehe configure()
+        self._filters = {}             # Kanal -> OverlapSave, beim Start entworfen
         
         # Kanal A (Spannung)
         if PICO_SDK_AVAILABLE:
@@ -577,13 +644,23 @@ class PicoReader:
         self.is_configured = False
         self.pulse_id = 1
         self.pulse_count = 0
+        self._run_first_pulse_id = 1  # erste pulse_id des laufenden Messlaufs
         
         # Callbacks
         self.on_pulse_callback = None  # Callback: (pulse_id, t, u, i) -> None
+        self.on_armed_callback = None  # Callback: (pulse_id, n_captures) -> None
+        
+        # Puls-Ring im Shared Memory für Leser in anderen Prozessen (optional)
+        self.ring = None
         
         # Datenpuffer (werden beim Konfigurieren erstellt)
         self.buf_a = None
         self.buf_b = None
+        self._seg_bufs = []      # (buf_a, buf_b) je Speichersegment (Rapid-Block)
+        self._n_segments = 0
+        self.pre_samples = 0
+        self.trigger_offset_s = 0.0   # Trigger-Versatz des zuletzt gemeldeten Pulses
+        self._trig_offsets = []       # Trigger-Versatz je Segment des letzten Blocks
         
         # Timebase und Sampling
         self.timebase = None
@@ -594,6 +671,14 @@ class PicoReader:
         # Meta-Daten für Speicherung
         self.meta = {}
         
+        # Geräte-Session (bleibt zwischen Messläufen offen, siehe open())
+        self._applied = {}          # zuletzt ans Gerät gesendete Einstellungen
+        self.last_applied = []      # beim letzten Start gesendete Einstellungen
+        self.reconnects = 0         # wiederhergestellte USB-Trennungen
+        self.recover_timeout_s = 30.0
+        self.first_arm_s = None     # Start -> erster scharfer Block
+        self._t_start = 0.0
+        
     def configure(
         self,
         run_name: str,
@@ -608,7 +693,11 @@ class PicoReader:
         rogowski_v_per_a: float = None,
         pretrig_ratio: float = None,
         base_samples: int = None,
-        oversample: int = None
+        oversample: int = None,
+        roi: bool = None,
+        roi_margin_s: float = None,
+        roi_decimation: int = None,
+        filters: dict = None
     ) -> None:
         """
         Konfiguriert den PicoReader für Messungen.
@@ -647,6 +736,19 @@ class PicoReader:
             Anzahl Samples nach Trigger (Standard: 400000).
         oversample : int, optional
             Oversampling-Faktor (1=kein, 2=mittel über 2 Samples, Standard: 1).
+        roi : bool, optional
+            ROI-Modus: erst eine Min/Max-Grobansicht von Kanal B holen, daraus den
+            Pulsbereich bestimmen und nur diesen übertragen (Standard: False).
+            Zeitvektor und Speicherung enthalten dann nur diesen Bereich, der
+            Versatz steht in den Metadaten.
+        roi_margin_s : float, optional
+            Rand vor/nach dem aktiven Bereich in Sekunden (Standard: 50e-6).
+        roi_decimation : int, optional
+            Samples je Wert der Grobansicht (Standard: 256).
+        filters : dict, optional
+            Frequenzgang-Korrektur je Kanal, z.B. ``{"i": {"response": "rogowski.csv",
+            "lowpass_hz": 5e6}}`` (siehe ``processing/sensor_filter.py``); ``{}``
+            schaltet sie ab (Standard: keine). Puls-Ring bleibt unkorrigiert.
         
         Returns
         -------
@@ -655,7 +757,7 @@ class PicoReader:
         Notes
         -----
         - Die Konfiguration wird nicht an das Gerät gesendet, bis `start_measurement()`
-          aufgerufen wird.
+          aufgerufen wird; bei offener Session nur die geänderten Einstellungen.
         - Verzeichnis für Speicherung wird erstellt falls nötig.
         """
         # Run-Name und Verzeichnis
@@ -685,8 +787,11 @@ class PicoReader:
         if oversample is not None:
             self.oversample = oversample
         
-        # Gesamtanzahl Samples berechnen
-        self.n_samples = self.base_samples + int(self.pretrig_ratio * self.base_samples)
+        # Gesamtanzahl Samples berechnen; explizite Abtastung ersetzt ein Fenster aus set_window()
+        if target_fs is not None or pretrig_ratio is not None or base_samples is not None:
+            self.window = self._pending_window = None
+        if self.window is None:
+            self.n_samples = self.base_samples + int(self.pretrig_ratio * self.base_samples)
         
         # Kanal A
         if coupling_a is not None:
@@ -727,6 +832,18 @@ class PicoReader:
         if rogowski_v_per_a is not None:
             self.rogowski_v_per_a = rogowski_v_per_a
         
+        # ROI-Modus
+        if roi is not None:
+            self.roi = bool(roi)
+        if roi_margin_s is not None:
+            self.roi_margin_s = roi_margin_s
+        if roi_decimation is not None:
+            self.roi_decimation = max(1, int(roi_decimation))
+        
+        # Sensor-Korrektur
+        if filters is not None:
+            self.filters = filters or None
+        
         # Als konfiguriert markieren
         self.is_configured = True
         
@@ -786,6 +903,125 @@ class PicoReader:
             else:
                 raise RuntimeError(f"Fehler beim Öffnen des Picoscope-Geräts: Status {status}")
     
+    def open(self) -> bool:
+        """
+        Öffnet das Gerät, falls keine erreichbare Session besteht.
+        
+        `start_measurement()` ruft das selbst auf; vorab aufgerufen (z.B. beim
+        Start der GUI) entfällt das Öffnen samt Firmware-Laden beim ersten Lauf.
+        
+        Returns
+        -------
+        bool
+            True wenn das Gerät neu geöffnet wurde, False wenn die Session weiterläuft.
+        """
+        if self.handle is not None:
+            if self._ping():
+                return False
+            print("[Pico] Gerät antwortet nicht mehr - öffne neu")
+            self.close()
+        
+        self._open_device()
+        self.max_adc = ct.c_int16()
+        assert_pico_ok(ps.ps3000aMaximumValue(self.handle, ct.byref(self.max_adc)))
+        # Frisch geöffnet: Gerät hat Default-Einstellungen und ein Speichersegment
+        self._applied = {}
+        self._n_segments = 0
+        return True
+    
+    def _ping(self) -> bool:
+        """
+        Prüft, ob das geöffnete Gerät noch über USB antwortet (interne Funktion).
+        """
+        try:
+            return ps.ps3000aPingUnit(self.handle) == 0
+        except Exception:
+            return False
+    
+    def _apply_config(self) -> list:
+        """
+        Sendet nur die Einstellungen, die sich seit dem letzten Lauf geändert haben (interne Funktion).
+        
+        Returns
+        -------
+        list
+            Namen der gesendeten Einstellungen ("ch_a", "ch_b", "timebase", "trigger", "buffers").
+        """
+        want = {
+            "ch_a": (self.coupling_a, self.range_a, self.dc_offset_a),
+            "ch_b": (self.coupling_b, self.range_b, self.dc_offset_b),
+            "timebase": (self.target_fs, self.n_samples),
+            "trigger": (self.range_a, self.trigger_level_v, self.auto_trig_ms),
+            "buffers": self.n_samples,
+        }
+        changed = [k for k, v in want.items() if self._applied.get(k) != v]
+        
+        for key in changed:
+            if key == "ch_a":
+                self._set_channel(self.ch_a, *want["ch_a"])
+            elif key == "ch_b":
+                self._set_channel(self.ch_b, *want["ch_b"])
+            elif key == "timebase":
+                self.timebase, self.dt, self.fs = pick_timebase(
+                    self.handle, self.target_fs, self.n_samples
+                )
+            elif key == "trigger":
+                self._setup_trigger()
+            elif key == "buffers":
+                n_seg_before = self._n_segments
+                self._setup_data_buffers()
+                if n_seg_before > 1:
+                    # Gerät ist noch in Segmente geteilt -> beim nächsten Block neu einteilen
+                    self._n_segments = 0
+            self._applied[key] = want[key]
+        
+        self.last_applied = changed
+        return changed
+    
+    def _recover(self) -> None:
+        """
+        Baut die Session nach einer USB-Trennung neu auf (interne Funktion).
+        
+        Versucht bis ``recover_timeout_s`` mit wachsender Pause das Gerät neu zu
+        öffnen und die komplette Konfiguration zu senden.
+        
+        Raises
+        ------
+        RuntimeError
+            Wenn das Gerät in dieser Zeit nicht wieder erreichbar ist oder die
+            Messung inzwischen gestoppt wurde.
+        """
+        self.close()
+        deadline = time.monotonic() + self.recover_timeout_s
+        delay = 0.2
+        while True:
+            try:
+                self.open()
+                self._apply_config()
+                self.reconnects += 1
+                print(f"[Pico] Verbindung wiederhergestellt ({self.reconnects}. Mal)")
+                return
+            except Exception as e:
+                self.close()
+                if not self.is_running or time.monotonic() + delay > deadline:
+                    raise RuntimeError(f"Picoscope nach USB-Trennung nicht wieder erreichbar: {e}") from e
+                print(f"[Pico] Gerät nicht erreichbar, neuer Versuch in {delay:.1f} s")
+                time.sleep(delay)
+                delay = min(2 * delay, 2.0)
+    
+    def _set_channel(self, channel, coupling, v_range, dc_offset):
+        """
+        Konfiguriert einen Kanal (interne Funktion).
+        """
+        assert_pico_ok(ps.ps3000aSetChannel(
+            self.handle,
+            channel,
+            1,  # enabled
+            coupling,
+            v_range,
+            dc_offset
+        ))
+    
     def _setup_channels(self):
         """
         Konfiguriert die Kanäle (interne Funktion).
@@ -796,24 +1032,10 @@ class PicoReader:
             return
         
         # Kanal A: Spannung
-        assert_pico_ok(ps.ps3000aSetChannel(
-            self.handle,
-            self.ch_a,
-            1,  # enabled
-            self.coupling_a,
-            self.range_a,
-            self.dc_offset_a
-        ))
+        self._set_channel(self.ch_a, self.coupling_a, self.range_a, self.dc_offset_a)
         
         # Kanal B: Strom/Rogowski
-        assert_pico_ok(ps.ps3000aSetChannel(
-            self.handle,
-            self.ch_b,
-            1,  # enabled
-            self.coupling_b,
-            self.range_b,
-            self.dc_offset_b
-        ))
+        self._set_channel(self.ch_b, self.coupling_b, self.range_b, self.dc_offset_b)
     
     def _setup_trigger(self):
         """
@@ -874,20 +1096,396 @@ class PicoReader:
             0,
             ps.PS3000A_RATIO_MODE["PS3000A_RATIO_MODE_NONE"]
         ))
+        self._n_segments = 1
+        self._seg_bufs = [(self.buf_a, self.buf_b)]
+    
+    def attach_ring(self, ring) -> None:
+        """
+        Schreibt jeden erfassten Puls zusätzlich als ADC-Rohwerte in einen Puls-Ring.
+        
+        GUI, Speicherung und Auswertung können dann in eigenen Prozessen lesen,
+        ohne die Erfassung über den GIL aufzuhalten (siehe ``pulse_ring.py``).
+        
+        Parameters
+        ----------
+        ring : PulseRing or None
+            Ring mit Slots für mindestens ``n_samples`` Samples; None entfernt ihn.
+        """
+        if ring is not None and self.n_samples and ring.slot_samples < self.n_samples:
+            raise ValueError(f"Ring-Slots zu klein: {ring.slot_samples} < {self.n_samples} Samples")
+        self.ring = ring
+    
+    def set_window(self, target_fs: float, pre_samples: int, post_samples: int) -> None:
+        """
+        Setzt Abtastrate und Erfassungsfenster (Samples vor/nach dem Trigger).
+        
+        Ersetzt ``base_samples``/``pretrig_ratio`` aus `configure()`, bis dort
+        wieder Abtastwerte angegeben werden. Während einer Messung gilt das
+        Fenster ab dem nächsten Block (siehe ``control/capture_window.py``).
+        """
+        self._pending_window = (float(target_fs), int(pre_samples), int(post_samples))
+        if not self.is_running:
+            self._take_window()
+    
+    def _take_window(self) -> bool:
+        """
+        Übernimmt ein mit `set_window()` gesetztes Fenster (interne Funktion).
+        
+        Returns
+        -------
+        bool
+            True, wenn sich das Fenster geändert hat.
+        """
+        win, self._pending_window = self._pending_window, None
+        if win is None or win == self.window:
+            return False
+        fs, pre, post = win
+        if self.ring is not None and self.ring.slot_samples < pre + post:
+            raise ValueError(f"Ring-Slots zu klein: {self.ring.slot_samples} < {pre + post} Samples")
+        self.window = win
+        self.target_fs = fs
+        self.n_samples = pre + post
+        return True
+    
+    def _split_window(self) -> tuple:
+        """(pre_samples, post_samples) des aktuellen Fensters (interne Funktion)."""
+        if self.window is not None:
+            return self.window[1], self.window[2]
+        pre_samples = int(self.pretrig_ratio * self.n_samples)
+        return pre_samples, self.n_samples - pre_samples
+    
+    def _rewrite_window_meta(self, save_csv: bool, save_npz: bool) -> None:
+        """
+        Fensterwechsel im Lauf: Meta auf das neue Fenster setzen und neu schreiben
+        (interne Funktion).
+        
+        ``fs``, ``dt_s``, Pre-/Post-Samples und ``filters`` beschreiben danach
+        die ab jetzt gespeicherten Pulse; ``windows`` listet alle Fenster des
+        Laufs mit der ersten pulse_id, ab der sie gelten.
+        """
+        keys = ('fs', 'dt_s', 'pretrigger_samples', 'posttrigger_samples')
+        windows = self.meta.setdefault(
+            'windows', [{'first_pulse_id': self._run_first_pulse_id,
+                         **{k: self.meta[k] for k in keys}}])
+        pre_samples, post_samples = self._split_window()
+        self.meta.update(fs=self.fs, dt_s=self.dt, pretrigger_samples=pre_samples,
+                         posttrigger_samples=post_samples,
+                         filters=filters_meta(self._filters))
+        windows.append({'first_pulse_id': self.pulse_id, **{k: self.meta[k] for k in keys}})
+        if save_csv:
+            write_meta(self.meta_path, self.meta)
+        if save_npz:
+            from pico_pulse_lab.storage.npz_writer import update_meta_npz
+            update_meta_npz(self.npz_path, self.meta)
+    
+    def set_armed_callback(self, callback):
+        """
+        Setzt einen Callback, der aufgerufen wird, sobald das Scope scharf ist.
+        
+        Damit kann eine externe Pulsquelle (STM32) genau dann auslösen, wenn
+        die Erfassung wartet. Eine Exception im Callback bricht die Messung ab.
+        
+        Parameters
+        ----------
+        callback : callable, optional
+            Funktion mit Signatur: (pulse_id, n_captures) -> None
+            - pulse_id: int - ID des ersten Pulses in diesem Block
+            - n_captures: int - Anzahl Segmente (Pulse), die der Block erwartet
+            Falls None: Callback wird entfernt.
+        """
+        self.on_armed_callback = callback
+    
+    def _prepare_segments(self, n_seg: int):
+        """
+        Stellt Speichersegmente und Datenpuffer für n_seg Erfassungen ein (interne Funktion).
+        """
+        if n_seg == self._n_segments:
+            return
+        max_samples = ct.c_int32()
+        assert_pico_ok(ps.ps3000aMemorySegments(self.handle, n_seg, ct.byref(max_samples)))
+        if max_samples.value < self.n_samples:
+            raise RuntimeError(f"Rapid-Block: {n_seg} Segmente à {self.n_samples} Samples "
+                               f"passen nicht in den Gerätespeicher (max {max_samples.value})")
+        assert_pico_ok(ps.ps3000aSetNoOfCaptures(self.handle, n_seg))
+        
+        self._seg_bufs = []
+        for seg in range(n_seg):
+            if seg == 0:
+                buf_a, buf_b = self.buf_a, self.buf_b
+            else:
+                buf_a = (ct.c_int16 * self.n_samples)()
+                buf_b = (ct.c_int16 * self.n_samples)()
+            for ch, buf in ((self.ch_a, buf_a), (self.ch_b, buf_b)):
+                assert_pico_ok(ps.ps3000aSetDataBuffer(
+                    self.handle, ch, ct.byref(buf), self.n_samples, seg,
+                    ps.PS3000A_RATIO_MODE["PS3000A_RATIO_MODE_NONE"]
+                ))
+            self._seg_bufs.append((buf_a, buf_b))
+        self._n_segments = n_seg
+    
+    def _capture_block(self, n_seg: int, pre_samples: int, post_samples: int,
+                       capture_timeout_s: float = None) -> list:
+        """
+        Armt das Scope für n_seg Erfassungen und liefert die Rohdaten (interne Funktion).
+        
+        Returns
+        -------
+        list
+            Liste von (adc_a, adc_b, start) je Segment, leer bei Abbruch über `stop()`.
+            adc_a/adc_b sind int16-Sichten auf die Treiberpuffer, start ist die
+            Position des ersten Samples im Erfassungsfenster (ROI-Modus, sonst 0).
+        
+        Raises
+        ------
+        TimeoutError
+            Wenn innerhalb von capture_timeout_s kein Block fertig wird.
+        """
+        self._prepare_segments(n_seg)
+        
+        # Block-Messung starten
+        time_indisposed_ms = ct.c_int32(0)
+        assert_pico_ok(
+            ps.ps3000aRunBlock(
+                self.handle,
+                pre_samples,
+                post_samples,
+                self.timebase,
+                int(self.oversample),
+                ct.byref(time_indisposed_ms),
+                0,
+                None,
+                None
+            )
+        )
+        
+        if self.first_arm_s is None:
+            self.first_arm_s = time.monotonic() - self._t_start
+        
+        # Scope ist scharf -> Pulsquelle darf auslösen
+        if self.on_armed_callback:
+            self.on_armed_callback(self.pulse_id, n_seg)
+        
+        # Warten bis fertig
+        deadline = None if capture_timeout_s is None else time.monotonic() + capture_timeout_s
+        ready = ct.c_int16(0)
+        while not ready.value:
+            assert_pico_ok(ps.ps3000aIsReady(self.handle, ct.byref(ready)))
+            if ready.value:
+                break
+            if not self.is_running:
+                ps.ps3000aStop(self.handle)
+                return []
+            if deadline is not None and time.monotonic() > deadline:
+                ps.ps3000aStop(self.handle)
+                raise TimeoutError(f"Kein Trigger innerhalb von {capture_timeout_s} s")
+            time.sleep(0.001)
+        
+        self._trig_offsets = self._read_trigger_offsets(n_seg)
+        
+        # Werte holen
+        if self.roi:
+            return [self._get_roi(seg) for seg in range(n_seg)]
+        
+        if n_seg == 1:
+            n = ct.c_int32(self.n_samples)
+            overflow = ct.c_int16()
+            assert_pico_ok(
+                ps.ps3000aGetValues(
+                    self.handle,
+                    0,
+                    ct.byref(n),
+                    1,
+                    ps.PS3000A_RATIO_MODE["PS3000A_RATIO_MODE_NONE"],
+                    0,
+                    ct.byref(overflow)
+                )
+            )
+        else:
+            n = ct.c_uint32(self.n_samples)
+            overflow = (ct.c_int16 * n_seg)()
+            assert_pico_ok(
+                ps.ps3000aGetValuesBulk(
+                    self.handle,
+                    ct.byref(n),
+                    0,
+                    n_seg - 1,
+                    1,
+                    ps.PS3000A_RATIO_MODE["PS3000A_RATIO_MODE_NONE"],
+                    ct.byref(overflow)
+                )
+            )
+        
+        # Sichten auf die Treiberpuffer (int16), gültig bis zum nächsten Block
+        return [
+            (np.frombuffer(buf_a, dtype=np.int16, count=n.value),
+             np.frombuffer(buf_b, dtype=np.int16, count=n.value), 0)
+            for buf_a, buf_b in self._seg_bufs[:n_seg]
+        ]
+    
+    def _read_trigger_offsets(self, n_seg: int) -> list:
+        """
+        Trigger-Versatz je Segment in s (interne Funktion).
+        
+        Der Trigger liegt zwischen zwei Abtastpunkten; der Treiber meldet, wie
+        weit nach dem nominalen Triggersample. Grundlage für die Ausrichtung
+        beim kohärenten Mitteln (``processing/averaging.py``). Ohne echten
+        Trigger (Auto-Trigger) liefert der Treiber einen Fehler -> 0.
+        """
+        offsets = []
+        t_off = ct.c_int64()
+        units = ct.c_int32()
+        for seg in range(n_seg):
+            status = ps.ps3000aGetTriggerTimeOffset64(self.handle, ct.byref(t_off),
+                                                      ct.byref(units), seg)
+            ok = status == 0 and 0 <= units.value < len(TIME_UNIT_S)
+            offsets.append(t_off.value * TIME_UNIT_S[units.value] if ok else 0.0)
+        return offsets
+    
+    def _get_roi(self, seg: int) -> tuple:
+        """
+        Holt nur den Bereich um den Puls aus Segment seg (interne Funktion).
+        
+        1. Grobansicht: Min/Max von Kanal B (Strom) je ``roi_decimation`` Samples
+        2. Pulsbereich daraus bestimmen (`locate_roi`)
+        3. Nur diesen Bereich in voller Auflösung übertragen
+        
+        Returns
+        -------
+        tuple
+            (adc_a, adc_b, start) wie in `_capture_block()`.
+        """
+        ratio = self.roi_decimation
+        n_coarse = -(-self.n_samples // ratio)
+        if self._agg_bufs is None or len(self._agg_bufs[0]) != n_coarse:
+            self._agg_bufs = ((ct.c_int16 * n_coarse)(), (ct.c_int16 * n_coarse)())
+        agg_max, agg_min = self._agg_bufs
+        mode_agg = ps.PS3000A_RATIO_MODE["PS3000A_RATIO_MODE_AGGREGATE"]
+        mode_raw = ps.PS3000A_RATIO_MODE["PS3000A_RATIO_MODE_NONE"]
+        overflow = ct.c_int16()
+        
+        # 1) Grobansicht
+        assert_pico_ok(ps.ps3000aSetDataBuffers(
+            self.handle, self.ch_b, ct.byref(agg_max), ct.byref(agg_min), n_coarse, seg, mode_agg
+        ))
+        n = ct.c_uint32(self.n_samples)
+        assert_pico_ok(ps.ps3000aGetValues(
+            self.handle, 0, ct.byref(n), ratio, mode_agg, seg, ct.byref(overflow)
+        ))
+        
+        # 2) Pulsbereich
+        start, length = locate_roi(
+            np.frombuffer(agg_max, dtype=np.int16, count=n.value),
+            np.frombuffer(agg_min, dtype=np.int16, count=n.value),
+            ratio, self.n_samples, self.pre_samples, int(self.roi_margin_s / self.dt)
+        )
+        
+        # 3) Rohpuffer wieder zuordnen und nur den Bereich holen (landet am Pufferanfang)
+        buf_a, buf_b = self._seg_bufs[seg]
+        for ch, buf in ((self.ch_a, buf_a), (self.ch_b, buf_b)):
+            assert_pico_ok(ps.ps3000aSetDataBuffer(
+                self.handle, ch, ct.byref(buf), self.n_samples, seg, mode_raw
+            ))
+        n = ct.c_uint32(length)
+        assert_pico_ok(ps.ps3000aGetValues(
+            self.handle, start, ct.byref(n), 1, mode_raw, seg, ct.byref(overflow)
+        ))
+        self.roi_last = (start, n.value)
+        return (np.frombuffer(buf_a, dtype=np.int16, count=n.value),
+                np.frombuffer(buf_b, dtype=np.int16, count=n.value), start)
     
+    def _adc_scales(self) -> tuple:
+        """
+        Umrechnungsfaktoren ADC-Wert -> Spannung (DUT) bzw. Strom (interne Funktion).
+        """
+        vfs_a = range_fullscale_volts(self.range_a)
+        vfs_b = range_fullscale_volts(self.range_b)
+        
+        # Spannung: ADC -> Volt -> DUT (mit Tastkopf-Dämpfung)
+        scale_u = vfs_a / self.max_adc.value * self.u_probe_attenuation
+        
+        # Strom: ADC -> Volt -> Ampere (mit Rogowski-Kalibrierung)
+        scale_i = vfs_b / self.max_adc.value
+        if self.rogowski_v_per_a and self.rogowski_v_per_a > 0:
+            scale_i /= self.rogowski_v_per_a
+        return scale_u, scale_i
+    
+    def _adc_to_physical(self, adc_a: np.ndarray, adc_b: np.ndarray) -> tuple:
+        """
+        Rechnet ADC-Werte in Spannung (DUT) und Strom um (interne Funktion).
+        """
+        scale_u, scale_i = self._adc_scales()
+        return self._apply_filters(adc_a * scale_u, adc_b * scale_i)
+    
+    def _prepare_filters(self) -> None:
+        """
+        Entwirft die Korrekturfilter für die aktuelle Abtastrate (interne Funktion).
+        
+        Entwürfe sind zwischengespeichert, ein Neustart mit gleicher Rate kostet nichts.
+        """
+        self._filters = build_filters(self.filters, self.fs)
+    
+    def _apply_filters(self, u: np.ndarray, i: np.ndarray) -> tuple:
+        """
+        Frequenzgang-Korrektur von Spannung und Strom, falls konfiguriert (interne Funktion).
+        """
+        if "u" in self._filters:
+            u = self._filters["u"].filter(u)
+        if "i" in self._filters:
+            i = self._filters["i"].filter(i)
+        return u, i
+    
+    def _publish_raw(self, adc_a: np.ndarray, adc_b: np.ndarray, scales: tuple,
+                     start: int = 0) -> None:
+        """
+        Legt die Rohwerte eines Pulses im Puls-Ring ab, falls einer angehängt ist (interne Funktion).
+        """
+        if self.ring is None:
+            return
+        self.ring.publish(self.pulse_id, adc_a, adc_b, dt=self.dt, scale_u=scales[0],
+                          scale_i=scales[1], pre_samples=self.pre_samples - start,
+                          t_trig=self.trigger_offset_s)
+    
+    def _emit_pulse(self, t, u, i, i_unit: str, save_csv: bool, save_npz: bool,
+                    roi: tuple = None):
+        """
+        Callback, Speicherung und Zähler für einen erfassten Puls (interne Funktion).
+        """
+        # Callback aufrufen (für Live-Updates)
+        if self.on_pulse_callback:
+            try:
+                self.on_pulse_callback(self.pulse_id, t, u, i)
+            except Exception as e:
+                print(f"[Warnung] Callback-Fehler: {e}")
+        
+        # Speicherung
+        if save_csv:
+            append_pulse_to_csv(self.csv_path, t, u, i, i_unit, self.pulse_id)
+        
+        if save_npz:
+            from pico_pulse_lab.storage.npz_writer import append_pulse_npz
+            append_pulse_npz(self.npz_path, self.pulse_id, t, u, i, roi=roi)
+        
+        # Zähler aktualisieren
+        self.pulse_count += 1
+        self.pulse_id += 1
+
     def start_measurement(
         self,
         n_pulses: int = 1,
         inter_pulse_delay_s: float = 0.0,
         save_csv: bool = True,
-        save_npz: bool = True
+        save_npz: bool = True,
+        captures_per_arm: int = 1,
+        capture_timeout_s: float = None
     ) -> None:
         """
         Startet eine Messung mit n Pulsen.
         
-        Diese Funktion öffnet das Gerät, konfiguriert es und startet die
-        Messung. Die Funktion läuft blockierend, bis alle Pulse erfasst sind.
-        Für nicht-blockierende Ausführung in einem Thread starten.
+        Diese Funktion öffnet das Gerät (falls noch keine Session besteht),
+        sendet die geänderten Einstellungen und startet die Messung. Die
+        Funktion läuft blockierend, bis alle Pulse erfasst sind; das Gerät
+        bleibt danach für den nächsten Lauf offen. Für nicht-blockierende
+        Ausführung in einem Thread starten.
         
         Parameters
         ----------
@@ -899,6 +1497,10 @@ class PicoReader:
             Daten in CSV speichern (Standard: True).
         save_npz : bool, optional
             Daten in .npz speichern (Standard: True).
+        captures_per_arm : int, optional
+            Anzahl Erfassungen pro Arm (Rapid-Block, Standard: 1).
+        capture_timeout_s : float, optional
+            Maximale Wartezeit auf einen Trigger pro Block (Standard: None = unbegrenzt).
         
         Returns
         -------
@@ -909,6 +1511,8 @@ class PicoReader:
         RuntimeError
             Wenn der Reader nicht konfiguriert ist oder das Gerät nicht
             geöffnet werden kann.
+        TimeoutError
+            Wenn capture_timeout_s gesetzt ist und kein Trigger kommt.
         
         Notes
         -----
@@ -917,6 +1521,8 @@ class PicoReader:
         - Für nicht-blockierende Ausführung in separatem Thread starten.
         - Wenn PicoSDK nicht verfügbar ist, läuft die Messung im Mock-Modus
           und erzeugt synthetische Testdaten.
+        - Bricht die USB-Verbindung während der Messung ab, wird die Session
+          neu aufgebaut und der unterbrochene Block wiederholt (`_recover()`).
         """
         if not self.is_configured:
             raise RuntimeError("Reader muss zuerst mit configure() konfiguriert werden")
@@ -927,37 +1533,26 @@ class PicoReader:
         # Mock-Modus: Wenn SDK nicht verfügbar, Mock-Messung durchführen
         if not PICO_SDK_AVAILABLE:
             print("[Mock] PicoSDK nicht verfügbar - Messung im Mock-Modus")
-            self._run_mock_measurement(n_pulses, inter_pulse_delay_s, save_csv, save_npz)
+            self._run_mock_measurement(n_pulses, inter_pulse_delay_s, save_csv, save_npz,
+                                       captures_per_arm)
             return
         
         self.is_running = True
+        self._t_start = time.monotonic()
+        self.first_arm_s = None
         
         try:
-            # Gerät öffnen
-            self._open_device()
+            # Session öffnen bzw. weiterverwenden
+            self.open()
             
             try:
-                # Kanäle konfigurieren
-                self._setup_channels()
-                
-                # Maximalwert ADC abfragen
-                self.max_adc = ct.c_int16()
-                assert_pico_ok(ps.ps3000aMaximumValue(self.handle, ct.byref(self.max_adc)))
-                
-                # Timebase bestimmen
-                self.timebase, self.dt, self.fs = pick_timebase(
-                    self.handle, self.target_fs, self.n_samples
-                )
-                
-                # Trigger einrichten
-                self._setup_trigger()
-                
-                # Datenpuffer zuordnen
-                self._setup_data_buffers()
+                # Kanäle, Timebase, Trigger und Puffer: nur Änderungen senden
+                self._apply_config()
+                self._prepare_filters()
                 
                 # Zeitvektor berechnen
-                pre_samples = int(self.pretrig_ratio * self.n_samples)
-                post_samples = self.n_samples - pre_samples
+                pre_samples, post_samples = self._split_window()
+                self.pre_samples = pre_samples
                 t = np.arange(self.n_samples) * self.dt
                 
                 # Speicherung vorbereiten
@@ -983,7 +1578,8 @@ class PicoReader:
                     'posttrigger_samples': post_samples,
                     'ch_a': {
                         'coupling': "AC" if self.coupling_a == ps.PS3000A_COUPLING["PS3000A_AC"] else "DC",
-                        'v_range': vfs_a
+                        'v_range': vfs_a,
+                        'u_probe_attenuation': self.u_probe_attenuation
                     },
                     'ch_b': {
                         'coupling': "AC" if self.coupling_b == ps.PS3000A_COUPLING["PS3000A_AC"] else "DC",
@@ -991,6 +1587,11 @@ class PicoReader:
                         'rogowski_v_per_a': self.rogowski_v_per_a
                     },
                     'trigger_level_v': self.trigger_level_v,
+                    'roi': {
+                        'margin_s': self.roi_margin_s,
+                        'decimation': self.roi_decimation
+                    } if self.roi else None,
+                    'filters': filters_meta(self._filters),
                     'csv_path': self.csv_path if save_csv else None,
                     'npz_path': self.npz_path if save_npz else None
                 }
@@ -1016,86 +1617,44 @@ class PicoReader:
                     self.pulse_id = max(ids) + 1 if ids else 1
                 else:
                     self.pulse_id = 1
+                self._run_first_pulse_id = self.pulse_id
                 
-                # Messschleife
-                for k in range(n_pulses):
-                    # Block-Messung starten
-                    time_indisposed_ms = ct.c_int32(0)
-                    assert_pico_ok(
-                        ps.ps3000aRunBlock(
-                            self.handle,
-                            pre_samples,
-                            post_samples,
-                            self.timebase,
-                            int(self.oversample),
-                            ct.byref(time_indisposed_ms),
-                            0,
-                            None,
-                            None
-                        )
-                    )
-                    
-                    # Warten bis fertig
-                    ready = ct.c_int16(0)
-                    while not ready.value:
-                        ps.ps3000aIsReady(self.handle, ct.byref(ready))
-                        time.sleep(0.001)
-                    
-                    # Werte holen
-                    n = ct.c_int32(self.n_samples)
-                    overflow = ct.c_int16()
-                    assert_pico_ok(
-                        ps.ps3000aGetValues(
-                            self.handle,
-                            0,
-                            ct.byref(n),
-                            1,
-                            ps.PS3000A_RATIO_MODE["PS3000A_RATIO_MODE_NONE"],
-                            0,
-                            ct.byref(overflow)
-                        )
-                    )
-                    
-                    # ADC -> Volt
-                    adc_a = np.frombuffer(self.buf_a, dtype=np.int16, count=n.value).astype(np.float64)
-                    adc_b = np.frombuffer(self.buf_b, dtype=np.int16, count=n.value).astype(np.float64)
-                    
-                    # Spannung: ADC -> Volt -> DUT (mit Tastkopf-Dämpfung)
-                    vfs_a = range_fullscale_volts(self.range_a)
-                    vfs_b = range_fullscale_volts(self.range_b)
-                    u = adc_a * (vfs_a / self.max_adc.value) * self.u_probe_attenuation
-                    
-                    # Strom: ADC -> Volt -> Ampere (mit Rogowski-Kalibrierung)
-                    i_v = adc_b * (vfs_b / self.max_adc.value)
-                    if self.rogowski_v_per_a and self.rogowski_v_per_a > 0:
-                        i = i_v / self.rogowski_v_per_a
-                    else:
-                        i = i_v
-                    
-                    # Callback aufrufen (für Live-Updates)
-                    if self.on_pulse_callback:
-                        try:
-                            self.on_pulse_callback(self.pulse_id, t, u, i)
-                        except Exception as e:
-                            print(f"[Warnung] Callback-Fehler: {e}")
-                    
-                    # Speicherung
-                    if save_csv:
-                        append_pulse_to_csv(self.csv_path, t, u, i, i_unit, self.pulse_id)
-                    
-                    if save_npz:
-                        append_pulse_npz(self.npz_path, self.pulse_id, t, u, i)
-                    
-                    # Zähler aktualisieren
-                    self.pulse_count += 1
-                    self.pulse_id += 1
+                # Messschleife: pro Arm ein Block mit captures_per_arm Segmenten (Rapid-Block)
+                k = 0
+                while k < n_pulses and self.is_running:
+                    n_seg = min(int(captures_per_arm), n_pulses - k)
+                    if self._take_window():
+                        # T1 der Firmware geändert -> neues Fenster ab diesem Block
+                        self._apply_config()
+                        self._prepare_filters()
+                        pre_samples, post_samples = self._split_window()
+                        self.pre_samples = pre_samples
+                        t = np.arange(self.n_samples) * self.dt
+                        self._rewrite_window_meta(save_csv, save_npz)
+                    try:
+                        block = self._capture_block(n_seg, pre_samples, post_samples,
+                                                    capture_timeout_s)
+                    except Exception:
+                        # Nur eine USB-Trennung wird behandelt, alles andere bricht ab
+                        if not self.is_running or self._ping():
+                            raise
+                        self._recover()
+                        continue
+                    for seg, (adc_a, adc_b, start) in enumerate(block):
+                        n = len(adc_a)
+                        self.trigger_offset_s = self._trig_offsets[seg]
+                        self._publish_raw(adc_a, adc_b, self._adc_scales(), start)
+                        u, i = self._adc_to_physical(adc_a, adc_b)
+                        self._emit_pulse(t[start:start + n], u, i, i_unit, save_csv, save_npz,
+                                         roi=(start, n) if self.roi else None)
+                    k += n_seg
                     
                     # Pause zwischen Pulsen
                     if inter_pulse_delay_s > 0:
                         time.sleep(inter_pulse_delay_s)
                 
             finally:
-                # Gerät stoppen und schließen
+                # Gerät stoppen, Session bleibt für den nächsten Lauf offen
                 try:
                     ps.ps3000aStop(self.handle)
                 except Exception:
@@ -1103,9 +1662,9 @@ class PicoReader:
         
         finally:
             self.is_running = False
-            self.close()
     
-    def _run_mock_measurement(self, n_pulses: int, inter_pulse_delay_s: float, save_csv: bool, save_npz: bool):
+    def _run_mock_measurement(self, n_pulses: int, inter_pulse_delay_s: float, save_csv: bool, save_npz: bool,
+                              captures_per_arm: int = 1):
         """
         Führt eine Mock-Messung durch (wenn SDK nicht verfügbar).
         
@@ -1116,11 +1675,12 @@ class PicoReader:
         
         try:
             # Zeitvektor erstellen
-            pre_samples = int(self.pretrig_ratio * self.n_samples)
-            post_samples = self.n_samples - pre_samples
+            pre_samples, post_samples = self._split_window()
+            self.pre_samples = pre_samples
             self.dt = 1.0 / self.target_fs  # Geschätztes dt
             self.fs = self.target_fs
             t = np.arange(self.n_samples) * self.dt
+            self._prepare_filters()
             
             # Speicherung vorbereiten
             i_unit = "A" if (self.rogowski_v_per_a and self.rogowski_v_per_a > 0) else "V"
@@ -1142,10 +1702,12 @@ class PicoReader:
                 'dt_s': self.dt,
                 'pretrigger_samples': pre_samples,
                 'posttrigger_samples': post_samples,
-                'ch_a': {'coupling': getattr(self, 'coupling_a_str', 'AC'), 'v_range': vfs_a},
+                'ch_a': {'coupling': getattr(self, 'coupling_a_str', 'AC'), 'v_range': vfs_a,
+                        'u_probe_attenuation': self.u_probe_attenuation},
                 'ch_b': {'coupling': getattr(self, 'coupling_b_str', 'AC'), 'v_range': vfs_b,
                         'rogowski_v_per_a': self.rogowski_v_per_a},
                 'trigger_level_v': self.trigger_level_v,
+                'filters': filters_meta(self._filters),
                 'csv_path': self.csv_path if save_csv else None,
                 'npz_path': self.npz_path if save_npz else None,
                 'mock_mode': True  # Markierung für Mock-Modus
@@ -1167,12 +1729,34 @@ class PicoReader:
                 self.pulse_id = max(ids) + 1 if ids else 1
             else:
                 self.pulse_id = 1
+            self._run_first_pulse_id = self.pulse_id
             
             # Mock-Messung: Synthetische Pulse
+            self.first_arm_s = 0.0
             for k in range(n_pulses):
+                if not self.is_running:
+                    break
+                if self._take_window():
+                    self.pre_samples, _ = self._split_window()
+                    self.dt = 1.0 / self.target_fs
+                    self.fs = self.target_fs
+                    t = np.arange(self.n_samples) * self.dt
+                    self._prepare_filters()
+                    self._rewrite_window_meta(save_csv, save_npz)
+                if self.on_armed_callback and k % captures_per_arm == 0:
+                    self.on_armed_callback(self.pulse_id, min(captures_per_arm, n_pulses - k))
+                
                 # Synthetische Daten erzeugen: Exponential-Fall mit Rauschen
                 u = 10.0 * np.exp(-t * 1000) * np.sin(2 * np.pi * 1000 * t) + np.random.normal(0, 0.1, len(t))
                 i = -0.1 * np.exp(-t * 1000) * np.cos(2 * np.pi * 1000 * t) + np.random.normal(0, 0.01, len(t))
+                u_raw, i_raw = u, i
+                u, i = self._apply_filters(u, i)
+                
+                # Puls-Ring: Rohwerte wie vom Scope (int16, max. ADC-Wert 32512)
+                if self.ring is not None:
+                    scales = (12.0 / 32512, 0.12 / 32512)
+                    self._publish_raw(np.round(u_raw / scales[0]).astype(np.int16),
+                                      np.round(i_raw / scales[1]).astype(np.int16), scales)
                 
                 # Callback aufrufen
                 if self.on_pulse_callback:
@@ -1214,17 +1798,18 @@ class PicoReader:
         
         Notes
         -----
-        - Aktuell unterstützt die Implementierung keinen Abbruch während
-          der Messung. Diese Funktion bereitet die Implementierung vor.
+        - Die Messschleife prüft das Flag vor jedem Block und während des
+          Wartens auf den Trigger; ein laufender Block wird abgebrochen.
         """
         self.is_running = False
     
     def close(self) -> None:
         """
-        Schließt das Picoscope-Gerät.
+        Schließt das Picoscope-Gerät und beendet die Session.
         
-        Diese Funktion wird automatisch von `start_measurement()` aufgerufen.
-        Kann auch manuell aufgerufen werden für explizites Cleanup.
+        `start_measurement()` lässt das Gerät offen, damit der nächste Lauf
+        ohne Öffnen und Neukonfiguration startet; beim Beenden der Anwendung
+        (oder um das Gerät freizugeben) explizit aufrufen.
         
         Returns
         -------
@@ -1239,6 +1824,8 @@ class PicoReader:
         elif not PICO_SDK_AVAILABLE:
             # Mock-Modus: Nichts zu schließen
             self.handle = None
+        self._applied = {}
+        self._n_segments = 0
     
     def get_latest_pulse(self) -> tuple:
         """
@@ -1251,13 +1838,16 @@ class PicoReader:
         
         Notes
         -----
-        - Diese Funktion liest die Daten aus der letzten Messung.
-        - Für Live-Zugriff während Messung verwende Callbacks.
+        - Diese Funktion liest den neuesten Puls aus dem angehängten Puls-Ring
+          (``attach_ring()``); ohne Ring liefert sie None.
+        - Für Live-Zugriff während Messung verwende Callbacks oder einen ``RingCursor``.
         """
-        # Diese Funktion würde aus Speicher laden
-        # Aktuell wird sie durch Callbacks ersetzt
-        # Kann erweitert werden für Speicher-basierte Implementierung
-        return None
+        if self.ring is None or self.ring.written == 0:
+            return None
+        view = self.ring.view(self.ring.written - 1)
+        if view is None:
+            return None
+        return (view.pulse_id, *view.physical())
     
     def get_status(self) -> dict:
         """
@@ -1272,11 +1862,181 @@ class PicoReader:
             - pulse_count: int - Anzahl erfasster Pulse in aktueller Session
             - pulse_id: int - Nächste freie Pulse-ID
             - run_name: str - Name des aktuellen Messlaufs
+            - session_open: bool - Ist das Gerät (noch) geöffnet?
+            - reconnects: int - Wiederhergestellte USB-Trennungen
+            - first_arm_s: float - Zeit vom Start bis zum ersten scharfen Block
+            - window: tuple - (fs, pre, post) aus `set_window()` oder None
         """
         return {
             'is_running': self.is_running,
             'is_configured': self.is_configured,
             'pulse_count': self.pulse_count,
             'pulse_id': self.pulse_id,
-            'run_name': self.run_name
+            'run_name': self.run_name,
+            'session_open': self.handle is not None,
+            'reconnects': self.reconnects,
+            'first_arm_s': self.first_arm_s,
+            'window': self.window
         }
+
+
+def acquisition_process(ring_name: str, config: dict, n_pulses: int, stop_event=None,
+                        **measure_kwargs) -> None:
+    """
+    Einstiegspunkt für die Erfassung in einem eigenen Prozess.
+    
+    Öffnet den (vom Elternprozess angelegten) Puls-Ring, konfiguriert einen
+    ``PicoReader`` und misst; GUI, Speicherung und Auswertung lesen die Pulse
+    über ``PulseRing.attach(ring_name).cursor()`` ohne Kopie.
+    
+    Parameters
+    ----------
+    ring_name : str
+        Name des Puls-Rings (``PulseRing.name``)
+    config : dict
+        Argumente für ``PicoReader.configure()``
+    n_pulses : int
+        Anzahl zu erfassender Pulse
+    stop_event : multiprocessing.Event, optional
+        Gesetzt = Messung abbrechen (wie ``PicoReader.stop()``)
+    **measure_kwargs
+        Weitere Argumente für ``PicoReader.start_measurement()``
+    
+    Examples
+    --------
+    >>> ring = PulseRing.create(n_slots=8, slot_samples=480_000)
+    >>> proc = multiprocessing.Process(target=acquisition_process,
+    ...                                args=(ring.name, {"run_name": "R1"}, 100))
+    >>> proc.start()
+    """
+    from pico_pulse_lab.acquisition.pulse_ring import PulseRing
+    
+    ring = PulseRing.attach(ring_name)
+    reader = PicoReader()
+    try:
+        reader.configure(**config)
+        _measure_into_ring(reader, ring, n_pulses, stop_event, measure_kwargs)
+    finally:
+        ring.mark_closed()          # auch wenn configure() scheitert
+        reader.attach_ring(None)
+        reader.close()
+        ring.close()
+
+
+def _measure_into_ring(reader: PicoReader, ring, n_pulses: int, stop_event,
+                       measure_kwargs: dict) -> None:
+    """Ein Messlauf in den Puls-Ring; ``stop_event`` bricht ab, Ring danach geschlossen."""
+    import threading
+    
+    done = threading.Event()
+    try:
+        reader.attach_ring(ring)
+        ring.mark_closed(False)
+        if stop_event is not None:
+            # Abfragen statt stop_event.wait(): ein beim Prozessende blockierter
+            # Wartender ließe ein späteres set() im Elternprozess hängen
+            def watch():
+                while not done.wait(0.05):
+                    if stop_event.is_set():
+                        reader.stop()
+                        break
+            threading.Thread(target=watch, daemon=True).start()
+        reader.start_measurement(n_pulses=n_pulses, **measure_kwargs)
+    finally:
+        done.set()
+        ring.mark_closed()          # wartende Leser kehren zurück
+
+
+def acquisition_worker(commands, events, stop_event=None) -> None:
+    """
+    Langlebiger Erfassungsprozess: ein ``PicoReader`` (und damit eine offene
+    Geräte-Session) für beliebig viele Messläufe.
+    
+    Der Elternprozess schickt je Lauf ``(ring_name, config, n_pulses,
+    measure_kwargs)`` über ``commands``, ``None`` beendet den Prozess. Nach
+    jedem Lauf folgt auf ``events`` ``("done", run_name, fehler)`` mit
+    ``fehler = None`` bei Erfolg. ``config`` wirkt wie ``PicoReader.configure()``
+    auf den bestehenden Reader, nicht angegebene Einstellungen bleiben also
+    vom vorigen Lauf erhalten.
+    
+    ``("set_window", fs, pre_samples, post_samples)`` wirkt wie
+    ``PicoReader.set_window()`` und wird auch während eines Laufs gelesen
+    (dort ab dem nächsten Block); andere Aufträge warten bis zum Laufende.
+    
+    Parameters
+    ----------
+    commands, events : multiprocessing.Queue
+        Aufträge an den Prozess bzw. Rückmeldungen
+    stop_event : multiprocessing.Event, optional
+        Gesetzt = laufende Messung abbrechen; der Elternprozess setzt es vor
+        jedem Auftrag zurück
+    
+    Examples
+    --------
+    >>> ctx = multiprocessing.get_context("spawn")
+    >>> cmds, evts, stop = ctx.Queue(), ctx.Queue(), ctx.Event()
+    >>> ctx.Process(target=acquisition_worker, args=(cmds, evts, stop)).start()
+    >>> cmds.put((ring.name, {"run_name": "R1"}, 100, {}))
+    >>> evts.get()
+    ('done', 'R1', None)
+    """
+    import queue
+    import threading
+    from collections import deque
+    from pico_pulse_lab.acquisition.pulse_ring import PulseRing
+    
+    reader = PicoReader()
+    ring = None
+    waiting = deque()           # während eines Laufs gelesene Aufträge
+    
+    def listen(done):
+        # Fenster sofort an den Reader, alles andere nach dem Lauf
+        while not done.is_set():
+            try:
+                cmd = commands.get(timeout=0.05)
+            except queue.Empty:
+                continue
+            if cmd is not None and cmd[0] == "set_window":
+                reader.set_window(*cmd[1:])
+            else:
+                waiting.append(cmd)
+    
+    try:
+        while True:
+            cmd = waiting.popleft() if waiting else commands.get()
+            if cmd is None:
+                break
+            if cmd[0] == "set_window":
+                # zwischen zwei Läufen; der Ring wird erst beim Start geprüft
+                reader.attach_ring(None)
+                reader.set_window(*cmd[1:])
+                continue
+            ring_name, config, n_pulses, measure_kwargs = cmd
+            error = None
+            try:
+                if ring is None or ring.name != ring_name:
+                    # Daemon hat einen größeren Ring angelegt
+                    reader.attach_ring(None)
+                    if ring is not None:
+                        ring.close()
+                    ring = None
+                    ring = PulseRing.attach(ring_name)
+                reader.configure(**config)
+                done = threading.Event()
+                listener = threading.Thread(target=listen, args=(done,), daemon=True)
+                listener.start()
+                try:
+                    _measure_into_ring(reader, ring, n_pulses, stop_event, measure_kwargs)
+                finally:
+                    done.set()
+                    listener.join()
+            except Exception as e:
+                error = f"{type(e).__name__}: {e}"
+                if ring is not None:
+                    ring.mark_closed()
+            events.put(("done", config.get("run_name"), error))
+    finally:
+        reader.attach_ring(None)
+        reader.close()
+        if ring is not None:
+            ring.close()
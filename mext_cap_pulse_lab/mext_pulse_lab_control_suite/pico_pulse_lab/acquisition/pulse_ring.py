@@ -0,0 +1,339 @@
+"""
+Puls-Ring im Shared Memory: Erfassung und Auswertung in getrennten Prozessen.
+
+Die Erfassung (``PicoReader``) schreibt jeden Puls als ADC-Rohwerte (int16,
+U und I) in einen festen Slot eines Rings im Shared Memory. GUI, Speicherung
+und Auswertung hängen sich als Leser an (``PulseRing.attach``) und lesen die
+Slots ohne Kopie, jeder mit eigenem Cursor. Matplotlib-Redraws und
+Parameterschätzung halten so nicht mehr ``ps3000aGetValues`` auf (GIL).
+
+Aufbau des Speichers (Little Endian):
+
+    Kopf (64 Byte)     MAGIC VERSION KANÄLE SLOTS SAMPLES_JE_SLOT GESCHRIEBEN(8) GESCHLOSSEN
+    Slot-Köpfe         je SEQ(8) PULSE_ID(8) N PRE DT SKALA_U SKALA_I T_WALL T_MONO T_TRIG
+    Daten              int16 [Slots, Kanäle, Samples]
+
+Ein Schreiber, beliebig viele Leser, keine Sperren: Der Schreiber blockiert
+nie, sondern überschreibt den ältesten Slot. Jeder Slot trägt eine
+Sequenznummer (Seqlock): ungerade = wird geschrieben, ``2*k + 2`` = enthält
+den k-ten Puls. Leser prüfen sie vor und nach dem Lesen und erkennen so
+überholte Slots (``RingCursor.lost``).
+"""
+
+import os
+import time
+from multiprocessing import shared_memory
+from typing import Optional
+
+import numpy as np
+
+MAGIC = 0x474E5250          # "PRNG"
+VERSION = 2
+HEADER_SIZE = 64
+
+_HEADER_DTYPE = np.dtype([
+    ("magic", "<u4"), ("version", "<u2"), ("n_channels", "<u2"),
+    ("n_slots", "<u4"), ("slot_samples", "<u4"),
+    ("written", "<u8"),         # Anzahl vollständig geschriebener Pulse
+    ("closed", "<u4"),          # Schreiber fertig (Messlauf beendet)
+    ("_pad", "V36"),
+])
+
+_SLOT_DTYPE = np.dtype([
+    ("seq", "<u8"), ("pulse_id", "<u8"),
+    ("n_samples", "<u4"), ("pre_samples", "<u4"),
+    ("dt", "<f8"), ("scale_u", "<f8"), ("scale_i", "<f8"),
+    ("t_wall", "<f8"), ("t_mono", "<f8"),
+    ("t_trig", "<f8"),          # Trigger-Versatz zwischen zwei Samples in s
+])
+
+
+class RingOverrun(RuntimeError):
+    """Der Slot wurde während des Lesens vom Schreiber überschrieben."""
+
+
+def ring_size(n_slots: int, slot_samples: int, n_channels: int = 2) -> int:
+    """Größe des Shared-Memory-Blocks in Byte."""
+    return HEADER_SIZE + n_slots * _SLOT_DTYPE.itemsize + n_slots * n_channels * slot_samples * 2
+
+
+def _open_shm(name: str) -> shared_memory.SharedMemory:
+    """Vorhandenen Block öffnen, ohne dass der Resource-Tracker des Lesers ihn beim
+    Prozessende löscht (der Block gehört dem Prozess, der ihn angelegt hat)."""
+    try:
+        return shared_memory.SharedMemory(name=name, track=False)     # ab Python 3.13
+    except TypeError:
+        pass
+    if os.name != "posix":
+        return shared_memory.SharedMemory(name=name)
+    # bis 3.12: Anmeldung beim Tracker unterdrücken (ein nachträgliches unregister würde
+    # in Kindprozessen auch den Eintrag des Erzeugers austragen, der Tracker ist geteilt)
+    from multiprocessing import resource_tracker
+    register = resource_tracker.register
+    resource_tracker.register = lambda n, rtype: None if rtype == "shared_memory" else register(n, rtype)
+    try:
+        return shared_memory.SharedMemory(name=name)
+    finally:
+        resource_tracker.register = register
+
+
+class PulseView:
+    """
+    Ein Puls im Ring, ohne Kopie (``adc_u``/``adc_i`` zeigen in den Shared Memory).
+
+    Die Arrays bleiben gültig, bis der Schreiber den Slot einmal rundum wieder
+    erreicht. ``valid()`` prüft das, ``physical()`` kopiert und prüft danach.
+    """
+    __slots__ = ("index", "pulse_id", "pre_samples", "dt", "scale_u", "scale_i",
+                 "t_wall", "t_mono", "t_trig", "adc_u", "adc_i", "_seq", "_hdr")
+
+    def __init__(self, index: int, hdr, data: np.ndarray):
+        self.index = index
+        self._hdr = hdr
+        self._seq = int(hdr["seq"])
+        n = int(hdr["n_samples"])
+        self.pulse_id = int(hdr["pulse_id"])
+        self.pre_samples = int(hdr["pre_samples"])
+        self.dt = float(hdr["dt"])
+        self.scale_u = float(hdr["scale_u"])
+        self.scale_i = float(hdr["scale_i"])
+        self.t_wall = float(hdr["t_wall"])
+        self.t_mono = float(hdr["t_mono"])
+        self.t_trig = float(hdr["t_trig"])
+        self.adc_u = data[0, :n]
+        self.adc_i = data[1, :n]
+
+    @property
+    def n_samples(self) -> int:
+        return len(self.adc_u)
+
+    def valid(self) -> bool:
+        """True, solange der Slot noch diesen Puls enthält."""
+        return int(self._hdr["seq"]) == self._seq
+
+    def physical(self) -> tuple:
+        """
+        Zeitvektor, Spannung und Strom als neue float64-Arrays.
+
+        Raises
+        ------
+        RingOverrun
+            Wenn der Schreiber den Slot während des Kopierens überschrieben hat.
+        """
+        u = self.adc_u * self.scale_u
+        i = self.adc_i * self.scale_i
+        if not self.valid():
+            raise RingOverrun(f"Puls {self.pulse_id} überschrieben")
+        t = (np.arange(self.n_samples) - self.pre_samples) * self.dt
+        return t, u, i
+
+
+class PulseRing:
+    """
+    Ring aus Puls-Slots im Shared Memory.
+
+    Der Erfassungsprozess legt den Ring mit ``create()`` an und schreibt mit
+    ``publish()``, alle anderen Prozesse öffnen ihn mit ``attach()`` und lesen
+    über einen eigenen ``RingCursor``.
+
+    Examples
+    --------
+    >>> ring = PulseRing.create(n_slots=8, slot_samples=480_000)
+    >>> reader.attach_ring(ring)                     # im Erfassungsprozess
+    >>> cur = PulseRing.attach(ring.name).cursor()   # in GUI/Speicherung
+    >>> p = cur.wait(timeout=1.0)
+    >>> t, u, i = p.physical()
+    """
+
+    def __init__(self, shm: shared_memory.SharedMemory, owner: bool):
+        self._shm = shm
+        self._owner = owner
+        self._head = np.ndarray((), dtype=_HEADER_DTYPE, buffer=shm.buf)
+        if int(self._head["magic"]) != MAGIC or int(self._head["version"]) != VERSION:
+            raise ValueError(f"'{shm.name}' ist kein Puls-Ring (Version {VERSION})")
+        self.n_slots = int(self._head["n_slots"])
+        self.slot_samples = int(self._head["slot_samples"])
+        self.n_channels = int(self._head["n_channels"])
+        self._slots = np.ndarray((self.n_slots,), dtype=_SLOT_DTYPE, buffer=shm.buf,
+                                 offset=HEADER_SIZE)
+        self._data = np.ndarray((self.n_slots, self.n_channels, self.slot_samples), dtype=np.int16,
+                                buffer=shm.buf,
+                                offset=HEADER_SIZE + self.n_slots * _SLOT_DTYPE.itemsize)
+
+    @classmethod
+    def create(cls, n_slots: int, slot_samples: int, name: Optional[str] = None,
+               n_channels: int = 2) -> "PulseRing":
+        """
+        Legt einen neuen Ring an (Eigentümer, gibt ihn bei ``close()`` frei).
+
+        Parameters
+        ----------
+        n_slots : int
+            Anzahl Slots; so viele Pulse darf ein Leser zurückliegen
+        slot_samples : int
+            Samples je Kanal und Slot (mindestens ``n_samples`` der Erfassung)
+        name : str, optional
+            Name des Blocks, by default None (vom System vergeben)
+        """
+        if n_slots < 2 or slot_samples < 1:
+            raise ValueError("Ring braucht mindestens 2 Slots mit je 1 Sample")
+        shm = shared_memory.SharedMemory(name=name, create=True,
+                                         size=ring_size(n_slots, slot_samples, n_channels))
+        head = np.ndarray((), dtype=_HEADER_DTYPE, buffer=shm.buf)
+        head["n_channels"], head["n_slots"], head["slot_samples"] = n_channels, n_slots, slot_samples
+        head["written"], head["closed"] = 0, 0
+        np.ndarray((n_slots,), dtype=_SLOT_DTYPE, buffer=shm.buf, offset=HEADER_SIZE)[:] = 0
+        head["version"] = VERSION
+        head["magic"] = MAGIC           # zuletzt: erst jetzt ist der Ring gültig
+        del head
+        return cls(shm, owner=True)
+
+    @classmethod
+    def attach(cls, name: str) -> "PulseRing":
+        """Öffnet einen vorhandenen Ring (Leser oder Schreiber in einem anderen Prozess)."""
+        return cls(_open_shm(name), owner=False)
+
+    @property
+    def name(self) -> str:
+        return self._shm.name
+
+    @property
+    def written(self) -> int:
+        """Anzahl bisher vollständig geschriebener Pulse."""
+        return int(self._head["written"])
+
+    @property
+    def closed(self) -> bool:
+        """Der Schreiber hat den Messlauf beendet."""
+        return bool(self._head["closed"])
+
+    def mark_closed(self, closed: bool = True) -> None:
+        """Messlauf beendet (bzw. neu begonnen); wartende Leser kehren zurück."""
+        self._head["closed"] = int(closed)
+
+    def publish(self, pulse_id: int, adc_u: np.ndarray, adc_i: np.ndarray, *, dt: float,
+                scale_u: float, scale_i: float, pre_samples: int = 0,
+                t_wall: Optional[float] = None, t_trig: float = 0.0) -> int:
+        """
+        Schreibt einen Puls (nur ein Schreiber je Ring).
+
+        Parameters
+        ----------
+        pulse_id : int
+            ID des Pulses (wie in CSV/NPZ)
+        adc_u, adc_i : np.ndarray
+            ADC-Rohwerte (int16) von Kanal A und B
+        dt : float
+            Abtastintervall in s
+        scale_u, scale_i : float
+            Umrechnung Rohwert -> V am DUT bzw. A (oder V ohne Rogowski)
+        pre_samples : int, optional
+            Samples vor dem Trigger, by default 0
+        t_wall : float, optional
+            Zeitstempel (Unix-Zeit), by default jetzt
+        t_trig : float, optional
+            Trigger-Versatz in s (``ps3000aGetTriggerTimeOffset64``), by default 0.0
+
+        Returns
+        -------
+        int
+            Laufende Nummer des Pulses im Ring.
+        """
+        n = len(adc_u)
+        if n > self.slot_samples or len(adc_i) != n:
+            raise ValueError(f"Puls mit {n} Samples passt nicht in Slots zu {self.slot_samples}")
+        k = int(self._head["written"])
+        slot = self._slots[k % self.n_slots]
+        slot["seq"] = 2 * k + 1                 # Slot gesperrt: Leser verwerfen ihn
+        self._data[k % self.n_slots, 0, :n] = adc_u
+        self._data[k % self.n_slots, 1, :n] = adc_i
+        slot["pulse_id"], slot["n_samples"], slot["pre_samples"] = pulse_id, n, pre_samples
+        slot["dt"], slot["scale_u"], slot["scale_i"] = dt, scale_u, scale_i
+        slot["t_wall"] = time.time() if t_wall is None else t_wall
+        slot["t_mono"] = time.monotonic()
+        slot["t_trig"] = t_trig
+        slot["seq"] = 2 * k + 2                 # freigegeben
+        self._head["written"] = k + 1
+        return k
+
+    def view(self, k: int) -> Optional[PulseView]:
+        """Puls Nummer k ohne Kopie, None wenn (noch) nicht vorhanden oder überschrieben."""
+        slot = self._slots[k % self.n_slots]
+        if int(slot["seq"]) != 2 * k + 2:
+            return None
+        v = PulseView(k, slot, self._data[k % self.n_slots])
+        return v if v.valid() else None
+
+    def cursor(self, from_oldest: bool = False) -> "RingCursor":
+        """Neuer Lese-Cursor (ab dem nächsten Puls bzw. ab dem ältesten im Ring)."""
+        return RingCursor(self, from_oldest)
+
+    def close(self) -> None:
+        """Gibt die Sicht frei; der Eigentümer löscht den Block. Vorher erzeugte
+        ``PulseView``-Arrays dürfen danach nicht mehr verwendet werden."""
+        self._head = self._slots = self._data = None
+        try:
+            self._shm.close()
+        except BufferError:
+            pass                                # Leser hält noch Views, Freigabe beim GC
+        if self._owner:
+            self._shm.unlink()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+class RingCursor:
+    """
+    Lese-Position eines Lesers (nur lokal, der Schreiber kennt die Leser nicht).
+
+    Attributes
+    ----------
+    lost : int
+        Pulse, die der Schreiber überschrieben hat, bevor dieser Leser sie gelesen hat.
+    """
+
+    def __init__(self, ring: PulseRing, from_oldest: bool = False):
+        self.ring = ring
+        self.lost = 0
+        w = ring.written
+        self.next = max(0, w - ring.n_slots + 1) if from_oldest else w
+
+    def poll(self) -> Optional[PulseView]:
+        """Nächster ungelesener Puls oder None; überholte Pulse werden übersprungen."""
+        w = self.ring.written
+        if self.next >= w:
+            return None
+        oldest = w - self.ring.n_slots + 1      # Slot von w wird evtl. gerade beschrieben
+        if self.next < oldest:
+            self.lost += oldest - self.next
+            self.next = oldest
+        while self.next < w:
+            v = self.ring.view(self.next)
+            self.next += 1
+            if v is not None:
+                return v
+            self.lost += 1
+        return None
+
+    def latest(self) -> Optional[PulseView]:
+        """Neuester Puls (z.B. für die Live-Anzeige); ältere gelten als gelesen."""
+        w = self.ring.written
+        if w == 0:
+            return None
+        self.next = w
+        return self.ring.view(w - 1)
+
+    def wait(self, timeout: Optional[float] = None, poll_s: float = 0.001) -> Optional[PulseView]:
+        """Wartet auf den nächsten Puls; None bei Timeout oder beendetem Messlauf."""
+        end = None if timeout is None else time.monotonic() + timeout
+        while True:
+            v = self.poll()
+            if v is not None:
+                return v
+            if self.ring.closed or (end is not None and time.monotonic() >= end):
+                return None
+            time.sleep(poll_s)
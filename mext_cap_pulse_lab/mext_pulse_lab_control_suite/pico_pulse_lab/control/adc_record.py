@@ -0,0 +1,127 @@
+"""
+Dekoder für die ADC-Messdaten der Firmware (U_DC und Brückenstrom je Puls).
+
+Die Firmware tastet während jedes Pulspaars Zwischenkreisspannung (PA0) und
+Strom (PA1) mit dem internen ADC ab, wertet pro Puls Mittelwert/Min/Max aus
+und sendet bei aktivierter Aufzeichnung (ADC-Kommando 0x90, Dezimierung N)
+jeden N-ten Zyklus einen kompakten Frame:
+
+    FF 98 ZYKLUS(4) N+(2) N-(2) [U_mean U_min U_max I_mean I_min I_max](2 je Wert) x 2
+
+Alle Werte Little Endian, Rohwerte 12 Bit. Die Umrechnung in Volt/Ampere
+hängt von Spannungsteiler und Strommessung ab und erfolgt über ``AdcScale``.
+"""
+
+from typing import NamedTuple
+
+PREAMBLE = 0xFF
+ADC_CMD = 0x90          # Kommando/Antwort: Dezimierung setzen
+ADC_REC_CMD = 0x98      # Messdaten-Frame (unaufgefordert)
+ADC_REC_SIZE = 34
+ADC_ST_READY = 0x01     # Antwort-Status: ADC kalibriert, DMA läuft
+ADC_ST_ON = 0x02        # Antwort-Status: Aufzeichnung aktiv
+
+ADC_FULL_SCALE = 4095
+ADC_VREF = 3.3
+ADC_PAIR_US = 2.82      # Abtastabstand je Wertepaar (U, I) in µs, siehe adc_init()
+
+
+class PulseStats(NamedTuple):
+    """Kennwerte eines Pulses (Rohwerte oder skaliert)."""
+    n: int              # Anzahl Wertepaare im Puls
+    u_mean: float
+    u_min: float
+    u_max: float
+    i_mean: float
+    i_min: float
+    i_max: float
+
+    @property
+    def i_peak(self) -> float:
+        """Betragsmäßig größter Strom im Puls."""
+        return self.i_max if abs(self.i_max) >= abs(self.i_min) else self.i_min
+
+    @property
+    def u_sag(self) -> float:
+        """Einbruch der Zwischenkreisspannung im Puls."""
+        return self.u_max - self.u_min
+
+
+class AdcRecord(NamedTuple):
+    """Ein Messdaten-Frame: positiver und negativer Puls eines Zyklus."""
+    cycle: int
+    pos: PulseStats
+    neg: PulseStats
+
+
+class AdcScale(NamedTuple):
+    """
+    Umrechnung der Rohwerte in physikalische Größen.
+
+    Parameters
+    ----------
+    u_per_volt_in : float
+        Volt am DUT je Volt am ADC-Pin (Teilerverhältnis), by default 1.0
+    a_per_volt_in : float
+        Ampere je Volt am ADC-Pin (Shunt x Verstärkung), by default 1.0
+    i_zero_v : float
+        Pin-Spannung bei 0 A (Offset bipolarer Strommessung), by default 0.0
+    """
+    u_per_volt_in: float = 1.0
+    a_per_volt_in: float = 1.0
+    i_zero_v: float = 0.0
+
+    def volts(self, raw: float) -> float:
+        return raw * ADC_VREF / ADC_FULL_SCALE * self.u_per_volt_in
+
+    def amps(self, raw: float) -> float:
+        return (raw * ADC_VREF / ADC_FULL_SCALE - self.i_zero_v) * self.a_per_volt_in
+
+    def raw_u(self, volts: float) -> int:
+        """Rohwert zu einer Spannung am DUT (z.B. Überspannungsschwelle für PROT)."""
+        return _clip_raw(volts / self.u_per_volt_in / ADC_VREF * ADC_FULL_SCALE)
+
+    def raw_i(self, amps: float) -> int:
+        """Rohwert zu einem Strom (z.B. Überstromschwelle für PROT)."""
+        return _clip_raw((amps / self.a_per_volt_in + self.i_zero_v) / ADC_VREF * ADC_FULL_SCALE)
+
+    def apply(self, rec: AdcRecord) -> AdcRecord:
+        """Liefert den Datensatz in V/A (Probenanzahl bleibt)."""
+        def conv(p: PulseStats) -> PulseStats:
+            return PulseStats(p.n, self.volts(p.u_mean), self.volts(p.u_min), self.volts(p.u_max),
+                              self.amps(p.i_mean), self.amps(p.i_min), self.amps(p.i_max))
+        return AdcRecord(rec.cycle, conv(rec.pos), conv(rec.neg))
+
+
+def _clip_raw(x: float) -> int:
+    return int(min(max(round(x), 0), ADC_FULL_SCALE))
+
+
+def decode_adc_record(frame: bytes) -> AdcRecord:
+    """
+    Dekodiert einen Messdaten-Frame (Rohwerte).
+
+    Raises
+    ------
+    ValueError
+        Wenn der Frame kein ADC-Messdaten-Frame ist.
+    """
+    if len(frame) != ADC_REC_SIZE or frame[0] != PREAMBLE or frame[1] != ADC_REC_CMD:
+        raise ValueError(f"kein ADC-Frame: {frame.hex(' ')}")
+    u16 = [int.from_bytes(frame[k:k + 2], "little") for k in range(6, ADC_REC_SIZE, 2)]
+    n_pos, n_neg = u16[0], u16[1]
+    return AdcRecord(
+        cycle=int.from_bytes(frame[2:6], "little"),
+        pos=PulseStats(n_pos, *u16[2:8]),
+        neg=PulseStats(n_neg, *u16[8:14]),
+    )
+
+
+def encode_adc_record(rec: AdcRecord) -> bytes:
+    """Baut einen Messdaten-Frame aus Rohwerten (Simulator, Tests)."""
+    out = bytearray([PREAMBLE, ADC_REC_CMD])
+    out += int(rec.cycle).to_bytes(4, "little")
+    vals = [rec.pos.n, rec.neg.n, *rec.pos[1:], *rec.neg[1:]]
+    for v in vals:
+        out += int(v).to_bytes(2, "little")
+    return bytes(out)
@@ -0,0 +1,130 @@
+"""
+Erfassungsfenster passend zum Pulsmuster der Firmware.
+
+Ein Pulspaar ist T1 positiv und direkt danach T1 negativ, danach schwingt der
+Kreis aus. Statt des festen Fensters (400 000 Samples + 20 % Pretrigger)
+wird nur aufgezeichnet, was davon gebraucht wird:
+
+    Pretrigger  |  2 * T1  |  Ausschwingen
+    PRE_US         Paar       SETTLE_US
+
+bei der gewünschten Abtastrate; passt das nicht in ``max_samples``, wird die
+Abtastrate gesenkt. ``WindowTracker`` hält das Fenster eines ``PicoReader``
+aktuell, wenn T1 per SET oder RETIME geändert wird (auch während einer
+Messung, dann ab dem nächsten Block).
+"""
+
+import math
+from typing import NamedTuple, Optional
+
+from pico_pulse_lab.control.event_log import Event, EventId
+from pico_pulse_lab.control.stm32_uart import NucleoLink
+
+PRE_US = 20.0               # Pretrigger (Grundlinie vor dem Puls)
+SETTLE_US = 100.0           # Ausschwingen nach dem Pulspaar
+MIN_SAMPLES = 2000
+MAX_SAMPLES = 480_000       # bisheriges festes Fenster
+T1_MIN_US, T1_MAX_US = 10, 1000   # Begrenzung von T1 in der Firmware
+
+
+class CaptureWindow(NamedTuple):
+    """Erfassungsfenster: Abtastrate und Samples vor/nach dem Trigger."""
+    fs: float
+    pre_samples: int
+    post_samples: int
+
+    @property
+    def n_samples(self) -> int:
+        return self.pre_samples + self.post_samples
+
+    @property
+    def duration_s(self) -> float:
+        return self.n_samples / self.fs
+
+
+def window_for(t1_us: float, *, fs: float = 20e6, pre_us: float = PRE_US,
+               settle_us: float = SETTLE_US, min_samples: int = MIN_SAMPLES,
+               max_samples: int = MAX_SAMPLES) -> CaptureWindow:
+    """
+    Kleinstes Fenster, das ein Pulspaar mit T1 samt Ausschwingen abdeckt.
+
+    Parameters
+    ----------
+    t1_us : float
+        Pulsdauer T1 der Firmware in µs
+    fs : float, optional
+        Gewünschte Abtastrate in Hz, by default 20e6
+    pre_us, settle_us : float, optional
+        Pretrigger und Ausschwingzeit in µs
+    min_samples, max_samples : int, optional
+        Grenzen für die Fensterlänge; über ``max_samples`` wird fs gesenkt
+
+    Returns
+    -------
+    CaptureWindow
+    """
+    pre_s = pre_us * 1e-6
+    duration = pre_s + (2 * t1_us + settle_us) * 1e-6
+    fs = min(fs, max_samples / duration)
+    n = min(max(min_samples, math.ceil(duration * fs)), max_samples)
+    pre = min(math.ceil(pre_s * fs), n - 1)
+    return CaptureWindow(fs, pre, n - pre)
+
+
+class WindowTracker:
+    """
+    Passt das Fenster eines ``PicoReader`` an T1 der Firmware an.
+
+    Lauscht auf die Events SET T1 und RETIME; ``sync()`` liest T1 per READBACK.
+    CONFIG meldet kein Event: danach ``apply(ack.t1_us)`` oder ``sync()`` aufrufen
+    (``PulseController`` mit ``window=`` erledigt das selbst).
+
+    Parameters
+    ----------
+    link : NucleoLink
+        Verbundener UART-Client der Firmware.
+    reader : PicoReader
+        Reader, dessen Fenster über ``set_window()`` gesetzt wird.
+    **window_kwargs
+        Weitere Argumente für ``window_for()`` (z.B. ``fs``, ``settle_us``).
+
+    Examples
+    --------
+    >>> tracker = WindowTracker(nuc, reader, fs=20e6)
+    >>> tracker.sync()          # T1 lesen, Fenster setzen
+    >>> nuc.retime(t1_us=50)    # Fenster folgt ab dem nächsten Block
+    """
+
+    def __init__(self, link: NucleoLink, reader, **window_kwargs):
+        self.link = link
+        self.reader = reader
+        self.window_kwargs = window_kwargs
+        self.t1_us: Optional[int] = None
+        self.window: Optional[CaptureWindow] = None
+        link.add_event_listener(self._on_event)
+
+    def apply(self, t1_us: int) -> CaptureWindow:
+        """Berechnet das Fenster für T1 und gibt es an den Reader."""
+        win = window_for(t1_us, **self.window_kwargs)
+        self.reader.set_window(win.fs, win.pre_samples, win.post_samples)
+        self.t1_us, self.window = int(t1_us), win
+        return win
+
+    def sync(self, timeout: float = 2.0) -> CaptureWindow:
+        """Liest T1 aus der Firmware (READBACK) und setzt das Fenster."""
+        t1_us, _ = self.link.readback(1).result(timeout)
+        return self.apply(t1_us)
+
+    def _on_event(self, ev: Event) -> None:
+        # Läuft im Reader-Thread des Links: keine Anfragen an die Firmware hier
+        if ev.id == EventId.RETIME:
+            t1_us = ev.a1 & 0xFFFF
+        elif ev.id == EventId.CMD_SET and ev.a0 == 1:
+            t1_us = min(max(ev.a1, T1_MIN_US), T1_MAX_US)   # Event meldet den Rohwert
+        else:
+            return
+        if t1_us != self.t1_us:
+            try:
+                self.apply(t1_us)
+            except ValueError as e:
+                print(f"[Warnung] Erfassungsfenster für T1={t1_us} µs: {e}")
@@ -0,0 +1,164 @@
+"""
+Dekoder für das binäre Event-Log der Firmware.
+
+Die Firmware formatiert keine Texte mehr (kein printf im Betrieb), sondern
+schreibt pro Ereignis einen 16-Byte-Frame in ihren Sende-Ring:
+
+    FF 80 ID SEQ TS(4) ARG0(4) ARG1(4)      (Little Endian, TS in µs seit Reset)
+
+Hier werden die Frames dekodiert, Zeitstempel-Überläufe (32 Bit µs ≈ 71 min)
+aufgelöst, verlorene Events über die Sequenznummer erkannt und der Text
+erzeugt, den die Firmware früher selbst ausgegeben hat.
+"""
+
+from enum import IntEnum
+from typing import NamedTuple, Optional
+
+PREAMBLE = 0xFF
+EVENT_CMD = 0x80
+EVENT_SIZE = 16
+
+
+class EventId(IntEnum):
+    """Event-IDs, siehe ``evt_id_t`` in ``Core/Src/main.c``."""
+    BOOT        = 0x01
+    CMD_SET     = 0x10
+    CMD_START   = 0x11
+    CMD_STOP    = 0x12
+    CMD_RB      = 0x13
+    CMD_UNKNOWN = 0x1F
+    RX_FRAME    = 0x20
+    SEQ_START   = 0x30
+    SEQ_DONE    = 0x31
+    SEQ_STOP    = 0x32
+    WAVE_START  = 0x33
+    WAVE_DONE   = 0x34
+    CH_START    = 0x35
+    CH_DONE     = 0x36
+    CH_STOP     = 0x37
+    RETIME      = 0x38
+    RATE_START  = 0x39
+    RATE_DONE   = 0x3A
+    OVERRUN     = 0x40
+    UART_ERR    = 0x41
+    FAULT       = 0x42
+    FAULT_CLR   = 0x43
+
+
+class Event(NamedTuple):
+    """Ein dekodiertes Firmware-Event."""
+    id: int
+    seq: int
+    t_us: int       # Zeitstempel in µs seit Reset (Überläufe aufgelöst)
+    a0: int
+    a1: int
+    text: str
+
+
+def _timer_name(n: int) -> str:
+    return "T2" if n == 2 else "T1"
+
+
+def _exit_name(n: int) -> str:
+    return "hard" if n == 2 else "soft"
+
+
+def _rate_end_name(n: int) -> str:
+    return {0: "done", 1: "stopped", 2: "thermal guard"}.get(n, f"end {n}")
+
+
+def _fault_name(f: int) -> str:
+    names = [n for bit, n in ((0x01, "over-current"), (0x02, "over-voltage"), (0x80, "break"))
+             if f & bit]
+    return "/".join(names) or f"0x{f:02X}"
+
+
+# Texte wie bisher von der Firmware per printf ausgegeben (Host-Tools und Tests
+# werten einige davon aus, z.B. "CMD: SET T1 OK").
+_FORMAT = {
+    EventId.BOOT:        lambda a0, a1: f"BOOT: reset=0x{a0:08X} sysclk={a1} Hz",
+    EventId.CMD_SET:     lambda a0, a1: f"CMD: SET {_timer_name(a0)} OK (period={a1})",
+    EventId.CMD_START:   lambda a0, a1: "CMD: START (seq) OK",
+    EventId.CMD_STOP:    lambda a0, a1: "CMD: STOP (hard) OK" if a0 else "CMD: STOP (soft) requested",
+    EventId.CMD_RB:      lambda a0, a1: f"CMD: READBACK {_timer_name(a0)} OK",
+    EventId.CMD_UNKNOWN: lambda a0, a1: f"Unknown CMD: 0x{a0:02X}",
+    EventId.RX_FRAME:    lambda a0, a1: "RX: FF " + " ".join(
+        f"{b:02X}" for b in a0.to_bytes(4, "little")[:max(0, min(a1, 5) - 1)]),
+    EventId.SEQ_START:   lambda a0, a1: f"SEQ: start (pulses={a0}, cycles={a1})",
+    EventId.SEQ_DONE:    lambda a0, a1: f"SEQ: done (pulses={a0}, cycles={a1})",
+    EventId.SEQ_STOP:    lambda a0, a1: f"SEQ: stop {_exit_name(a0)} (cycles={a1})",
+    EventId.WAVE_START:  lambda a0, a1: f"WAVE: start (steps={a0}, repeats={a1})",
+    EventId.WAVE_DONE:   lambda a0, a1: f"WAVE: {'aborted' if a1 else 'done'} (passes={a0})",
+    EventId.CH_START:    lambda a0, a1: f"CH{a0}: start (pulses={a1})",
+    EventId.CH_DONE:     lambda a0, a1: f"CH{a0}: done (pulses={a1})",
+    EventId.CH_STOP:     lambda a0, a1: f"CH{a0}: stop (pulses={a1})",
+    EventId.RETIME:      lambda a0, a1: f"RETIME: T1={a1 & 0xFFFF} us T2={a1 >> 16} ms (from cycle {a0})",
+    EventId.RATE_START:  lambda a0, a1: f"RATE: start ({1e6 / a0 if a0 else 0:.2f} kHz, pulses={a1})",
+    EventId.RATE_DONE:   lambda a0, a1: f"RATE: {_rate_end_name(a1)} (pulses={a0})",
+    EventId.OVERRUN:     lambda a0, a1: (f"WARN: overrun T{a0} ({a1} cyc late)" if a0 in (1, 2)
+                                         else f"WARN: pulse train longer than T2 (t1_cnt={a1})"),
+    EventId.UART_ERR:    lambda a0, a1: f"ERR: UART error 0x{a0:X}",
+    EventId.FAULT:       lambda a0, a1: f"FAULT: {_fault_name(a0)} (cycles={a1}), bridge disabled",
+    EventId.FAULT_CLR:   lambda a0, a1: f"FAULT: cleared ({_fault_name(a0)})",
+}
+
+
+def render(event_id: int, a0: int, a1: int) -> str:
+    """Erzeugt den Text zu einem Event (unbekannte IDs werden roh ausgegeben)."""
+    fmt = _FORMAT.get(event_id)
+    if fmt is None:
+        return f"EVT 0x{event_id:02X} a0={a0} a1={a1}"
+    return fmt(a0, a1)
+
+
+class EventDecoder:
+    """
+    Dekodiert Event-Frames fortlaufend (ein Decoder pro Verbindung).
+
+    Attributes
+    ----------
+    lost : int
+        Anzahl verlorener Events (Lücken in der Sequenznummer, z.B. Sende-Ring voll).
+    """
+
+    def __init__(self):
+        self.lost = 0
+        self._last_seq: Optional[int] = None
+        self._last_ts = 0
+        self._ts_wraps = 0
+
+    def decode(self, frame: bytes) -> Event:
+        """
+        Dekodiert einen 16-Byte-Event-Frame.
+
+        Raises
+        ------
+        ValueError
+            Wenn der Frame kein Event-Frame ist.
+        """
+        if len(frame) != EVENT_SIZE or frame[0] != PREAMBLE or frame[1] != EVENT_CMD:
+            raise ValueError(f"kein Event-Frame: {frame.hex(' ')}")
+        eid, seq = frame[2], frame[3]
+        ts = int.from_bytes(frame[4:8], "little")
+        a0 = int.from_bytes(frame[8:12], "little")
+        a1 = int.from_bytes(frame[12:16], "little")
+
+        if eid == EventId.BOOT:
+            # Neustart: Zähler der Firmware beginnen von vorn
+            self._last_seq, self._last_ts, self._ts_wraps = None, 0, 0
+        if self._last_seq is not None:
+            self.lost += (seq - self._last_seq - 1) & 0xFF
+        self._last_seq = seq
+        if ts < self._last_ts:
+            self._ts_wraps += 1
+        self._last_ts = ts
+
+        t_us = (self._ts_wraps << 32) | ts
+        return Event(eid, seq, t_us, a0, a1, render(eid, a0, a1))
+
+
+def format_event(ev: Event, with_time: bool = True) -> str:
+    """Textzeile für Log/Monitor, optional mit Zeitstempel in Sekunden."""
+    if not with_time:
+        return ev.text
+    return f"[{ev.t_us / 1e6:12.6f}] {ev.text}"
@@ -0,0 +1,126 @@
+"""
+Schnellmodus der Firmware: Pulspaare mit 1..50 kHz Wiederholrate.
+
+Im Timer-Betrieb ist T2 auf ganze ms (>= 1 ms) begrenzt, weil die CPU jeden
+Zyklus startet. Im Schnellmodus läuft der Zyklus komplett in Hardware: TIM1
+erzeugt Periode und Drives, TIM8 die Enables je Zyklus, TIM2 zählt die
+Pulspaare. Die CPU bekommt einen einzigen Interrupt nach dem letzten Zyklus.
+T1 und Periode werden deshalb in ns übertragen (Raster 5.9 ns).
+
+    FF E0 T1_NS(4) PERIODE_NS(4) N(2) FLAGS         -> Antwort gleich aufgebaut, STATUS statt FLAGS
+
+Schutz: 2*T1 ist auf die halbe Periode begrenzt, dazu führt die Firmware ein
+Wärmebudget (Einschaltzeit minus 10 % Dauer-Tastgrad). Ist es erschöpft,
+endet der Lauf (Event RATE_DONE mit Grund ``guard``) und ein Neustart wird
+abgelehnt, bis die Hälfte abgebaut ist. STOP hart/soft und CONFIG beenden
+den Schnellmodus, STATUS meldet ``state = 4``.
+"""
+
+from typing import NamedTuple
+
+PREAMBLE = 0xFF
+RATE_CMD = 0xE0
+RATE_SIZE = 13
+
+RATE_F_START = 0x01
+
+RATE_ST_RUNNING = 0x01
+RATE_ST_CLAMPED = 0x02
+RATE_ST_GUARD = 0x04
+RATE_ST_REJECT = 0x80
+
+PERIOD_NS_MIN = 20_000       # 50 kHz
+PERIOD_NS_MAX = 1_000_000    # 1 kHz, darunter Timer-Betrieb
+T1_NS_MIN = 500
+DUTY_MAX = 0.5               # 2*T1 / Periode
+COOL_US_PER_MS = 100         # Wärmebudget: dauerhaft zulässige Einschaltzeit je ms
+HEAT_MAX_US = 2_000_000      # Überschuss bis zum Guard
+SYSCLK_HZ = 170_000_000
+
+RATE_END_DONE, RATE_END_STOP, RATE_END_GUARD = 0, 1, 2
+
+
+class RateAck(NamedTuple):
+    """Antwort auf RATE: erreichte Werte des Schnellmodus."""
+    t1_ns: int
+    period_ns: int
+    pulse_count: int        # 0 = endlos
+    running: bool
+    clamped: bool
+    guard: bool             # Wärmebudget erschöpft, Start gesperrt
+    rejected: bool
+
+    @property
+    def rate_hz(self) -> float:
+        return 1e9 / self.period_ns if self.period_ns else 0.0
+
+    @property
+    def duty(self) -> float:
+        """Tastgrad 2*T1 / Periode."""
+        return 2 * self.t1_ns / self.period_ns if self.period_ns else 0.0
+
+
+def _ticks(ns: int, div: int) -> int:
+    return (ns * 17 + div // 2) // div
+
+
+def _ns(ticks: int, div: int) -> int:
+    return (ticks * div + 8) // 17
+
+
+def rate_grid(t1_ns: int, period_ns: int) -> tuple[int, int, bool]:
+    """
+    T1 und Periode auf das Timer-Raster legen wie ``rate_setup()`` der Firmware.
+
+    Returns
+    -------
+    tuple[int, int, bool]
+        Erreichtes T1 in ns, erreichte Periode in ns, begrenzt ja/nein.
+    """
+    per = min(max(int(period_ns), PERIOD_NS_MIN), PERIOD_NS_MAX)
+    t1 = min(max(int(t1_ns), T1_NS_MIN), per)
+    psc = (_ticks(per, 100) - 1) >> 16
+    div = 100 * (psc + 1)
+    per_t, t1_t = _ticks(per, div), _ticks(t1, div)
+    clamped = per != period_ns or t1 != t1_ns
+    t1_max = per_t * 50 // 200
+    if t1_t > t1_max:
+        t1_t, clamped = t1_max, True
+    return _ns(t1_t, div), _ns(per_t, div), clamped
+
+
+def on_us_per_ms(t1_ns: int, period_ns: int) -> int:
+    """Einschaltzeit je ms Laufzeit, mit der die Firmware das Wärmebudget belastet."""
+    return 2000 * t1_ns // period_ns if period_ns else 0
+
+
+def guard_after_ms(t1_ns: int, period_ns: int, heat_us: int = 0) -> float:
+    """Laufzeit in ms bis zum Guard (``inf``, wenn der Tastgrad dauerhaft zulässig ist)."""
+    net = on_us_per_ms(t1_ns, period_ns) - COOL_US_PER_MS
+    return (HEAT_MAX_US - heat_us) / net if net > 0 else float("inf")
+
+
+def encode_rate_frame(t1_ns: int, period_ns: int, pulse_count: int = 0, *,
+                      start: bool = True) -> bytes:
+    """Baut den 13-Byte-RATE-Frame."""
+    return (bytes([PREAMBLE, RATE_CMD]) + int(t1_ns).to_bytes(4, "little")
+            + int(period_ns).to_bytes(4, "little") + int(pulse_count).to_bytes(2, "little")
+            + bytes([RATE_F_START if start else 0]))
+
+
+def decode_rate_frame(frame: bytes) -> tuple[int, int, int, int]:
+    """T1 ns, Periode ns, Pulspaare und Flags eines RATE-Frames (Simulator, Tests)."""
+    if len(frame) != RATE_SIZE or frame[0] != PREAMBLE or frame[1] != RATE_CMD:
+        raise ValueError(f"kein RATE-Frame: {frame.hex(' ')}")
+    return (int.from_bytes(frame[2:6], "little"), int.from_bytes(frame[6:10], "little"),
+            int.from_bytes(frame[10:12], "little"), frame[12])
+
+
+def decode_rate_ack(frame: bytes) -> RateAck:
+    """Dekodiert die Antwort auf RATE."""
+    t1, per, n, status = decode_rate_frame(frame)
+    return RateAck(t1, per, n,
+                   running=bool(status & RATE_ST_RUNNING),
+                   clamped=bool(status & RATE_ST_CLAMPED),
+                   guard=bool(status & RATE_ST_GUARD),
+                   rejected=bool(status & RATE_ST_REJECT))
@@ -0,0 +1,126 @@
+"""
+Mehrkanalbetrieb der Firmware: bis zu 3 Vollbrücken (DUTs) parallel am HRTIM.
+
+Jeder Kanal hat eigenes T1, T2 und eine eigene Pulszahl. Die Flanken des
+Pulspaars erzeugt der HRTIM (Raster 184 ps, bei langen Pulsen ein Vielfaches
+davon), die CPU startet nur das Pulspaar je Zyklus. T1 wird deshalb in ps
+übertragen.
+
+    FF C0 KANAL T1_PS(4) T2_MS(2) N(2) FLAGS        -> Antwort gleich aufgebaut, STATUS statt FLAGS
+    FF C1 KANAL 00 FLAGS                            -> Antwort FF C1 KANAL STATUS GEFEUERT(4) REST(2)
+
+Solange ein Kanal konfiguriert oder gestartet ist, läuft die Firmware im
+Zustand MULTI (STATUS ``state = 3``); Einzelbrücke, FIRE und WAVE sind dann
+gesperrt. ``CHAN_F_EXIT``, STOP hart und CONFIG beenden den Mehrkanalbetrieb.
+"""
+
+from typing import NamedTuple
+
+PREAMBLE = 0xFF
+CHAN_CMD = 0xC0          # Kanal setzen (+ starten)
+CHAN_CTRL_CMD = 0xC1     # Kanal starten/stoppen, Mehrkanalbetrieb verlassen
+CHAN_SIZE = 12
+CHAN_ST_SIZE = 10
+CHANNELS = 3
+
+CHAN_F_START = 0x01
+CHAN_F_STOP = 0x02
+CHAN_F_EXIT = 0x80
+
+CHAN_ST_RUNNING = 0x01
+CHAN_ST_CLAMPED = 0x02
+CHAN_ST_MULTI = 0x04
+CHAN_ST_REJECT = 0x80
+
+T1_PS_MIN = 1_000_000        # 1 µs
+T1_PS_MAX = 750_000_000      # 750 µs
+T2_MS_MIN, T2_MS_MAX = 1, 10000
+HR_PS_PER_TICK = 100000 / 544   # 1 / (170 MHz * 32) = 183.8 ps
+
+
+class ChannelAck(NamedTuple):
+    """Antwort auf CHAN: übernommene Werte eines Kanals."""
+    channel: int
+    t1_ps: int              # erreichtes T1 (Tick-Raster des HRTIM)
+    t2_ms: int
+    pulse_count: int        # 0 = endlos
+    running: bool
+    clamped: bool
+    multi: bool             # Mehrkanalbetrieb aktiv
+    rejected: bool
+
+    @property
+    def t1_us(self) -> float:
+        return self.t1_ps / 1e6
+
+
+class ChannelState(NamedTuple):
+    """Antwort auf CHAN_CTRL: Zählerstand eines Kanals."""
+    channel: int
+    running: bool
+    multi: bool
+    rejected: bool
+    fired: int              # gestartete Pulspaare seit dem letzten Start
+    remaining: int          # 0 = endlos bzw. fertig
+
+
+def t1_grid(t1_ps: int) -> tuple[int, float]:
+    """
+    T1 auf das HRTIM-Raster legen wie ``hr_setup()`` der Firmware.
+
+    Returns
+    -------
+    tuple[int, float]
+        Erreichtes T1 in ps und Auflösung in ps (184 ps << Prescaler).
+    """
+    ps = min(max(int(t1_ps), T1_PS_MIN), T1_PS_MAX)
+    hr = (ps * 544 + 50000) // 100000
+    psc = 0
+    while True:
+        t1t = (hr + ((1 << psc) >> 1)) >> psc
+        lead = max(5440 >> psc, 0x60)
+        if 2 * (lead + t1t) <= 0xFFDF or psc == 7:
+            break
+        psc += 1
+    return ((t1t << psc) * 100000 + 272) // 544, (1 << psc) * HR_PS_PER_TICK
+
+
+def encode_channel_frame(channel: int, t1_ps: int, t2_ms: int, pulse_count: int = 0, *,
+                         start: bool = True) -> bytes:
+    """Baut den 12-Byte-CHAN-Frame."""
+    if not 0 <= channel < CHANNELS:
+        raise ValueError(f"Kanal {channel} ungültig (0..{CHANNELS - 1})")
+    return (bytes([PREAMBLE, CHAN_CMD, channel]) + int(t1_ps).to_bytes(4, "little")
+            + int(t2_ms).to_bytes(2, "little") + int(pulse_count).to_bytes(2, "little")
+            + bytes([CHAN_F_START if start else 0]))
+
+
+def decode_channel_frame(frame: bytes) -> tuple[int, int, int, int, int]:
+    """Kanal, T1 ps, T2 ms, Pulspaare und Flags eines CHAN-Frames (Simulator, Tests)."""
+    if len(frame) != CHAN_SIZE or frame[0] != PREAMBLE or frame[1] != CHAN_CMD:
+        raise ValueError(f"kein CHAN-Frame: {frame.hex(' ')}")
+    return (frame[2], int.from_bytes(frame[3:7], "little"), int.from_bytes(frame[7:9], "little"),
+            int.from_bytes(frame[9:11], "little"), frame[11])
+
+
+def decode_channel_ack(frame: bytes) -> ChannelAck:
+    """Dekodiert die Antwort auf CHAN."""
+    ch, t1, t2, n, status = decode_channel_frame(frame)
+    return ChannelAck(ch, t1, t2, n,
+                      running=bool(status & CHAN_ST_RUNNING),
+                      clamped=bool(status & CHAN_ST_CLAMPED),
+                      multi=bool(status & CHAN_ST_MULTI),
+                      rejected=bool(status & CHAN_ST_REJECT))
+
+
+def decode_channel_state(frame: bytes) -> ChannelState:
+    """Dekodiert die Antwort auf CHAN_CTRL."""
+    status = frame[3]
+    return ChannelState(
+        channel=frame[2],
+        running=bool(status & CHAN_ST_RUNNING),
+        multi=bool(status & CHAN_ST_MULTI),
+        rejected=bool(status & CHAN_ST_REJECT),
+        fired=int.from_bytes(frame[4:8], "little"),
+        remaining=int.from_bytes(frame[8:10], "little"),
+    )
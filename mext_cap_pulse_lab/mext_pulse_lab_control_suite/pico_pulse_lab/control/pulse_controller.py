@@ -0,0 +1,215 @@
+"""
+Ablaufsteuerung zwischen STM32-Pulsquelle und PicoScope-Erfassung.
+
+Zwei Betriebsarten:
+
+- getriggert: Scope armen -> Firmware feuert genau ein Pulspaar (bzw. N im
+  Rapid-Block-Modus) -> Erfassung abwarten -> nächster Block. Kein Puls geht
+  verloren, egal wie lange Speicherung/Verarbeitung dauern.
+- freilaufend: Firmware läuft im eigenen T2-Takt, das Scope wird so schnell wie
+  möglich neu gearmt. Nach jeder Erfassung wird der Zykluszähler der Firmware
+  gelesen; Differenzen werden als verpasste Pulse gemeldet.
+"""
+
+import time
+from typing import Optional
+
+from pico_pulse_lab.control.stm32_uart import NucleoLink
+
+
+class PulseController:
+    """
+    Koordiniert NucleoLink (STM32) und PicoReader (PicoScope).
+
+    Parameters
+    ----------
+    link : NucleoLink
+        Verbundener UART-Client der Firmware.
+    reader : PicoReader
+        Konfigurierter PicoReader (``configure()`` bereits aufgerufen).
+    reply_timeout_s : float, optional
+        Timeout für Firmware-Antworten in Sekunden, by default 2.0
+    arm_margin_s : float, optional
+        Zusätzliche Wartezeit nach dem Armen, bevor gefeuert wird, by default 0.002
+    window : WindowTracker, optional
+        Führt das Erfassungsfenster des Readers mit T1 nach (auch nach CONFIG,
+        das kein Event auslöst), by default None
+
+    Examples
+    --------
+    >>> ctrl = PulseController(nuc, reader)
+    >>> report = ctrl.run_triggered(100, t1_us=200, t2_ms=50)
+    >>> print(report['captured'], report['missed'])
+    """
+
+    def __init__(self, link: NucleoLink, reader, *, reply_timeout_s: float = 2.0,
+                 arm_margin_s: float = 0.002, window=None):
+        self.link = link
+        self.reader = reader
+        self.window = window
+        self.reply_timeout_s = reply_timeout_s
+        self.arm_margin_s = arm_margin_s
+        self.missed_at = []         # (pulse_id, verpasste Pulse davor)
+        self._cycles_start = 0
+        self._cycles_last = 0
+
+    # -------- Hilfen --------
+    def _configure(self, t1_us: int, t2_ms: int) -> None:
+        """CONFIG ohne Start; das Fenster folgt dem von der Firmware übernommenen T1."""
+        ack = self.link.configure(t1_us, t2_ms, 0, arm=False).result(self.reply_timeout_s)
+        if self.window is not None:
+            self.window.apply(ack.t1_us)
+
+    def _cycles(self) -> int:
+        """Liest den Zykluszähler (abgeschlossene Pulspaare) der Firmware."""
+        return self.link.cycle_count().result(self.reply_timeout_s).cycles
+
+    def _wait_idle(self, timeout_s: float) -> int:
+        """Wartet bis die Firmware keine Sequenz mehr fährt und liefert den Zähler."""
+        end = time.monotonic() + timeout_s
+        while True:
+            ack = self.link.cycle_count().result(self.reply_timeout_s)
+            if not ack.running or time.monotonic() > end:
+                return ack.cycles
+            time.sleep(0.005)
+
+    def _pretrigger_s(self) -> float:
+        """Zeit, bis das Scope nach RunBlock seine Pretrigger-Samples gesammelt hat."""
+        dt = getattr(self.reader, "dt", None) or 0.0
+        return self.reader.pre_samples * dt + self.arm_margin_s
+
+    def _report(self, mode: str, captured: int, cycles_end: int) -> dict:
+        fired = cycles_end - self._cycles_start
+        return {
+            'mode': mode,
+            'captured': captured,
+            'fired': fired,
+            'missed': max(0, fired - captured),
+            'missed_at': list(self.missed_at),
+            'cycles_start': self._cycles_start,
+            'cycles_end': cycles_end,
+        }
+
+    # -------- Betriebsarten --------
+    def run_triggered(self, n_pulses: int, *, t1_us: Optional[int] = None,
+                      t2_ms: Optional[int] = None, pulses_per_arm: int = 1,
+                      capture_timeout_s: float = 5.0, save_csv: bool = False,
+                      save_npz: bool = True) -> dict:
+        """
+        Getriggerter Betrieb: pro Arm feuert die Firmware genau ``pulses_per_arm`` Pulspaare.
+
+        Parameters
+        ----------
+        n_pulses : int
+            Anzahl zu erfassender Pulse.
+        t1_us, t2_ms : int, optional
+            Falls gesetzt, vorher per CONFIG (ohne Start) übernehmen.
+        pulses_per_arm : int, optional
+            1 = Einzelpuls pro Arm, >1 = Rapid-Block mit N Segmenten, by default 1
+        capture_timeout_s : float, optional
+            Maximale Wartezeit auf den Trigger pro Block, by default 5.0
+        save_csv, save_npz : bool, optional
+            Speicherung wie bei ``PicoReader.start_measurement``.
+
+        Returns
+        -------
+        dict
+            captured, fired, missed, missed_at, cycles_start, cycles_end
+        """
+        if t1_us is not None and t2_ms is not None:
+            self._configure(t1_us, t2_ms)
+        elif self.window is not None:
+            self.window.sync(self.reply_timeout_s)
+        self.missed_at = []
+        self._cycles_start = self._cycles()
+        captured_before = self.reader.pulse_count
+
+        def on_armed(pulse_id: int, n_captures: int):
+            time.sleep(self._pretrigger_s())
+            ack = self.link.fire(n_captures).result(self.reply_timeout_s)
+            if ack.busy:
+                raise RuntimeError("Firmware lehnt FIRE ab: Sequenz läuft bereits")
+            if ack.rejected:
+                raise RuntimeError("Firmware lehnt FIRE ab: Schutz ausgelöst, erst quittieren")
+
+        self.reader.set_armed_callback(on_armed)
+        try:
+            self.reader.start_measurement(
+                n_pulses=n_pulses,
+                save_csv=save_csv,
+                save_npz=save_npz,
+                captures_per_arm=pulses_per_arm,
+                capture_timeout_s=capture_timeout_s,
+            )
+        finally:
+            self.reader.set_armed_callback(None)
+
+        cycles_end = self._wait_idle(self.reply_timeout_s)
+        return self._report('triggered', self.reader.pulse_count - captured_before, cycles_end)
+
+    def run_free(self, n_pulses: int, *, t1_us: int, t2_ms: int,
+                 capture_timeout_s: Optional[float] = None, save_csv: bool = False,
+                 save_npz: bool = True) -> dict:
+        """
+        Freilaufender Betrieb mit Abgleich gegen den Zykluszähler der Firmware.
+
+        Die Firmware wird erst gestartet, wenn das Scope das erste Mal scharf ist.
+        Nach jeder Erfassung gilt: alle seit dem Start abgeschlossenen Zyklen, die
+        nicht erfasst wurden, sind verpasst.
+
+        Returns
+        -------
+        dict
+            captured, fired, missed, missed_at, cycles_start, cycles_end
+        """
+        self._configure(t1_us, t2_ms)
+        self.missed_at = []
+        self._cycles_start = self._cycles_last = self._cycles()
+        captured_before = self.reader.pulse_count
+        if capture_timeout_s is None:
+            capture_timeout_s = 3 * t2_ms / 1000.0 + 1.0
+
+        started = False
+        user_cb = self.reader.on_pulse_callback
+
+        def on_armed(pulse_id: int, n_captures: int):
+            nonlocal started
+            if not started:
+                time.sleep(self._pretrigger_s())
+                ack = self.link.configure(t1_us, t2_ms, 0, arm=True).result(self.reply_timeout_s)
+                if ack.rejected:
+                    raise RuntimeError("Firmware startet nicht: Schutz ausgelöst, erst quittieren")
+                started = True
+
+        def on_pulse(pulse_id, t, u, i):
+            cycles = self._cycles()
+            captured = self.reader.pulse_count - captured_before + 1   # dieser Puls zählt mit
+            missed_total = cycles - self._cycles_start - captured
+            missed_before = sum(n for _, n in self.missed_at)
+            if missed_total > missed_before:
+                self.missed_at.append((pulse_id, missed_total - missed_before))
+            self._cycles_last = cycles
+            if user_cb:
+                user_cb(pulse_id, t, u, i)
+
+        self.reader.set_armed_callback(on_armed)
+        self.reader.set_callback(on_pulse)
+        try:
+            self.reader.start_measurement(
+                n_pulses=n_pulses,
+                save_csv=save_csv,
+                save_npz=save_npz,
+                capture_timeout_s=capture_timeout_s,
+            )
+        finally:
+            self.reader.set_armed_callback(None)
+            self.reader.set_callback(user_cb)
+            self.link.stop_timer(hard=True).result(self.reply_timeout_s)
+
+        # Zyklen nach der letzten Erfassung wurden nicht mehr angefordert
+        return self._report('free', self.reader.pulse_count - captured_before, self._cycles_last)
+
+    def stop(self) -> None:
+        """Bricht die laufende Erfassung ab und stoppt die Firmware sofort."""
+        self.reader.stop()
+        self.link.stop_timer(hard=True).result(self.reply_timeout_s)
@@ -1,6 +1,25 @@
 import serial
 from enum import IntEnum
 import time
+import asyncio
+import threading
+from collections import deque
+from concurrent.futures import Future
+from typing import Callable, NamedTuple, Optional
+
+from pico_pulse_lab.control.event_log import EVENT_CMD, EVENT_SIZE, Event, EventDecoder
+from pico_pulse_lab.control.adc_record import (ADC_REC_CMD, ADC_REC_SIZE, ADC_ST_ON, ADC_ST_READY,
+                                               AdcRecord, decode_adc_record)
+from pico_pulse_lab.control.waveform import (WAVE_ACK_SIZE, WAVE_CMD, WAVE_CTRL_CMD, WAVE_F_CLEAR,
+                                             WAVE_F_LOAD, WAVE_F_RUN, WAVE_F_SAVE, WAVE_F_STOP,
+                                             WaveAck, Waveform, crc16, decode_wave_ack,
+                                             encode_wave_frames)
+from pico_pulse_lab.control.multichannel import (CHAN_CMD, CHAN_CTRL_CMD, CHAN_F_EXIT, CHAN_F_START,
+                                                 CHAN_F_STOP, CHAN_SIZE, CHAN_ST_SIZE, ChannelAck,
+                                                 ChannelState, decode_channel_ack,
+                                                 decode_channel_state, encode_channel_frame)
+from pico_pulse_lab.control.high_rate import (RATE_CMD, RATE_SIZE, RateAck, decode_rate_ack,
+                                              encode_rate_frame)
 
 PREAMBLE = 0xFF
 FRAME_SIZE = 5  # Frame-Größe in Bytes
@@ -17,7 +36,168 @@ class CmdBase(IntEnum):
     START    = 0x20  # Timer1: 0x20, Timer2: 0x21
     STOP     = 0x30  # Timer1: 0x30, Timer2: 0x31
     READBACK = 0x40  # Timer1: 0x40, Timer2: 0x41
+    CONFIG   = 0x50  # configure-and-arm (T1, T2, Pulsanzahl, Flags in einem Frame)
+    FIRE     = 0x60  # genau N Pulspaare feuern (N = 0: nur Zykluszähler lesen)
+    STATUS   = 0x70  # Telemetrie-Snapshot (Zustand, Zähler, Latenz, Uptime)
+    ADC      = 0x90  # ADC-Messdaten je Pulspaar ein/aus (value = Dezimierung)
+    PROT     = 0xA0  # Schutzschwellen: 0xA0 = Strom, 0xA1 = Spannung; Fehler quittieren
+    WAVE     = 0xB0  # Zustandsfolge: 0xB0 = Schritte hochladen, 0xB1 = Steuerung
+    CHAN     = 0xC0  # HRTIM-Kanäle (Mehrkanal): 0xC0 = Kanal setzen, 0xC1 = Steuerung
+    RETIME   = 0xD0  # neue T1/T2 im laufenden Betrieb, wirksam an einer Zyklusgrenze
+    RATE     = 0xE0  # Schnellmodus: Pulspaare mit 1..50 kHz, Zyklus komplett in Hardware
+
+
+T1_F_HW_SYNC = 0x02    # SET-/CONFIG-Flags T1: TIM2-Update startet TIM1 per Hardware (Master/Slave)
+
+CONFIG_SIZE = 11       # CONFIG-Frame: FF 50 T1(2) T2(2) N(2) FLAGS_T1 FLAGS_T2 CFG_FLAGS
+CONFIG_ACK_SIZE = 9    # ACK:          FF 50 T1(2) T2(2) N(2) STATUS
+CFG_F_ARM = 0x01       # CFG_FLAGS: nach dem Übernehmen sofort starten
+CFG_ST_ARMED = 0x01    # STATUS: Sequenz läuft
+CFG_ST_CLAMPED = 0x02  # STATUS: mindestens ein Wert wurde von der Firmware begrenzt
+CFG_ST_REJECT = 0x80   # STATUS: Start abgelehnt, Fehler-Latch gesetzt
+
+RETIME_SIZE = 6        # RETIME-Frame: FF D0 T1(2) T2(2), 0 = Wert unverändert
+RETIME_ACK_SIZE = 11   # ACK:          FF D0 T1(2) T2(2) UMSCHALTZYKLUS(4) STATUS
+RT_ST_PENDING = 0x01   # STATUS: Sequenz läuft, Umschaltung steht noch aus
+RT_ST_CLAMPED = 0x02   # STATUS: T1/T2 von der Firmware begrenzt
+
+FIRE_ACK_SIZE = 9      # ACK: FF 60 CYCLES(4) REMAINING(2) STATUS
+FIRE_ST_RUNNING = 0x01 # STATUS: Sequenz läuft
+FIRE_ST_BUSY = 0x02    # STATUS: FIRE abgelehnt, Sequenz lief bereits
+FIRE_ST_REJECT = 0x80  # STATUS: FIRE abgelehnt, Fehler-Latch gesetzt
+
+STATUS_SIZE = 28       # FF 70 STATE EXIT CYCLES(4) REMAINING(2) RX_DROP(2) LAT_MAX(2) OVR(2) UPTIME(4) ISR_MAX(2)
+                       #       FAULT FAULT_PHASE FAULT_CYCLE(4)
+STATUS_F_CLR_PEAK = 0x01  # Flags: Spitzenwerte (Latenz, ISR-Laufzeit) nach dem Lesen zurücksetzen
+CPU_CLK_HZ = 170_000_000  # SYSCLK der Firmware (DWT-Zyklenzähler)
+
+PROT_CURRENT = 1          # PROT-Kanal: Überstrom (COMP1, PA1)
+PROT_VOLTAGE = 2          # PROT-Kanal: Überspannung (COMP3, PA0)
+PROT_F_RESET = 0x01       # PROT-Flags: Fehler quittieren
+PROT_F_OC = 0x01          # Fehler-Latch: Überstrom
+PROT_F_OV = 0x02          # Fehler-Latch: Überspannung
+PROT_F_BRK = 0x80         # Fehler-Latch: Break ohne anstehenden Komparator
+
+# Frames, die die Firmware unaufgefordert sendet (Länge inkl. Preamble und CMD)
+UNSOLICITED: dict[int, int] = {
+    EVENT_CMD: EVENT_SIZE,          # Event-Log, siehe event_log.py
+    ADC_REC_CMD: ADC_REC_SIZE,      # ADC-Messdaten je Pulspaar, siehe adc_record.py
+}
+
+
+class ConfigAck(NamedTuple):
+    """Von der Firmware übernommene Werte nach CONFIG."""
+    t1_us: int
+    t2_ms: int
+    pulse_count: int
+    armed: bool
+    clamped: bool
+    rejected: bool          # Start verlangt, aber Fehler-Latch gesetzt (erst quittieren)
+
+
+class RetimeAck(NamedTuple):
+    """Antwort auf RETIME: übernommene Werte und Zyklus, ab dem sie gelten."""
+    t1_us: int
+    t2_ms: int
+    switch_cycle: int       # Zykluszähler vor dem ersten Pulspaar mit den neuen Werten
+    pending: bool           # Sequenz läuft, Umschaltung an der Zyklusgrenze steht aus
+    clamped: bool
+
+
+class FireAck(NamedTuple):
+    """Antwort auf FIRE: Zykluszähler der Firmware zum Zeitpunkt des Kommandos."""
+    cycles: int
+    remaining: int
+    running: bool
+    busy: bool
+    rejected: bool          # Fehler-Latch gesetzt, nichts gestartet (erst quittieren)
+
+
+class AdcAck(NamedTuple):
+    """Antwort auf das ADC-Kommando."""
+    decimation: int         # jeder N-te Zyklus wird gesendet, 0 = aus
+    ready: bool             # ADC der Firmware initialisiert
+    on: bool                # Aufzeichnung aktiv
+
+
+class ProtAck(NamedTuple):
+    """Antwort auf PROT: aktive Schwelle (DAC-Rohwert, Skala wie ADC) und Fehler-Latch."""
+    threshold: int
+    fault: int
+
+    @property
+    def faulted(self) -> bool:
+        return self.fault != 0
+
+
+class Status(NamedTuple):
+    """Telemetrie-Snapshot der Firmware (Antwort auf STATUS)."""
+    state: int              # 0 = IDLE, 1 = RUN, 2 = WAVE (Zustandsfolge läuft), 3 = MULTI (HRTIM),
+                            # 4 = RATE (Schnellmodus)
+    exit: int               # 0 = keiner, 1 = Soft-Stop angefordert, 2 = Hard-Stop
+    cycles: int             # abgeschlossene Pulspaare seit Reset
+    remaining: int          # verbleibende Pulspaare (0 = Endlos/keine Sequenz)
+    rx_dropped: int         # verworfene UART-Frames
+    isr_latency_max: int    # max. ISR-Latenz in CPU-Takten
+    overruns: int           # Zyklen/Pulse, die nicht rechtzeitig fertig wurden
+    uptime_ms: int
+    isr_exec_max: int       # max. Laufzeit der Puls-ISRs (TIM1/TIM2) in CPU-Takten
+    fault: int = 0          # Schutz-Latch (PROT_F_*), 0 = kein Fehler
+    fault_phase: int = 0    # Puls beim Auslösen: 0 = keiner, 1 = positiv, 2 = negativ
+    fault_cycle: int = 0    # abgeschlossene Pulspaare vor dem Auslösen
+
+    @property
+    def running(self) -> bool:
+        return self.state == 1
+
+    @property
+    def wave_running(self) -> bool:
+        return self.state == 2
+
+    @property
+    def multi_active(self) -> bool:
+        """Mehrkanalbetrieb (HRTIM) aktiv, Einzelbrücke gesperrt."""
+        return self.state == 3
 
+    @property
+    def rate_active(self) -> bool:
+        """Schnellmodus läuft (``cycles`` zählt dessen Pulspaare mit)."""
+        return self.state == 4
+
+    @property
+    def faulted(self) -> bool:
+        return self.fault != 0
+
+    @property
+    def fault_text(self) -> str:
+        """Fehler als Text, z.B. "Überstrom in Puls+ von Zyklus 12"."""
+        return describe_fault(self.fault, self.fault_phase, self.fault_cycle)
+
+    @property
+    def isr_latency_us(self) -> float:
+        return self.isr_latency_max * 1e6 / CPU_CLK_HZ
+
+    @property
+    def isr_exec_us(self) -> float:
+        return self.isr_exec_max * 1e6 / CPU_CLK_HZ
+
+
+
+def describe_fault(fault: int, phase: int = 0, cycle: int = 0) -> str:
+    """Text zum Fehler-Latch der Firmware."""
+    if not fault:
+        return "kein Fehler"
+    names = []
+    if fault & PROT_F_OC:
+        names.append("Überstrom")
+    if fault & PROT_F_OV:
+        names.append("Überspannung")
+    if fault & PROT_F_BRK:
+        names.append("Break-Impuls")
+    where = {1: "Puls+", 2: "Puls-"}.get(phase)
+    # Zyklus der Auslösung: im Puls ist es das gerade laufende Paar
+    return "/".join(names) + (f" in {where} von Zyklus {cycle + 1}" if where
+                              else f" nach Zyklus {cycle}")
 
 
 """ 
@@ -80,6 +260,147 @@ def _lsb_msb_to_u16(lsb: int, msb: int) -> int:
     """
     return ((msb & 0xFF) << 8) | (lsb & 0xFF)
 
+def _build_frame(cmd: int, value: int = 0, flags: int = 0) -> bytes:
+    """Setzt einen 5-Byte-Kommandoframe zusammen.
+
+    Parameters
+    ----------
+    cmd : int
+        Befehlscode (z.B. 0x10 für SET T1)
+    value : int, optional
+        16-Bit-Nutzwert, by default 0
+    flags : int, optional
+        Flag-Byte, by default 0
+
+    Returns
+    -------
+    bytes
+        Der 5-Byte-Frame
+    """
+    lsb, msb = _u16_to_lsb_msb(value)
+    return bytes([PREAMBLE, cmd & 0xFF, lsb, msb, flags & 0xFF])
+
+def _decode_readback(frame: bytes) -> tuple[int, int]:
+    """Dekodiert einen READBACK-Antwortframe zu (Wert, Flags)."""
+    return _lsb_msb_to_u16(frame[2], frame[3]), frame[4] & 0xFF
+
+def _build_config_frame(t1_us: int, t2_ms: int, pulse_count: int, *, arm: bool,
+                        t1_flags: int = 0, t2_flags: int = 0) -> bytes:
+    """Setzt den CONFIG-Frame (configure-and-arm) zusammen.
+
+    Parameters
+    ----------
+    t1_us : int
+        Pulsdauer T1 in µs (10..1000)
+    t2_ms : int
+        Zykluszeit T2 in ms (1..10000)
+    pulse_count : int
+        Anzahl Zyklen, 0 = endlos bis STOP
+    arm : bool
+        Sequenz direkt nach dem Übernehmen starten
+    t1_flags, t2_flags : int, optional
+        Flag-Bytes wie bei SET, by default 0
+
+    Returns
+    -------
+    bytes
+        Der 11-Byte-Frame
+    """
+    t1 = _u16_to_lsb_msb(t1_us)
+    t2 = _u16_to_lsb_msb(t2_ms)
+    n = _u16_to_lsb_msb(pulse_count)
+    return bytes([PREAMBLE, CmdBase.CONFIG, *t1, *t2, *n,
+                  t1_flags & 0xFF, t2_flags & 0xFF, CFG_F_ARM if arm else 0])
+
+def _decode_config_ack(frame: bytes) -> ConfigAck:
+    """Dekodiert den ACK-Frame auf CONFIG."""
+    status = frame[8]
+    return ConfigAck(
+        t1_us=_lsb_msb_to_u16(frame[2], frame[3]),
+        t2_ms=_lsb_msb_to_u16(frame[4], frame[5]),
+        pulse_count=_lsb_msb_to_u16(frame[6], frame[7]),
+        armed=bool(status & CFG_ST_ARMED),
+        clamped=bool(status & CFG_ST_CLAMPED),
+        rejected=bool(status & CFG_ST_REJECT),
+    )
+
+def _build_retime_frame(t1_us: int = 0, t2_ms: int = 0) -> bytes:
+    """Setzt den RETIME-Frame zusammen (0 = Wert unverändert lassen)."""
+    return bytes([PREAMBLE, CmdBase.RETIME, *_u16_to_lsb_msb(t1_us), *_u16_to_lsb_msb(t2_ms)])
+
+def _decode_retime_ack(frame: bytes) -> RetimeAck:
+    """Dekodiert den ACK-Frame auf RETIME."""
+    status = frame[10]
+    return RetimeAck(
+        t1_us=_lsb_msb_to_u16(frame[2], frame[3]),
+        t2_ms=_lsb_msb_to_u16(frame[4], frame[5]),
+        switch_cycle=int.from_bytes(frame[6:10], "little"),
+        pending=bool(status & RT_ST_PENDING),
+        clamped=bool(status & RT_ST_CLAMPED),
+    )
+
+def _decode_fire_ack(frame: bytes) -> FireAck:
+    """Dekodiert den ACK-Frame auf FIRE."""
+    status = frame[8]
+    return FireAck(
+        cycles=int.from_bytes(frame[2:6], "little"),
+        remaining=_lsb_msb_to_u16(frame[6], frame[7]),
+        running=bool(status & FIRE_ST_RUNNING),
+        busy=bool(status & FIRE_ST_BUSY),
+        rejected=bool(status & FIRE_ST_REJECT),
+    )
+
+def _decode_status(frame: bytes) -> Status:
+    """Dekodiert den STATUS-Frame."""
+    return Status(
+        state=frame[2],
+        exit=frame[3],
+        cycles=int.from_bytes(frame[4:8], "little"),
+        remaining=_lsb_msb_to_u16(frame[8], frame[9]),
+        rx_dropped=_lsb_msb_to_u16(frame[10], frame[11]),
+        isr_latency_max=_lsb_msb_to_u16(frame[12], frame[13]),
+        overruns=_lsb_msb_to_u16(frame[14], frame[15]),
+        uptime_ms=int.from_bytes(frame[16:20], "little"),
+        isr_exec_max=_lsb_msb_to_u16(frame[20], frame[21]),
+        fault=frame[22],
+        fault_phase=frame[23],
+        fault_cycle=int.from_bytes(frame[24:28], "little"),
+    )
+
+def _decode_prot_ack(frame: bytes) -> ProtAck:
+    """Dekodiert die Antwort auf PROT."""
+    return ProtAck(threshold=_lsb_msb_to_u16(frame[2], frame[3]), fault=frame[4])
+
+
+def _decode_adc_ack(frame: bytes) -> AdcAck:
+    """Dekodiert die Antwort auf das ADC-Kommando."""
+    return AdcAck(
+        decimation=_lsb_msb_to_u16(frame[2], frame[3]),
+        ready=bool(frame[4] & ADC_ST_READY),
+        on=bool(frame[4] & ADC_ST_ON),
+    )
+
+
+# Länge der binären Antwortframes je Befehlscode (inkl. Preamble und CMD).
+# Codes, die hier fehlen, werden mit FRAME_SIZE gelesen.
+REPLY_LEN: dict[int, int] = {
+    _code_for_timer(CmdBase.READBACK, 1): FRAME_SIZE,
+    _code_for_timer(CmdBase.READBACK, 2): FRAME_SIZE,
+    CmdBase.CONFIG: CONFIG_ACK_SIZE,
+    CmdBase.FIRE: FIRE_ACK_SIZE,
+    CmdBase.RETIME: RETIME_ACK_SIZE,
+    CmdBase.STATUS: STATUS_SIZE,
+    CmdBase.ADC: FRAME_SIZE,
+    _code_for_timer(CmdBase.PROT, PROT_CURRENT): FRAME_SIZE,
+    _code_for_timer(CmdBase.PROT, PROT_VOLTAGE): FRAME_SIZE,
+    WAVE_CMD: FRAME_SIZE,
+    WAVE_CTRL_CMD: WAVE_ACK_SIZE,
+    CHAN_CMD: CHAN_SIZE,
+    CHAN_CTRL_CMD: CHAN_ST_SIZE,
+    RATE_CMD: RATE_SIZE,
+    **UNSOLICITED,
+}
+
 
 
 class NucleoUART:
@@ -120,35 +441,39 @@ class NucleoUART:
         bytes
             Der 5-Byte-Frame
         """
-        lsb, msb = _u16_to_lsb_msb(value)                       # LSB, MSB aus Wert
-        return bytes([PREAMBLE, cmd, lsb, msb, flags & 0xFF])   # Frame zusammenbauen
+        return _build_frame(cmd, value, flags)
 
     def _write_packet(self, pkt: bytes) -> None:
-        """ Schreibt einen 5-Byte-Frame auf die serielle Schnittstelle.
+        """ Schreibt einen Frame auf die serielle Schnittstelle.
 
         Parameters
         ----------
         pkt : bytes
-            Der 5-Byte-Frame
+            Der Frame (5 Bytes, CONFIG: 11 Bytes)
 
         Raises
         ------
         ValueError
             Wenn der Frame ungültig ist.
         """
-        if len(pkt) != FRAME_SIZE or pkt[0] != PREAMBLE:  # Check ob Frame gültig ist
+        if len(pkt) < FRAME_SIZE or pkt[0] != PREAMBLE:   # Check ob Frame gültig ist
             raise ValueError("invalid packet")
         self.ser.reset_output_buffer()  # Output-Puffer leeren
         self.ser.write(pkt)             # Frame schreiben
         self.ser.flush()                # Schreib-Buffer leeren (blockierend)
 
-    def _read_packet(self) -> bytes:
-        """ Liest einen 5-Byte-Frame von der seriellen Schnittstelle.
+    def _read_packet(self, size: int = FRAME_SIZE) -> bytes:
+        """ Liest einen Frame von der seriellen Schnittstelle.
+
+        Parameters
+        ----------
+        size : int, optional
+            Framelänge inkl. Preamble, by default FRAME_SIZE
 
         Returns
         -------
         bytes
-            Der 5-Byte-Frame
+            Der Frame
 
         Raises
         ------
@@ -157,17 +482,23 @@ class NucleoUART:
         TimeoutError
             Wenn der Frame unvollständig ist.
         """
-        # Resync auf PREAMBLE, dann restliche 4 Bytes lesen
+        # Resync auf PREAMBLE, Event-/ADC-Frames überspringen, dann restliche Bytes lesen
         while True:
             b = self.ser.read(1)
             if not b:
                 raise TimeoutError("UART read timeout (waiting for preamble)")
-            if b[0] == PREAMBLE:
+            if b[0] != PREAMBLE:
+                continue
+            cmd = self.ser.read(1)
+            if not cmd:
+                raise TimeoutError("UART read timeout (reading frame body)")
+            if cmd[0] not in UNSOLICITED:
                 break
-        rest = self.ser.read(FRAME_SIZE - 1)
-        if len(rest) != FRAME_SIZE - 1:
+            self.ser.read(UNSOLICITED[cmd[0]] - 2)
+        rest = self.ser.read(size - 2)
+        if len(rest) != size - 2:
             raise TimeoutError("UART read timeout (reading frame body)")
-        return b + rest
+        return b + cmd + rest
 
     def drain_text(self, timeout: float = 0.5) -> str:
         """ Liest Textdaten von der seriellen Schnittstelle ein.
@@ -180,7 +511,7 @@ class NucleoUART:
         Returns
         -------
         str
-            Eingelesene Textdaten
+            Eingelesene Textdaten (Event-Frames als Textzeilen)
         """
         end = time.time() + timeout
         buf = bytearray()
@@ -190,10 +521,21 @@ class NucleoUART:
                 buf.extend(self.ser.read(n))
             else:
                 time.sleep(0.01)
-        return buf.decode(errors="replace")
+        # Event-Frames in Text umsetzen, übrige Binärframes auslassen
+        out, i, dec = [], 0, EventDecoder()
+        while i < len(buf):
+            if buf[i] == PREAMBLE and i + 1 < len(buf):
+                n = REPLY_LEN.get(buf[i + 1], FRAME_SIZE)
+                if buf[i + 1] == EVENT_CMD and i + n <= len(buf):
+                    out.append(dec.decode(bytes(buf[i:i + n])).text + "\n")
+                i += n
+                continue
+            out.append(chr(buf[i]) if buf[i] < 0x80 else "?")
+            i += 1
+        return "".join(out)
 
     # ---------- High-Level API ----------
-    def set_timer(self, timer: int, period: int) -> None:
+    def set_timer(self, timer: int, period: int, flags: int = 0) -> None:
         """ SET Timer (1 oder 2) mit Periode (in µs für T1, ms für T2).
 
         Parameters
@@ -204,10 +546,12 @@ class NucleoUART:
             Periode in µs (T1) oder ms (T2)
                 - Timer 1 (T1): Zeitraum von 10 µs bis 1000 µs
                 - Timer 2 (T2): Zeitraum von 1 ms bis 10.000 ms (10 s)
+        flags : int, optional
+            Timer-Flags, z.B. ``T1_F_HW_SYNC`` für T1, by default 0
             
         """
         cmd = _code_for_timer(CmdBase.SET, timer)
-        self._write_packet(self._build_packet(cmd, value=period, flags=0))
+        self._write_packet(self._build_packet(cmd, value=period, flags=flags))
 
     def start_sequence(self, pulse_count: int, timer_for_cmd: int = 1) -> None:
         """ START Sequenz (global).
@@ -242,6 +586,186 @@ class NucleoUART:
         flags = pkt[4] & 0xFF                       # Flags extrahieren (derzeit ungenutzt)
         return value, flags # Wert zurückgeben
 
+    def configure(self, t1_us: int, t2_ms: int, pulse_count: int = 0, *, arm: bool = True,
+                  t1_flags: int = 0, t2_flags: int = 0) -> ConfigAck:
+        """ CONFIG: T1, T2, Pulsanzahl und Flags in einem Frame setzen (optional starten).
+
+        Die Firmware stoppt beide Timer, übernimmt alle Werte und antwortet mit
+        genau einem ACK-Frame – ersetzt SET T1/SET T2/READBACK/START.
+
+        Returns
+        -------
+        ConfigAck
+            Tatsächlich übernommene (ggf. begrenzte) Werte
+        """
+        self.ser.reset_input_buffer()   # alte Textausgaben verwerfen
+        self._write_packet(_build_config_frame(t1_us, t2_ms, pulse_count, arm=arm,
+                                               t1_flags=t1_flags, t2_flags=t2_flags))
+        pkt = self._read_packet(CONFIG_ACK_SIZE)
+        if pkt[1] != CmdBase.CONFIG:
+            raise ValueError(f"unexpected response: got 0x{pkt[1]:02X}")
+        return _decode_config_ack(pkt)
+
+    def retime(self, t1_us: int = 0, t2_ms: int = 0) -> RetimeAck:
+        """ RETIME: T1/T2 ändern, ohne eine laufende Sequenz anzuhalten.
+
+        Die Firmware übernimmt die Werte direkt nach einem Pulspaar; ab
+        ``switch_cycle`` laufen alle Pulspaare mit den neuen Werten. Ohne
+        laufende Sequenz gelten sie sofort.
+
+        Parameters
+        ----------
+        t1_us : int, optional
+            Neue Pulsdauer in µs (10..1000), 0 = unverändert, by default 0
+        t2_ms : int, optional
+            Neue Zykluszeit in ms (1..10000), 0 = unverändert, by default 0
+
+        Returns
+        -------
+        RetimeAck
+            Übernommene Werte und Umschaltzyklus
+        """
+        self.ser.reset_input_buffer()
+        self._write_packet(_build_retime_frame(t1_us, t2_ms))
+        pkt = self._read_packet(RETIME_ACK_SIZE)
+        if pkt[1] != CmdBase.RETIME:
+            raise ValueError(f"unexpected response: got 0x{pkt[1]:02X}")
+        return _decode_retime_ack(pkt)
+
+    def fire(self, n_pulses: int = 1) -> FireAck:
+        """ FIRE: genau n Pulspaare mit den aktuellen T1/T2 auslösen (0 = nur Zähler lesen).
+
+        Returns
+        -------
+        FireAck
+            Zykluszähler und Status der Firmware
+        """
+        self.ser.reset_input_buffer()
+        self._write_packet(self._build_packet(CmdBase.FIRE, value=n_pulses))
+        pkt = self._read_packet(FIRE_ACK_SIZE)
+        if pkt[1] != CmdBase.FIRE:
+            raise ValueError(f"unexpected response: got 0x{pkt[1]:02X}")
+        return _decode_fire_ack(pkt)
+
+    def status(self, *, clear_peak: bool = False) -> Status:
+        """ STATUS: Telemetrie-Snapshot lesen.
+
+        Parameters
+        ----------
+        clear_peak : bool, optional
+            Latenz-Spitzenwert nach dem Lesen zurücksetzen, by default False
+
+        Returns
+        -------
+        Status
+            Zustand und Zähler der Firmware
+        """
+        self.ser.reset_input_buffer()
+        flags = STATUS_F_CLR_PEAK if clear_peak else 0
+        self._write_packet(self._build_packet(CmdBase.STATUS, flags=flags))
+        pkt = self._read_packet(STATUS_SIZE)
+        if pkt[1] != CmdBase.STATUS:
+            raise ValueError(f"unexpected response: got 0x{pkt[1]:02X}")
+        return _decode_status(pkt)
+
+    def adc_stream(self, decimation: int = 1) -> AdcAck:
+        """ ADC: Messdaten je Pulspaar ein-/ausschalten.
+
+        Parameters
+        ----------
+        decimation : int, optional
+            Jeden N-ten Zyklus senden (0 = aus), by default 1
+
+        Returns
+        -------
+        AdcAck
+            Übernommene Dezimierung und ADC-Zustand
+        """
+        self.ser.reset_input_buffer()
+        self._write_packet(self._build_packet(CmdBase.ADC, value=decimation))
+        pkt = self._read_packet(FRAME_SIZE)
+        if pkt[1] != CmdBase.ADC:
+            raise ValueError(f"unexpected response: got 0x{pkt[1]:02X}")
+        return _decode_adc_ack(pkt)
+
+    def configure_channel(self, channel: int, t1_us: float, t2_ms: int, pulse_count: int = 0, *,
+                          start: bool = True) -> ChannelAck:
+        """ CHAN: einen HRTIM-Kanal (0..2) setzen und optional starten.
+
+        Parameters
+        ----------
+        channel : int
+            Kanal bzw. DUT, 0..2
+        t1_us : float
+            Pulsdauer in µs (1..750), Raster 184 ps (< 5 µs) bis 23.5 ns (750 µs)
+        t2_ms : int
+            Zykluszeit in ms (1..10000)
+        pulse_count : int, optional
+            Anzahl Pulspaare, 0 = endlos bis Stopp, by default 0
+        start : bool, optional
+            Kanal direkt starten, by default True
+
+        Returns
+        -------
+        ChannelAck
+            Erreichte Werte des Kanals (T1 auf das HRTIM-Raster gerundet)
+        """
+        self.ser.reset_input_buffer()
+        self._write_packet(encode_channel_frame(channel, round(t1_us * 1e6), t2_ms, pulse_count,
+                                                start=start))
+        pkt = self._read_packet(CHAN_SIZE)
+        if pkt[1] != CHAN_CMD:
+            raise ValueError(f"unexpected response: got 0x{pkt[1]:02X}")
+        return decode_channel_ack(pkt)
+
+    def channel_control(self, channel: int, *, start: bool = False, stop: bool = False,
+                        exit_multi: bool = False) -> ChannelState:
+        """ CHAN_CTRL: Kanal starten/stoppen bzw. den Mehrkanalbetrieb verlassen.
+
+        Ohne Flags liefert die Firmware nur den Zählerstand des Kanals.
+
+        Returns
+        -------
+        ChannelState
+            Zustand und gefeuerte Pulspaare des Kanals
+        """
+        flags = ((CHAN_F_START if start else 0) | (CHAN_F_STOP if stop else 0)
+                 | (CHAN_F_EXIT if exit_multi else 0))
+        self.ser.reset_input_buffer()
+        self._write_packet(self._build_packet(CHAN_CTRL_CMD, value=channel, flags=flags))
+        pkt = self._read_packet(CHAN_ST_SIZE)
+        if pkt[1] != CHAN_CTRL_CMD:
+            raise ValueError(f"unexpected response: got 0x{pkt[1]:02X}")
+        return decode_channel_state(pkt)
+
+    def configure_rate(self, t1_us: float, rate_hz: float, pulse_count: int = 0, *,
+                       start: bool = True) -> RateAck:
+        """ RATE: Schnellmodus setzen und optional starten.
+
+        Parameters
+        ----------
+        t1_us : float
+            Pulsdauer in µs (ab 0.5), 2*T1 höchstens die halbe Periode
+        rate_hz : float
+            Wiederholrate in Hz (1 kHz .. 50 kHz), Raster der Periode 5.9 ns
+        pulse_count : int, optional
+            Anzahl Pulspaare, 0 = endlos bis Stopp, by default 0
+        start : bool, optional
+            Direkt starten, by default True
+
+        Returns
+        -------
+        RateAck
+            Erreichte Werte; ``guard`` = Wärmebudget erschöpft, Start abgelehnt
+        """
+        self.ser.reset_input_buffer()
+        self._write_packet(encode_rate_frame(round(t1_us * 1e3), round(1e9 / rate_hz),
+                                             pulse_count, start=start))
+        pkt = self._read_packet(RATE_SIZE)
+        if pkt[1] != RATE_CMD:
+            raise ValueError(f"unexpected response: got 0x{pkt[1]:02X}")
+        return decode_rate_ack(pkt)
+
     def close(self) -> None:
         """ Schließt die serielle Schnittstelle. """
         if self.ser.is_open and self.ser:
@@ -249,6 +773,399 @@ class NucleoUART:
 
 
 
+class UARTReply(Future):
+    """Ausstehende Antwort auf ein Kommando.
+
+    Verhält sich wie ein ``concurrent.futures.Future`` (``.result(timeout)``
+    blockiert) und kann zusätzlich in einer asyncio-Coroutine direkt mit
+    ``await`` abgewartet werden.
+    """
+    def __await__(self):
+        return asyncio.wrap_future(self).__await__()
+
+
+class NucleoLink:
+    """
+    Nebenläufiger UART-Client für die Nucleo-Firmware.
+
+    Ein einzelner Reader-Thread besitzt die Schnittstelle und trennt den
+    Empfangsstrom in binäre Antwortframes (beginnen mit 0xFF) und ASCII-Zeilen
+    (Log-Ausgaben der Firmware). Mehrere Kommandos dürfen gleichzeitig
+    ausstehen; Antworten werden über den Befehlscode in FIFO-Reihenfolge dem
+    passenden ``UARTReply`` zugeordnet (die Firmware beantwortet Kommandos in
+    Empfangsreihenfolge).
+
+    Textzeilen und nicht angeforderte Frames werden an registrierte Listener
+    verteilt, z.B. an den Serial-Monitor der GUI – ein zweiter Leser auf
+    derselben Schnittstelle ist damit nicht mehr nötig. Event-Frames der
+    Firmware (0x80) werden dekodiert, an Event-Listener gegeben und als
+    Textzeile ausgegeben; ADC-Messdaten (0x98) gehen nur an ADC-Listener.
+
+    Parameters
+    ----------
+    port : str
+        Gerätepfad oder pyserial-URL (z.B. ``"loop://"``).
+    baudrate : int, optional
+        Baudrate, by default 115200
+    timeout : float, optional
+        Standard-Timeout für Antworten in Sekunden, by default 2.0
+    ser : optional
+        Bereits geöffnetes serial-ähnliches Objekt (Tests, Simulator).
+        Wenn gesetzt, wird ``port`` ignoriert.
+    on_line : Callable[[str], None], optional
+        Listener für empfangene Textzeilen.
+    """
+    POLL_S = 0.02  # Lese-Timeout des Reader-Threads
+
+    def __init__(self, port: str = "", baudrate: int = 115200, timeout: float = 2.0,
+                 *, ser=None, on_line: Optional[Callable[[str], None]] = None):
+        self.timeout = timeout
+        if ser is None:
+            ser = serial.serial_for_url(
+                port,
+                baudrate=baudrate,
+                timeout=self.POLL_S,
+                bytesize=serial.EIGHTBITS,
+                parity=serial.PARITY_NONE,
+                stopbits=serial.STOPBITS_ONE,
+                write_timeout=timeout,
+            )
+        self.ser = ser
+
+        self._tx_lock = threading.Lock()
+        self._lock = threading.Lock()
+        self._pending: dict[int, deque] = {}   # reply_cmd -> deque[(UARTReply, deadline, decode)]
+        self._line_listeners: list[Callable[[str], None]] = []
+        self._frame_listeners: list[Callable[[bytes], None]] = []
+        self._event_listeners: list[Callable[[Event], None]] = []
+        self._adc_listeners: list[Callable[[AdcRecord], None]] = []
+        self.events = EventDecoder()
+        if on_line is not None:
+            self._line_listeners.append(on_line)
+
+        # Parser-Zustand (nur im Reader-Thread benutzt)
+        self._text = bytearray()
+        self._frame: Optional[bytearray] = None
+
+        self._stop = threading.Event()
+        self._reader = threading.Thread(target=self._rx_loop, name="NucleoLink-RX", daemon=True)
+        self._reader.start()
+
+    def __enter__(self): return self
+    def __exit__(self, exc_type, exc, tb): self.close()
+
+    # -------- Listener --------
+    def add_line_listener(self, cb: Callable[[str], None]) -> None:
+        """Registriert einen Listener für empfangene Textzeilen (Aufruf im Reader-Thread)."""
+        self._line_listeners.append(cb)
+
+    def add_frame_listener(self, cb: Callable[[bytes], None]) -> None:
+        """Registriert einen Listener für Binärframes, auf die kein Kommando wartet."""
+        self._frame_listeners.append(cb)
+
+    def add_event_listener(self, cb: Callable[[Event], None]) -> None:
+        """Registriert einen Listener für dekodierte Firmware-Events (Aufruf im Reader-Thread)."""
+        self._event_listeners.append(cb)
+
+    def add_adc_listener(self, cb: Callable[[AdcRecord], None]) -> None:
+        """Registriert einen Listener für ADC-Messdaten (Rohwerte, Aufruf im Reader-Thread)."""
+        self._adc_listeners.append(cb)
+
+    # -------- Reader-Thread --------
+    def _rx_loop(self) -> None:
+        """Reader-Thread: liest, demultiplext und lässt abgelaufene Anfragen verfallen."""
+        while not self._stop.is_set():
+            try:
+                n = self.ser.in_waiting
+                chunk = self.ser.read(n if n else 1)
+            except Exception as e:
+                if not self._stop.is_set():
+                    self._emit_line(f"[RX-ERR] {e}")
+                    self._fail_pending(ConnectionError(str(e)))
+                break
+            if chunk:
+                self._feed(chunk)
+            self._expire_pending()
+
+    def _feed(self, chunk: bytes) -> None:
+        """Zerlegt empfangene Bytes in Binärframes und Textzeilen."""
+        for b in chunk:
+            if self._frame is not None:
+                self._frame.append(b)
+                need = REPLY_LEN.get(self._frame[1], FRAME_SIZE) if len(self._frame) >= 2 else FRAME_SIZE
+                if len(self._frame) >= need:
+                    frame, self._frame = bytes(self._frame), None
+                    self._dispatch_frame(frame)
+            elif b == PREAMBLE:
+                self._frame = bytearray([b])
+            elif b == 0x0A:  # '\n'
+                text = self._text.decode(errors="replace").strip()
+                self._text.clear()
+                if text:
+                    self._emit_line(text)
+            else:
+                self._text.append(b)
+
+    def _dispatch_frame(self, frame: bytes) -> None:
+        """Ordnet einen Frame dem ältesten wartenden Kommando zu oder verteilt ihn an Listener."""
+        if frame[1] == EVENT_CMD:
+            self._dispatch_event(frame)
+            return
+        if frame[1] == ADC_REC_CMD:
+            self._dispatch_adc(frame)
+            return
+        with self._lock:
+            q = self._pending.get(frame[1])
+            entry = q.popleft() if q else None
+        if entry is not None:
+            fut, _, decode = entry
+            try:
+                fut.set_result(decode(frame))
+            except Exception as e:
+                fut.set_exception(e)
+            return
+        if self._frame_listeners:
+            for cb in list(self._frame_listeners):
+                cb(frame)
+        else:
+            self._emit_line("[RX-FRAME] " + frame.hex(" ").upper())
+
+    def _dispatch_event(self, frame: bytes) -> None:
+        ev = self.events.decode(frame)
+        for cb in list(self._event_listeners):
+            try:
+                cb(ev)
+            except Exception:
+                pass
+        self._emit_line(ev.text)
+
+    def _dispatch_adc(self, frame: bytes) -> None:
+        rec = decode_adc_record(frame)
+        for cb in list(self._adc_listeners):
+            try:
+                cb(rec)
+            except Exception:
+                pass
+
+    def _emit_line(self, text: str) -> None:
+        for cb in list(self._line_listeners):
+            try:
+                cb(text)
+            except Exception:
+                pass
+
+    def _expire_pending(self) -> None:
+        """Setzt TimeoutError für Anfragen, deren Frist abgelaufen ist."""
+        now = time.monotonic()
+        expired = []
+        with self._lock:
+            for cmd, q in self._pending.items():
+                while q and q[0][1] < now:
+                    expired.append((cmd, q.popleft()[0]))
+        for cmd, fut in expired:
+            fut.set_exception(TimeoutError(f"no reply for CMD 0x{cmd:02X}"))
+
+    def _fail_pending(self, exc: Exception) -> None:
+        with self._lock:
+            entries = [e for q in self._pending.values() for e in q]
+            self._pending.clear()
+        for fut, _, _ in entries:
+            if not fut.done():
+                fut.set_exception(exc)
+
+    # -------- Senden --------
+    def _request(self, pkt: bytes, reply_cmd: Optional[int] = None,
+                 decode: Optional[Callable[[bytes], object]] = None,
+                 timeout: Optional[float] = None) -> UARTReply:
+        """Sendet einen Frame; ohne ``reply_cmd`` ist die Antwort mit dem Schreiben erledigt."""
+        fut = UARTReply()
+        if reply_cmd is not None:
+            deadline = time.monotonic() + (self.timeout if timeout is None else timeout)
+            with self._lock:
+                self._pending.setdefault(reply_cmd, deque()).append((fut, deadline, decode or bytes))
+        try:
+            with self._tx_lock:
+                self.ser.write(pkt)
+                self.ser.flush()
+        except Exception as e:
+            if reply_cmd is not None:
+                with self._lock:
+                    q = self._pending.get(reply_cmd)
+                    if q:
+                        try:
+                            q.remove(next(x for x in q if x[0] is fut))
+                        except StopIteration:
+                            pass
+            fut.set_exception(e)
+            return fut
+        if reply_cmd is None:
+            fut.set_result(None)
+        return fut
+
+    # ---------- High-Level API ----------
+    def set_timer(self, timer: int, period: int, flags: int = 0) -> UARTReply:
+        """SET Timer (1 oder 2), Periode in µs (T1) bzw. ms (T2); Flags z.B. ``T1_F_HW_SYNC``."""
+        cmd = _code_for_timer(CmdBase.SET, timer)
+        return self._request(_build_frame(cmd, period, flags))
+
+    def start_sequence(self, pulse_count: int, timer_for_cmd: int = 1) -> UARTReply:
+        """START Sequenz; pulse_count = 0 → endlos bis STOP."""
+        cmd = _code_for_timer(CmdBase.START, timer_for_cmd)
+        return self._request(_build_frame(cmd, pulse_count))
+
+    def stop_timer(self, *, hard: bool = False, timer_for_cmd: int = 1) -> UARTReply:
+        """STOP Sequenz (Soft: Zyklus zu Ende laufen lassen, Hard: sofort)."""
+        cmd = _code_for_timer(CmdBase.STOP, timer_for_cmd)
+        return self._request(_build_frame(cmd, 0, 1 if hard else 0))
+
+    stop = stop_timer
+
+    def configure(self, t1_us: int, t2_ms: int, pulse_count: int = 0, *, arm: bool = True,
+                  t1_flags: int = 0, t2_flags: int = 0,
+                  timeout: Optional[float] = None) -> UARTReply:
+        """CONFIG in einem Round-Trip; das Ergebnis ist ein ``ConfigAck``."""
+        pkt = _build_config_frame(t1_us, t2_ms, pulse_count, arm=arm,
+                                  t1_flags=t1_flags, t2_flags=t2_flags)
+        return self._request(pkt, reply_cmd=CmdBase.CONFIG,
+                             decode=_decode_config_ack, timeout=timeout)
+
+    def retime(self, t1_us: int = 0, t2_ms: int = 0,
+               timeout: Optional[float] = None) -> UARTReply:
+        """RETIME ohne Stopp (0 = unverändert); das Ergebnis ist ein ``RetimeAck``.
+        Sobald die Werte aktiv sind, meldet die Firmware zusätzlich das Event RETIME."""
+        return self._request(_build_retime_frame(t1_us, t2_ms), reply_cmd=CmdBase.RETIME,
+                             decode=_decode_retime_ack, timeout=timeout)
+
+    def fire(self, n_pulses: int = 1, timeout: Optional[float] = None) -> UARTReply:
+        """FIRE: n Pulspaare auslösen; das Ergebnis ist ein ``FireAck``."""
+        return self._request(_build_frame(CmdBase.FIRE, n_pulses), reply_cmd=CmdBase.FIRE,
+                             decode=_decode_fire_ack, timeout=timeout)
+
+    def cycle_count(self, timeout: Optional[float] = None) -> UARTReply:
+        """Liest den Zykluszähler der Firmware (FIRE mit n = 0)."""
+        return self.fire(0, timeout=timeout)
+
+    def status(self, *, clear_peak: bool = False, timeout: Optional[float] = None) -> UARTReply:
+        """STATUS: Telemetrie-Snapshot; das Ergebnis ist ein ``Status``."""
+        flags = STATUS_F_CLR_PEAK if clear_peak else 0
+        return self._request(_build_frame(CmdBase.STATUS, 0, flags), reply_cmd=CmdBase.STATUS,
+                             decode=_decode_status, timeout=timeout)
+
+    def protection(self, channel: int, threshold: int = 0, *, reset: bool = False,
+                   timeout: Optional[float] = None) -> UARTReply:
+        """PROT: Schwelle (DAC-Rohwert, 0 = unverändert) für ``PROT_CURRENT``/``PROT_VOLTAGE``
+        setzen und/oder den Fehler quittieren; das Ergebnis ist ein ``ProtAck``."""
+        cmd = _code_for_timer(CmdBase.PROT, channel)
+        flags = PROT_F_RESET if reset else 0
+        return self._request(_build_frame(cmd, threshold, flags), reply_cmd=cmd,
+                             decode=_decode_prot_ack, timeout=timeout)
+
+    def clear_fault(self, timeout: Optional[float] = None) -> UARTReply:
+        """Quittiert den Schutz-Latch (nur wirksam, wenn kein Komparator mehr anliegt)."""
+        return self.protection(PROT_CURRENT, 0, reset=True, timeout=timeout)
+
+    def adc_stream(self, decimation: int = 1, timeout: Optional[float] = None) -> UARTReply:
+        """ADC-Messdaten je Pulspaar (jeder N-te Zyklus, 0 = aus); das Ergebnis ist ein ``AdcAck``."""
+        return self._request(_build_frame(CmdBase.ADC, decimation), reply_cmd=CmdBase.ADC,
+                             decode=_decode_adc_ack, timeout=timeout)
+
+    def wave_control(self, flags: int, repeats: int = 0,
+                     timeout: Optional[float] = None) -> UARTReply:
+        """WAVE-Steuerung (``WAVE_F_*``, mehrere kombinierbar); das Ergebnis ist ein ``WaveAck``."""
+        return self._request(_build_frame(WAVE_CTRL_CMD, repeats, flags), reply_cmd=WAVE_CTRL_CMD,
+                             decode=decode_wave_ack, timeout=timeout)
+
+    def wave_upload(self, wave: Waveform, timeout: Optional[float] = None) -> WaveAck:
+        """
+        Lädt eine Zustandsfolge in den RAM der Firmware (blockiert bis zur Prüfung).
+
+        Jeder Frame wird einzeln bestätigt: der Empfangspuffer der Firmware fasst
+        nur wenige Frames am Stück. Zum Schluss wird die CRC verglichen.
+
+        Raises
+        ------
+        ValueError
+            Wenn die Firmware einen Frame ablehnt oder die CRC nicht passt.
+        """
+        ack = self.wave_control(WAVE_F_CLEAR, timeout=timeout).result()
+        if ack.rejected:
+            raise ValueError("WAVE: Tabelle wird gerade abgespielt")
+        for frame in encode_wave_frames(wave):
+            ack = self._request(frame, reply_cmd=WAVE_CMD, decode=decode_wave_ack,
+                                timeout=timeout).result()
+            if ack.rejected:
+                raise ValueError(f"WAVE: Frame abgelehnt ({frame.hex(' ')})")
+        ack = self.wave_control(0, timeout=timeout).result()
+        if ack.length != len(wave) or ack.crc != crc16(wave):
+            raise ValueError(f"WAVE: Prüfung fehlgeschlagen (Länge {ack.length}/{len(wave)}, "
+                             f"CRC 0x{ack.crc:04X}/0x{crc16(wave):04X})")
+        return ack
+
+    def wave_run(self, repeats: int = 1, timeout: Optional[float] = None) -> UARTReply:
+        """Spielt die geladene Zustandsfolge ``repeats`` mal ab (Lücke je ~1 µs)."""
+        return self.wave_control(WAVE_F_RUN, repeats, timeout=timeout)
+
+    def wave_stop(self, timeout: Optional[float] = None) -> UARTReply:
+        """Bricht das Abspielen sofort ab (Brücke aus)."""
+        return self.wave_control(WAVE_F_STOP, timeout=timeout)
+
+    def wave_save(self, timeout: Optional[float] = None) -> UARTReply:
+        """Schreibt die Tabelle in den Flash (wird beim Reset geladen, ~20 ms)."""
+        return self.wave_control(WAVE_F_SAVE, timeout=timeout)
+
+    def wave_load(self, timeout: Optional[float] = None) -> UARTReply:
+        """Lädt die im Flash gespeicherte Tabelle."""
+        return self.wave_control(WAVE_F_LOAD, timeout=timeout)
+
+    def configure_channel(self, channel: int, t1_us: float, t2_ms: int, pulse_count: int = 0, *,
+                          start: bool = True, timeout: Optional[float] = None) -> UARTReply:
+        """CHAN: HRTIM-Kanal 0..2 setzen (T1 in µs, Raster 184 ps); das Ergebnis ist ein
+        ``ChannelAck``. Antworten mehrerer Kanäle kommen in Sende-Reihenfolge."""
+        pkt = encode_channel_frame(channel, round(t1_us * 1e6), t2_ms, pulse_count, start=start)
+        return self._request(pkt, reply_cmd=CHAN_CMD, decode=decode_channel_ack, timeout=timeout)
+
+    def channel_control(self, channel: int, flags: int = 0,
+                        timeout: Optional[float] = None) -> UARTReply:
+        """CHAN_CTRL (``CHAN_F_*``); das Ergebnis ist ein ``ChannelState``."""
+        return self._request(_build_frame(CHAN_CTRL_CMD, channel, flags), reply_cmd=CHAN_CTRL_CMD,
+                             decode=decode_channel_state, timeout=timeout)
+
+    def channel_start(self, channel: int, timeout: Optional[float] = None) -> UARTReply:
+        """Startet einen gesetzten Kanal erneut (Zähler von vorn)."""
+        return self.channel_control(channel, CHAN_F_START, timeout=timeout)
+
+    def channel_stop(self, channel: int, timeout: Optional[float] = None) -> UARTReply:
+        """Hält einen Kanal sofort an; die anderen laufen weiter."""
+        return self.channel_control(channel, CHAN_F_STOP, timeout=timeout)
+
+    def multi_exit(self, timeout: Optional[float] = None) -> UARTReply:
+        """Alle Kanäle aus, Pins zurück an die Einzelbrücke."""
+        return self.channel_control(0, CHAN_F_EXIT, timeout=timeout)
+
+    def configure_rate(self, t1_us: float, rate_hz: float, pulse_count: int = 0, *,
+                       start: bool = True, timeout: Optional[float] = None) -> UARTReply:
+        """RATE: Schnellmodus mit 1..50 kHz setzen (+ starten); das Ergebnis ist ein
+        ``RateAck``. Das Ende meldet die Firmware mit dem Event RATE_DONE, STOP beendet."""
+        pkt = encode_rate_frame(round(t1_us * 1e3), round(1e9 / rate_hz), pulse_count, start=start)
+        return self._request(pkt, reply_cmd=RATE_CMD, decode=decode_rate_ack, timeout=timeout)
+
+    def readback(self, timer: int, timeout: Optional[float] = None) -> UARTReply:
+        """READBACK; das Ergebnis ist ``(value, flags)`` (T1: µs, T2: ms)."""
+        cmd = _code_for_timer(CmdBase.READBACK, timer)
+        return self._request(_build_frame(cmd), reply_cmd=cmd,
+                             decode=_decode_readback, timeout=timeout)
+
+    def close(self) -> None:
+        """Beendet den Reader-Thread und schließt die Schnittstelle."""
+        self._stop.set()
+        if self._reader.is_alive() and self._reader is not threading.current_thread():
+            self._reader.join(timeout=1.0)
+        self._fail_pending(ConnectionError("link closed"))
+        if self.ser and self.ser.is_open:
+            self.ser.close()
+
+
+
 
 
 
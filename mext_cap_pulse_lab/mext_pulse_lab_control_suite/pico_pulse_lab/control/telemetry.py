@@ -0,0 +1,170 @@
+"""
+Telemetrie-Quellen für die Firmware-Statusdaten und ADC-Messwerte.
+
+Der ``StatusPoller`` fragt die Firmware zyklisch per STATUS ab (bis 100 Hz)
+und stellt den letzten Snapshot sowie eine kurze Historie bereit. Der
+``AdcMonitor`` sammelt die ADC-Messdaten (U_DC/I je Puls), die die Firmware
+unaufgefordert sendet. Die GUI liest nur ``latest`` bzw. bekommt Daten per
+Callback und muss selbst keine seriellen Zugriffe machen.
+"""
+
+import math
+import threading
+import time
+from collections import deque
+from typing import Callable, Optional
+
+from pico_pulse_lab.control.adc_record import AdcRecord, AdcScale
+from pico_pulse_lab.control.stm32_uart import AdcAck, NucleoLink, Status
+
+
+class StatusPoller:
+    """
+    Pollt ``NucleoLink.status()`` in einem Hintergrund-Thread.
+
+    Parameters
+    ----------
+    link : NucleoLink
+        Verbundener UART-Client der Firmware.
+    rate_hz : float, optional
+        Abfragerate, by default 10.0 (max. 100)
+    on_status : callable, optional
+        Callback ``(Status) -> None``, wird im Poll-Thread aufgerufen.
+    history : int, optional
+        Anzahl gespeicherter Snapshots, by default 600
+
+    Examples
+    --------
+    >>> poller = StatusPoller(nuc, rate_hz=20)
+    >>> poller.start()
+    >>> print(poller.latest.cycles, poller.latest.isr_latency_us)
+    >>> poller.stop()
+    """
+
+    MAX_RATE_HZ = 100.0
+
+    def __init__(self, link: NucleoLink, rate_hz: float = 10.0,
+                 on_status: Optional[Callable[[Status], None]] = None, history: int = 600):
+        self.link = link
+        self.period_s = 1.0 / min(max(rate_hz, 0.1), self.MAX_RATE_HZ)
+        self.on_status = on_status
+        self.history = deque(maxlen=history)   # (host_time_s, Status)
+        self.latest: Optional[Status] = None
+        self.errors = 0                        # fehlgeschlagene Abfragen (Timeout o.ä.)
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+
+    @property
+    def is_running(self) -> bool:
+        return self._thread is not None and self._thread.is_alive()
+
+    def start(self) -> None:
+        """Startet den Poll-Thread (mehrfacher Aufruf ist unkritisch)."""
+        if self.is_running:
+            return
+        self._stop.clear()
+        self._thread = threading.Thread(target=self._run, name="StatusPoller", daemon=True)
+        self._thread.start()
+
+    def stop(self) -> None:
+        """Beendet den Poll-Thread und wartet auf dessen Ende."""
+        self._stop.set()
+        if self._thread and self._thread is not threading.current_thread():
+            self._thread.join(timeout=1.0)
+        self._thread = None
+
+    def poll_once(self, timeout: Optional[float] = None) -> Status:
+        """Liest einen Snapshot synchron und übernimmt ihn in ``latest``/``history``."""
+        st = self.link.status(timeout=timeout).result()
+        self.latest = st
+        self.history.append((time.monotonic(), st))
+        if self.on_status:
+            self.on_status(st)
+        return st
+
+    def _run(self) -> None:
+        next_t = time.monotonic()
+        while not self._stop.is_set():
+            try:
+                self.poll_once(timeout=max(self.period_s, 0.2))
+            except ConnectionError:
+                break                           # Link geschlossen
+            except Exception:
+                self.errors += 1
+            # feste Rate, ohne nach einem Timeout Abfragen nachzuholen
+            next_t = max(next_t + self.period_s, time.monotonic())
+            self._stop.wait(next_t - time.monotonic())
+
+
+class AdcMonitor:
+    """
+    Empfängt die ADC-Messdaten der Firmware (ein Datensatz je N-tem Pulspaar).
+
+    Parameters
+    ----------
+    link : NucleoLink
+        Verbundener UART-Client der Firmware.
+    scale : AdcScale, optional
+        Umrechnung Rohwerte -> V/A, by default AdcScale() (Volt am ADC-Pin)
+    on_record : callable, optional
+        Callback ``(AdcRecord) -> None`` mit skalierten Werten, im Reader-Thread.
+    history : int, optional
+        Anzahl gespeicherter Datensätze, by default 600
+
+    Examples
+    --------
+    >>> mon = AdcMonitor(nuc, AdcScale(u_per_volt_in=101.0, a_per_volt_in=20.0))
+    >>> mon.enable(AdcMonitor.decimation_for(t2_ms=5))
+    >>> print(mon.latest.pos.u_mean, mon.latest.pos.i_peak)
+    """
+
+    MAX_RECORD_RATE_HZ = 50.0   # 34-Byte-Frames: ~15 % der UART-Bandbreite bei 115200 Baud
+
+    def __init__(self, link: NucleoLink, scale: AdcScale = AdcScale(),
+                 on_record: Optional[Callable[[AdcRecord], None]] = None, history: int = 600):
+        self.link = link
+        self.scale = scale
+        self.on_record = on_record
+        self.history = deque(maxlen=history)   # (host_time_s, AdcRecord skaliert)
+        self.latest: Optional[AdcRecord] = None
+        self.received = 0
+        self.lost_cycles = 0                   # Zyklen ohne Datensatz über die Dezimierung hinaus
+        self.decimation = 0
+        self._last_cycle: Optional[int] = None
+        self._active = True
+        link.add_adc_listener(self._on_raw)
+
+    @staticmethod
+    def decimation_for(t2_ms: float, max_rate_hz: float = MAX_RECORD_RATE_HZ) -> int:
+        """Kleinste Dezimierung, bei der höchstens ``max_rate_hz`` Datensätze/s anfallen."""
+        return max(1, math.ceil(1000.0 / (max(t2_ms, 1e-3) * max_rate_hz)))
+
+    def enable(self, decimation: int = 1, timeout: Optional[float] = None) -> AdcAck:
+        """Schaltet die Messdaten ein (jeder N-te Zyklus)."""
+        ack = self.link.adc_stream(decimation, timeout=timeout).result()
+        self.decimation = ack.decimation
+        self._last_cycle = None
+        return ack
+
+    def disable(self, timeout: Optional[float] = None) -> AdcAck:
+        """Schaltet die Messdaten der Firmware ab."""
+        return self.enable(0, timeout=timeout)
+
+    def close(self) -> None:
+        """Ignoriert weitere Datensätze (der Listener bleibt am Link registriert)."""
+        self._active = False
+
+    def _on_raw(self, raw: AdcRecord) -> None:
+        if not self._active:
+            return
+        if self._last_cycle is not None and self.decimation:
+            gap = raw.cycle - self._last_cycle
+            if gap > self.decimation:
+                self.lost_cycles += gap - self.decimation
+        self._last_cycle = raw.cycle
+        rec = self.scale.apply(raw)
+        self.received += 1
+        self.latest = rec
+        self.history.append((time.monotonic(), rec))
+        if self.on_record:
+            self.on_record(rec)
@@ -0,0 +1,236 @@
+"""
+Zustandsfolgen (Waveforms) für die WAVE-Engine der Firmware.
+
+Statt des festen Pulspaars (positiv, negativ, aus) spielt die Firmware eine
+hochgeladene Tabelle von Brückenzuständen mit je eigener Dauer ab. Den
+Schrittakt liefert TIM8 (0.1 µs je Tick), Zustandswechsel schreibt die DMA
+direkt in die Register – die CPU ist pro Schritt nicht beteiligt.
+
+Upload in Frames zu je bis zu 3 Schritten:
+
+    FF B0 INDEX(2) N [ZUSTAND DAUER(2)] x 3        -> Antwort FF B0 LÄNGE(2) STATUS
+
+Steuerung (Leeren, Flash laden/speichern, Abspielen, Abbrechen):
+
+    FF B1 DURCHLÄUFE(2) FLAGS                       -> Antwort FF B1 LÄNGE(2) CRC16(2) STATUS
+
+Nach dem letzten Schritt schaltet die Firmware die Brücke ab (Enables aus).
+"""
+
+from enum import IntEnum
+from typing import Iterable, NamedTuple
+
+PREAMBLE = 0xFF
+WAVE_CMD = 0xB0         # Schritte hochladen
+WAVE_CTRL_CMD = 0xB1    # Steuerung (Leeren, Flash, Abspielen, Abbruch)
+WAVE_DATA_SIZE = 14
+WAVE_ACK_SIZE = 7
+STEPS_PER_FRAME = 3
+MAX_STEPS = 256
+
+TICK_US = 0.1                    # TIM8: 170 MHz / 17
+MIN_TICKS = 3                    # kürzester Schritt (0.3 µs)
+MAX_TICKS = 0xFFFF               # längster Schritt (6553.5 µs), längere werden geteilt
+
+WAVE_F_CLEAR = 0x01
+WAVE_F_LOAD = 0x02
+WAVE_F_SAVE = 0x04
+WAVE_F_RUN = 0x08
+WAVE_F_STOP = 0x10
+
+WAVE_ST_RUNNING = 0x01
+WAVE_ST_STORED = 0x02            # Flash enthält genau die aktuelle Tabelle
+WAVE_ST_REJECT = 0x80
+
+WS_DRIVE_L = 0x01
+WS_DRIVE_R = 0x02
+WS_ENABLE = 0x04
+
+
+class BridgeState(IntEnum):
+    """Zustände der Vollbrücke (Bits wie ``WS_*`` in ``Core/Src/main.c``)."""
+    OFF       = 0                                     # Enables aus, Brücke hochohmig
+    POS       = WS_ENABLE | WS_DRIVE_L                # links High, rechts Low: +U_DC am DUT
+    NEG       = WS_ENABLE | WS_DRIVE_R                # links Low, rechts High: -U_DC am DUT
+    ZERO_LOW  = WS_ENABLE                             # beide Low Sides: Freilauf über Masse
+    ZERO_HIGH = WS_ENABLE | WS_DRIVE_L | WS_DRIVE_R   # beide High Sides: Freilauf über U_DC
+
+
+class WaveStep(NamedTuple):
+    """Ein Tabellenschritt: Zustand und Dauer in Ticks (0.1 µs)."""
+    state: int
+    ticks: int
+
+    @property
+    def duration_us(self) -> float:
+        return self.ticks * TICK_US
+
+
+class WaveAck(NamedTuple):
+    """Antwort auf WAVE-Upload bzw. -Steuerung."""
+    length: int             # Schritte in der Tabelle der Firmware
+    crc: int                # CRC16 der Tabelle (nur Steuer-Antwort, sonst -1)
+    running: bool
+    stored: bool            # Flash enthält diese Tabelle
+    rejected: bool
+
+
+def ticks_from_us(us: float) -> int:
+    """Dauer in µs auf Ticks runden (mindestens ``MIN_TICKS``)."""
+    return max(MIN_TICKS, int(round(us / TICK_US)))
+
+
+class Waveform:
+    """
+    Tabelle von Brückenzuständen für die WAVE-Engine.
+
+    Dauern über 6.5 ms werden automatisch auf mehrere Schritte gleichen
+    Zustands verteilt. Aufeinanderfolgende gleiche Zustände werden nicht
+    zusammengefasst (die Tabelle bleibt so, wie sie aufgebaut wurde).
+
+    Examples
+    --------
+    >>> w = Waveform.burst(5, t_on_us=50, t_off_us=200)
+    >>> nuc.wave_upload(w)
+    >>> nuc.wave_run(repeats=10).result()
+    """
+
+    def __init__(self, steps: Iterable[WaveStep] = ()):
+        self.steps: list[WaveStep] = []
+        for s in steps:
+            self.add_ticks(s.state, s.ticks)
+
+    def __len__(self) -> int:
+        return len(self.steps)
+
+    def __iter__(self):
+        return iter(self.steps)
+
+    @property
+    def duration_us(self) -> float:
+        """Dauer eines Durchlaufs in µs."""
+        return sum(s.ticks for s in self.steps) * TICK_US
+
+    def add_ticks(self, state: int, ticks: int) -> "Waveform":
+        """Hängt einen Schritt an (Dauer in Ticks)."""
+        ticks = max(MIN_TICKS, int(ticks))
+        while ticks > 0:
+            part = min(ticks, MAX_TICKS)
+            if ticks - part and ticks - part < MIN_TICKS:
+                part -= MIN_TICKS          # Rest nicht kürzer als ein Mindestschritt
+            self.steps.append(WaveStep(int(state), part))
+            ticks -= part
+        if len(self.steps) > MAX_STEPS:
+            raise ValueError(f"Waveform zu lang: {len(self.steps)} > {MAX_STEPS} Schritte")
+        return self
+
+    def add(self, state: int, us: float) -> "Waveform":
+        """Hängt einen Schritt an (Dauer in µs, Auflösung 0.1 µs)."""
+        return self.add_ticks(state, ticks_from_us(us))
+
+    # ---------- typische Profile ----------
+    @classmethod
+    def pulse_pair(cls, t1_us: float, t_off_us: float = 0.0) -> "Waveform":
+        """Das klassische Pulspaar (positiv, negativ) wie im Timer-Betrieb."""
+        w = cls().add(BridgeState.POS, t1_us).add(BridgeState.NEG, t1_us)
+        if t_off_us > 0:
+            w.add(BridgeState.OFF, t_off_us)
+        return w
+
+    @classmethod
+    def burst(cls, n: int, t_on_us: float, t_off_us: float, *, bipolar: bool = True,
+              idle: int = BridgeState.ZERO_LOW) -> "Waveform":
+        """
+        Burst aus n Pulsen mit Pausen.
+
+        Parameters
+        ----------
+        n : int
+            Anzahl Pulse
+        t_on_us, t_off_us : float
+            Puls- und Pausendauer in µs
+        bipolar : bool, optional
+            Polarität abwechselnd (sonst nur positiv), by default True
+        idle : int, optional
+            Zustand in den Pausen, by default ``ZERO_LOW`` (Freilauf)
+        """
+        w = cls()
+        for k in range(n):
+            w.add(BridgeState.NEG if bipolar and k % 2 else BridgeState.POS, t_on_us)
+            if k + 1 < n:
+                w.add(idle, t_off_us)
+        return w
+
+    @classmethod
+    def ripple(cls, freq_hz: float, periods: int, duty: float = 1.0, *,
+               idle: int = BridgeState.ZERO_LOW) -> "Waveform":
+        """
+        Rechteck-Ripple: je Periode positive und negative Halbwelle.
+
+        Parameters
+        ----------
+        freq_hz : float
+            Ripple-Frequenz
+        periods : int
+            Anzahl Perioden
+        duty : float, optional
+            Anteil jeder Halbwelle mit Spannung (Rest Freilauf), by default 1.0
+        """
+        half_us = 0.5e6 / freq_hz
+        on_us = half_us * min(max(duty, 0.0), 1.0)
+        w = cls()
+        for _ in range(periods):
+            for st in (BridgeState.POS, BridgeState.NEG):
+                if on_us >= MIN_TICKS * TICK_US:
+                    w.add(st, on_us)
+                if half_us - on_us >= MIN_TICKS * TICK_US:
+                    w.add(idle, half_us - on_us)
+        return w
+
+
+def crc16(steps: Iterable[WaveStep]) -> int:
+    """CRC16-CCITT (0x1021, Start 0xFFFF) wie ``wave_crc()`` der Firmware."""
+    crc = 0xFFFF
+    for s in steps:
+        for b in (s.state & 0xFF, s.ticks & 0xFF, (s.ticks >> 8) & 0xFF):
+            crc ^= b << 8
+            for _ in range(8):
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def encode_wave_frames(steps: Iterable[WaveStep]) -> list[bytes]:
+    """Teilt die Tabelle in WAVE_DATA-Frames (je bis zu 3 Schritte)."""
+    steps = list(steps)
+    frames = []
+    for idx in range(0, len(steps), STEPS_PER_FRAME):
+        chunk = steps[idx:idx + STEPS_PER_FRAME]
+        out = bytearray([PREAMBLE, WAVE_CMD, idx & 0xFF, (idx >> 8) & 0xFF, len(chunk)])
+        for s in chunk:
+            out += bytes([s.state & 0xFF, s.ticks & 0xFF, (s.ticks >> 8) & 0xFF])
+        out += bytes(WAVE_DATA_SIZE - len(out))
+        frames.append(bytes(out))
+    return frames
+
+
+def decode_wave_data_frame(frame: bytes) -> tuple[int, list[WaveStep]]:
+    """Startindex und Schritte eines WAVE_DATA-Frames (Simulator, Tests)."""
+    if len(frame) != WAVE_DATA_SIZE or frame[0] != PREAMBLE or frame[1] != WAVE_CMD:
+        raise ValueError(f"kein WAVE-Frame: {frame.hex(' ')}")
+    idx = int.from_bytes(frame[2:4], "little")
+    n = frame[4]
+    steps = [WaveStep(frame[5 + 3 * k], int.from_bytes(frame[6 + 3 * k:8 + 3 * k], "little"))
+             for k in range(min(n, STEPS_PER_FRAME))]
+    return idx, steps
+
+
+def decode_wave_ack(frame: bytes) -> WaveAck:
+    """Dekodiert die Antwort auf WAVE_DATA (5 Bytes) oder WAVE_CTRL (7 Bytes)."""
+    status = frame[-1]
+    return WaveAck(
+        length=int.from_bytes(frame[2:4], "little"),
+        crc=int.from_bytes(frame[4:6], "little") if frame[1] == WAVE_CTRL_CMD else -1,
+        running=bool(status & WAVE_ST_RUNNING),
+        stored=bool(status & WAVE_ST_STORED),
+        rejected=bool(status & WAVE_ST_REJECT),
+    )
@@ -0,0 +1,214 @@
+"""
+Client für den Mess-Daemon (GUI, Skripte, Überwachung).
+
+Ein Lese-Thread ordnet Antworten über die Request-ID zu und ruft für
+abonnierte Themen die registrierten Callbacks auf (im Lese-Thread, also
+kurz halten bzw. in die eigene Event-Schleife weiterreichen).
+
+Example
+-------
+>>> with DaemonClient() as c:
+...     c.subscribe(["params"], lambda topic, d: print(d["esr"], d["cap"]))
+...     c.nucleo("set_timer", 1, 500.0)
+...     c.pico_start({"run_name": "nacht_01"}, n_pulses=100_000)
+"""
+
+import itertools
+import os
+import socket
+import subprocess
+import sys
+import threading
+import time
+from concurrent.futures import Future
+from typing import Callable, Iterable, Optional
+
+from pico_pulse_lab.daemon.protocol import DEFAULT_HOST, DEFAULT_PORT, TOPICS, decode, encode
+
+
+# Projektverzeichnis (enthält pico_pulse_lab) für den Start des Daemons
+_project_dir = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+
+class DaemonError(RuntimeError):
+    """Der Daemon hat ein Kommando abgelehnt oder ist nicht erreichbar."""
+
+
+class DaemonClient:
+    """
+    Verbindung zum Mess-Daemon.
+
+    Parameters
+    ----------
+    host, port : str, int
+        Adresse des Daemons, by default 127.0.0.1:47650
+    timeout : float, optional
+        Standard-Wartezeit auf Antworten in Sekunden, by default 10.0
+    """
+
+    def __init__(self, host: str = DEFAULT_HOST, port: int = DEFAULT_PORT, timeout: float = 10.0):
+        self.timeout = timeout
+        self._sock = socket.create_connection((host, port), timeout=timeout)
+        self._sock.settimeout(None)
+        self._ids = itertools.count(1)
+        self._pending: dict[int, Future] = {}
+        self._listeners: dict[str, list[Callable[[str, dict], None]]] = {}
+        self._lock = threading.Lock()
+        self._send_lock = threading.Lock()
+        self._reader = threading.Thread(target=self._read_loop, name="daemon-client", daemon=True)
+        self._reader.start()
+
+    def request(self, cmd: str, timeout: Optional[float] = None, **args):
+        """Sendet ein Kommando und wartet auf das Ergebnis (``DaemonError`` bei Fehler)."""
+        fut: Future = Future()
+        with self._lock:
+            req_id = next(self._ids)
+            self._pending[req_id] = fut
+        try:
+            with self._send_lock:
+                self._sock.sendall(encode({"id": req_id, "cmd": cmd, "args": args}))
+        except OSError as e:
+            with self._lock:
+                self._pending.pop(req_id, None)
+            raise DaemonError(f"Daemon nicht erreichbar: {e}") from e
+        return fut.result(self.timeout if timeout is None else timeout)
+
+    def subscribe(self, topics: Iterable[str] = TOPICS,
+                  callback: Optional[Callable[[str, dict], None]] = None) -> list:
+        """Abonniert Themen; ``callback(topic, data)`` wird je Nachricht aufgerufen."""
+        topics = [topics] if isinstance(topics, str) else list(topics)
+        if callback is not None:
+            with self._lock:
+                for t in topics:
+                    self._listeners.setdefault(t, []).append(callback)
+        return self.request("subscribe", topics=topics)
+
+    def unsubscribe(self, topics: Iterable[str] = TOPICS) -> list:
+        topics = [topics] if isinstance(topics, str) else list(topics)
+        with self._lock:
+            for t in topics:
+                self._listeners.pop(t, None)
+        return self.request("unsubscribe", topics=topics)
+
+    # ---- Kommandos ----
+
+    def state(self) -> dict:
+        return self.request("state")
+
+    def nucleo_connect(self, port: str, baudrate: int = 115200) -> bool:
+        return self.request("nucleo_connect", port=port, baudrate=baudrate)
+
+    def nucleo_disconnect(self) -> bool:
+        return self.request("nucleo_disconnect")
+
+    def nucleo(self, method: str, *args, **kwargs):
+        """Ruft eine ``NucleoLink``-Methode im Daemon auf (Antwort als dict/Liste)."""
+        return self.request("nucleo", method=method, args=list(args), kwargs=kwargs)
+
+    def pico_start(self, config: dict, n_pulses: int = 1000, **kwargs) -> dict:
+        return self.request("pico_start", config=config, n_pulses=n_pulses, **kwargs)
+
+    def pico_stop(self) -> bool:
+        return self.request("pico_stop")
+
+    def temp_start(self, interval_s: float = 0.5) -> bool:
+        return self.request("temp_start", interval_s=interval_s)
+
+    def temp_stop(self) -> bool:
+        return self.request("temp_stop")
+
+    def shutdown(self) -> bool:
+        """Beendet den Daemon (inklusive laufender Messung)."""
+        return self.request("shutdown")
+
+    def close(self) -> None:
+        try:
+            self._sock.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+        self._sock.close()
+        if self._reader is not threading.current_thread():
+            self._reader.join(timeout=1.0)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    # ---- Lese-Thread ----
+
+    def _read_loop(self) -> None:
+        try:
+            with self._sock.makefile("rb") as rf:
+                for line in rf:
+                    if line.strip():
+                        self._handle(decode(line))
+        except (OSError, ValueError):
+            pass
+        with self._lock:
+            pending, self._pending = self._pending, {}
+        for fut in pending.values():
+            fut.set_exception(DaemonError("Verbindung zum Daemon getrennt"))
+
+    def _handle(self, msg: dict) -> None:
+        if "topic" in msg:
+            with self._lock:
+                listeners = list(self._listeners.get(msg["topic"], ()))
+            for cb in listeners:
+                try:
+                    cb(msg["topic"], msg["data"])
+                except Exception as e:
+                    print(f"[DaemonClient] Callback-Fehler ({msg['topic']}): {e}")
+            return
+        with self._lock:
+            fut = self._pending.pop(msg.get("id"), None)
+        if fut is None:
+            return
+        if msg.get("ok"):
+            fut.set_result(msg.get("result"))
+        else:
+            fut.set_exception(DaemonError(msg.get("error", "unbekannter Fehler")))
+
+
+def connect_or_spawn(host: str = DEFAULT_HOST, port: int = DEFAULT_PORT, *,
+                     start_timeout: float = 15.0, **kwargs) -> DaemonClient:
+    """
+    Verbindet mit dem laufenden Daemon oder startet ihn vorher als eigenen Prozess.
+
+    Der gestartete Daemon ist vom Aufrufer unabhängig und läuft weiter, wenn
+    dieser (z.B. die GUI) beendet wird; beenden über ``shutdown()``.
+
+    Parameters
+    ----------
+    host, port : str, int
+        Adresse des Daemons
+    start_timeout : float, optional
+        Wartezeit auf den neu gestarteten Daemon in Sekunden, by default 15.0
+    **kwargs
+        Weitere Argumente für ``DaemonClient``
+
+    Raises
+    ------
+    DaemonError
+        Wenn der Daemon auch nach dem Start nicht erreichbar ist.
+    """
+    try:
+        return DaemonClient(host, port, **kwargs)
+    except OSError:
+        pass
+    flags = getattr(subprocess, "CREATE_NEW_PROCESS_GROUP", 0)  # Strg+C der GUI nicht weiterreichen
+    proc = subprocess.Popen([sys.executable, "-m", "pico_pulse_lab.daemon.server",
+                             "--host", host, "--port", str(port)],
+                            cwd=_project_dir, creationflags=flags,
+                            start_new_session=(os.name != "nt"))
+    t_end = time.monotonic() + start_timeout
+    while True:
+        try:
+            return DaemonClient(host, port, **kwargs)
+        except OSError as e:
+            if proc.poll() is not None:
+                raise DaemonError(f"Daemon beendet (Exitcode {proc.returncode})") from e
+            if time.monotonic() > t_end:
+                raise DaemonError(f"Daemon auf {host}:{port} nicht erreichbar: {e}") from e
+        time.sleep(0.2)
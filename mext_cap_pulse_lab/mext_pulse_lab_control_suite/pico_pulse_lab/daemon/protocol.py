@@ -0,0 +1,97 @@
+"""
+Protokoll zwischen Mess-Daemon und Clients (GUI, Skripte, Überwachung).
+
+Verbindung über TCP auf localhost, je Nachricht eine Zeile JSON (UTF-8, ``\\n``):
+
+    Client -> Daemon   {"id": 7, "cmd": "pico_start", "args": {...}}
+    Daemon -> Client   {"id": 7, "ok": true, "result": ...}
+                       {"id": 7, "ok": false, "error": "..."}
+    Daemon -> Client   {"topic": "pulse", "data": {...}}        (nach "subscribe")
+
+Themen (``TOPICS``): ``pulse`` (dezimierte Kurven je Puls), ``params``
+(ESR/C), ``status`` (Firmware-STATUS), ``event`` (Firmware-Events), ``adc``
+(ADC-Messdaten der Firmware), ``temp`` (TC-08) und ``log`` (Meldungen des
+Daemons und Textzeilen der Firmware). Die vollen Rohdaten liegen im
+Puls-Ring des Daemons (Name in ``state``), lokale Leser hängen sich direkt an.
+"""
+
+import base64
+import json
+from typing import Any
+
+import numpy as np
+
+DEFAULT_HOST = "127.0.0.1"
+DEFAULT_PORT = 47650
+TOPICS = ("pulse", "params", "status", "event", "adc", "temp", "log")
+LIVE_POINTS = 2000          # Punkte je Kurve im Thema "pulse" (Min/Max-Paare)
+
+
+def encode(msg: dict) -> bytes:
+    """Nachricht als JSON-Zeile."""
+    return json.dumps(msg, separators=(",", ":"), ensure_ascii=False).encode("utf-8") + b"\n"
+
+
+def decode(line: bytes) -> dict:
+    """JSON-Zeile als Nachricht."""
+    return json.loads(line.decode("utf-8"))
+
+
+def to_jsonable(obj: Any) -> Any:
+    """Antworten der Firmware-Clients (NamedTuples, Tupel, numpy-Werte) in JSON-Typen."""
+    if hasattr(obj, "_asdict"):
+        return {k: to_jsonable(v) for k, v in obj._asdict().items()}
+    if isinstance(obj, dict):
+        return {str(k): to_jsonable(v) for k, v in obj.items()}
+    if isinstance(obj, (list, tuple)):
+        return [to_jsonable(v) for v in obj]
+    if isinstance(obj, np.ndarray):
+        return obj.tolist()
+    if isinstance(obj, np.generic):
+        return obj.item()
+    return obj
+
+
+def decimate_minmax(y: np.ndarray, n_points: int = LIVE_POINTS) -> tuple:
+    """
+    Min/Max-Dezimierung für die Live-Anzeige (Spitzen bleiben sichtbar).
+
+    Returns
+    -------
+    tuple
+        (Indizes, Werte): je Block das Minimum und Maximum in zeitlicher Reihenfolge.
+    """
+    n = len(y)
+    if n <= n_points:
+        return np.arange(n), np.asarray(y)
+    block = -(-n // (n_points // 2))
+    m = n // block
+    blocks = np.asarray(y)[:m * block].reshape(m, block)
+    i_min, i_max = blocks.argmin(axis=1), blocks.argmax(axis=1)
+    lo, hi = np.minimum(i_min, i_max), np.maximum(i_min, i_max)
+    base = np.arange(m) * block
+    idx = np.column_stack((base + lo, base + hi)).ravel()
+    return idx, np.asarray(y)[idx]
+
+
+def _b64(a: np.ndarray) -> str:
+    return base64.b64encode(np.ascontiguousarray(a, dtype="<f4").tobytes()).decode("ascii")
+
+
+def _unb64(s: str) -> np.ndarray:
+    return np.frombuffer(base64.b64decode(s), dtype="<f4").astype(np.float64)
+
+
+def pack_trace(pulse_id: int, t: np.ndarray, u: np.ndarray, i: np.ndarray,
+               n_points: int = LIVE_POINTS) -> dict:
+    """Puls für das Thema ``pulse``: U und I getrennt dezimiert, float32 als Base64."""
+    iu, ud = decimate_minmax(u, n_points)
+    ii, id_ = decimate_minmax(i, n_points)
+    return {"pulse_id": int(pulse_id), "n_samples": len(t),
+            "t_u": _b64(t[iu]), "u": _b64(ud), "t_i": _b64(t[ii]), "i": _b64(id_)}
+
+
+def unpack_trace(data: dict) -> tuple:
+    """Gegenstück zu ``pack_trace``: (pulse_id, t_u, u, t_i, i) als float64-Arrays."""
+    return (data["pulse_id"], _unb64(data["t_u"]), _unb64(data["u"]),
+            _unb64(data["t_i"]), _unb64(data["i"]))
@@ -0,0 +1,620 @@
+"""
+Mess-Daemon ohne GUI: besitzt PicoScope, Nucleo-Link und TC-08.
+
+Der Daemon läuft als eigener Prozess (auch über Nacht, unabhängig davon, ob
+eine GUI reagiert) und wird über eine lokale TCP-Verbindung gesteuert
+(Protokoll siehe ``protocol.py``). Beliebig viele Clients können gleichzeitig
+verbunden sein und Datenströme abonnieren.
+
+- Die Erfassung läuft in einem langlebigen Kindprozess (``acquisition_worker``),
+  dessen ``PicoReader`` die Geräte-Session über alle Messläufe offen hält; je
+  Lauf bekommt er Konfiguration und Start über eine Queue. Er schreibt
+  Roh-ADC-Werte in einen Puls-Ring; ein Thread des Daemons liest daraus,
+  wendet dieselbe Sensor-Korrektur (``filters``) wie der Speicherpfad an,
+  schätzt ESR/C (auf Wunsch aus kohärent gemittelten Pulsen) und verteilt
+  dezimierte Kurven.
+- Der ``NucleoLink`` gehört dem Daemon; Clients rufen dessen Methoden über
+  das Kommando ``nucleo`` auf, Firmware-Events, STATUS und ADC-Messdaten
+  werden verteilt. Mit ``window_fs`` folgt das Erfassungsfenster T1 der
+  Firmware (``WindowTracker``), auch während eines Laufs im Erfassungsprozess.
+- Langsame Clients bremsen nichts: Datenströme gehen über eine begrenzte
+  Warteschlange je Client, bei Überlauf werden Nachrichten verworfen.
+
+Start::
+
+    python -m pico_pulse_lab.daemon.server --nucleo COM5 --temp
+"""
+
+import argparse
+import copy
+import multiprocessing as mp
+import os
+import queue
+import socket
+import sys
+import threading
+import time
+from typing import Callable, Optional
+
+# Python-Pfad wie bei den anderen Einstiegspunkten: daemon -> pico_pulse_lab -> Projekt
+_parent_dir = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+if _parent_dir not in sys.path:
+    sys.path.insert(0, _parent_dir)
+
+from pico_pulse_lab.acquisition.picoscope_reader import (PicoReader, acquisition_worker,
+                                                          range_fullscale_volts)
+from pico_pulse_lab.acquisition.pulse_ring import PulseRing, RingOverrun
+from pico_pulse_lab.acquisition.temp_logger import TempLogger
+from pico_pulse_lab.control.capture_window import WindowTracker
+from pico_pulse_lab.control.stm32_uart import NucleoLink
+from pico_pulse_lab.control.telemetry import AdcMonitor, StatusPoller
+from pico_pulse_lab.daemon.protocol import (DEFAULT_HOST, DEFAULT_PORT, LIVE_POINTS, TOPICS,
+                                            decode, encode, pack_trace, to_jsonable)
+from pico_pulse_lab.processing.averaging import CoherentAverager
+from pico_pulse_lab.processing.cap_params import estimate_band_params, estimate_cap_params
+from pico_pulse_lab.processing.sensor_filter import build_filters, filters_meta
+from pico_pulse_lab.processing.uncertainty import ErrorModel, monte_carlo
+
+OUT_QUEUE = 256             # Nachrichten je Client, darüber werden Datenströme verworfen
+NUCLEO_TIMEOUT_S = 5.0
+ACQ_EXIT_TIMEOUT_S = 10.0   # Warten auf das Ende des Erfassungsprozesses (Gerät schließen)
+
+# Methoden des NucleoLink, die Clients über "nucleo" aufrufen dürfen (JSON-Argumente)
+NUCLEO_METHODS = frozenset({
+    "set_timer", "start_sequence", "stop_timer", "configure", "retime", "fire", "cycle_count",
+    "status", "protection", "clear_fault", "adc_stream", "wave_control", "wave_run",
+    "wave_stop", "wave_save", "wave_load", "configure_channel", "channel_control",
+    "channel_start", "channel_stop", "multi_exit", "configure_rate", "readback",
+})
+
+
+class _Client:
+    """Verbindung eines Clients: abonnierte Themen und eigener Sende-Thread."""
+
+    def __init__(self, sock: socket.socket, addr):
+        self.sock = sock
+        self.addr = addr
+        self.topics: set[str] = set()
+        self.dropped = 0
+        self._q: queue.Queue = queue.Queue(maxsize=OUT_QUEUE)
+        self._writer = threading.Thread(target=self._write_loop, name=f"client-{addr}",
+                                        daemon=True)
+        self._writer.start()
+
+    def send(self, msg: dict, stream: bool = False) -> None:
+        """Antworten warten auf Platz, Datenströme werden bei vollem Puffer verworfen."""
+        try:
+            if stream:
+                self._q.put_nowait(msg)
+            else:
+                self._q.put(msg, timeout=NUCLEO_TIMEOUT_S)
+        except queue.Full:
+            self.dropped += 1
+
+    def close(self) -> None:
+        try:
+            self._q.put_nowait(None)
+        except queue.Full:
+            pass
+        try:
+            self.sock.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+
+    def _write_loop(self) -> None:
+        while True:
+            msg = self._q.get()
+            if msg is None:
+                break
+            try:
+                self.sock.sendall(encode(msg))
+            except OSError:
+                break
+
+
+class LabDaemon:
+    """
+    Headless-Messdienst mit lokaler Steuerschnittstelle.
+
+    Parameters
+    ----------
+    host, port : str, int
+        Adresse des Steuer-Sockets, by default 127.0.0.1:47650 (Port 0 = frei wählen)
+    ring_slots : int, optional
+        Slots des Puls-Rings, by default 8
+    param_interval_s : float, optional
+        Mindestabstand der ESR/C-Schätzung, by default 2.0 (wie bisher in der GUI)
+    status_hz : float, optional
+        STATUS-Abfragerate der Firmware, by default 5.0
+    window_fs : float, optional
+        Abtastrate für das an T1 der Firmware angepasste Erfassungsfenster
+        (``control/capture_window.py``), None = Fenster aus der Konfiguration,
+        by default None
+
+    Examples
+    --------
+    >>> d = LabDaemon(port=0)
+    >>> d.start()
+    >>> DaemonClient(port=d.port).state()
+    """
+
+    def __init__(self, host: str = DEFAULT_HOST, port: int = DEFAULT_PORT, *,
+                 ring_slots: int = 8, param_interval_s: float = 2.0, status_hz: float = 5.0,
+                 live_points: int = LIVE_POINTS, window_fs: Optional[float] = None):
+        self.host, self.port = host, port
+        self.ring_slots = ring_slots
+        self.param_interval_s = param_interval_s
+        self.status_hz = status_hz
+        self.live_points = live_points
+        self.window_fs = window_fs
+
+        self.nuc: Optional[NucleoLink] = None
+        self.status_poller: Optional[StatusPoller] = None
+        self.adc_monitor: Optional[AdcMonitor] = None
+        self.temp_logger: Optional[TempLogger] = None
+        self.window: Optional[WindowTracker] = None
+        self._pending_window: Optional[tuple] = None  # (fs, pre, post) für den nächsten Lauf
+
+        self.ring: Optional[PulseRing] = None
+        self._proc: Optional[mp.Process] = None      # Erfassungsprozess, lebt über Läufe
+        self._acq_cmds = self._acq_events = self._stop_evt = None
+        self._probe: Optional[PicoReader] = None     # Spiegel der Konfiguration (ohne Gerät)
+        self._running = threading.Event()            # Messlauf aktiv
+        self._consumer: Optional[threading.Thread] = None
+        self.pulse_count = 0
+        self.lost = 0
+        self.latest_params = None       # {"pulse_id", "esr", "cap", "t", "n_avg", "bands", "ci"}
+        self.n_bands = 0                # ESR(f)/C(f)-Bänder je Schätzung, 0 = aus
+        self.n_draws = 0                # Monte-Carlo-Ziehungen je Schätzung, 0 = aus
+        self.error_model: Optional[ErrorModel] = None
+        self.averager: Optional[CoherentAverager] = None
+        self.filter_spec: Optional[dict] = None     # wie PicoReader.filters, je Lauf
+        self._filters: dict = {}                    # Kanal -> OverlapSave für die Ring-Rate
+        self._filters_dt: Optional[float] = None
+
+        self._clients: list[_Client] = []
+        self._lock = threading.Lock()
+        self._sock: Optional[socket.socket] = None
+        self._done = threading.Event()
+        self._commands: dict[str, Callable] = {
+            "state": self.state,
+            "subscribe": None, "unsubscribe": None,     # je Client, siehe _dispatch
+            "nucleo_connect": self.nucleo_connect,
+            "nucleo_disconnect": self.nucleo_disconnect,
+            "nucleo": self.nucleo_call,
+            "pico_start": self.pico_start,
+            "pico_stop": self.pico_stop,
+            "temp_start": self.temp_start,
+            "temp_stop": self.temp_stop,
+            "shutdown": self._request_shutdown,
+        }
+
+    # ============ Server ============
+
+    def start(self) -> None:
+        """Öffnet den Steuer-Socket und nimmt Clients in einem Hintergrund-Thread an."""
+        self._sock = socket.create_server((self.host, self.port))
+        self.port = self._sock.getsockname()[1]
+        threading.Thread(target=self._accept_loop, name="daemon-accept", daemon=True).start()
+        self.log(f"Daemon bereit auf {self.host}:{self.port}")
+
+    def serve_forever(self) -> None:
+        """Startet und blockiert bis ``shutdown`` (Kommando oder Strg+C)."""
+        if self._sock is None:
+            self.start()
+        try:
+            while not self._done.wait(0.5):
+                pass
+        except KeyboardInterrupt:
+            pass
+        finally:
+            self.shutdown()
+
+    def shutdown(self) -> None:
+        """Beendet Messung, Temperaturlogger, Nucleo-Link und alle Verbindungen."""
+        self._done.set()
+        self.pico_stop()
+        if self._consumer is not None:
+            self._consumer.join(timeout=10.0)
+        self._stop_acquisition()
+        self.temp_stop()
+        self.nucleo_disconnect()
+        if self._sock is not None:
+            self._sock.close()
+            self._sock = None
+        with self._lock:
+            clients, self._clients = self._clients, []
+        for c in clients:
+            c.close()
+        if self.ring is not None:
+            self.ring.close()
+            self.ring = None
+
+    def _accept_loop(self) -> None:
+        while not self._done.is_set():
+            try:
+                sock, addr = self._sock.accept()
+            except OSError:
+                break
+            client = _Client(sock, addr)
+            with self._lock:
+                self._clients.append(client)
+            threading.Thread(target=self._client_loop, args=(client,), daemon=True).start()
+
+    def _client_loop(self, client: _Client) -> None:
+        try:
+            with client.sock.makefile("rb") as rf:
+                for line in rf:
+                    if line.strip():
+                        self._dispatch(client, line)
+        except OSError:
+            pass
+        finally:
+            with self._lock:
+                if client in self._clients:
+                    self._clients.remove(client)
+            client.close()
+
+    def _dispatch(self, client: _Client, line: bytes) -> None:
+        req_id = None
+        try:
+            msg = decode(line)
+            req_id, cmd, args = msg.get("id"), msg.get("cmd"), msg.get("args") or {}
+            if cmd in ("subscribe", "unsubscribe"):
+                topics = set(args.get("topics") or TOPICS)
+                unknown = topics - set(TOPICS)
+                if unknown:
+                    raise ValueError(f"unbekannte Themen: {sorted(unknown)}")
+                client.topics = client.topics | topics if cmd == "subscribe" else client.topics - topics
+                result = sorted(client.topics)
+            elif cmd in self._commands:
+                result = self._commands[cmd](**args)
+            else:
+                raise ValueError(f"unbekanntes Kommando: {cmd}")
+            client.send({"id": req_id, "ok": True, "result": to_jsonable(result)})
+        except Exception as e:
+            client.send({"id": req_id, "ok": False, "error": f"{type(e).__name__}: {e}"})
+
+    def publish(self, topic: str, data) -> None:
+        """Verteilt eine Nachricht an alle Clients, die das Thema abonniert haben."""
+        with self._lock:
+            targets = [c for c in self._clients if topic in c.topics]
+        if not targets:
+            return
+        msg = {"topic": topic, "data": to_jsonable(data)}
+        for c in targets:
+            c.send(msg, stream=True)
+
+    def subscribed(self, topic: str) -> bool:
+        with self._lock:
+            return any(topic in c.topics for c in self._clients)
+
+    def log(self, text: str) -> None:
+        print(f"[Daemon] {text}")
+        self.publish("log", {"source": "daemon", "text": text, "t": time.time()})
+
+    def _request_shutdown(self) -> bool:
+        # Antwort geht noch raus, serve_forever() räumt danach auf
+        self._done.set()
+        return True
+
+    def state(self) -> dict:
+        """Überblick für Clients (auch als Lebenszeichen)."""
+        with self._lock:
+            clients = [{"addr": str(c.addr), "topics": sorted(c.topics), "dropped": c.dropped}
+                       for c in self._clients]
+        return {
+            "nucleo": self.nuc is not None,
+            "pico_running": self._running.is_set(),
+            "acq_pid": self._proc.pid if self._proc is not None and self._proc.is_alive() else None,
+            "pulses": self.pulse_count,
+            "lost": self.lost,
+            "ring": self.ring.name if self.ring is not None else None,
+            "temp_running": bool(self.temp_logger and self.temp_logger.is_running),
+            "params": self.latest_params,
+            "filters": filters_meta(self._filters),
+            "status": self.status_poller.latest if self.status_poller else None,
+            "clients": clients,
+        }
+
+    # ============ Nucleo ============
+
+    def nucleo_connect(self, port: str = "", baudrate: int = 115200, *, ser=None) -> bool:
+        """Öffnet den UART-Link (``ser`` nur für Tests im selben Prozess)."""
+        if self.nuc is not None:
+            raise RuntimeError("Nucleo bereits verbunden")
+        self.nuc = NucleoLink(port=port, baudrate=baudrate, timeout=1.0, ser=ser,
+                              on_line=lambda l: self.publish("log", {"source": "nucleo",
+                                                                      "text": l,
+                                                                      "t": time.time()}))
+        self.nuc.add_event_listener(self._on_event)
+        self.status_poller = StatusPoller(self.nuc, rate_hz=self.status_hz,
+                                          on_status=lambda st: self.publish("status", st))
+        self.status_poller.start()
+        self.adc_monitor = AdcMonitor(self.nuc, on_record=lambda rec: self.publish("adc", rec))
+        self.log(f"Nucleo verbunden ({port or 'ser'})")
+        if self.window_fs:
+            self.window = WindowTracker(self.nuc, self, fs=self.window_fs)
+            try:
+                self.window.sync(NUCLEO_TIMEOUT_S)
+            except Exception as e:
+                self.log(f"Erfassungsfenster: T1 nicht gelesen ({e})")
+        return True
+
+    def nucleo_disconnect(self) -> bool:
+        self.window = None
+        if self.status_poller is not None:
+            self.status_poller.stop()
+            self.status_poller = None
+        if self.adc_monitor is not None:
+            self.adc_monitor.close()
+            self.adc_monitor = None
+        if self.nuc is not None:
+            try:
+                self.nuc.close()
+            except Exception:
+                pass
+            self.nuc = None
+            self.log("Nucleo getrennt")
+        return True
+
+    def _on_event(self, ev) -> None:
+        self.publish("event", ev)
+
+    def nucleo_call(self, method: str, args: list = (), kwargs: Optional[dict] = None):
+        """Ruft eine freigegebene ``NucleoLink``-Methode auf und wartet auf die Antwort."""
+        if self.nuc is None:
+            raise RuntimeError("Nucleo nicht verbunden")
+        if method not in NUCLEO_METHODS:
+            raise ValueError(f"Methode nicht freigegeben: {method}")
+        if method == "adc_stream":
+            # über den Monitor, damit dessen Dezimierung (Verlustzählung) stimmt
+            return self.adc_monitor.enable(*args, **{"timeout": NUCLEO_TIMEOUT_S, **(kwargs or {})})
+        reply = getattr(self.nuc, method)(*args, **(kwargs or {}))
+        reply = reply.result(NUCLEO_TIMEOUT_S) if hasattr(reply, "result") else reply
+        if method == "configure" and self.window is not None:
+            self.window.apply(reply.t1_us)          # CONFIG meldet kein Event
+        return reply
+
+    # ============ Picoscope ============
+
+    def pico_start(self, config: dict, n_pulses: int = 1000, save_csv: bool = False,
+                   save_npz: bool = True, captures_per_arm: int = 1, average: int = 0,
+                   bands: int = 0, uncertainty: int = 0) -> dict:
+        """
+        Startet einen Messlauf im Erfassungsprozess (beim ersten Aufruf gestartet).
+
+        Die Konfiguration wirkt wie ``PicoReader.configure()`` auf den Reader
+        des Prozesses: nicht angegebene Einstellungen bleiben vom vorigen Lauf.
+
+        Parameters
+        ----------
+        config : dict
+            Argumente für ``PicoReader.configure()`` (mindestens ``run_name``)
+        n_pulses : int, optional
+            Anzahl Pulse, by default 1000
+        average : int, optional
+            ESR/C aus dem kohärenten Mittel der letzten ``average`` Pulse
+            schätzen, 0 = aus dem Einzelpuls, by default 0
+        bands : int, optional
+            Zusätzlich ESR(f)/C(f) in so vielen logarithmischen Bändern
+            (``latest_params["bands"]``), 0 = aus, by default 0
+        uncertainty : int, optional
+            Konfidenzintervalle für ESR/C aus so vielen Monte-Carlo-Ziehungen
+            (``latest_params["ci"]``), 0 = aus, by default 0
+        """
+        if self._running.is_set():
+            raise RuntimeError("Messung läuft bereits")
+        self._ensure_acquisition()
+        # Erst auf einer Kopie prüfen: ein abgelehnter Start darf den Spiegel nicht
+        # gegen den Reader des Prozesses verschieben (der bekommt die Konfiguration nicht)
+        probe = copy.copy(self._probe)
+        window = self._pending_window
+        if window is not None:
+            probe.set_window(*window)       # wie im Prozess: vor der Konfiguration
+        probe.configure(**config)
+        build_filters(probe.filters, probe.target_fs)       # Fehler vor dem Start melden
+        self._probe = probe
+        if self.ring is None or self.ring.slot_samples < probe.n_samples:
+            if self.ring is not None:
+                self.ring.close()
+            self.ring = PulseRing.create(self.ring_slots, probe.n_samples)
+        self.ring.mark_closed(False)
+        self.averager = CoherentAverager(window=average) if average > 0 else None
+        self.n_bands = int(bands)
+        self.n_draws = int(uncertainty)
+        self.filter_spec = probe.filters
+        self._filters, self._filters_dt = {}, None
+        self.error_model = ErrorModel.from_meta({
+            "ch_a": {"v_range": range_fullscale_volts(probe.range_a),
+                     "u_probe_attenuation": probe.u_probe_attenuation},
+            "ch_b": {"v_range": range_fullscale_volts(probe.range_b),
+                     "rogowski_v_per_a": probe.rogowski_v_per_a}})
+
+        self.pulse_count = 0
+        self.lost = 0
+        self._stop_evt.clear()
+        self._running.set()
+        cursor = self.ring.cursor()
+        if window is not None:
+            self._acq_cmds.put(("set_window", *window))
+            self._pending_window = None
+        self._acq_cmds.put((self.ring.name, config, n_pulses,
+                            dict(save_csv=save_csv, save_npz=save_npz,
+                                 captures_per_arm=captures_per_arm)))
+        self._consumer = threading.Thread(target=self._consume, args=(self._proc, cursor),
+                                          name="ring-consumer", daemon=True)
+        self._consumer.start()
+        self.log(f"Messung gestartet: {config.get('run_name')} ({n_pulses} Pulse)")
+        return {"ring": self.ring.name, "slot_samples": self.ring.slot_samples}
+
+    def pico_stop(self) -> bool:
+        if self._running.is_set():
+            self._stop_evt.set()
+        return True
+
+    def set_window(self, target_fs: float, pre_samples: int, post_samples: int) -> None:
+        """
+        Erfassungsfenster vom ``WindowTracker`` (läuft im Reader-Thread des Links).
+
+        Während eines Laufs geht es sofort an den Erfassungsprozess (dort ab dem
+        nächsten Block), sofern es in die Slots des Rings passt; sonst und
+        zwischen den Läufen gilt es ab dem nächsten ``pico_start``.
+        """
+        window = (float(target_fs), int(pre_samples), int(post_samples))
+        if self._running.is_set():
+            if self.ring.slot_samples >= window[1] + window[2]:
+                self._acq_cmds.put(("set_window", *window))
+                self._probe.set_window(*window)
+                self._pending_window = None
+                return
+            self.log(f"Erfassungsfenster {window[1] + window[2]} Samples passt nicht in den "
+                     f"Ring ({self.ring.slot_samples}), gilt ab dem nächsten Lauf")
+        self._pending_window = window
+
+    def _ensure_acquisition(self) -> None:
+        """Startet den Erfassungsprozess, falls er (noch) nicht läuft."""
+        if self._proc is not None and self._proc.is_alive():
+            return
+        ctx = mp.get_context("spawn")
+        self._acq_cmds, self._acq_events = ctx.Queue(), ctx.Queue()
+        self._stop_evt = ctx.Event()
+        self._proc = ctx.Process(target=acquisition_worker, name="pico-acquisition",
+                                 args=(self._acq_cmds, self._acq_events, self._stop_evt),
+                                 daemon=True)
+        self._proc.start()
+        self._probe = PicoReader()      # neuer Prozess = neuer Reader mit Standardwerten
+        self.log(f"Erfassungsprozess gestartet (PID {self._proc.pid})")
+
+    def _stop_acquisition(self) -> None:
+        """Beendet den Erfassungsprozess (schließt das Gerät)."""
+        if self._proc is None:
+            return
+        if self._proc.is_alive():
+            self._acq_cmds.put(None)
+            self._proc.join(ACQ_EXIT_TIMEOUT_S)
+            if self._proc.is_alive():
+                self._proc.terminate()
+                self._proc.join(1.0)
+        self._proc = None
+
+    def _consume(self, proc: mp.Process, cursor) -> None:
+        """Liest den Puls-Ring: Zähler, dezimierte Kurven, ESR/C im Abstand param_interval_s."""
+        next_param = 0.0
+        result = None
+        while True:
+            view = cursor.wait(timeout=0.2)
+            if view is None:
+                if result is None:
+                    result = self._run_result(proc)
+                if result is not None and cursor.poll() is None:
+                    break
+                continue
+            try:
+                t, u, i = view.physical()
+            except RingOverrun:
+                self.lost += 1
+                continue
+            u, i = self._apply_filters(view.dt, u, i)
+            self.pulse_count += 1
+            if self.subscribed("pulse"):
+                self.publish("pulse", pack_trace(view.pulse_id, t, u, i, self.live_points))
+            n_avg = 1
+            if self.averager is not None:
+                try:
+                    n_avg = self.averager.add(t, u, i, t_trig=view.t_trig)
+                    t, u, i = self.averager.average()
+                except ValueError as e:
+                    self.log(f"Mittelung Puls {view.pulse_id}: {e}")
+            if time.monotonic() >= next_param:
+                next_param = time.monotonic() + self.param_interval_s
+                try:
+                    esr, cap = estimate_cap_params(t, u, i)
+                    self.latest_params = {"pulse_id": view.pulse_id, "esr": float(esr),
+                                          "cap": float(cap), "t": time.time(), "n_avg": n_avg,
+                                          "bands": None, "ci": None}
+                    if self.n_bands > 0:
+                        self.latest_params["bands"] = estimate_band_params(
+                            t, u, i, n_bands=self.n_bands).to_dict()
+                    if self.n_draws > 0:
+                        self.latest_params["ci"] = monte_carlo(
+                            t, u, i, self.error_model, self.n_draws, n_avg=n_avg).to_dict()
+                    self.publish("params", self.latest_params)
+                except Exception as e:
+                    self.log(f"Parameter-Schätzung Puls {view.pulse_id}: {e}")
+        self.lost += cursor.lost
+        self._running.clear()
+        _, run_name, error = result
+        if error:
+            self.log(f"Messung {run_name} fehlgeschlagen: {error}")
+        self.log(f"Messung beendet ({self.pulse_count} Pulse, {self.lost} verloren)")
+
+    def _apply_filters(self, dt: float, u, i) -> tuple:
+        """
+        Sensor-Korrektur wie im Erfassungsprozess (``PicoReader._apply_filters``).
+
+        Der Ring enthält Roh-ADC-Werte; die Filter werden für dessen Abtastrate
+        entworfen (Entwürfe sind zwischengespeichert) und bei geänderter Rate neu gebaut.
+        """
+        if not self.filter_spec:
+            return u, i
+        if dt != self._filters_dt:
+            self._filters, self._filters_dt = build_filters(self.filter_spec, 1.0 / dt), dt
+        if "u" in self._filters:
+            u = self._filters["u"].filter(u)
+        if "i" in self._filters:
+            i = self._filters["i"].filter(i)
+        return u, i
+
+    def _run_result(self, proc: mp.Process):
+        """Rückmeldung des Erfassungsprozesses zum laufenden Lauf, None solange er misst."""
+        try:
+            return self._acq_events.get_nowait()
+        except queue.Empty:
+            pass
+        if not proc.is_alive():
+            return ("done", None, f"Erfassungsprozess beendet (Exitcode {proc.exitcode})")
+        return None
+
+    # ============ Temperatur ============
+
+    def temp_start(self, interval_s: float = 0.5) -> bool:
+        if self.temp_logger is not None and self.temp_logger.is_running:
+            return True
+        self.temp_logger = TempLogger(update_interval_s=interval_s)
+        self.temp_logger.set_callback(
+            lambda ch, temp, ts: self.publish("temp", {"channel": ch, "temp": temp, "t": ts}))
+        return self.temp_logger.start()
+
+    def temp_stop(self) -> bool:
+        if self.temp_logger is not None:
+            self.temp_logger.stop()
+            self.temp_logger = None
+        return True
+
+
+def main(argv=None) -> int:
+    """Kommandozeile: Daemon starten, optional Nucleo verbinden und TC-08 starten."""
+    ap = argparse.ArgumentParser(description="Pulse-Lab Mess-Daemon (ohne GUI)")
+    ap.add_argument("--host", default=DEFAULT_HOST)
+    ap.add_argument("--port", type=int, default=DEFAULT_PORT)
+    ap.add_argument("--nucleo", help="serieller Port der Nucleo-Firmware, z.B. COM5")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--temp", action="store_true", help="TC-08 Temperaturlogger starten")
+    ap.add_argument("--ring-slots", type=int, default=8)
+    ap.add_argument("--window-fs", type=float, default=None,
+                    help="Erfassungsfenster an T1 der Firmware anpassen, Abtastrate in Hz")
+    a = ap.parse_args(argv)
+
+    d = LabDaemon(a.host, a.port, ring_slots=a.ring_slots, window_fs=a.window_fs)
+    d.start()
+    if a.nucleo:
+        d.nucleo_connect(a.nucleo, a.baud)
+    if a.temp:
+        d.temp_start()
+    d.serve_forever()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
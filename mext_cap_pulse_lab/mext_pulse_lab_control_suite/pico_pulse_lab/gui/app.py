@@ -8,12 +8,16 @@ Diese GUI integriert:
 - Live-Plots (U/I übereinander, Temperatur)
 - Automatische Parameter-Berechnung (ESR, Kapazität)
 - Speicherung (.npz + optional CSV)
+
+Die GUI ist ein reiner Client des Mess-Daemons (``pico_pulse_lab.daemon``):
+COM-Port, PicoScope und TC-08 gehören dem Daemon, die GUI schickt Kommandos
+und zeigt die abonnierten Datenströme an. Läuft kein Daemon, wird er beim
+Start gestartet; er läuft nach dem Schließen der GUI weiter.
 """
 
 import tkinter as tk
 from tkinter import ttk, messagebox
 import threading
-import time
 import queue
 import os
 import sys
@@ -37,10 +41,14 @@ except Exception:
     list_ports = None
 
 # Imports für Pulse Lab Module
-from pico_pulse_lab.control.stm32_uart import NucleoUART
-from pico_pulse_lab.acquisition.picoscope_reader import PicoReader
-from pico_pulse_lab.acquisition.temp_logger import TempLogger
-from pico_pulse_lab.processing.cap_params import estimate_cap_params
+from pico_pulse_lab.control.adc_record import AdcRecord, PulseStats
+from pico_pulse_lab.control.stm32_uart import Status, T1_F_HW_SYNC
+from pico_pulse_lab.control.telemetry import AdcMonitor
+from pico_pulse_lab.daemon.client import DaemonClient, connect_or_spawn
+from pico_pulse_lab.daemon.protocol import DEFAULT_HOST, DEFAULT_PORT, unpack_trace
+
+STATE_POLL_MS = 1000    # Abfrage von state() (laufende Messung, Verbindung)
+TEMP_HISTORY = 200      # Punkte im Temperatur-Plot
 
 
 class App:
@@ -53,7 +61,7 @@ class App:
     - Unten: Live-Plots (U/I links übereinander, Temperatur rechts, Parameter darunter)
     """
     
-    def __init__(self, root):
+    def __init__(self, root, host: str = DEFAULT_HOST, port: int = DEFAULT_PORT):
         """
         Initialisiert das Control Center.
         
@@ -61,43 +69,40 @@ class App:
         ----------
         root : tk.Tk
             Hauptfenster der Anwendung.
+        host, port : str, int, optional
+            Adresse des Mess-Daemons, by default 127.0.0.1:47650
         """
         self.root = root
         self.root.title("Pulse Lab Control Center")
         self.root.geometry("1400x900")
         
-        # STM32 UART
-        self.nuc = None
-        self._rx_q = queue.Queue()
-        self._reader_stop = True
-        
-        # Picoscope
-        self.pico_reader: Optional[PicoReader] = None
-        self.pico_thread: Optional[threading.Thread] = None
-        self.pico_queue = queue.Queue()  # Für Pulse-Updates
+        # Mess-Daemon: Callbacks kommen im Lese-Thread des Clients -> Queue
+        self.client: Optional[DaemonClient] = None
+        self._daemon_q = queue.Queue()   # (topic, data) aus den Datenströmen
+        self._state_busy = False         # state()-Abfrage läuft noch
         
-        # Temp-Logger
-        self.temp_logger: Optional[TempLogger] = None
-        self.temp_queue = queue.Queue()  # Für Temperatur-Updates
+        # Zustand laut Daemon
+        self.nucleo_connected = False
+        self.pico_running = False
+        self.temp_running = False
         
-        # Live-Daten (thread-sicher)
-        self.latest_pulse = None  # (pulse_id, t, u, i)
+        # Live-Daten (nur im Tk-Thread verändert)
+        self.latest_pulse = None  # (pulse_id, t_u, u, t_i, i), dezimiert
         self.pulse_count = 0
         self.latest_params = None  # (esr, cap, timestamp)
         self.param_history = []  # Liste von (timestamp, esr, cap)
-        
-        # Parameter-Berechnungs-Timer
-        self.param_timer_active = False
+        self.temp_history = []   # Liste von (timestamp, temp), Kanal 1
         
         # Build UI
         self._build_ui()
         self._set_connected(False)
         
+        self._connect_daemon(host, port)
+        self.root.protocol("WM_DELETE_WINDOW", self.on_close)
+        
         # Start Queue-Drainer für Thread-zu-GUI Kommunikation
         self.root.after(100, self._drain_queues)
-        
-        # Start Parameter-Berechnung Timer (alle 2 Sekunden)
-        self._start_param_calculation()
+        self.root.after(STATE_POLL_MS, self._poll_state)
     
     def _build_ui(self):
         """
@@ -129,6 +134,9 @@ class App:
         self.btn_connect.grid(row=0, column=5, padx=(12, 0))
         self.btn_disconnect.grid(row=0, column=6)
         
+        self.lbl_daemon = ttk.Label(frm_conn, text="Daemon: -")
+        self.lbl_daemon.grid(row=0, column=7, sticky="w", padx=(12, 0))
+        
         frm_conn.columnconfigure(1, weight=1)
         
         # ============ Zeile 1: Links STM32, Rechts Messteuerung ============
@@ -185,6 +193,11 @@ class App:
         self.btn_stop = ttk.Button(frm_seq, text="STOP", command=self.on_stop)
         self.btn_stop.grid(row=0, column=5)
         
+        # TIM2 startet TIM1 per Hardware (kein ISR-Jitter am Beginn jeder Pulsfolge)
+        self.var_hw_sync = tk.BooleanVar(value=True)
+        ttk.Checkbutton(frm_seq, text="HW-Sync TIM2→TIM1", variable=self.var_hw_sync).grid(
+            row=1, column=0, columnspan=3, sticky="w")
+        
         # Readback
         frm_rb = ttk.LabelFrame(frm_stm32, text="Readback")
         frm_rb.grid(row=2, column=0, columnspan=2, sticky="ew", **pad)
@@ -194,9 +207,26 @@ class App:
         self.btn_rb_t1.grid(row=0, column=0, padx=(0, 6))
         self.btn_rb_t2.grid(row=0, column=1, padx=(6, 0))
         
+        # Firmware-Telemetrie (STATUS, zyklisch gepollt)
+        frm_status = ttk.LabelFrame(frm_stm32, text="Firmware-Status")
+        frm_status.grid(row=3, column=0, columnspan=2, sticky="ew", **pad)
+        
+        self.lbl_fw_state = ttk.Label(frm_status, text="Zustand: -")
+        self.lbl_fw_state.grid(row=0, column=0, sticky="w", padx=(0, 12))
+        self.lbl_fw_cycles = ttk.Label(frm_status, text="Zyklen: -")
+        self.lbl_fw_cycles.grid(row=0, column=1, sticky="w", padx=(0, 12))
+        self.lbl_fw_diag = ttk.Label(frm_status, text="Latenz: - | Überläufe: - | RX verworfen: -")
+        self.lbl_fw_diag.grid(row=1, column=0, columnspan=2, sticky="w")
+        self.lbl_fw_adc = ttk.Label(frm_status, text="ADC: -")
+        self.lbl_fw_adc.grid(row=2, column=0, columnspan=2, sticky="w")
+        self.lbl_fw_fault = ttk.Label(frm_status, text="Schutz: -")
+        self.lbl_fw_fault.grid(row=3, column=0, sticky="w")
+        self.btn_clear_fault = ttk.Button(frm_status, text="Fehler quittieren", command=self.on_clear_fault)
+        self.btn_clear_fault.grid(row=3, column=1, sticky="e")
+        
         # Log für STM32
         frm_log = ttk.LabelFrame(frm_stm32, text="Log")
-        frm_log.grid(row=3, column=0, columnspan=2, sticky="nsew", **pad)
+        frm_log.grid(row=4, column=0, columnspan=2, sticky="nsew", **pad)
         
         self.txt_log = tk.Text(frm_log, height=8, width=50)
         self.txt_log.grid(row=0, column=0, sticky="nsew")
@@ -370,15 +400,70 @@ class App:
         # Parameter-Fenster (wird bei Bedarf erstellt)
         self.param_window = None
     
+    # ============ Mess-Daemon ============
+    
+    def _connect_daemon(self, host: str, port: int):
+        """Verbindet mit dem Daemon (startet ihn bei Bedarf) und abonniert die Datenströme."""
+        try:
+            self.client = connect_or_spawn(host, port)
+            self.client.subscribe(["pulse", "params", "status", "adc", "temp", "log"],
+                                  lambda topic, data: self._daemon_q.put((topic, data)))
+            self.lbl_daemon.configure(text=f"Daemon: {host}:{port}")
+            self._apply_state(self.client.state())
+        except Exception as e:
+            self.client = None
+            self.lbl_daemon.configure(text="Daemon: nicht erreichbar", foreground="red")
+            messagebox.showerror("Daemon", f"Mess-Daemon nicht erreichbar: {e}")
+            self.log(f"[ERR] Daemon: {e}")
+    
+    def _poll_state(self):
+        """Fragt den Zustand des Daemons ab (Messung beendet, Nucleo getrennt, ...)."""
+        if self.client is not None and not self._state_busy:
+            self._state_busy = True
+            
+            def work():
+                try:
+                    self._daemon_q.put(("state", self.client.state()))
+                except Exception as e:
+                    self._daemon_q.put(("daemon_error", str(e)))
+                finally:
+                    self._state_busy = False
+            self._in_thread(work)
+        self.root.after(STATE_POLL_MS, self._poll_state)
+    
+    def _apply_state(self, st: dict):
+        """Übernimmt den Daemon-Zustand in die Buttons."""
+        if st["nucleo"] != self.nucleo_connected:
+            self._set_connected(st["nucleo"])
+        self.pico_running = st["pico_running"]
+        self.btn_pico_start.configure(state=("disabled" if self.pico_running else "normal"))
+        self.btn_pico_stop.configure(state=("normal" if self.pico_running else "disabled"))
+        self.temp_running = st["temp_running"]
+        self.btn_temp_start.configure(state=("disabled" if self.temp_running else "normal"))
+    
+    def _nucleo(self, method: str, *args, **kwargs):
+        """Ruft eine NucleoLink-Methode im Daemon auf (blockierend, nur in Worker-Threads)."""
+        if self.client is None:
+            raise RuntimeError("Daemon nicht verbunden")
+        return self.client.nucleo(method, *args, **kwargs)
+    
+    def on_close(self):
+        """Schließt nur die GUI; Daemon und laufende Messung bleiben aktiv."""
+        if self.client is not None:
+            self.client.close()
+            self.client = None
+        self.root.destroy()
+    
     # ============ STM32-Funktionen (bestehend) ============
     
     def _set_connected(self, ok: bool):
         """Aktiviert/deaktiviert STM32-Buttons basierend auf Verbindungsstatus."""
+        self.nucleo_connected = ok
         self.btn_connect.configure(state=("disabled" if ok else "normal"))
         self.btn_disconnect.configure(state=("normal" if ok else "disabled"))
         state = "normal" if ok else "disabled"
         for w in [self.btn_set_t1, self.btn_set_t2, self.btn_start, self.btn_stop,
-                  self.btn_rb_t1, self.btn_rb_t2]:
+                  self.btn_rb_t1, self.btn_rb_t2, self.btn_clear_fault]:
             w.configure(state=state)
     
     def log(self, msg: str):
@@ -400,32 +485,31 @@ class App:
             self.cmb_port.set(ports[0])
     
     def connect(self):
-        """Stellt Verbindung zum STM32 über UART her."""
+        """Lässt den Daemon die UART-Verbindung zum STM32 öffnen."""
         port = self.cmb_port.get().strip()
         baud = int(self.cmb_baud.get().strip())
         if not port:
             messagebox.showwarning("Hinweis", "Bitte zuerst einen Port auswählen.")
             return
+        if self.client is None:
+            messagebox.showwarning("Hinweis", "Mess-Daemon nicht verbunden.")
+            return
         try:
-            self.nuc = NucleoUART(port=port, baudrate=baud, timeout=1.0)
+            # Der Daemon besitzt den Port; STATUS, ADC und Textzeilen kommen als Datenströme
+            self.client.nucleo_connect(port, baud)
             self._set_connected(True)
-            self.log(f"[OK] Verbunden mit {port} @ {baud} Baud")
-            self._reader_stop = False
-            threading.Thread(target=self._serial_monitor_reader, daemon=True).start()
-            self.root.after(50, self._drain_monitor_queue)
+            self.log(f"[OK] Verbunden mit {port} @ {baud} Baud (über Daemon)")
         except Exception as e:
             messagebox.showerror("Verbindung fehlgeschlagen", str(e))
             self.log(f"[ERR] {e}")
     
     def disconnect(self):
-        """Trennt die UART-Verbindung."""
-        self._reader_stop = True
-        if self.nuc:
-            try:
-                self.nuc.close()
-            except Exception:
-                pass
-            self.nuc = None
+        """Lässt den Daemon die UART-Verbindung trennen."""
+        try:
+            if self.client is not None:
+                self.client.nucleo_disconnect()
+        except Exception as e:
+            self.log(f"[ERR] Trennen: {e}")
         self._set_connected(False)
         self.log("[i] Verbindung getrennt")
     
@@ -436,25 +520,36 @@ class App:
     def on_set_timer(self, timer: int):
         """SET-Befehl für Timer 1 oder 2."""
         def work():
-            if not self.nuc:
+            if not self.nucleo_connected:
                 return
             try:
                 period = int(self.ent_period_t1.get() if timer == 1 else self.ent_period_t2.get())
-                self.log(f"> SET T{timer} period={period}")
-                self.nuc.set_timer(timer, period)
+                flags = T1_F_HW_SYNC if (timer == 1 and self.var_hw_sync.get()) else 0
+                self.log(f"> SET T{timer} period={period} flags=0x{flags:02X}")
+                self._nucleo("set_timer", timer, period, flags)
             except Exception as e:
                 self.log(f"[ERR] SET T{timer}: {e}")
         self._in_thread(work)
     
     def on_start(self):
-        """START-Befehl für die Sequenz."""
+        """START: T1, T2 und Pulsanzahl per CONFIG in einem Frame setzen und starten."""
         def work():
-            if not self.nuc:
+            if not self.nucleo_connected:
                 return
             try:
+                t1 = int(self.ent_period_t1.get())
+                t2 = int(self.ent_period_t2.get())
                 pulses = int(self.ent_pulses.get())
-                self.log(f"> START sequence pulse_count={pulses}")
-                self.nuc.start_sequence(pulses)
+                self.log(f"> CONFIG+START T1={t1} µs, T2={t2} ms, pulse_count={pulses}")
+                t1_flags = T1_F_HW_SYNC if self.var_hw_sync.get() else 0
+                ack = self._nucleo("configure", t1, t2, pulses, arm=True, t1_flags=t1_flags)
+                note = " (begrenzt)" if ack["clamped"] else ""
+                self.log(f"< ACK T1={ack['t1_us']} µs, T2={ack['t2_ms']} ms, "
+                         f"pulse_count={ack['pulse_count']}, armed={ack['armed']}{note}")
+                # U/I je Puls vom MCU-ADC, Rate begrenzt auf die UART-Bandbreite
+                adc = self._nucleo("adc_stream", AdcMonitor.decimation_for(ack["t2_ms"]))
+                if not adc["ready"]:
+                    self.log("[i] ADC der Firmware nicht verfügbar")
             except Exception as e:
                 self.log(f"[ERR] START: {e}")
         self._in_thread(work)
@@ -462,24 +557,39 @@ class App:
     def on_stop(self):
         """STOP-Befehl für die Sequenz."""
         def work():
-            if not self.nuc:
+            if not self.nucleo_connected:
                 return
             try:
                 mode = self.stop_mode.get()
                 hard = (mode == "Hard")
                 self.log(f"> STOP ({mode})")
-                self.nuc.stop_timer(hard=hard, timer_for_cmd=1)
+                self._nucleo("stop_timer", hard=hard, timer_for_cmd=1)
             except Exception as e:
                 self.log(f"[ERR] STOP: {e}")
         self._in_thread(work)
     
+    def on_clear_fault(self):
+        """Quittiert den Schutz-Latch der Firmware (Überstrom/Überspannung)."""
+        def work():
+            if not self.nucleo_connected:
+                return
+            try:
+                ack = self._nucleo("clear_fault")
+                if ack["fault"]:
+                    self.log("[WARN] Fehler steht noch an (Komparator aktiv), nicht quittiert")
+                else:
+                    self.log("< Schutz quittiert, Brücke freigegeben")
+            except Exception as e:
+                self.log(f"[ERR] Quittieren: {e}")
+        self._in_thread(work)
+    
     def on_readback(self, timer: int):
         """READBACK für Timer 1 oder 2."""
         def work():
-            if not self.nuc:
+            if not self.nucleo_connected:
                 return
             try:
-                val, flags = self.nuc.readback(timer)
+                val, flags = self._nucleo("readback", timer)
                 unit = "µs" if timer == 1 else "ms"
                 self.log(f"< READBACK T{timer}: {val} {unit}, flags=0x{flags:02X}")
             except Exception as e:
@@ -489,87 +599,67 @@ class App:
     # ============ Picoscope-Funktionen ============
     
     def on_pico_start(self):
-        """Startet eine Picoscope-Messung in separatem Thread."""
-        if self.pico_reader and self.pico_reader.is_running:
+        """Startet eine Picoscope-Messung im Erfassungsprozess des Daemons."""
+        if self.pico_running:
             messagebox.showwarning("Hinweis", "Messung läuft bereits.")
             return
+        if self.client is None:
+            messagebox.showwarning("Hinweis", "Mess-Daemon nicht verbunden.")
+            return
         
         run_name = self.ent_run_name.get().strip()
         if not run_name:
             messagebox.showwarning("Hinweis", "Bitte Run-Name eingeben.")
             return
         
-        # Konfiguration aus GUI lesen
+        # Konfiguration aus GUI lesen (Argumente für PicoReader.configure im Daemon)
         try:
-            target_fs = float(self.ent_target_fs.get()) * 1e6  # MS/s -> Hz
-            trigger_level = float(self.ent_trig_level.get())
-            
-            # Reader erstellen und konfigurieren
-            self.pico_reader = PicoReader()
-            self.pico_reader.configure(
+            config = dict(
                 run_name=run_name,
-                target_fs=target_fs,
-                trigger_level_v=trigger_level,
+                target_fs=float(self.ent_target_fs.get()) * 1e6,  # MS/s -> Hz
+                trigger_level_v=float(self.ent_trig_level.get()),
                 coupling_a=self.cmb_coupling_a.get(),
                 range_a=self.cmb_range_a.get(),
                 coupling_b=self.cmb_coupling_b.get(),
                 range_b=self.cmb_range_b.get()
             )
-            
-            # Callback setzen
-            self.pico_reader.set_callback(self._on_pico_pulse)
-            
-            # Thread starten
             save_csv = self.chk_save_csv.instate(['selected'])
-            self.pico_thread = threading.Thread(
-                target=self._pico_measurement_thread,
-                args=(save_csv,),
-                daemon=True
-            )
-            self.pico_thread.start()
+            self.client.pico_start(config, n_pulses=1000,  # Groß genug für praktisch endlos
+                                   save_csv=save_csv, save_npz=True)
             
+            self.pico_running = True
+            self.pulse_count = 0
             self.btn_pico_start.configure(state="disabled")
+            self.btn_pico_stop.configure(state="normal")
             self.log(f"[Pico] Messung gestartet: {run_name}")
         
         except Exception as e:
             messagebox.showerror("Fehler", f"Fehler beim Starten der Messung: {e}")
             self.log(f"[ERR] Pico-Start: {e}")
     
-    def _pico_measurement_thread(self, save_csv: bool):
-        """Thread-Funktion für Picoscope-Messung."""
-        try:
-            # Endlos-Messung (kann später erweitert werden)
-            self.pico_reader.start_measurement(
-                n_pulses=1000,  # Groß genug für praktisch endlos
-                save_csv=save_csv,
-                save_npz=True
-            )
-        except Exception as e:
-            self.pico_queue.put(("error", str(e)))
-    
-    def _on_pico_pulse(self, pulse_id: int, t: np.ndarray, u: np.ndarray, i: np.ndarray):
-        """Callback für jeden erfassten Puls (wird vom Reader aufgerufen)."""
-        self.pico_queue.put(("pulse", (pulse_id, t, u, i)))
-    
     def on_pico_stop(self):
-        """Stoppt die Picoscope-Messung."""
-        if self.pico_reader:
-            self.pico_reader.stop()
-            self.btn_pico_start.configure(state="normal")
+        """Stoppt die Picoscope-Messung (Ende meldet der Daemon über state())."""
+        if self.client is None:
+            return
+        try:
+            self.client.pico_stop()
             self.log("[Pico] Messung gestoppt")
+        except Exception as e:
+            self.log(f"[ERR] Pico-Stop: {e}")
     
     # ============ Temp-Logger-Funktionen ============
     
     def on_temp_start(self):
-        """Startet den Temperatur-Logger."""
+        """Startet den Temperatur-Logger im Daemon."""
+        if self.client is None:
+            messagebox.showwarning("Hinweis", "Mess-Daemon nicht verbunden.")
+            return
         try:
             interval = float(self.ent_temp_interval.get())
-            self.temp_logger = TempLogger(update_interval_s=interval)
-            
-            # Callback setzen
-            self.temp_logger.set_callback(self._on_temp_update)
-            
-            self.temp_logger.start()
+            if not self.client.temp_start(interval_s=interval):
+                raise RuntimeError("TC-08 nicht gestartet")
+            self.temp_running = True
+            self.temp_history = []
             self.btn_temp_start.configure(state="disabled")
             self.log("[Temp] Temperaturmessung gestartet")
         
@@ -577,75 +667,114 @@ class App:
             messagebox.showerror("Fehler", f"Fehler beim Starten: {e}")
             self.log(f"[ERR] Temp-Start: {e}")
     
-    def _on_temp_update(self, channel: int, temp: float, timestamp: float):
-        """Callback für Temperatur-Updates."""
-        self.temp_queue.put(("temp", (channel, temp, timestamp)))
-    
     def on_temp_stop(self):
-        """Stoppt den Temperatur-Logger."""
-        if self.temp_logger:
-            self.temp_logger.stop()
+        """Stoppt den Temperatur-Logger im Daemon."""
+        if self.client is None:
+            return
+        try:
+            self.client.temp_stop()
+            self.temp_running = False
             self.btn_temp_start.configure(state="normal")
             self.log("[Temp] Temperaturmessung gestoppt")
+        except Exception as e:
+            self.log(f"[ERR] Temp-Stop: {e}")
     
     # ============ Queue-Drainer und Updates ============
     
     def _drain_queues(self):
-        """Drainiert alle Queues und aktualisiert die GUI (wird periodisch aufgerufen)."""
-        # Picoscope-Updates
+        """Drainiert die Daemon-Queue und aktualisiert die GUI (wird periodisch aufgerufen)."""
+        new_pulse = new_temp = False
+        status = adc = None
         try:
             while True:
-                msg_type, data = self.pico_queue.get_nowait()
-                if msg_type == "pulse":
-                    pulse_id, t, u, i = data
-                    self.latest_pulse = (pulse_id, t, u, i)
+                topic, data = self._daemon_q.get_nowait()
+                if topic == "pulse":
+                    self.latest_pulse = unpack_trace(data)
                     self.pulse_count += 1
-                    self.lbl_pulse_count.configure(text=f"Pulse: {self.pulse_count}")
-                    self._update_ui_plots()
-                elif msg_type == "error":
-                    self.log(f"[ERR] Pico: {data}")
-                    self.btn_pico_start.configure(state="normal")
+                    new_pulse = True
+                elif topic == "params":
+                    self._update_params(data)
+                elif topic == "status":
+                    status = data       # nur der letzte Snapshot wird angezeigt
+                elif topic == "adc":
+                    adc = data
+                elif topic == "temp":
+                    if data["channel"] == 1:
+                        self.temp_history.append((data["t"], data["temp"]))
+                        del self.temp_history[:-TEMP_HISTORY]
+                        self.lbl_temp.configure(text=f"Temp: {data['temp']:.2f} °C")
+                        new_temp = True
+                elif topic == "log":
+                    if data["source"] == "nucleo":
+                        self._monitor(data["text"])
+                    else:
+                        self.log(f"[{data['source']}] {data['text']}")
+                elif topic == "state":
+                    self._apply_state(data)
+                elif topic == "daemon_error":
+                    self.lbl_daemon.configure(text="Daemon: getrennt", foreground="red")
+                    self.log(f"[ERR] Daemon: {data}")
         except queue.Empty:
             pass
         
-        # Temperatur-Updates
-        try:
-            while True:
-                msg_type, data = self.temp_queue.get_nowait()
-                if msg_type == "temp":
-                    channel, temp, timestamp = data
-                    self.lbl_temp.configure(text=f"Temp: {temp:.2f} °C")
-                    self._update_temp_plot()
-        except queue.Empty:
-            pass
-        
-        # Serial Monitor
-        try:
-            while True:
-                line = self._rx_q.get_nowait()
-                self.txt_mon.configure(state="normal")
-                self.txt_mon.insert("end", line + "\n")
-                self.txt_mon.see("end")
-                self.txt_mon.configure(state="disabled")
-        except queue.Empty:
-            pass
+        # Plots nur einmal je Durchlauf neu zeichnen
+        if new_pulse:
+            self.lbl_pulse_count.configure(text=f"Pulse: {self.pulse_count}")
+            self._update_ui_plots()
+        if new_temp:
+            self._update_temp_plot()
+        if status is not None:
+            self._update_fw_status(Status(**status))
+        if adc is not None:
+            self._update_fw_adc(AdcRecord(adc["cycle"], PulseStats(**adc["pos"]),
+                                          PulseStats(**adc["neg"])))
         
         # Wieder aufrufen
         self.root.after(100, self._drain_queues)
     
+    def _monitor(self, line: str):
+        """Schreibt eine Textzeile der Firmware in den Serial Monitor."""
+        self.txt_mon.configure(state="normal")
+        self.txt_mon.insert("end", line + "\n")
+        self.txt_mon.see("end")
+        self.txt_mon.configure(state="disabled")
+    
+    def _update_fw_status(self, st):
+        """Zeigt den letzten STATUS-Snapshot der Firmware an."""
+        state = "RUN" if st.running else "IDLE"
+        if st.exit:
+            state += " (Stop angefordert)" if st.exit == 1 else " (Hard-Stop)"
+        self.lbl_fw_state.configure(text=f"Zustand: {state} | Uptime: {st.uptime_ms / 1000:.1f} s")
+        rem = f", verbleibend {st.remaining}" if st.remaining else ""
+        self.lbl_fw_cycles.configure(text=f"Zyklen: {st.cycles}{rem}")
+        self.lbl_fw_diag.configure(
+            text=f"Latenz max: {st.isr_latency_us:.2f} µs | ISR max: {st.isr_exec_us:.2f} µs | "
+                 f"Überläufe: {st.overruns} | RX verworfen: {st.rx_dropped}"
+        )
+        self.lbl_fw_fault.configure(text=f"Schutz: {st.fault_text}",
+                                    foreground=("red" if st.faulted else ""))
+    
+    def _update_fw_adc(self, rec):
+        """Zeigt die letzten ADC-Kennwerte je Puls an (Volt am ADC-Pin)."""
+        p, n = rec.pos, rec.neg
+        self.lbl_fw_adc.configure(
+            text=f"ADC Zyklus {rec.cycle}: U+ {p.u_mean:.2f} V (min {p.u_min:.2f}), "
+                 f"I+ {p.i_peak:.2f} | U- {n.u_mean:.2f} V (min {n.u_min:.2f}), I- {n.i_peak:.2f}"
+        )
+    
     def _update_ui_plots(self):
-        """Aktualisiert die U/I-Plots mit dem neuesten Puls."""
+        """Aktualisiert die U/I-Plots mit dem neuesten (dezimierten) Puls."""
         if self.latest_pulse is None:
             return
         
-        pulse_id, t, u, i = self.latest_pulse
+        pulse_id, t_u, u, t_i, i = self.latest_pulse
         
         # Plots aktualisieren
         self.ax_u.clear()
         self.ax_i.clear()
         
-        self.ax_u.plot(t, u, linewidth=1.0, label=f"U (pulse {pulse_id})")
-        self.ax_i.plot(t, i, linewidth=1.0, label=f"I (pulse {pulse_id})")
+        self.ax_u.plot(t_u, u, linewidth=1.0, label=f"U (pulse {pulse_id})")
+        self.ax_i.plot(t_i, i, linewidth=1.0, label=f"I (pulse {pulse_id})")
         
         self.ax_u.set_ylabel("Spannung U [V]")
         self.ax_i.set_ylabel("Strom I [A]")
@@ -658,64 +787,34 @@ class App:
         self.canvas_ui.draw()
     
     def _update_temp_plot(self):
-        """Aktualisiert den Temperatur-Plot."""
-        if not self.temp_logger:
+        """Aktualisiert den Temperatur-Plot (Zeit relativ zum ersten Wert)."""
+        if not self.temp_history:
             return
         
-        ts, temps = self.temp_logger.get_temperature_history(channel=1, max_points=200)
-        
-        if len(ts) == 0:
-            return
+        ts, temps = np.array(self.temp_history).T
         
         self.ax_temp.clear()
-        self.ax_temp.plot(ts, temps, linewidth=1.0, color='red')
+        self.ax_temp.plot(ts - ts[0], temps, linewidth=1.0, color='red')
         self.ax_temp.set_ylabel("Temperatur [°C]")
         self.ax_temp.set_xlabel("Zeit t [s]")
         self.ax_temp.grid(True, alpha=0.3)
         
         self.canvas_temp.draw()
     
-    # ============ Parameter-Berechnung ============
-    
-    def _start_param_calculation(self):
-        """Startet periodische Parameter-Berechnung (alle 2 Sekunden)."""
-        self.param_timer_active = True
-        self._calculate_params()
+    # ============ Parameter-Anzeige ============
     
-    def _calculate_params(self):
-        """Berechnet ESR und Kapazität aus dem neuesten Puls."""
-        if not self.param_timer_active:
-            return
+    def _update_params(self, p: dict):
+        """Übernimmt eine ESR/C-Schätzung des Daemons (Thema "params", alle 2 s)."""
+        esr, cap = p["esr"], p["cap"]
+        self.latest_params = (esr, cap, p["t"])
+        self.param_history.append((p["t"], esr, cap))
         
-        if self.latest_pulse is None:
-            # Nächstes Mal versuchen
-            self.root.after(2000, self._calculate_params)
-            return
+        # Historie begrenzen
+        if len(self.param_history) > 1000:
+            self.param_history = self.param_history[-1000:]
         
-        try:
-            pulse_id, t, u, i = self.latest_pulse
-            
-            # Parameter berechnen
-            esr, cap = estimate_cap_params(t, u, i)
-            
-            # Parameter speichern
-            self.latest_params = (esr, cap, time.time())
-            self.param_history.append((time.time(), esr, cap))
-            
-            # Historie begrenzen
-            if len(self.param_history) > 1000:
-                self.param_history = self.param_history[-1000:]
-            
-            # GUI aktualisieren
-            self.lbl_esr.configure(text=f"ESR: {esr:.6f} Ω")
-            self.lbl_cap.configure(text=f"C: {cap*1e6:.6f} µF")
-        
-        except Exception as e:
-            # Fehler ignorieren (z.B. wenn Daten noch nicht ausreichend)
-            pass
-        
-        # Wieder aufrufen in 2 Sekunden
-        self.root.after(2000, self._calculate_params)
+        self.lbl_esr.configure(text=f"ESR: {esr:.6f} Ω")
+        self.lbl_cap.configure(text=f"C: {cap*1e6:.6f} µF")
     
     def open_param_window(self):
         """Öffnet separates Fenster für Parameter-Zeitverlauf."""
@@ -741,48 +840,6 @@ class App:
         
         self.param_window.window.protocol("WM_DELETE_WINDOW", 
                                          lambda: (on_close(), self.param_window.on_close()))
-    
-    # ============ Serial Monitor ============
-    
-    def _drain_monitor_queue(self):
-        """Drainiert die Serial-Monitor-Queue (separat, wird periodisch aufgerufen)."""
-        try:
-            while True:
-                line = self._rx_q.get_nowait()
-                self.txt_mon.configure(state="normal")
-                self.txt_mon.insert("end", line + "\n")
-                self.txt_mon.see("end")
-                self.txt_mon.configure(state="disabled")
-        except queue.Empty:
-            pass
-        self.root.after(50, self._drain_monitor_queue)
-    
-    def _serial_monitor_reader(self):
-        """Thread: Liest serielle Daten und schreibt in Queue."""
-        ser = self.nuc.ser if (self.nuc and hasattr(self.nuc, "ser")) else None
-        if not ser:
-            return
-        
-        buf = bytearray()
-        while not self._reader_stop and ser and ser.is_open:
-            try:
-                n = ser.in_waiting
-                if n:
-                    chunk = ser.read(n)
-                    if not chunk:
-                        continue
-                    buf.extend(chunk)
-                    
-                    while b"\n" in buf:
-                        line, _, buf = buf.partition(b"\n")
-                        text = line.decode(errors="replace").strip()
-                        if text:
-                            self._rx_q.put(text)
-                else:
-                    time.sleep(0.01)
-            except Exception as e:
-                self._rx_q.put(f"[RX-ERR] {e}")
-                break
 
 
 if __name__ == "__main__":
@@ -0,0 +1,260 @@
+"""
+Kohärente Mittelung aufeinanderfolgender Pulse.
+
+Ein einzelner Puls ist mit dem 8-Bit-ADC (ENOB ~7.6) stark verrauscht. Da
+die Pulse sich wiederholen, lässt sich das Rauschen durch Mittelung um
+sqrt(N) senken -- allerdings nur, wenn die Pulse vorher auf Bruchteile eines
+Samples genau übereinandergelegt werden: Der Trigger sitzt bei jedem Puls
+an einer anderen Stelle zwischen zwei Abtastpunkten, ungemittelt verschmiert
+das die Flanken und damit ESR und ESL.
+
+Ausrichtung (einzeln oder kombiniert):
+
+- Trigger-Versatz aus ``ps3000aGetTriggerTimeOffset64`` (``PulseView.t_trig``)
+- Kreuzkorrelation mit dem bisherigen Mittelwert (FFT), Maximum per
+  Newton-Verfahren auf der bandbegrenzten Korrelation interpoliert
+
+Verschoben wird mit einer Phasenrampe im Spektrum (``fractional_delay``).
+``CoherentAverager`` hält nur die letzten ``window`` Pulse (oder bei
+``window=None`` nur die Summe), nicht jeden Rohpuls.
+"""
+
+from typing import Optional, Tuple
+
+import numpy as np
+
+ALIGN_MODES = ("xcorr", "trigger", "both", "none")
+
+
+def _nfft(n: int) -> int:
+    """FFT-Länge ohne Umlauf für Verschiebungen bis n Samples."""
+    return 1 << int(np.ceil(np.log2(2 * n)))
+
+
+def fractional_delay(x: np.ndarray, d: float) -> np.ndarray:
+    """
+    Verzögert ein Signal um d Samples (auch Bruchteile): ``y[n] = x[n - d]``.
+
+    Parameters
+    ----------
+    x : np.ndarray
+        Signal (1D, reell)
+    d : float
+        Verzögerung in Samples, negativ = vorziehen
+
+    Returns
+    -------
+    np.ndarray
+        Verschobenes Signal gleicher Länge; herausgeschobene Enden sind 0.
+    """
+    x = np.asarray(x, dtype=float)
+    if d == 0:
+        return x.copy()
+    n = len(x)
+    nfft = _nfft(n)
+    X = np.fft.rfft(x, nfft)
+    X *= np.exp(-2j * np.pi * np.fft.rfftfreq(nfft) * d)
+    X[-1] = X[-1].real          # Nyquist-Bin reell halten
+    return np.fft.irfft(X, nfft)[:n]
+
+
+def estimate_delay(ref: np.ndarray, x: np.ndarray, max_lag: Optional[int] = None,
+                   n_iter: int = 3) -> float:
+    """
+    Verzögerung von x gegenüber ref in Samples (``x[n] ≈ ref[n - d]``).
+
+    Das Maximum der Kreuzkorrelation wird zuerst ganzzahlig gesucht und dann
+    mit einigen Newton-Schritten auf der aus dem Spektrum berechneten
+    (bandbegrenzten) Korrelation verfeinert.
+
+    Parameters
+    ----------
+    ref, x : np.ndarray
+        Referenz und zu vergleichendes Signal, gleiche Länge
+    max_lag : int, optional
+        Suchbereich ±max_lag Samples, by default None (ganzes Fenster)
+    n_iter : int, optional
+        Newton-Schritte, by default 3
+
+    Returns
+    -------
+    float
+        Verzögerung in Samples.
+    """
+    ref = np.asarray(ref, dtype=float)
+    x = np.asarray(x, dtype=float)
+    if len(ref) != len(x):
+        raise ValueError("ref und x müssen gleich lang sein")
+    n = len(x)
+    nfft = _nfft(n)
+    C = np.fft.rfft(x - x.mean(), nfft) * np.conj(np.fft.rfft(ref - ref.mean(), nfft))
+    r = np.fft.irfft(C, nfft)
+
+    lags = np.arange(nfft)
+    lags[lags >= nfft // 2] -= nfft
+    if max_lag is not None:
+        r = np.where(np.abs(lags) <= max_lag, r, -np.inf)
+    k = int(np.argmax(r))
+    d = float(lags[k])
+
+    # r(τ) = Re Σ c·C·e^{jωτ} mit c = 1 für DC/Nyquist, sonst 2
+    w = 2 * np.pi * np.fft.rfftfreq(nfft)
+    c = np.full(len(C), 2.0)
+    c[0] = c[-1] = 1.0
+    Cw = c * C
+    for _ in range(n_iter):
+        e = Cw * np.exp(1j * w * d)
+        r1 = np.real(np.sum(1j * w * e))
+        r2 = np.real(np.sum(-(w ** 2) * e))
+        if r2 >= 0:
+            break               # kein Maximum in der Nähe: ganzzahliges Ergebnis behalten
+        step = r1 / r2
+        if abs(step) > 1.0:
+            break
+        d -= step
+    return d
+
+
+class CoherentAverager:
+    """
+    Gleitender kohärenter Mittelwert über die letzten ``window`` Pulse.
+
+    Jeder neue Puls wird auf Bruchteile eines Samples an den bisherigen
+    Mittelwert angeglichen und dann aufsummiert; der älteste fällt heraus.
+    Ändern sich Länge oder Abtastintervall (neues Erfassungsfenster), beginnt
+    die Mittelung neu.
+
+    Parameters
+    ----------
+    window : int or None, optional
+        Anzahl gemittelter Pulse, None = alle seit dem letzten ``reset()``
+        (ohne Pulse zu speichern), by default 16
+    align : str, optional
+        "xcorr", "trigger", "both" oder "none", by default "both"
+    channel : str, optional
+        Kanal für die Kreuzkorrelation, "i" oder "u", by default "i"
+    max_lag : int, optional
+        Suchbereich der Kreuzkorrelation in Samples, by default 64
+
+    Examples
+    --------
+    >>> avg = CoherentAverager(window=32)
+    >>> for view in cursor:                              # Puls-Ring
+    ...     t, u, i = view.physical()
+    ...     avg.add(t, u, i, t_trig=view.t_trig)
+    >>> esr, cap = estimate_cap_params(*avg.average())
+    """
+
+    def __init__(self, window: Optional[int] = 16, align: str = "both", channel: str = "i",
+                 max_lag: Optional[int] = 64):
+        if align not in ALIGN_MODES:
+            raise ValueError(f"align muss eines von {ALIGN_MODES} sein")
+        if channel not in ("u", "i"):
+            raise ValueError("channel muss 'u' oder 'i' sein")
+        if window is not None and window < 1:
+            raise ValueError("window muss >= 1 sein")
+        self.window = window
+        self.align = align
+        self.channel = channel
+        self.max_lag = max_lag
+        self.last_shift = 0.0       # zuletzt angewandte Verschiebung in Samples
+        self.reset()
+
+    def reset(self) -> None:
+        """Verwirft alle bisher gemittelten Pulse."""
+        self._t = None
+        self._dt = None
+        self._sum_u = self._sum_i = None
+        self._hist_u = self._hist_i = None
+        self._count = 0
+        self._head = 0
+        self.total = 0              # Pulse seit reset() (auch herausgefallene)
+
+    @property
+    def count(self) -> int:
+        """Anzahl Pulse im aktuellen Mittelwert."""
+        return self._count
+
+    def _start(self, t: np.ndarray, dt: float) -> None:
+        n = len(t)
+        self._t, self._dt = np.array(t, dtype=float), dt
+        self._sum_u, self._sum_i = np.zeros(n), np.zeros(n)
+        if self.window is not None:
+            self._hist_u = np.zeros((self.window, n))
+            self._hist_i = np.zeros((self.window, n))
+        self._count = self._head = 0
+
+    def add(self, t: np.ndarray, u: np.ndarray, i: np.ndarray,
+            t_trig: Optional[float] = None) -> int:
+        """
+        Nimmt einen Puls in den Mittelwert auf.
+
+        Parameters
+        ----------
+        t, u, i : np.ndarray
+            Zeitvektor (gleichabständig), Spannung und Strom
+        t_trig : float, optional
+            Trigger-Versatz in s (Trigger liegt um t_trig nach dem nominalen
+            Triggersample), by default None
+
+        Returns
+        -------
+        int
+            Anzahl Pulse im Mittelwert.
+        """
+        t = np.asarray(t, dtype=float)
+        if len(t) < 2 or len(u) != len(t) or len(i) != len(t):
+            raise ValueError("t, u, i müssen gleich lang sein (mindestens 2 Samples)")
+        dt = float(t[1] - t[0])
+        if (self._t is None or len(t) != len(self._t)
+                or abs(dt - self._dt) > 1e-9 * abs(self._dt)
+                or abs(t[0] - self._t[0]) > 0.5 * abs(dt)):
+            self._start(t, dt)
+
+        shift = 0.0
+        if t_trig and self.align in ("trigger", "both"):
+            shift = -t_trig / dt
+        u = fractional_delay(u, shift) if shift else np.asarray(u, dtype=float)
+        i = fractional_delay(i, shift) if shift else np.asarray(i, dtype=float)
+        if self._count and self.align in ("xcorr", "both"):
+            ref = (self._sum_i if self.channel == "i" else self._sum_u) / self._count
+            d = estimate_delay(ref, i if self.channel == "i" else u, self.max_lag)
+            if d:
+                u, i = fractional_delay(u, -d), fractional_delay(i, -d)
+                shift -= d
+        self.last_shift = shift
+
+        if self.window is not None:
+            if self._count == self.window:
+                self._sum_u -= self._hist_u[self._head]
+                self._sum_i -= self._hist_i[self._head]
+            else:
+                self._count += 1
+            self._hist_u[self._head], self._hist_i[self._head] = u, i
+            self._head = (self._head + 1) % self.window
+            if self._head == 0:
+                # einmal je Umlauf neu summieren, damit sich Rundungsfehler nicht aufschaukeln
+                self._sum_u[:] = self._hist_u[:self._count].sum(axis=0)
+                self._sum_i[:] = self._hist_i[:self._count].sum(axis=0)
+            else:
+                self._sum_u += u
+                self._sum_i += i
+        else:
+            self._count += 1
+            self._sum_u += u
+            self._sum_i += i
+        self.total += 1
+        return self._count
+
+    def average(self) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+        """
+        Gemittelter Puls ``(t, u, i)`` für die Parameterschätzung.
+
+        Raises
+        ------
+        ValueError
+            Wenn noch kein Puls aufgenommen wurde.
+        """
+        if not self._count:
+            raise ValueError("Noch kein Puls gemittelt")
+        return self._t.copy(), self._sum_u / self._count, self._sum_i / self._count
@@ -7,10 +7,68 @@ aus gemessenen Spannungs- und Strompulsen.
 
 Die Berechnung basiert auf einer FFT-basierten Methode, die ein
 lineares Gleichungssystem löst, um die Impedanz-Parameter zu bestimmen.
+
+``estimate_band_params`` liefert dieselben Parameter frequenzabhängig
+(ESR(f), C(f)) in logarithmisch verteilten Bändern aus einem Spektrum.
+
+``fit_spectrum`` ist das gemeinsame Vorderteil (Eingabeprüfung, FFT,
+Frequenzauswahl) von ``estimate_cap_params`` und der Monte-Carlo-Unsicherheit
+(``uncertainty.py``), damit beide dieselben Frequenzpunkte verwenden.
 """
 
 import numpy as np
-from typing import Tuple
+from typing import NamedTuple, Optional, Tuple, Union
+
+
+def _pulse_rfft(t: np.ndarray, u: np.ndarray, i: np.ndarray) -> Tuple[np.ndarray, ...]:
+    """
+    Prüft die Eingaben und berechnet das einseitige Spektrum (interne Funktion).
+
+    Returns
+    -------
+    tuple
+        (f, U, I): Frequenzen in Hz und rFFT von u und i, k = 0 .. N//2.
+
+    Raises
+    ------
+    ValueError
+        Bei unterschiedlichen Längen oder nicht streng monoton steigendem Zeitvektor.
+    """
+    t = np.asarray(t, dtype=float)
+    u = np.asarray(u, dtype=float)
+    i = np.asarray(i, dtype=float)
+    if len(t) != len(u) or len(t) != len(i):
+        raise ValueError("Arrays t, u, i müssen gleiche Länge haben")
+    dt = np.diff(t)
+    if np.any(dt <= 0):
+        raise ValueError("Zeitvektor muss streng monoton steigend sein")
+    # Abtastfrequenz aus mittlerem Zeitabstand
+    f = np.fft.rfftfreq(t.size, d=np.mean(dt)) if t.size > 1 else np.zeros(1)
+    return f, np.fft.rfft(u), np.fft.rfft(i)
+
+
+def fit_spectrum(t: np.ndarray, u: np.ndarray, i: np.ndarray) -> Tuple[np.ndarray, ...]:
+    """
+    Frequenzpunkte der ESR/C-Schätzung: positive Frequenzen ohne Nyquist und
+    ohne die erste (wie im MATLAB-Code, vermeidet Instabilitäten bei kleinem ω).
+
+    Returns
+    -------
+    tuple
+        (omega, U, I): Kreisfrequenzen und Spektren von u und i an diesen Punkten.
+
+    Raises
+    ------
+    ValueError
+        Wie ``estimate_cap_params``.
+    """
+    f, fU, fI = _pulse_rfft(t, u, i)
+    k = np.arange(1, (len(t) - 1) // 2 + 1)
+    if k.size == 0:
+        raise ValueError("Keine positiven Frequenzen gefunden (N zu klein?)")
+    if k.size > 1:
+        k = k[1:]       # sonst Fallback: nur die eine positive Frequenz
+    return 2.0 * np.pi * f[k], fU[k], fI[k]
 
 
 def estimate_cap_params(t: np.ndarray, u: np.ndarray, i: np.ndarray) -> Tuple[float, float]:
@@ -74,57 +132,19 @@ def estimate_cap_params(t: np.ndarray, u: np.ndarray, i: np.ndarray) -> Tuple[fl
     >>> esr, cap = estimate_cap_params(t, u, i)
     >>> print(f"ESR: {esr:.6f} Ω, C: {cap*1e6:.6f} µF")
     """
-    # Eingabevalidierung
-    t = np.asarray(t, dtype=float)
-    u = np.asarray(u, dtype=complex)  # Komplex erlauben (für FFT)
-    i = np.asarray(i, dtype=complex)
-    
-    if len(t) != len(u) or len(t) != len(i):
-        raise ValueError("Arrays t, u, i müssen gleiche Länge haben")
-    
-    # Zeitvektor prüfen: muss streng monoton steigend sein
-    dt = np.diff(t)
-    if np.any(dt <= 0):
-        raise ValueError("Zeitvektor muss streng monoton steigend sein")
-    
-    # Abtastfrequenz aus mittlerem Zeitabstand berechnen
-    fs = 1.0 / np.mean(dt)
-    N = t.size
-    
-    # FFT berechnen (shifted für symmetrische Darstellung)
-    fU = np.fft.fftshift(np.fft.fft(u))
-    fI = np.fft.fftshift(np.fft.fft(i))
-    
-    # Frequenzachse generieren (shifted)
-    f = np.fft.fftshift(np.fft.fftfreq(N, d=1.0 / fs))
-    omega = 2.0 * np.pi * f  # Kreisfrequenz
-    
-    # Nur positive Frequenzen verwenden (DC ausschließen)
-    pos_idx = np.where(f > 0)[0]
-    if pos_idx.size == 0:
-        raise ValueError("Keine positiven Frequenzen gefunden (N zu klein?)")
-    
-    # Erste positive Frequenz überspringen (wie im MATLAB-Code)
-    # Vermeidet numerische Instabilitäten bei sehr kleinen Omega
-    if pos_idx.size > 1:
-        idx = pos_idx[1:]  # Ab Index 1
-    else:
-        idx = pos_idx  # Fallback: nur eine positive Frequenz
-    
+    OM, FU, FI = fit_spectrum(t, u, i)
+
     # Lineares Gleichungssystem aufbauen: A * x = b
     # U(ω) = ESR * I(ω) + (1/jωC) * I(ω)
     # A = [I(ω), -I(ω)/(jω)]
     # x = [ESR, 1/C]
     # b = U(ω)
-    FI = fI[idx]  # Strom-FFT bei ausgewählten Frequenzen
-    OM = omega[idx]  # Kreisfrequenzen
-    
     # Vermeide Division durch Null (sollte nicht passieren, da f > 0)
     A = np.column_stack([
         FI,  # Spalte 1: Strom-FFT (für ESR)
         (-1j / OM) * FI  # Spalte 2: Strom-FFT / jω (für 1/C)
     ])
-    b = fU[idx]  # Spannungs-FFT (Zielvektor)
+    b = FU  # Spannungs-FFT (Zielvektor)
     
     # Least-Squares-Lösung (überbestimmtes System)
     x, *_ = np.linalg.lstsq(A, b, rcond=None)
@@ -135,3 +155,115 @@ def estimate_cap_params(t: np.ndarray, u: np.ndarray, i: np.ndarray) -> Tuple[fl
     
     return esr_ohm, capacitance_f
 
+
+def log_bands(f_min: float, f_max: float, n_bands: int) -> np.ndarray:
+    """
+    Logarithmisch verteilte Bandgrenzen.
+
+    Returns
+    -------
+    np.ndarray
+        ``n_bands + 1`` Grenzen von f_min bis f_max in Hz.
+    """
+    if n_bands < 1 or not 0 < f_min < f_max:
+        raise ValueError("Es muss 0 < f_min < f_max und n_bands >= 1 gelten")
+    return np.geomspace(f_min, f_max, n_bands + 1)
+
+
+class BandParams(NamedTuple):
+    """ESR(f)/C(f)-Tabelle eines Pulses, ein Eintrag je Band."""
+    f_lo: np.ndarray
+    f_hi: np.ndarray
+    f_c: np.ndarray         # geometrische Bandmitte
+    esr: np.ndarray         # Ohm, NaN ohne Frequenzpunkte im Band
+    cap: np.ndarray         # Farad
+    n_bins: np.ndarray      # FFT-Punkte je Band
+    esl: float              # abgezogene ESL in Henry (0.0 = ohne)
+
+    def to_dict(self) -> dict:
+        """Tabelle als JSON-taugliches dict (NaN -> None)."""
+        def _list(x):
+            return [None if not np.isfinite(v) else float(v) for v in x]
+        return {"f_lo": _list(self.f_lo), "f_hi": _list(self.f_hi), "f_c": _list(self.f_c),
+                "esr": _list(self.esr), "cap": _list(self.cap),
+                "n_bins": [int(n) for n in self.n_bins], "esl": float(self.esl)}
+
+
+def estimate_band_params(t: np.ndarray, u: np.ndarray, i: np.ndarray, n_bands: int = 8,
+                         f_min: Optional[float] = None, f_max: Optional[float] = None,
+                         esl_h: Union[None, float, str] = None) -> BandParams:
+    """
+    Schätzt ESR und Kapazität getrennt in ``n_bands`` Frequenzbändern.
+
+    Je Puls wird genau ein Spektrum berechnet. Im Band b gilt das Modell
+    ``U(ω) = ESR_b·I(ω) + (1/C_b)·I(ω)/(jω) [+ jω·L·I(ω)]`` mit reellen
+    Unbekannten. Die beiden Spalten sind im Reellen orthogonal, die
+    Kleinste-Quadrate-Lösung zerfällt daher in Summen je Frequenzpunkt::
+
+        ESR_b = Σ Re(I*·U) / Σ |I|²
+        1/C_b = -Σ Im(I*·U)/ω / Σ |I|²/ω²
+
+    Diese Summen werden für alle Bänder zugleich gebildet (``np.bincount``),
+    ohne Schleife über die Bänder.
+
+    Parameters
+    ----------
+    t, u, i : np.ndarray
+        Zeitvektor (gleichabständig), Spannung und Strom wie bei
+        ``estimate_cap_params``
+    n_bands : int, optional
+        Anzahl logarithmisch verteilter Bänder, by default 8
+    f_min, f_max : float, optional
+        Auswertebereich in Hz, by default zweite FFT-Frequenz bis fs/2
+    esl_h : float or "fit", optional
+        Vor der Bandschätzung abzuziehende ESL in Henry; "fit" schätzt sie
+        global (ein Wert für alle Bänder) aus demselben Spektrum,
+        by default None (ohne ESL)
+
+    Returns
+    -------
+    BandParams
+        Tabelle mit Bandgrenzen, ESR(f), C(f) und Anzahl Frequenzpunkte.
+
+    Examples
+    --------
+    >>> bands = estimate_band_params(t, u, i, n_bands=6, f_max=2e6, esl_h="fit")
+    >>> for fc, esr in zip(bands.f_c, bands.esr):
+    ...     print(f"{fc / 1e3:8.1f} kHz  {esr * 1e3:.2f} mΩ")
+    """
+    f, fU, fI = _pulse_rfft(t, u, i)
+    if f.size < 3:
+        raise ValueError("Zu wenige Samples für eine Bandschätzung")
+    f_min = f[2] if f_min is None else float(f_min)
+    f_max = f[-1] if f_max is None else float(f_max)
+    edges = log_bands(f_min, f_max, n_bands)
+
+    sel = (f >= f_min) & (f <= f_max)
+    FU = fU[sel]
+    FI = fI[sel]
+    om = 2.0 * np.pi * f[sel]
+    band = np.clip(np.searchsorted(edges, f[sel], side="right") - 1, 0, n_bands - 1)
+
+    cross = np.conj(FI) * FU
+    p = np.abs(FI) ** 2
+    sums = lambda w: np.bincount(band, weights=w, minlength=n_bands)
+    s_re, s_im, s_ii = sums(cross.real), sums(cross.imag / om), sums(p)
+    s_iw = sums(p / om ** 2)
+
+    if esl_h == "fit":
+        # Gemeinsame ESL: Normalgleichungen für [L, 1/C] über alle Bänder
+        # (ESR ist im Reellen von beiden entkoppelt)
+        g = np.array([[np.sum(p * om ** 2), -np.sum(p)], [-np.sum(p), np.sum(s_iw)]])
+        rhs = np.array([np.sum(cross.imag * om), -np.sum(s_im)])
+        esl = float(np.linalg.solve(g, rhs)[0]) if np.linalg.det(g) > 0 else 0.0
+    else:
+        esl = float(esl_h or 0.0)
+    # jωL·I abziehen: Im(I*·U)/ω verringert sich um L·|I|²
+    s_im = s_im - esl * s_ii
+
+    n_bins = np.bincount(band, minlength=n_bands)
+    with np.errstate(divide="ignore", invalid="ignore"):
+        esr = np.where(n_bins > 0, s_re / s_ii, np.nan)
+        cap = np.where(n_bins > 0, -s_iw / s_im, np.nan)
+    return BandParams(edges[:-1], edges[1:], np.sqrt(edges[:-1] * edges[1:]), esr, cap,
+                      n_bins, esl)
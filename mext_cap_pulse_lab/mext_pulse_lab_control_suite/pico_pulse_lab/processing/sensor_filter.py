@@ -0,0 +1,241 @@
+"""
+Frequenzgang-Korrektur für Tastkopf und Rogowski-Spule (Overlap-Save).
+
+Bisher werden Spannung und Strom nur mit einem Faktor skaliert
+(``u_probe_attenuation``, ``rogowski_v_per_a``). Beide Sensoren sind bei
+20 MS/s aber nicht flach: der Tastkopf fällt zu hohen Frequenzen ab, die
+Rogowski-Spule mit Integrator zusätzlich zu tiefen. Hier wird aus einem
+gemessenen Frequenzgang ``H(f)`` (bezogen auf den Nennfaktor, also
+``|H| ≈ 1`` im flachen Bereich) ein Korrektur-FIR entworfen:
+
+    D(f) = conj(H) / (|H|² + reg)      (regularisierte Inverse)
+           · Tiefpass (optional, Kosinus-Flanke von fc bis 1.5·fc)
+
+Gefiltert wird per FFT im Overlap-Save-Verfahren mit zwischengespeicherten
+Filterspektren -- einzelne Pulse (``filter``, ohne Verzögerung) ebenso wie
+fortlaufende Datenströme (``process``, blockweise mit Gedächtnis).
+
+Frequenzgang-Dateien:
+
+- ``.npz`` mit ``f`` (Hz) und ``h`` (komplex)
+- ``.csv`` mit den Spalten ``f_hz, mag_db, phase_deg`` (Kopfzeile erlaubt)
+
+Der Entwurf (Parameter, nicht die Koeffizienten) steht über ``to_meta()`` in
+den Metadaten des Messlaufs.
+"""
+
+import functools
+import os
+from typing import NamedTuple, Optional
+
+import numpy as np
+
+DEFAULT_TAPS = 255
+DEFAULT_REG = 1e-2
+LOWPASS_TRANSITION = 1.5    # Tiefpass fällt von fc bis 1.5 * fc auf 0
+
+
+def load_response(path: str) -> tuple:
+    """
+    Lädt einen gemessenen Frequenzgang.
+
+    Returns
+    -------
+    tuple
+        (f in Hz, H komplex), nach Frequenz sortiert.
+    """
+    if os.path.splitext(path)[1].lower() == ".npz":
+        with np.load(path) as data:
+            f, h = np.asarray(data["f"], float), np.asarray(data["h"], complex)
+    else:
+        rows = np.genfromtxt(path, delimiter=",", comments="#", dtype=float)
+        rows = rows[~np.isnan(rows).any(axis=1)]            # Kopfzeile
+        f = rows[:, 0]
+        h = 10 ** (rows[:, 1] / 20) * np.exp(1j * np.deg2rad(rows[:, 2]))
+    order = np.argsort(f)
+    return f[order], h[order]
+
+
+def _interp_response(f_grid: np.ndarray, f: np.ndarray, h: np.ndarray) -> np.ndarray:
+    """Betrag (log) und Phase getrennt interpolieren; außerhalb Randwerte halten."""
+    mag = np.exp(np.interp(f_grid, f, np.log(np.maximum(np.abs(h), 1e-12))))
+    phase = np.interp(f_grid, f, np.unwrap(np.angle(h)))
+    return mag * np.exp(1j * phase)
+
+
+class FirDesign(NamedTuple):
+    """Entworfenes Korrektur-FIR: Koeffizienten, Gruppenlaufzeit (Samples) und Parameter."""
+    taps: np.ndarray
+    delay: int
+    fs: float
+    params: dict
+
+    def to_meta(self) -> dict:
+        """Entwurfsparameter für die Metadaten (JSON-tauglich)."""
+        return {**self.params, "fs": self.fs, "n_taps": len(self.taps), "delay": self.delay}
+
+
+def design_correction(fs: float, *, response: Optional[str] = None,
+                      lowpass_hz: Optional[float] = None, n_taps: int = DEFAULT_TAPS,
+                      reg: float = DEFAULT_REG) -> FirDesign:
+    """
+    Entwirft das Korrektur-FIR für einen Sensor.
+
+    Parameters
+    ----------
+    fs : float
+        Abtastrate in Hz
+    response : str, optional
+        Datei mit gemessenem Frequenzgang (siehe Modulbeschreibung), None = flach
+    lowpass_hz : float, optional
+        Grenzfrequenz des Entrausch-Tiefpasses, None = ohne
+    n_taps : int, optional
+        Filterlänge (wird ungerade gemacht), by default 255
+    reg : float, optional
+        Regularisierung der Inversen: begrenzt die Verstärkung auf ``1/(2*sqrt(reg))``
+        dort, wo der Sensor kaum noch überträgt, by default 1e-2
+
+    Returns
+    -------
+    FirDesign
+    """
+    mtime = os.path.getmtime(response) if response is not None else None
+    return _design_cached(float(fs), response, mtime, lowpass_hz, int(n_taps) | 1, float(reg))
+
+
+@functools.lru_cache(maxsize=32)
+def _design_cached(fs: float, response: Optional[str], mtime: Optional[float],
+                   lowpass_hz: Optional[float], n_taps: int, reg: float) -> FirDesign:
+    # mtime nur als Cache-Schlüssel: geänderte Frequenzgang-Datei -> neuer Entwurf
+    n_grid = 1 << int(np.ceil(np.log2(8 * n_taps)))
+    f_grid = np.fft.rfftfreq(n_grid, 1.0 / fs)
+    d = np.ones(len(f_grid), dtype=complex)
+    if response is not None:
+        f, h = load_response(response)
+        hg = _interp_response(f_grid, f, h)
+        d = np.conj(hg) / (np.abs(hg) ** 2 + reg)
+    if lowpass_hz is not None:
+        x = np.clip((f_grid - lowpass_hz) / ((LOWPASS_TRANSITION - 1) * lowpass_hz), 0, 1)
+        d *= 0.5 * (1 + np.cos(np.pi * x))
+    d[-1] = d[-1].real
+
+    half = n_taps // 2
+    h_imp = np.roll(np.fft.irfft(d, n_grid), half)[:n_taps] * np.hamming(n_taps)
+    params = {"response": os.path.basename(response) if response else None,
+              "lowpass_hz": lowpass_hz, "reg": reg}
+    return FirDesign(h_imp, half, fs, params)
+
+
+class OverlapSave:
+    """
+    FIR-Filter per FFT im Overlap-Save-Verfahren.
+
+    Filterspektren werden je FFT-Länge einmal berechnet und wiederverwendet.
+
+    Parameters
+    ----------
+    design : FirDesign or np.ndarray
+        Entwurf aus ``design_correction()`` oder reine Koeffizienten (Verzögerung 0)
+    block : int, optional
+        Nutzsamples je FFT-Block, by default 8 * Filterlänge
+
+    Examples
+    --------
+    >>> fir = OverlapSave(design_correction(fs, response="rogowski.csv", lowpass_hz=5e6))
+    >>> i_corr = fir.filter(i)                 # einzelner Puls, ohne Verzögerung
+    >>> for chunk in stream:                   # Datenstrom, Verzögerung fir.delay
+    ...     out = fir.process(chunk)
+    """
+
+    def __init__(self, design, block: Optional[int] = None):
+        if isinstance(design, FirDesign):
+            self.taps, self.delay = np.asarray(design.taps, float), design.delay
+            self.meta = design.to_meta()
+        else:
+            self.taps, self.delay = np.asarray(design, float), 0
+            self.meta = {"n_taps": len(self.taps), "delay": 0}
+        m = len(self.taps)
+        self.nfft = 1 << int(np.ceil(np.log2((block or 8 * m) + m - 1)))
+        self.step = self.nfft - (m - 1)
+        self._spectra = {}
+        self._history = np.zeros(m - 1)
+
+    def _spectrum(self, nfft: int) -> np.ndarray:
+        spec = self._spectra.get(nfft)
+        if spec is None:
+            spec = self._spectra[nfft] = np.fft.rfft(self.taps, nfft)
+        return spec
+
+    def _convolve(self, xp: np.ndarray) -> np.ndarray:
+        """Gültiger Teil der Faltung von xp (vorne m-1 Samples Gedächtnis)."""
+        m = len(self.taps)
+        n_out = len(xp) - (m - 1)
+        if n_out <= 0:
+            return np.zeros(0)
+        n_blocks = -(-n_out // self.step)
+        xp = np.concatenate((xp, np.zeros(n_blocks * self.step + m - 1 - len(xp))))
+        frames = np.lib.stride_tricks.sliding_window_view(xp, self.nfft)[::self.step]
+        y = np.fft.irfft(np.fft.rfft(frames, axis=1) * self._spectrum(self.nfft), self.nfft,
+                         axis=1)
+        return y[:, m - 1:].reshape(-1)[:n_out]
+
+    def filter(self, x: np.ndarray) -> np.ndarray:
+        """
+        Filtert ein vollständiges Signal (z.B. einen Puls), Verzögerung ausgeglichen.
+
+        Die Ränder werden mit 0 fortgesetzt (AC-gekoppelte Grundlinie).
+        """
+        x = np.asarray(x, dtype=float)
+        m = len(self.taps)
+        xp = np.concatenate((np.zeros(m - 1 - self.delay), x, np.zeros(self.delay)))
+        return self._convolve(xp)
+
+    def process(self, chunk: np.ndarray) -> np.ndarray:
+        """
+        Filtert den nächsten Abschnitt eines Datenstroms.
+
+        Die Ausgabe hat die Länge des Abschnitts und ist um ``delay`` Samples
+        verzögert; der Zustand bleibt bis ``reset()`` erhalten.
+        """
+        chunk = np.asarray(chunk, dtype=float)
+        xp = np.concatenate((self._history, chunk))
+        self._history = xp[len(xp) - (len(self.taps) - 1):]
+        return self._convolve(xp)
+
+    def reset(self) -> None:
+        """Setzt das Gedächtnis von ``process()`` zurück."""
+        self._history[:] = 0.0
+
+
+def build_filters(spec: Optional[dict], fs: float) -> dict:
+    """
+    Erstellt die Filter je Kanal aus einer (JSON-)Konfiguration.
+
+    Parameters
+    ----------
+    spec : dict or None
+        z.B. ``{"u": {"response": "tk_50.csv", "lowpass_hz": 5e6},
+        "i": {"response": "rogowski.npz"}}``; Schlüssel je Kanal wie bei
+        ``design_correction()``
+    fs : float
+        Abtastrate in Hz
+
+    Returns
+    -------
+    dict
+        Kanal ("u"/"i") -> ``OverlapSave``; leer ohne Konfiguration.
+    """
+    filters = {}
+    for ch, kwargs in (spec or {}).items():
+        if ch not in ("u", "i"):
+            raise ValueError(f"Unbekannter Kanal für Filter: {ch!r}")
+        if kwargs:
+            filters[ch] = OverlapSave(design_correction(fs, **kwargs))
+    return filters
+
+
+def filters_meta(filters: dict) -> Optional[dict]:
+    """Entwurfsparameter aller Filter für die Metadaten."""
+    if not filters:
+        return None
+    return {ch: f.meta for ch, f in filters.items()}
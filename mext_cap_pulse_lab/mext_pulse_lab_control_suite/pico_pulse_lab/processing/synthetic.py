@@ -0,0 +1,36 @@
+"""
+Synthetische Messsignale für Tests und Benchmarks ohne Messdaten.
+
+``pulse_pair`` ist der bipolare Strompuls der Vollbrücke (positive und
+negative Halbwelle gleicher Länge, weiche Flanken), aus dem sich über ein
+Ersatzschaltbild die Spannung berechnen lässt.
+"""
+
+import numpy as np
+
+
+def pulse_pair(n: int, start: float, width: float, amp: float = 1.0,
+               rise: float = 3.0) -> np.ndarray:
+    """
+    Pulspaar: ``+amp`` ab Sample ``start``, ``-amp`` ab ``start + width``, Ende bei
+    ``start + 2·width``; tanh-Flanken mit ``rise`` Samples.
+
+    Parameters
+    ----------
+    n : int
+        Anzahl Samples
+    start, width : float
+        Beginn und Länge je Halbwelle in Samples (auch gebrochen, z.B. für Verzögerungen)
+    amp : float, optional
+        Amplitude, by default 1.0
+    rise : float, optional
+        Flankenbreite in Samples, by default 3.0
+
+    Returns
+    -------
+    np.ndarray
+        (n,) Signal, mittelwertfrei sobald das Paar ganz im Fenster liegt.
+    """
+    k = np.arange(n) - start
+    edge = lambda a: np.tanh((k - a) / rise)
+    return 0.5 * amp * ((edge(0) - edge(width)) - (edge(width) - edge(2 * width)))
@@ -0,0 +1,213 @@
+"""
+Monte-Carlo-Unsicherheit von ESR und Kapazität.
+
+``estimate_cap_params`` liefert ESR und C ohne Fehlerangabe. Die
+Eingangsdaten sind aber mit drei Fehlerquellen behaftet:
+
+- 8-Bit-Quantisierung beider Kanäle (±LSB/2, weiß)
+- Toleranz des Tastkopf-Faktors (``u_probe_attenuation``)
+- Toleranz des Rogowski-Faktors (``rogowski_v_per_a``)
+
+Statt für jede Ziehung neu zu quantisieren und zu transformieren, wird das
+Spektrum des Pulses einmal berechnet und direkt im Frequenzbereich gestört:
+weißes Rauschen der Varianz σ² ergibt je FFT-Punkt komplexes Rauschen der
+Varianz N·σ², die Faktoren skalieren U bzw. I. Alle Ziehungen werden dann
+mit der geschlossenen Lösung der 2x2-Normalgleichungen von
+``estimate_cap_params`` in einer Matrixoperation gelöst.
+
+Ergebnis je Puls: Nominalwert, Standardabweichung und Konfidenzintervall
+(Perzentile) für ESR und C -- inline für einzelne Pulse (``monte_carlo``,
+z.B. im Daemon) oder für alle Pulse einer ``.npz``-Datei (``monte_carlo_npz``).
+Liegt der Nominalwert außerhalb des Intervalls, dominiert das Stromrauschen
+den Puls (Kleinste Quadrate verzerren zu kleinerem ESR) und die Schätzung
+ist nicht belastbar.
+"""
+
+from typing import Dict, NamedTuple, Optional, Sequence, Tuple
+
+import numpy as np
+
+from pico_pulse_lab.processing.cap_params import fit_spectrum
+
+ADC_BITS = 8
+DEFAULT_DRAWS = 1000
+DEFAULT_LEVEL = 0.95
+DEFAULT_U_GAIN_TOL = 0.02     # Tastkopf ±2 %
+DEFAULT_I_GAIN_TOL = 0.01     # Rogowski-Spule ±1 %
+
+
+class ErrorModel(NamedTuple):
+    """
+    Fehlerquellen der Messung.
+
+    ``u_lsb``/``i_lsb`` sind die Quantisierungsstufen in V bzw. A,
+    ``*_gain_tol`` relative Toleranzen der Faktoren (gleichverteilt in ±tol).
+    """
+    u_lsb: float
+    i_lsb: float
+    u_gain_tol: float = DEFAULT_U_GAIN_TOL
+    i_gain_tol: float = DEFAULT_I_GAIN_TOL
+
+    @classmethod
+    def from_meta(cls, meta: dict, u_gain_tol: float = DEFAULT_U_GAIN_TOL,
+                  i_gain_tol: float = DEFAULT_I_GAIN_TOL) -> "ErrorModel":
+        """
+        Fehlermodell aus den Metadaten eines Messlaufs (``ch_a``/``ch_b``).
+
+        Ohne ``u_probe_attenuation`` (ältere Läufe) wird 1 angenommen, ohne
+        ``rogowski_v_per_a`` bleibt der Strom in V.
+        """
+        ch_a, ch_b = meta.get("ch_a", {}), meta.get("ch_b", {})
+        u_lsb = 2.0 * ch_a["v_range"] * (ch_a.get("u_probe_attenuation") or 1.0) / 2 ** ADC_BITS
+        i_lsb = 2.0 * ch_b["v_range"] / 2 ** ADC_BITS
+        if ch_b.get("rogowski_v_per_a"):
+            i_lsb /= ch_b["rogowski_v_per_a"]
+        return cls(u_lsb, i_lsb, u_gain_tol, i_gain_tol)
+
+
+class ParamInterval(NamedTuple):
+    """ESR/C eines Pulses mit Monte-Carlo-Streuung und Konfidenzintervall."""
+    esr: float
+    cap: float
+    esr_std: float
+    cap_std: float
+    esr_ci: Tuple[float, float]
+    cap_ci: Tuple[float, float]
+    level: float
+    n_draws: int
+
+    def to_dict(self) -> dict:
+        """JSON-taugliche Darstellung (z.B. für ``latest_params``)."""
+        return {"esr_std": self.esr_std, "cap_std": self.cap_std,
+                "esr_ci": list(self.esr_ci), "cap_ci": list(self.cap_ci),
+                "level": self.level, "n_draws": self.n_draws}
+
+
+def pulse_spectrum(t: np.ndarray, u: np.ndarray, i: np.ndarray) -> Tuple[np.ndarray, ...]:
+    """
+    Frequenzpunkte von ``estimate_cap_params`` (``cap_params.fit_spectrum``),
+    dazu die Anzahl Samples für die Rauschvarianz je FFT-Punkt.
+
+    Returns
+    -------
+    tuple
+        (omega, U, I, N)
+    """
+    omega, U, I = fit_spectrum(t, u, i)
+    return omega, U, I, len(t)
+
+
+def solve_rc(omega: np.ndarray, U: np.ndarray, I: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Kleinste-Quadrate-Lösung von ``estimate_cap_params`` entlang der letzten Achse.
+
+    Mit den Spalten I und -jI/ω lauten die Normalgleichungen
+    ``[[a, -jb], [jb, c]] x = [s1, j·s2]`` mit a = Σ|I|², b = Σ|I|²/ω,
+    c = Σ|I|²/ω², s1 = Σ I*U, s2 = Σ I*U/ω -- geschlossen lösbar für
+    beliebig viele Ziehungen gleichzeitig.
+
+    Returns
+    -------
+    tuple
+        (esr, cap), Form der führenden Achsen von U/I.
+    """
+    p = np.abs(I) ** 2
+    cross = np.conj(I) * U
+    a = p.sum(axis=-1)
+    b = (p / omega).sum(axis=-1)
+    c = (p / omega ** 2).sum(axis=-1)
+    s1 = cross.sum(axis=-1)
+    s2 = (cross / omega).sum(axis=-1)
+    det = a * c - b * b
+    x0 = (c * s1 - b * s2) / det
+    x1 = 1j * (a * s2 - b * s1) / det
+    return np.real(x0), np.real(1.0 / x1)
+
+
+def monte_carlo(t: np.ndarray, u: np.ndarray, i: np.ndarray, errors: ErrorModel,
+                n_draws: int = DEFAULT_DRAWS, level: float = DEFAULT_LEVEL, n_avg: int = 1,
+                rng: Optional[np.random.Generator] = None) -> ParamInterval:
+    """
+    Propagiert die Fehlerquellen eines Pulses auf ESR und C.
+
+    Parameters
+    ----------
+    t, u, i : np.ndarray
+        Puls wie bei ``estimate_cap_params``
+    errors : ErrorModel
+        Quantisierung und Faktor-Toleranzen
+    n_draws : int, optional
+        Anzahl Ziehungen, by default 1000
+    level : float, optional
+        Konfidenzniveau des Intervalls, by default 0.95
+    n_avg : int, optional
+        Anzahl kohärent gemittelter Pulse: das Quantisierungsrauschen sinkt
+        um sqrt(n_avg), die Faktoren bleiben systematisch, by default 1
+    rng : np.random.Generator, optional
+        Zufallsgenerator (reproduzierbare Ergebnisse)
+
+    Returns
+    -------
+    ParamInterval
+    """
+    rng = rng or np.random.default_rng()
+    omega, U, I, n = pulse_spectrum(t, u, i)
+    esr0, cap0 = solve_rc(omega, U, I)
+
+    # weißes Rauschen σ² = LSB²/12 -> je FFT-Punkt Re/Im mit Varianz N·σ²/2
+    shape = (n_draws, omega.size)
+    scale = np.sqrt(n / 24.0 / max(n_avg, 1))
+    dU = (errors.u_lsb * scale) * (rng.standard_normal(shape) + 1j * rng.standard_normal(shape))
+    dI = (errors.i_lsb * scale) * (rng.standard_normal(shape) + 1j * rng.standard_normal(shape))
+    gu = 1.0 + rng.uniform(-errors.u_gain_tol, errors.u_gain_tol, (n_draws, 1))
+    gi = 1.0 + rng.uniform(-errors.i_gain_tol, errors.i_gain_tol, (n_draws, 1))
+
+    esr, cap = solve_rc(omega, gu * (U + dU), gi * (I + dI))
+    q = 100.0 * np.array([(1 - level) / 2, (1 + level) / 2])
+    esr_ci, cap_ci = np.percentile(esr, q), np.percentile(cap, q)
+    return ParamInterval(float(esr0), float(cap0), float(np.std(esr)), float(np.std(cap)),
+                         (float(esr_ci[0]), float(esr_ci[1])),
+                         (float(cap_ci[0]), float(cap_ci[1])), level, n_draws)
+
+
+def monte_carlo_npz(path: str, errors: Optional[ErrorModel] = None,
+                    pulse_ids: Optional[Sequence[int]] = None, n_draws: int = 500,
+                    level: float = DEFAULT_LEVEL, seed: Optional[int] = 0) -> Dict[str, np.ndarray]:
+    """
+    Unsicherheit aller (oder ausgewählter) Pulse einer ``.npz``-Datei.
+
+    Parameters
+    ----------
+    path : str
+        Messlauf im Format von ``storage.npz_writer``
+    errors : ErrorModel, optional
+        by default aus den Metadaten der Datei (Standard-Toleranzen)
+    pulse_ids : sequence of int, optional
+        by default alle Pulse (ohne den Metadaten-Platzhalter ``pulse_id`` 0)
+
+    Returns
+    -------
+    dict
+        Spalten-Arrays ``pulse_id, esr, esr_lo, esr_hi, esr_std, cap, cap_lo,
+        cap_hi, cap_std``.
+    """
+    from pico_pulse_lab.storage.npz_writer import load_meta_npz
+
+    if errors is None:
+        errors = ErrorModel.from_meta(load_meta_npz(path))
+    # Datei einmal laden statt je Puls (load_pulse_npz liest jedes Mal alles)
+    with np.load(path, allow_pickle=True) as data:
+        pulses = data["pulses"].item()
+    ids = sorted(p for p in pulses if p != 0) if pulse_ids is None else list(pulse_ids)
+    rng = np.random.default_rng(seed)
+
+    cols = {k: np.full(len(ids), np.nan) for k in
+            ("esr", "esr_lo", "esr_hi", "esr_std", "cap", "cap_lo", "cap_hi", "cap_std")}
+    for n, pid in enumerate(ids):
+        p = pulses[pid]
+        r = monte_carlo(p["t"], p["u"], p["i"], errors, n_draws, level, rng=rng)
+        cols["esr"][n], cols["cap"][n] = r.esr, r.cap
+        cols["esr_lo"][n], cols["esr_hi"][n] = r.esr_ci
+        cols["cap_lo"][n], cols["cap_hi"][n] = r.cap_ci
+        cols["esr_std"][n], cols["cap_std"][n] = r.esr_std, r.cap_std
+    return {"pulse_id": np.asarray(ids, dtype=int), **cols}
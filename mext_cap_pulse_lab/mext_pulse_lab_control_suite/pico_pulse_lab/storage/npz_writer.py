@@ -150,7 +150,8 @@ def append_pulse_npz(
     pulse_id: int,
     t: np.ndarray,
     u: np.ndarray,
-    i: np.ndarray
+    i: np.ndarray,
+    roi: tuple = None
 ) -> None:
     """
     Hängt einen neuen Puls an eine bestehende .npz Datei an.
@@ -172,6 +173,9 @@ def append_pulse_npz(
         Spannungswerte in Volt.
     i : np.ndarray
         Stromwerte in Ampere.
+    roi : tuple, optional
+        (start, length) des übertragenen Bereichs im Erfassungsfenster
+        (ROI-Modus); wird unter ``meta['roi_offsets'][pulse_id]`` abgelegt.
     
     Returns
     -------
@@ -218,6 +222,8 @@ def append_pulse_npz(
     # Metadaten aktualisieren
     meta['updated'] = datetime.now().isoformat()
     meta['pulse_count'] = len(pulses)
+    if roi is not None:
+        meta.setdefault('roi_offsets', {})[pulse_id] = (int(roi[0]), int(roi[1]))
     
     # Neue Struktur aufbauen
     data = {
@@ -229,6 +235,45 @@ def append_pulse_npz(
     np.savez_compressed(path, **data)
 
 
+def update_meta_npz(path: str, meta: Dict) -> None:
+    """
+    Ersetzt die Metadaten einer bestehenden .npz Datei, die Pulse bleiben.
+    
+    Für Änderungen während eines Laufs (z.B. neues Erfassungsfenster);
+    ``pulse_count``, ``roi_offsets`` und ``created`` der Datei bleiben erhalten.
+    
+    Parameters
+    ----------
+    path : str
+        Pfad zur .npz Datei. Muss bereits existieren.
+    meta : dict
+        Neue Metadaten.
+    
+    Returns
+    -------
+    None
+    
+    Raises
+    ------
+    FileNotFoundError
+        Wenn die Datei nicht existiert.
+    """
+    if not os.path.exists(path):
+        raise FileNotFoundError(f"Datei nicht gefunden: {path}")
+    
+    loaded = np.load(path, allow_pickle=True)
+    pulses = loaded['pulses'].item() if 'pulses' in loaded else {}
+    old = loaded['meta'].item() if 'meta' in loaded else {}
+    
+    meta_out = dict(meta)
+    for key in ('created', 'pulse_count', 'roi_offsets'):
+        if key in old:
+            meta_out[key] = old[key]
+    meta_out['updated'] = datetime.now().isoformat()
+    
+    np.savez_compressed(path, pulses=pulses, meta=meta_out)
+
+
 def get_all_pulse_ids(path: str) -> list:
     """
     Gibt eine Liste aller gespeicherten Pulse-IDs aus einer .npz Datei zurück.
@@ -0,0 +1,572 @@
+"""
+Host-Simulator der Nucleo-Firmware für Tests ohne Hardware.
+
+``FakeNucleo`` verhält sich wie ein geöffnetes ``serial.Serial``-Objekt
+(read/write/in_waiting/flush/close) und beantwortet empfangene Frames so
+wie die Firmware in ``Core/Src/main.c``: Event-Frames (0x80) statt
+Textausgaben für SET/START/STOP/READBACK, binäre Antwortframes für
+READBACK, CONFIG, FIRE, STATUS, ADC, PROT, WAVE, CHAN, RETIME und RATE sowie ADC-Messdaten (0x98)
+je abgeschlossenem Pulspaar, wenn die Aufzeichnung aktiv ist. ``trip()``
+simuliert das Auslösen des Komparator-Schutzes.
+
+Zyklen laufen nicht in Echtzeit: FIRE schließt die angeforderten Pulspaare
+sofort ab, im freilaufenden Betrieb schaltet ``tick()`` den Zähler weiter,
+im Schnellmodus (RATE) ``rate_elapse()`` die Laufzeit samt Wärmebudget.
+"""
+
+import threading
+import time
+
+from pico_pulse_lab.control.high_rate import (COOL_US_PER_MS, HEAT_MAX_US, on_us_per_ms,
+                                              rate_grid)
+from pico_pulse_lab.control.multichannel import t1_grid
+
+PREAMBLE = 0xFF
+FRAME_SIZE = 5
+
+CMD_SET_T1, CMD_SET_T2 = 0x10, 0x11
+CMD_START_T1, CMD_START_T2 = 0x20, 0x21
+CMD_STOP_T1, CMD_STOP_T2 = 0x30, 0x31
+CMD_READBACK_T1, CMD_READBACK_T2 = 0x40, 0x41
+CMD_CONFIG = 0x50
+CMD_FIRE = 0x60
+CMD_STATUS = 0x70
+CMD_EVENT = 0x80
+CMD_ADC, CMD_ADC_REC = 0x90, 0x98
+CMD_PROT_I, CMD_PROT_U = 0xA0, 0xA1
+CMD_WAVE, CMD_WAVE_CTRL = 0xB0, 0xB1
+CMD_CHAN, CMD_CHAN_CTRL = 0xC0, 0xC1
+CMD_RETIME = 0xD0
+CMD_RATE = 0xE0
+EVT_FAULT, EVT_FAULT_CLR = 0x42, 0x43
+EVT_WAVE_START, EVT_WAVE_DONE = 0x33, 0x34
+EVT_CH_START, EVT_CH_DONE, EVT_CH_STOP = 0x35, 0x36, 0x37
+EVT_RETIME = 0x38
+EVT_RATE_START, EVT_RATE_DONE = 0x39, 0x3A
+EVT_CMD_SET, EVT_CMD_START, EVT_CMD_STOP, EVT_CMD_RB = 0x10, 0x11, 0x12, 0x13
+EVT_CMD_UNKNOWN, EVT_RX_FRAME = 0x1F, 0x20
+CONFIG_SIZE = 11
+WAVE_DATA_SIZE = 14
+WAVE_MAX_STEPS = 256
+CHAN_SIZE = 12
+RETIME_SIZE = 6
+RATE_SIZE = 13
+CHANNELS = 3
+
+T1_MIN_US, T1_MAX_US = 10, 1000
+T2_MIN_MS, T2_MAX_MS = 1, 10000
+
+
+class FakeNucleo:
+    """
+    Serielle Gegenstelle mit Firmware-Verhalten.
+
+    Parameters
+    ----------
+    timeout : float, optional
+        Lese-Timeout wie bei pyserial, by default 0.02
+    reply_delay_s : float, optional
+        Künstliche Verzögerung vor jeder Antwort, by default 0.0
+    """
+
+    def __init__(self, timeout: float = 0.02, reply_delay_s: float = 0.0):
+        self.timeout = timeout
+        self.reply_delay_s = reply_delay_s
+        self.is_open = True
+        self.t1_us = 100
+        self.t2_ms = 1000
+        self.running = False
+        self.pulse_target = 0
+        self.t_flags = [0, 0]           # Tcfg[].flags (T1, T2)
+        self.cycles = 0                 # abgeschlossene Pulspaare
+        self.rx_frames = []             # vom Host empfangene Frames
+        self.rx_dropped = 0             # Diagnosezähler wie in der Firmware (STATUS)
+        self.isr_latency_max = 0        # CPU-Takte
+        self.isr_exec_max = 0           # CPU-Takte
+        self.overruns = 0
+        self.adc_decimation = 0         # ADC-Kommando, 0 = aus
+        self.adc_raw = (3000, 2900, 3050, 2600, 2048, 3100)   # U_mean U_min U_max I_mean I_min I_max
+        self.adc_samples = 35           # Wertepaare je Puls
+        self._adc_div = 0
+        self.prot_thr = [3900, 3900]    # DAC-Schwellen Strom, Spannung
+        self.fault = 0                  # Schutz-Latch
+        self.fault_phase = 0
+        self.fault_cycle = 0
+        self.comp_active = 0            # Komparatoren, die noch anliegen (verhindern Quittieren)
+        self.wave_tab = []              # [(Zustand, Ticks)], RAM-Tabelle
+        self.wave_flash = None          # gespeicherte Tabelle (None = Seite leer)
+        self.wave_running = False
+        self.wave_hold = False          # True: RUN bleibt aktiv bis STOP (sonst sofort fertig)
+        self.wave_passes = 0
+        self.multi = False              # Mehrkanalbetrieb (HRTIM), STATUS state 3
+        self.chan = [None] * CHANNELS   # je Kanal {t1_ps, t2_ms, n, run, fired}
+        self.chan_hold = False          # True: Kanäle mit Pulszahl laufen bis STOP
+        self.rt_pending = None          # RETIME: (T1 µs, T2 ms, Umschaltzyklus) bis zum nächsten Pulspaar
+        self.rate = None                # Schnellmodus {t1_ns, per_ns, n}
+        self.rate_running = False       # STATUS state 4
+        self.rate_fired = 0             # Pulspaare des laufenden Schnellmodus (TIM2)
+        self.rate_heat = 0              # Wärmebudget in µs Einschaltzeit
+        self.rate_guard = False
+        self._t0 = time.monotonic()
+        self._evt_seq = 0
+        self._inbuf = bytearray()       # Host -> Firmware
+        self._outbuf = bytearray()      # Firmware -> Host
+        self._cv = threading.Condition()
+
+    # -------- serial-API --------
+    @property
+    def in_waiting(self) -> int:
+        with self._cv:
+            return len(self._outbuf)
+
+    def read(self, n: int = 1) -> bytes:
+        end = time.monotonic() + (self.timeout or 0)
+        with self._cv:
+            while not self._outbuf and self.is_open:
+                rest = end - time.monotonic()
+                if rest <= 0:
+                    break
+                self._cv.wait(rest)
+            data = bytes(self._outbuf[:n])
+            del self._outbuf[:n]
+            return data
+
+    def write(self, data: bytes) -> int:
+        self._inbuf.extend(data)
+        while len(self._inbuf) >= 2:
+            if self._inbuf[0] != PREAMBLE:
+                del self._inbuf[0]
+                continue
+            size = {CMD_CONFIG: CONFIG_SIZE, CMD_WAVE: WAVE_DATA_SIZE,
+                    CMD_CHAN: CHAN_SIZE, CMD_RETIME: RETIME_SIZE,
+                    CMD_RATE: RATE_SIZE}.get(self._inbuf[1], FRAME_SIZE)
+            if len(self._inbuf) < size:
+                break
+            frame = bytes(self._inbuf[:size])
+            del self._inbuf[:size]
+            self.rx_frames.append(frame)
+            self._handle(frame)
+        return len(data)
+
+    def flush(self) -> None:
+        pass
+
+    def reset_output_buffer(self) -> None:
+        pass
+
+    def reset_input_buffer(self) -> None:
+        with self._cv:
+            self._outbuf.clear()
+
+    def close(self) -> None:
+        with self._cv:
+            self.is_open = False
+            self._cv.notify_all()
+
+    # -------- Firmware-Verhalten --------
+    def _send(self, data: bytes) -> None:
+        if self.reply_delay_s:
+            time.sleep(self.reply_delay_s)
+        with self._cv:
+            self._outbuf.extend(data)
+            self._cv.notify_all()
+
+    def _event(self, eid: int, a0: int = 0, a1: int = 0) -> None:
+        ts = int((time.monotonic() - self._t0) * 1e6) & 0xFFFFFFFF
+        self._send(bytes([PREAMBLE, CMD_EVENT, eid, self._evt_seq])
+                   + ts.to_bytes(4, "little") + a0.to_bytes(4, "little") + a1.to_bytes(4, "little"))
+        self._evt_seq = (self._evt_seq + 1) & 0xFF
+
+    def _handle_config(self, frame: bytes) -> None:
+        t1 = frame[2] | (frame[3] << 8)
+        t2 = frame[4] | (frame[5] << 8)
+        self.running = False
+        self._rate_end(1)                           # seq_hard_stop() beendet den Schnellmodus,
+        self._retime_commit()                       # ... übernimmt bereitliegende Werte,
+        self._wave_abort()                          # ... bricht auch WAVE ab
+        self._multi_exit()                          # ... und den Mehrkanalbetrieb
+        self.t1_us = min(max(t1, T1_MIN_US), T1_MAX_US)
+        self.t2_ms = min(max(t2, T2_MIN_MS), T2_MAX_MS)
+        self.pulse_target = frame[6] | (frame[7] << 8)
+        self.t_flags = [frame[8], frame[9]]
+        status = 0x02 if (self.t1_us != t1 or self.t2_ms != t2) else 0
+        if frame[10] & 0x01:
+            if self.fault:                          # seq_start() verweigert bei Fehler
+                status |= 0x80
+            else:
+                self.running = True
+                status |= 0x01
+        self._send(bytes([PREAMBLE, CMD_CONFIG,
+                          self.t1_us & 0xFF, self.t1_us >> 8,
+                          self.t2_ms & 0xFF, self.t2_ms >> 8,
+                          frame[6], frame[7], status]))
+
+    def _complete_cycles(self, n: int) -> None:
+        """Schließt n Pulspaare ab (Zähler + ADC-Messdaten wie adc_poll())."""
+        for _ in range(n):
+            self.cycles += 1
+            if self.rt_pending and self.cycles >= self.rt_pending[2]:
+                self._retime_commit()               # TIM1-ISR nach dem Pulspaar
+            if not self.adc_decimation:
+                continue
+            self._adc_div += 1
+            if self._adc_div < self.adc_decimation:
+                continue
+            self._adc_div = 0
+            self._send(self.adc_frame(self.cycles))
+
+    def adc_frame(self, cycle: int) -> bytes:
+        """ADC-Messdaten-Frame mit ``adc_raw`` für beide Pulse."""
+        stats = b"".join(v.to_bytes(2, "little") for v in self.adc_raw)
+        return (bytes([PREAMBLE, CMD_ADC_REC]) + cycle.to_bytes(4, "little")
+                + self.adc_samples.to_bytes(2, "little") * 2 + stats * 2)
+
+    def tick(self, n: int = 1) -> None:
+        """Lässt im laufenden Betrieb n Zyklen verstreichen."""
+        if self.running:
+            self._complete_cycles(n)
+
+    def _retime_commit(self) -> None:
+        if self.rt_pending:
+            self.t1_us, self.t2_ms, _ = self.rt_pending
+            self.rt_pending = None
+            self._event(EVT_RETIME, self.cycles, self.t1_us | (self.t2_ms << 16))
+
+    def _handle_retime(self, frame: bytes) -> None:
+        t1 = frame[2] | (frame[3] << 8)
+        t2 = frame[4] | (frame[5] << 8)
+        cur = self.rt_pending or (self.t1_us, self.t2_ms)
+        v1 = min(max(t1, T1_MIN_US), T1_MAX_US) if t1 else cur[0]
+        v2 = min(max(t2, T2_MIN_MS), T2_MAX_MS) if t2 else cur[1]
+        status = 0x02 if (t1 and v1 != t1) or (t2 and v2 != t2) else 0
+        if self.running:
+            cycle = self.cycles + 1
+            self.rt_pending = (v1, v2, cycle)
+            status |= 0x01
+        elif self.rate_running:
+            cycle = self.cycles + self.rate_fired           # übernommen am Ende des Schnellmodus
+            self.rt_pending = (v1, v2, cycle)
+            status |= 0x01
+        else:
+            cycle = self.cycles
+            self.rt_pending = (v1, v2, cycle)
+            self._retime_commit()
+        self._send(bytes([PREAMBLE, CMD_RETIME, v1 & 0xFF, v1 >> 8, v2 & 0xFF, v2 >> 8,
+                          *cycle.to_bytes(4, "little"), status]))
+
+    def _handle_fire(self, n: int) -> None:
+        status = 0
+        if n > 0:
+            if self.running or self.wave_running or self.multi or self.rate_running:
+                status |= 0x02
+            elif self.fault:
+                status |= 0x80
+            else:
+                self._complete_cycles(n)
+        if self.running:
+            status |= 0x01
+        cyc = self.cycles + (self.rate_fired if self.rate_running else 0)
+        self._send(bytes([PREAMBLE, CMD_FIRE, *cyc.to_bytes(4, "little"), 0, 0, status]))
+
+    def trip(self, fault: int = 0x01, phase: int = 1, still_active: bool = False) -> None:
+        """Schutz löst aus: Sequenz hart beenden, Fehler mit Zyklus festhalten."""
+        self.fault, self.fault_phase, self.fault_cycle = fault, phase, self.cycles
+        self.comp_active = fault if still_active else 0
+        self.running = False
+        self._rate_end(1)
+        self._retime_commit()
+        self._wave_abort()
+        self._multi_exit()
+        self._event(EVT_FAULT, fault, self.cycles)
+
+    def _handle_prot(self, cmd: int, value: int, flags: int) -> None:
+        k = 0 if cmd == CMD_PROT_I else 1
+        if value:
+            self.prot_thr[k] = min(value, 4095)
+        if flags & 0x01 and self.fault and not self.comp_active:
+            self._event(EVT_FAULT_CLR, self.fault)
+            self.fault = 0
+        thr = self.prot_thr[k]
+        self._send(bytes([PREAMBLE, cmd, thr & 0xFF, thr >> 8, self.fault]))
+
+    @staticmethod
+    def _wave_crc(tab) -> int:
+        crc = 0xFFFF
+        for st, ticks in tab:
+            for b in (st, ticks & 0xFF, ticks >> 8):
+                crc ^= b << 8
+                for _ in range(8):
+                    crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+        return crc
+
+    def _wave_abort(self) -> None:
+        if self.wave_running:
+            self.wave_running = False
+            self._event(EVT_WAVE_DONE, self.wave_passes, 1)
+
+    def _handle_wave_data(self, frame: bytes) -> None:
+        idx, n = frame[2] | (frame[3] << 8), frame[4]
+        status = 0
+        if self.wave_running or not 1 <= n <= 3 or idx + n > WAVE_MAX_STEPS or idx > len(self.wave_tab):
+            status = 0x80
+        else:
+            for k in range(n):
+                st, ticks = frame[5 + 3 * k] & 0x07, frame[6 + 3 * k] | (frame[7 + 3 * k] << 8)
+                step = (st, max(ticks, 3))
+                if idx + k < len(self.wave_tab):
+                    self.wave_tab[idx + k] = step
+                else:
+                    self.wave_tab.append(step)
+        if self.wave_running:
+            status |= 0x01
+        n_tab = len(self.wave_tab)
+        self._send(bytes([PREAMBLE, CMD_WAVE, n_tab & 0xFF, n_tab >> 8, status]))
+
+    def _handle_wave_ctrl(self, reps: int, flags: int) -> None:
+        ok = True
+        if flags & 0x10:                                        # STOP
+            self._wave_abort()
+        if flags & 0x01:                                        # CLEAR
+            if self.wave_running:
+                ok = False
+            else:
+                self.wave_tab = []
+        if flags & 0x02:                                        # LOAD
+            if self.wave_flash is None or self.wave_running:
+                ok = False
+            else:
+                self.wave_tab = list(self.wave_flash)
+        if flags & 0x04:                                        # SAVE
+            if self.wave_running or self.running or not self.wave_tab:
+                ok = False
+            else:
+                self.wave_flash = list(self.wave_tab)
+        if flags & 0x08:                                        # RUN
+            if (self.wave_running or self.running or self.rate_running or self.fault
+                    or not self.wave_tab):
+                ok = False
+            else:
+                reps = reps or 1
+                self._event(EVT_WAVE_START, len(self.wave_tab), reps)
+                self.wave_passes = 0 if self.wave_hold else reps
+                self.wave_running = self.wave_hold
+                if not self.wave_hold:
+                    self._event(EVT_WAVE_DONE, reps, 0)
+        n_tab = len(self.wave_tab)
+        crc = self._wave_crc(self.wave_tab)
+        stored = self.wave_flash is not None and self.wave_flash == self.wave_tab
+        status = (0x01 if self.wave_running else 0) | (0x02 if stored else 0) | (0 if ok else 0x80)
+        self._send(bytes([PREAMBLE, CMD_WAVE_CTRL, n_tab & 0xFF, n_tab >> 8,
+                          crc & 0xFF, crc >> 8, status]))
+
+    def _chan_stop(self, ch: int) -> None:
+        c = self.chan[ch]
+        if c and c["run"]:
+            c["run"] = False
+            self._event(EVT_CH_STOP, ch, c["fired"])
+
+    def _chan_start(self, ch: int) -> bool:
+        c = self.chan[ch]
+        if (c is None or c["run"] or self.fault or self.running or self.wave_running
+                or self.rate_running):
+            return False
+        self.multi = True
+        self._event(EVT_CH_START, ch, c["n"])
+        if c["n"] and not self.chan_hold:
+            c["fired"] = c["n"]
+            self._event(EVT_CH_DONE, ch, c["fired"])
+        else:
+            c["run"], c["fired"] = True, 1
+        return True
+
+    def _multi_exit(self) -> None:
+        if self.multi:
+            for ch in range(CHANNELS):
+                self._chan_stop(ch)
+            self.multi = False
+
+    def _chan_status(self, ch: int) -> int:
+        c = self.chan[ch] if ch < CHANNELS else None
+        return (0x01 if c and c["run"] else 0) | (0x04 if self.multi else 0)
+
+    def _handle_chan(self, frame: bytes) -> None:
+        ch, t2, n = frame[2], frame[7] | (frame[8] << 8), frame[9] | (frame[10] << 8)
+        t1 = int.from_bytes(frame[3:7], "little")
+        status = 0
+        if ch >= CHANNELS or self.running or self.wave_running or self.rate_running:
+            status = 0x80
+        else:
+            self._chan_stop(ch)
+            t1_ps, _ = t1_grid(t1)
+            t2_ms = min(max(t2, T2_MIN_MS), T2_MAX_MS)
+            self.chan[ch] = dict(t1_ps=t1_ps, t2_ms=t2_ms, n=n, run=False, fired=0)
+            if t2_ms != t2 or not 1_000_000 <= t1 <= 750_000_000:
+                status |= 0x02
+            if frame[11] & 0x01 and not self._chan_start(ch):
+                status |= 0x80
+        c = self.chan[ch] if ch < CHANNELS and self.chan[ch] else dict(t1_ps=0, t2_ms=0, n=0)
+        self._send(bytes([PREAMBLE, CMD_CHAN, ch]) + c["t1_ps"].to_bytes(4, "little")
+                   + c["t2_ms"].to_bytes(2, "little") + c["n"].to_bytes(2, "little")
+                   + bytes([status | self._chan_status(ch)]))
+
+    def _handle_chan_ctrl(self, ch: int, flags: int) -> None:
+        ok = True
+        if flags & 0x80:                                        # EXIT
+            self._multi_exit()
+        elif ch >= CHANNELS:
+            ok = False
+        else:
+            if flags & 0x02:                                    # STOP
+                self._chan_stop(ch)
+            if flags & 0x01:                                    # START
+                ok = self._chan_start(ch)
+        c = self.chan[ch] if ch < CHANNELS else None
+        fired = c["fired"] if c else 0
+        rem = c["n"] - fired if c and c["run"] and c["n"] else 0
+        self._send(bytes([PREAMBLE, CMD_CHAN_CTRL, ch & 0xFF,
+                          self._chan_status(ch) | (0 if ok else 0x80)])
+                   + fired.to_bytes(4, "little") + rem.to_bytes(2, "little"))
+
+    # -------- Schnellmodus (RATE) --------
+    def rate_elapse(self, ms: int) -> None:
+        """Lässt im Schnellmodus ms Millisekunden verstreichen (Pulspaare + Wärmebudget
+        im ms-Raster wie ``rate_poll()``)."""
+        for _ in range(int(ms)):
+            if self.rate_running:
+                r = self.rate
+                self.rate_heat += on_us_per_ms(r["t1_ns"], r["per_ns"])
+                self.rate_fired += 1_000_000 // r["per_ns"]
+                if r["n"] and self.rate_fired >= r["n"]:
+                    self.rate_fired = r["n"]
+                    self._rate_end(0)
+            self.rate_heat = max(0, self.rate_heat - COOL_US_PER_MS)
+            if self.rate_heat > HEAT_MAX_US:
+                self.rate_guard = True
+                self._rate_end(2)
+            elif self.rate_guard and self.rate_heat <= HEAT_MAX_US // 2:
+                self.rate_guard = False
+
+    def _rate_end(self, why: int) -> None:
+        if self.rate_running:
+            self.rate_running = False
+            self.cycles += self.rate_fired
+            self._event(EVT_RATE_DONE, self.rate_fired, why)
+            self._retime_commit()
+
+    def _handle_rate(self, frame: bytes) -> None:
+        t1 = int.from_bytes(frame[2:6], "little")
+        per = int.from_bytes(frame[6:10], "little")
+        n = frame[10] | (frame[11] << 8)
+        status = 0
+        if self.running or self.wave_running or self.multi:
+            status = 0x80
+        else:
+            self._rate_end(1)
+            t1_ns, per_ns, clamped = rate_grid(t1, per)
+            self.rate = dict(t1_ns=t1_ns, per_ns=per_ns, n=n)
+            status |= 0x02 if clamped else 0
+            if frame[12] & 0x01:
+                if self.fault or self.rate_guard:
+                    status |= 0x80
+                else:
+                    self.rate_running, self.rate_fired = True, 0
+                    self._event(EVT_RATE_START, per_ns, n)
+        if self.rate_guard:
+            status |= 0x04
+        if self.rate_running:
+            status |= 0x01
+        r = self.rate or dict(t1_ns=0, per_ns=0, n=0)
+        self._send(bytes([PREAMBLE, CMD_RATE]) + r["t1_ns"].to_bytes(4, "little")
+                   + r["per_ns"].to_bytes(4, "little") + r["n"].to_bytes(2, "little")
+                   + bytes([status]))
+
+    def _handle_status(self, flags: int) -> None:
+        rem = 0
+        if self.running and self.pulse_target:
+            rem = max(0, self.pulse_target - self.cycles)
+        cycles = self.cycles
+        if self.rate_running:
+            cycles += self.rate_fired
+            rem = self.rate["n"] - self.rate_fired if self.rate["n"] else 0
+        uptime = int((time.monotonic() - self._t0) * 1000) & 0xFFFFFFFF
+        state = (4 if self.rate_running else 3 if self.multi else 2 if self.wave_running
+                 else int(self.running))
+        self._send(bytes([PREAMBLE, CMD_STATUS, state, 0,
+                          *cycles.to_bytes(4, "little"),
+                          *rem.to_bytes(2, "little"),
+                          *self.rx_dropped.to_bytes(2, "little"),
+                          *min(self.isr_latency_max, 0xFFFF).to_bytes(2, "little"),
+                          *self.overruns.to_bytes(2, "little"),
+                          *uptime.to_bytes(4, "little"),
+                          *min(self.isr_exec_max, 0xFFFF).to_bytes(2, "little"),
+                          self.fault, self.fault_phase,
+                          *self.fault_cycle.to_bytes(4, "little")]))
+        if flags & 0x01:
+            self.isr_latency_max = 0
+            self.isr_exec_max = 0
+
+    def _handle(self, frame: bytes) -> None:
+        if frame[1] == CMD_ADC:
+            self.adc_decimation = frame[2] | (frame[3] << 8)
+            self._adc_div = 0
+            self._send(bytes([PREAMBLE, CMD_ADC, frame[2], frame[3],
+                              0x01 | (0x02 if self.adc_decimation else 0)]))
+            return
+        if frame[1] in (CMD_PROT_I, CMD_PROT_U):
+            self._handle_prot(frame[1], frame[2] | (frame[3] << 8), frame[4])
+            return
+        if frame[1] == CMD_STATUS:
+            self._handle_status(frame[4])
+            return
+        if frame[1] == CMD_WAVE:
+            self._handle_wave_data(frame)
+            return
+        if frame[1] == CMD_WAVE_CTRL:
+            self._handle_wave_ctrl(frame[2] | (frame[3] << 8), frame[4])
+            return
+        if frame[1] == CMD_CHAN:
+            self._handle_chan(frame)
+            return
+        if frame[1] == CMD_CHAN_CTRL:
+            self._handle_chan_ctrl(frame[2] | (frame[3] << 8), frame[4])
+            return
+        if frame[1] == CMD_RETIME:
+            self._handle_retime(frame)
+            return
+        if frame[1] == CMD_RATE:
+            self._handle_rate(frame)
+            return
+        if frame[1] == CMD_FIRE:
+            self._handle_fire(frame[2] | (frame[3] << 8))
+            return
+        if frame[1] == CMD_CONFIG:
+            self._handle_config(frame)   # kein Text-Echo
+            return
+        cmd, value, flags = frame[1], frame[2] | (frame[3] << 8), frame[4]
+        timer = 2 if cmd & 0x01 else 1
+        base = cmd & 0xF0
+        if base == 0x10:
+            if cmd == CMD_SET_T1:
+                self.t1_us = min(max(value, T1_MIN_US), T1_MAX_US)
+            else:
+                self.t2_ms = min(max(value, T2_MIN_MS), T2_MAX_MS)
+            self.t_flags[timer - 1] = flags
+            self._event(EVT_CMD_SET, timer, value)
+        elif base == 0x20:
+            self.running = not self.fault and not self.multi and not self.rate_running
+            self.pulse_target = value
+            self._event(EVT_CMD_START, value)
+        elif base == 0x30:
+            self.running = False
+            self._rate_end(1)
+            self._retime_commit()
+            if flags & 0x01:
+                self._multi_exit()
+            self._event(EVT_CMD_STOP, flags & 0x01)
+        elif base == 0x40:
+            v = self.t1_us if cmd == CMD_READBACK_T1 else self.t2_ms
+            self._send(bytes([PREAMBLE, cmd, v & 0xFF, v >> 8, self.t_flags[timer - 1]]))
+            self._event(EVT_CMD_RB, timer)
+        else:
+            self._event(EVT_CMD_UNKNOWN, cmd)
+        self._event(EVT_RX_FRAME, int.from_bytes(frame[1:5], "little"), len(frame))
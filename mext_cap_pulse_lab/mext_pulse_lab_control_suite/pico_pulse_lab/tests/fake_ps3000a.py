@@ -0,0 +1,259 @@
+"""
+Simulator des PS3000A-Treibers (``picosdk.ps3000a``) für Tests ohne Gerät.
+
+``FakePs3000a`` stellt die Konstanten und ``ps3000a*``-Funktionen bereit, die
+``PicoReader`` benutzt, und wird in den Tests anstelle von ``ps`` in
+``picoscope_reader`` eingesetzt (``install()``). Jeder Aufruf wird in
+``calls`` protokolliert, damit Tests prüfen können, was zwischen zwei
+Messläufen wirklich ans Gerät geht.
+
+``unplug()`` simuliert eine USB-Trennung: alle Aufrufe liefern
+``PICO_NOT_FOUND``, bis das Gerät nach einigen erfolglosen ``OpenUnit``
+wieder auftaucht. ``unplug_at_run_block`` trennt mitten in einer Messung.
+
+Ohne ``pulse`` liefert jede Erfassung einen abklingenden Verlauf über das
+ganze Fenster; mit ``pulse = (start, length)`` ein Pulspaar an dieser Stelle
+und sonst nur Rauschen. ``GetValues`` beachtet Startindex und
+Aggregat-Modus (Min/Max), ``transferred`` zählt die übertragenen Werte.
+``trigger_offset_s`` ist der gemeldete Trigger-Versatz (``GetTriggerTimeOffset64``).
+"""
+
+import ctypes as ct
+import time
+
+import numpy as np
+
+PICO_OK = 0
+PICO_NOT_FOUND = 3
+MAX_ADC = 32512
+
+_RANGES = ("10MV", "20MV", "50MV", "100MV", "200MV", "500MV", "1V", "2V", "5V", "10V",
+           "20V", "50V")
+
+
+class PicoStatusError(RuntimeError):
+    """Ersatz für ``PicoSDKCtypesError`` aus ``picosdk.functions``."""
+
+
+def assert_ok(status: int) -> None:
+    """Ersatz für ``picosdk.functions.assert_pico_ok``."""
+    if status != PICO_OK:
+        raise PicoStatusError(f"PicoSDK returned {status}")
+
+
+class FakePs3000a:
+    """
+    Treiber-Simulator mit einem angeschlossenen PS3000A.
+
+    Parameters
+    ----------
+    open_delay_s : float, optional
+        Dauer von ``OpenUnit`` (Firmware-Laden), by default 0.0
+    """
+
+    PICO_POWER_SUPPLY_NOT_CONNECTED = 0x119
+    PICO_USB3_0_DEVICE_NON_USB3_0_PORT = 0x11E
+    PS3000A_CHANNEL = {"PS3000A_CHANNEL_A": 0, "PS3000A_CHANNEL_B": 1}
+    PS3000A_COUPLING = {"PS3000A_AC": 0, "PS3000A_DC": 1}
+    PS3000A_RANGE = {f"PS3000A_{r}": k for k, r in enumerate(_RANGES)}
+    PS3000A_THRESHOLD_DIRECTION = {"PS3000A_FALLING": 3}
+    PS3000A_RATIO_MODE = {"PS3000A_RATIO_MODE_NONE": 0, "PS3000A_RATIO_MODE_AGGREGATE": 1}
+
+    def __init__(self, open_delay_s: float = 0.0):
+        self.open_delay_s = open_delay_s
+        self.calls: list[str] = []
+        self.connected = True
+        self.is_open = False
+        self.unplug_at_run_block = None     # n-ter RunBlock trennt die Verbindung
+        self.reopen_failures = 1            # erfolglose OpenUnit nach dieser Trennung
+        self.channels = {}                  # Kanal -> (coupling, range, offset)
+        self.n_segments = 1
+        self.n_captures = 1
+        self.run_blocks = 0
+        self.pulse = None                   # (start, length) des Pulspaars, None = ganzes Fenster
+        self.transferred = 0                # übertragene Werte (alle Kanäle)
+        self.trigger_offset_s = 0.0         # Trigger-Versatz je Segment, None = kein Trigger
+        self._n_block = 0
+        self._handle = 0
+        self._reopen_failures = 0
+        self._buffers = {}                  # (Kanal, Segment, Modus) -> (Max-/Rohpuffer, Min-Puffer)
+
+    def install(self, module) -> tuple:
+        """Setzt den Simulator in ``picoscope_reader`` ein; Rückgabe für ``uninstall()``."""
+        saved = (module.ps, module.PICO_SDK_AVAILABLE, module.assert_pico_ok)
+        module.ps, module.PICO_SDK_AVAILABLE, module.assert_pico_ok = self, True, assert_ok
+        return saved
+
+    @staticmethod
+    def uninstall(module, saved: tuple) -> None:
+        module.ps, module.PICO_SDK_AVAILABLE, module.assert_pico_ok = saved
+
+    def unplug(self, reopen_failures: int = 1) -> None:
+        """USB-Trennung; das Gerät ist nach ``reopen_failures`` Öffnungsversuchen wieder da."""
+        self.connected = False
+        self.is_open = False
+        self._reopen_failures = reopen_failures
+
+    def count(self, name: str) -> int:
+        return self.calls.count(name)
+
+    def _call(self, name: str) -> bool:
+        self.calls.append(name)
+        return self.connected and self.is_open
+
+    # ---- Gerät ----
+
+    def ps3000aOpenUnit(self, handle_ref, serial) -> int:
+        self.calls.append("OpenUnit")
+        if not self.connected:
+            if self._reopen_failures > 0:
+                self._reopen_failures -= 1
+                return PICO_NOT_FOUND
+            self.connected = True
+        time.sleep(self.open_delay_s)
+        self._handle += 1
+        handle_ref._obj.value = self._handle
+        self.is_open = True
+        self.channels, self._buffers = {}, {}
+        self.n_segments = self.n_captures = 1
+        return PICO_OK
+
+    def ps3000aChangePowerSource(self, handle, status) -> int:
+        return PICO_OK if self._call("ChangePowerSource") else PICO_NOT_FOUND
+
+    def ps3000aCloseUnit(self, handle) -> int:
+        self.calls.append("CloseUnit")
+        self.is_open = False
+        return PICO_OK
+
+    def ps3000aPingUnit(self, handle) -> int:
+        return PICO_OK if self._call("PingUnit") else PICO_NOT_FOUND
+
+    def ps3000aMaximumValue(self, handle, value_ref) -> int:
+        if not self._call("MaximumValue"):
+            return PICO_NOT_FOUND
+        value_ref._obj.value = MAX_ADC
+        return PICO_OK
+
+    # ---- Konfiguration ----
+
+    def ps3000aSetChannel(self, handle, channel, enabled, coupling, v_range, offset) -> int:
+        if not self._call("SetChannel"):
+            return PICO_NOT_FOUND
+        self.channels[channel] = (coupling, v_range, offset)
+        return PICO_OK
+
+    def ps3000aGetTimebase2(self, handle, tb, n_samples, interval_ref, seg, max_ref, os) -> int:
+        if not self._call("GetTimebase2"):
+            return PICO_NOT_FOUND
+        # PS3000A-Formel: tb < 3 -> 2^tb ns, sonst (tb - 2) * 8 ns
+        interval_ref._obj.value = float(2 ** tb if tb < 3 else (tb - 2) * 8)
+        max_ref._obj.value = 64_000_000 // self.n_segments
+        return PICO_OK
+
+    def ps3000aSetSimpleTrigger(self, handle, enable, source, threshold, direction, delay,
+                                auto_ms) -> int:
+        return PICO_OK if self._call("SetSimpleTrigger") else PICO_NOT_FOUND
+
+    def ps3000aSetDataBuffer(self, handle, channel, buf_ref, n, seg, mode) -> int:
+        if not self._call("SetDataBuffer"):
+            return PICO_NOT_FOUND
+        self._buffers[(channel, seg, mode)] = (buf_ref._obj, None)
+        return PICO_OK
+
+    def ps3000aSetDataBuffers(self, handle, channel, max_ref, min_ref, n, seg, mode) -> int:
+        if not self._call("SetDataBuffers"):
+            return PICO_NOT_FOUND
+        self._buffers[(channel, seg, mode)] = (max_ref._obj, min_ref._obj)
+        return PICO_OK
+
+    def ps3000aMemorySegments(self, handle, n_seg, max_ref) -> int:
+        if not self._call("MemorySegments"):
+            return PICO_NOT_FOUND
+        self.n_segments = n_seg
+        max_ref._obj.value = 64_000_000 // n_seg
+        return PICO_OK
+
+    def ps3000aSetNoOfCaptures(self, handle, n) -> int:
+        if not self._call("SetNoOfCaptures"):
+            return PICO_NOT_FOUND
+        self.n_captures = n
+        return PICO_OK
+
+    # ---- Erfassung ----
+
+    def ps3000aRunBlock(self, handle, pre, post, tb, os, indisposed_ref, seg, cb, param) -> int:
+        if not self._call("RunBlock"):
+            return PICO_NOT_FOUND
+        self.run_blocks += 1
+        self._n_block = pre + post
+        if self.unplug_at_run_block == self.run_blocks:
+            self.unplug(self.reopen_failures)
+        return PICO_OK
+
+    def ps3000aIsReady(self, handle, ready_ref) -> int:
+        if not self._call("IsReady"):
+            return PICO_NOT_FOUND
+        ready_ref._obj.value = 1
+        return PICO_OK
+
+    def wave(self, channel: int) -> np.ndarray:
+        """Erfasstes Fenster eines Kanals (ADC-Werte)."""
+        n = self._n_block
+        k = np.arange(n)
+        sign = 1 if channel == 0 else -1
+        if self.pulse is None:
+            return (sign * 8000 * np.exp(-k / (n / 4))).astype(np.int16)
+        w = (20 * np.sin(0.7 * k)).astype(np.int16)         # Rauschen
+        start, length = self.pulse
+        half = length // 2
+        w[start:start + half] = 6000 * sign
+        w[start + half:start + length] = -6000 * sign
+        return w
+
+    def _transfer(self, seg: int, start: int, n: int, ratio: int, mode: int) -> int:
+        n = max(0, min(n, self._n_block - start))
+        n_out = n
+        for ch in self.PS3000A_CHANNEL.values():
+            bufs = self._buffers.get((ch, seg, mode))
+            if bufs is None:
+                continue
+            w = self.wave(ch)[start:start + n]
+            if mode == self.PS3000A_RATIO_MODE["PS3000A_RATIO_MODE_AGGREGATE"]:
+                n_out = -(-n // ratio)
+                pad = np.concatenate((w, np.repeat(w[-1:], n_out * ratio - n)))
+                blocks = pad.reshape(n_out, ratio)
+                np.frombuffer(bufs[0], dtype=np.int16, count=n_out)[:] = blocks.max(axis=1)
+                np.frombuffer(bufs[1], dtype=np.int16, count=n_out)[:] = blocks.min(axis=1)
+                self.transferred += 2 * n_out
+            else:
+                np.frombuffer(bufs[0], dtype=np.int16, count=n)[:] = w
+                self.transferred += n
+        return n_out
+
+    def ps3000aGetValues(self, handle, start, n_ref, ratio, mode, seg, overflow_ref) -> int:
+        if not self._call("GetValues"):
+            return PICO_NOT_FOUND
+        n_ref._obj.value = self._transfer(seg, start, n_ref._obj.value, ratio, mode)
+        return PICO_OK
+
+    def ps3000aGetValuesBulk(self, handle, n_ref, seg_from, seg_to, ratio, mode,
+                             overflow_ref) -> int:
+        if not self._call("GetValuesBulk"):
+            return PICO_NOT_FOUND
+        n = n_ref._obj.value
+        for seg in range(seg_from, seg_to + 1):
+            n_ref._obj.value = self._transfer(seg, 0, n, ratio, mode)
+        return PICO_OK
+
+    def ps3000aGetTriggerTimeOffset64(self, handle, time_ref, units_ref, seg) -> int:
+        if not self._call("GetTriggerTimeOffset64"):
+            return PICO_NOT_FOUND
+        if self.trigger_offset_s is None:
+            return 0x47                     # PICO_NO_SAMPLES_AVAILABLE (Auto-Trigger)
+        time_ref._obj.value = round(self.trigger_offset_s * 1e12)
+        units_ref._obj.value = 1            # PS3000A_PS
+        return PICO_OK
+
+    def ps3000aStop(self, handle) -> int:
+        return PICO_OK if self._call("Stop") else PICO_NOT_FOUND
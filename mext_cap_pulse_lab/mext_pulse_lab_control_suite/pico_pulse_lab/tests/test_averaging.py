@@ -0,0 +1,200 @@
+"""
+Test-Funktionen für die kohärente Mittelung.
+
+Diese Tests prüfen die Verschiebung und Verzögerungsschätzung auf
+Bruchteile eines Samples, den gleitenden Mittelwert mit synthetischen,
+zeitlich verrauschten 8-Bit-Pulsen sowie den Trigger-Versatz vom Treiber
+(``FakePs3000a``) bis in den Puls-Ring.
+"""
+
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+import pico_pulse_lab.acquisition.picoscope_reader as pr
+from pico_pulse_lab.acquisition.pulse_ring import PulseRing
+from pico_pulse_lab.processing.averaging import (CoherentAverager, estimate_delay,
+                                                 fractional_delay)
+from pico_pulse_lab.processing.synthetic import pulse_pair
+from pico_pulse_lab.tests.fake_ps3000a import FakePs3000a
+
+N = 4000
+DT = 50e-9
+
+
+def _pulse(d: float = 0.0) -> tuple:
+    """Pulspaar mit weichen Flanken, um d Samples verzögert: (u, i)."""
+    i = pulse_pair(N, 400 + d, 1000)
+    u = 0.02 * np.cumsum(i) / 1000 + 0.05 * i
+    return u, i
+
+
+def _adc(x: np.ndarray, fullscale: float, rng) -> np.ndarray:
+    """Rauschen und 8-Bit-Quantisierung wie am Scope."""
+    lsb = 2 * fullscale / 256
+    return np.round((x + rng.normal(0, lsb, len(x))) / lsb) * lsb
+
+
+def test_fractional_delay():
+    """
+    Test: Verschiebung und Verzögerungsschätzung auf Bruchteile eines Samples.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Verschiebung um Bruchteile eines Samples ===")
+    try:
+        _, ref = _pulse()
+        for d in (0.37, -2.81, 5.5):
+            _, x = _pulse(d)
+            shifted = fractional_delay(ref, d)
+            err = np.max(np.abs(shifted - x)[20:-20])
+            assert err < 1e-3, f"fractional_delay({d}): Fehler {err:.2e}"
+            est = estimate_delay(ref, x, max_lag=16)
+            assert abs(est - d) < 0.01, f"estimate_delay: {est:.4f} statt {d}"
+
+        rng = np.random.default_rng(1)
+        x = _adc(_pulse(1.23)[1], 1.0, rng)
+        est = estimate_delay(ref, x, max_lag=16)
+        assert abs(est - 1.23) < 0.05, f"mit 8-Bit-Rauschen: {est:.4f} statt 1.23"
+        print(f"✓ Verzögerung 1.23 Samples aus 8-Bit-Daten: {est:.3f}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_coherent_average():
+    """
+    Test: Gleitender Mittelwert über zeitlich verrauschte Pulse.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Kohärente Mittelung ===")
+    try:
+        rng = np.random.default_rng(2)
+        t = (np.arange(N) - 400) * DT
+        delays = rng.uniform(-3, 3, 64)
+        pulses = [tuple(_adc(x, 1.0, rng) for x in _pulse(d)) for d in delays]
+
+        def rms_error(avg, d_ref):
+            _, i_ref = _pulse(d_ref)
+            return np.sqrt(np.mean((avg.average()[2] - i_ref)[50:-50] ** 2))
+
+        single = np.sqrt(np.mean((pulses[0][1] - _pulse(delays[0])[1])[50:-50] ** 2))
+        errors = {}
+        for mode, d_ref in (("xcorr", delays[0]), ("trigger", 0.0), ("none", 0.0)):
+            avg = CoherentAverager(window=None, align=mode)
+            for (u, i), d in zip(pulses, delays):
+                avg.add(t, u, i, t_trig=d * DT)
+            errors[mode] = rms_error(avg, d_ref)
+        assert avg.count == 64
+        assert errors["xcorr"] < single / 4, f"xcorr: {errors['xcorr']:.4f} vs {single:.4f}"
+        assert errors["trigger"] < single / 4, f"Trigger: {errors['trigger']:.4f}"
+        assert errors["none"] > 2 * errors["xcorr"], "ohne Ausrichtung nicht schlechter?"
+
+        # Gleitendes Fenster: nur die letzten 16 Pulse
+        avg = CoherentAverager(window=16, align="trigger")
+        for (u, i), d in zip(pulses[:40], delays):
+            avg.add(t, u, i, t_trig=d * DT)
+        ref = CoherentAverager(window=None, align="trigger")
+        for (u, i), d in zip(pulses[24:40], delays[24:40]):
+            ref.add(t, u, i, t_trig=d * DT)
+        assert avg.count == 16 and avg.total == 40
+        assert np.allclose(avg.average()[2], ref.average()[2], atol=1e-9), "Fenster falsch"
+
+        # Neues Erfassungsfenster: Mittelung beginnt neu
+        avg.add(t[:1000], pulses[0][0][:1000], pulses[0][1][:1000])
+        assert avg.count == 1
+        print(f"✓ Fehler einzeln {single:.4f}, gemittelt (64) xcorr {errors['xcorr']:.4f}, "
+              f"Trigger {errors['trigger']:.4f}, ohne Ausrichtung {errors['none']:.4f}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_trigger_offset_in_ring():
+    """
+    Test: Trigger-Versatz vom Treiber bis in den Puls-Ring.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Trigger-Versatz im Puls-Ring ===")
+    fake = FakePs3000a()
+    saved = fake.install(pr)
+    ring = PulseRing.create(n_slots=4, slot_samples=2000)
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            reader = pr.PicoReader()
+            reader.configure(run_name="trig", base_dir=tmpdir, base_samples=1000,
+                             target_fs=12.5e6)
+            reader.attach_ring(ring)
+            cur = ring.cursor()
+            offsets = [23e-9, None, 61e-9]
+            fake.trigger_offset_s = offsets[0]
+
+            def on_pulse(pid, t, u, i):
+                if pid < len(offsets):
+                    fake.trigger_offset_s = offsets[pid]
+
+            reader.set_callback(on_pulse)
+            reader.start_measurement(n_pulses=3, save_csv=False, save_npz=False)
+            seen = [cur.poll().t_trig for _ in range(3)]
+            assert np.allclose(seen, [23e-9, 0.0, 61e-9], atol=1e-15), seen
+            assert reader.trigger_offset_s == 61e-9
+        print(f"✓ t_trig je Puls: {[f'{x * 1e9:.0f} ns' for x in seen]}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        fake.uninstall(pr, saved)
+        ring.close()
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_fractional_delay())
+    results.append(test_coherent_average())
+    results.append(test_trigger_offset_in_ring())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
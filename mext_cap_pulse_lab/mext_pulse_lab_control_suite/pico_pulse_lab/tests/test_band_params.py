@@ -0,0 +1,146 @@
+"""
+Test-Funktionen für die bandweise ESR(f)/C(f)-Schätzung.
+
+Diese Tests prüfen ``estimate_band_params`` an einem synthetischen
+Kondensator mit frequenzabhängigem ESR und Serieninduktivität: Vergleich
+mit einer einzelnen Kleinste-Quadrate-Lösung je Band, Abzug einer bekannten
+bzw. geschätzten ESL und leere Bänder.
+"""
+
+import os
+import sys
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from pico_pulse_lab.processing.cap_params import estimate_band_params, log_bands
+from pico_pulse_lab.processing.synthetic import pulse_pair
+
+N = 4000
+DT = 50e-9
+C_F = 100e-6
+L_H = 20e-9
+
+
+def _esr(f: np.ndarray) -> np.ndarray:
+    """ESR mit Skin-Effekt: 20 mΩ + 10 mΩ·sqrt(f / 100 kHz)."""
+    return 0.02 + 0.01 * np.sqrt(f / 1e5)
+
+
+def _capacitor(esl: float = L_H) -> tuple:
+    """Pulspaar durch R(f)-L-C, Spannung zyklisch über das Spektrum: (t, u, i)."""
+    t = np.arange(N) * DT
+    i = pulse_pair(N, 400, 1000, amp=100)
+    f = np.fft.rfftfreq(N, DT)
+    w = 2 * np.pi * f
+    z = np.zeros(len(f), dtype=complex)
+    z[1:] = _esr(f[1:]) + 1j * w[1:] * esl + 1 / (1j * w[1:] * C_F)
+    u = np.fft.irfft(z * np.fft.rfft(i), N)
+    return t, u, i
+
+
+def test_bands_vs_lstsq():
+    """
+    Test: Jedes Band entspricht der Kleinste-Quadrate-Lösung nur dieses Bands.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Bänder gegen Einzel-Lösung ===")
+    try:
+        t, u, i = _capacitor(esl=0.0)
+        bands = estimate_band_params(t, u, i, n_bands=6, f_min=20e3, f_max=5e6)
+        assert np.allclose(bands.f_lo, log_bands(20e3, 5e6, 6)[:-1])
+
+        f = np.fft.rfftfreq(N, DT)
+        FU, FI = np.fft.rfft(u), np.fft.rfft(i)
+        for b in range(6):
+            hi = f < bands.f_hi[b] if b < 5 else f <= bands.f_hi[b]    # f_max im obersten Band
+            sel = (f >= bands.f_lo[b]) & hi
+            a = np.column_stack([FI[sel], -1j * FI[sel] / (2 * np.pi * f[sel])])
+            # reelle Unbekannte: Real- und Imaginärteil untereinander
+            x, *_ = np.linalg.lstsq(np.vstack([a.real, a.imag]),
+                                    np.concatenate([FU[sel].real, FU[sel].imag]), rcond=None)
+            assert np.isclose(bands.esr[b], x[0], rtol=1e-9), (b, bands.esr[b], x[0])
+            assert np.isclose(bands.cap[b], 1 / x[1], rtol=1e-9), (b, bands.cap[b], 1 / x[1])
+            assert bands.n_bins[b] == np.count_nonzero(sel)
+
+        # ESR steigt mit der Frequenz und liegt innerhalb der Bandgrenzen
+        assert np.all(np.diff(bands.esr) > 0), bands.esr
+        assert np.all((bands.esr >= _esr(bands.f_lo)) & (bands.esr <= _esr(bands.f_hi)))
+        assert np.allclose(bands.cap, C_F, rtol=1e-6), bands.cap
+        print("✓ ESR(f) [mΩ]: " + ", ".join(f"{x * 1e3:.1f}" for x in bands.esr))
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_esl():
+    """
+    Test: Bekannte und gemeinsam geschätzte ESL, leere Bänder.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: ESL-Abzug ===")
+    try:
+        t, u, i = _capacitor()
+        plain = estimate_band_params(t, u, i, n_bands=6, f_min=20e3, f_max=5e6)
+        known = estimate_band_params(t, u, i, n_bands=6, f_min=20e3, f_max=5e6, esl_h=L_H)
+        fit = estimate_band_params(t, u, i, n_bands=6, f_min=20e3, f_max=5e6, esl_h="fit")
+
+        # ohne ESL wird C in den oberen Bändern verfälscht, der ESR nicht
+        assert abs(plain.cap[-1] / C_F - 1) > 0.5, plain.cap
+        assert np.allclose(plain.esr, known.esr)
+        assert np.allclose(known.cap, C_F, rtol=1e-6), known.cap
+        assert abs(fit.esl / L_H - 1) < 1e-6, fit.esl
+        assert np.allclose(fit.cap, C_F, rtol=1e-6), fit.cap
+
+        # Bänder unterhalb der Frequenzauflösung (5 kHz) bleiben leer
+        sparse = estimate_band_params(t, u, i, n_bands=12, f_min=1e3, f_max=1e6)
+        assert sparse.n_bins[0] == 0 and np.isnan(sparse.esr[0]), sparse.n_bins
+        assert sparse.to_dict()["esr"][0] is None
+        print(f"✓ C oberstes Band ohne ESL {plain.cap[-1] * 1e6:.1f} µF, "
+              f"ESL geschätzt {fit.esl * 1e9:.2f} nH")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_bands_vs_lstsq())
+    results.append(test_esl())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
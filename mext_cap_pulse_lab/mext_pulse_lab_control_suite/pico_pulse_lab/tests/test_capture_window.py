@@ -0,0 +1,202 @@
+"""
+Test-Funktionen für das Erfassungsfenster aus T1 der Firmware.
+
+Diese Tests prüfen die Fensterberechnung, das Einlesen von T1 über den
+Firmware-Simulator ``FakeNucleo`` und das Nachführen des Fensters eines
+``PicoReader`` (gegen ``FakePs3000a``), wenn T1 während der Messung per
+RETIME geändert wird.
+"""
+
+import json
+import os
+import sys
+import tempfile
+import time
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+import pico_pulse_lab.acquisition.picoscope_reader as pr
+from pico_pulse_lab.control.capture_window import WindowTracker, window_for
+from pico_pulse_lab.control.pulse_controller import PulseController
+from pico_pulse_lab.control.stm32_uart import NucleoLink
+from pico_pulse_lab.storage.npz_writer import load_meta_npz
+from pico_pulse_lab.tests.fake_nucleo import FakeNucleo
+from pico_pulse_lab.tests.fake_ps3000a import FakePs3000a
+
+
+def test_window_for():
+    """
+    Test: Fenstergröße und Abtastrate aus T1.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Fensterberechnung ===")
+    try:
+        # 20 µs + 2 * 1000 µs + 100 µs bei 20 MS/s
+        win = window_for(1000)
+        assert (win.pre_samples, win.n_samples) == (400, 42_400), win
+        assert win.fs == 20e6
+
+        # Kurzer Puls: Mindestlänge
+        win = window_for(10, min_samples=3000)
+        assert win.n_samples == 3000 and win.pre_samples == 400, win
+
+        # Langer Puls, kleiner Speicher: Abtastrate sinkt, Fenster deckt alles ab
+        win = window_for(1000, max_samples=10_000)
+        assert win.n_samples <= 10_000 and win.fs < 20e6, win
+        assert win.duration_s >= 2120e-6 - 1 / win.fs, f"Fenster zu kurz: {win.duration_s}"
+        print(f"✓ T1 = 1000 µs: 42 400 statt 480 000 Samples; "
+              f"bei max. 10 000 Samples {win.fs / 1e6:.2f} MS/s")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+class _WindowStub:
+    """Nimmt nur ``set_window()`` entgegen."""
+
+    def __init__(self):
+        self.windows = []
+
+    def set_window(self, fs, pre, post):
+        self.windows.append((fs, pre, post))
+
+
+def test_tracker_sync():
+    """
+    Test: T1 per READBACK und über SET-/RETIME-Events.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: T1 aus der Firmware ===")
+    fake = FakeNucleo()
+    link = NucleoLink(ser=fake)
+    try:
+        stub = _WindowStub()
+        tracker = WindowTracker(link, stub)
+        fake.t1_us = 250
+        win = tracker.sync()
+        assert tracker.t1_us == 250 and stub.windows[-1] == tuple(win), stub.windows
+        assert win == window_for(250), win
+
+        link.set_timer(1, 2000).result(2.0)     # Firmware begrenzt auf 1000 µs
+        link.retime(t1_us=40).result(2.0)
+        deadline = time.monotonic() + 1.0
+        while tracker.t1_us != 40 and time.monotonic() < deadline:
+            time.sleep(0.01)
+        assert [w[1] + w[2] for w in stub.windows[1:]] == \
+            [window_for(1000).n_samples, window_for(40).n_samples], stub.windows
+
+        # CONFIG löst kein Event aus: der PulseController übernimmt T1 aus dem ACK
+        PulseController(link, stub, window=tracker)._configure(5, 100)
+        assert tracker.t1_us == 10 and stub.windows[-1] == tuple(window_for(10)), stub.windows
+        print(f"✓ {len(stub.windows)} Fenster: READBACK, SET (begrenzt), RETIME, CONFIG")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        link.close()
+
+
+def test_window_follows_retime():
+    """
+    Test: RETIME während der Messung ändert das Fenster ab dem nächsten Block,
+    Meta-JSON und .npz-Meta beschreiben danach das neue Fenster.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Fenster folgt RETIME ===")
+    pico = FakePs3000a()
+    saved = pico.install(pr)
+    fake = FakeNucleo()
+    link = NucleoLink(ser=fake)
+    tmpdir = tempfile.TemporaryDirectory()
+    try:
+        reader = pr.PicoReader()
+        reader.configure(run_name="win", base_dir=tmpdir.name)
+        tracker = WindowTracker(link, reader, fs=12.5e6)
+        tracker.sync()
+        assert reader.n_samples == 4000 and reader.get_status()["window"][1] == 250
+
+        lengths = []
+
+        def on_pulse(pid, t, u, i):
+            lengths.append((len(t), t[0], reader.pre_samples))
+            if pid == 2:
+                link.retime(t1_us=300).result(2.0)
+                deadline = time.monotonic() + 1.0
+                while reader._pending_window is None and time.monotonic() < deadline:
+                    time.sleep(0.01)
+
+        reader.set_callback(on_pulse)
+        reader.start_measurement(n_pulses=4, save_csv=True, save_npz=True)
+        assert [n for n, _, _ in lengths] == [4000, 4000, 9000, 9000], lengths
+        with open(reader.meta_path, encoding="utf-8") as f:
+            meta_json = json.load(f)
+        for meta in (meta_json, load_meta_npz(reader.npz_path)):
+            assert (meta["fs"], meta["pretrigger_samples"] + meta["posttrigger_samples"]) == \
+                (12.5e6, 9000), f"Meta beschreibt altes Fenster: {meta}"
+            assert [(w["first_pulse_id"], w["pretrigger_samples"] + w["posttrigger_samples"])
+                    for w in meta["windows"]] == [(1, 4000), (3, 9000)], meta["windows"]
+        assert load_meta_npz(reader.npz_path)["pulse_count"] == 5, "Pulse in .npz verloren"
+        assert abs(reader.dt - 80e-9) < 1e-15, reader.dt
+        assert reader.last_applied == ["timebase", "buffers"], reader.last_applied
+
+        # configure() mit Abtastwerten ersetzt das Fenster wieder
+        reader.configure(run_name="fix", base_dir=tmpdir.name, base_samples=1000)
+        assert reader.window is None and reader.n_samples == 1200
+        print(f"✓ Fenster {lengths[0][0]} -> {lengths[-1][0]} Samples nach RETIME")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        link.close()
+        pico.uninstall(pr, saved)
+        tmpdir.cleanup()
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_window_for())
+    results.append(test_tracker_sync())
+    results.append(test_window_follows_retime())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,246 @@
+"""
+Test-Funktionen für den Mess-Daemon und seinen Client.
+
+Diese Tests starten den Daemon im Testprozess (freier Port), steuern den
+Firmware-Simulator ``FakeNucleo`` über die lokale Schnittstelle und lassen
+eine Mock-Messung im Erfassungsprozess laufen, deren Pulse und Parameter
+als Datenströme beim Client ankommen.
+"""
+
+import os
+import sys
+import tempfile
+import threading
+import time
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from pico_pulse_lab.control.capture_window import window_for
+from pico_pulse_lab.daemon.client import DaemonClient, DaemonError
+from pico_pulse_lab.daemon.protocol import decimate_minmax, unpack_trace
+from pico_pulse_lab.daemon.server import LabDaemon
+from pico_pulse_lab.tests.fake_nucleo import FakeNucleo
+
+
+def _wait_for(cond, timeout: float = 5.0) -> bool:
+    t_end = time.monotonic() + timeout
+    while time.monotonic() < t_end:
+        if cond():
+            return True
+        time.sleep(0.02)
+    return cond()
+
+
+def test_decimate_minmax():
+    """
+    Test: Min/Max-Dezimierung behält Spitzen und zeitliche Reihenfolge.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Min/Max-Dezimierung ===")
+    try:
+        y = np.sin(np.linspace(0, 20, 100_000))
+        y[31_337] = 5.0
+        idx, vals = decimate_minmax(y, 1000)
+        assert len(idx) <= 1000 and np.all(np.diff(idx) >= 0), "Indizes unsortiert/zu viele"
+        assert vals.max() == 5.0 and 31_337 in idx, "Spitze verloren"
+        idx, vals = decimate_minmax(y[:500], 1000)
+        assert len(idx) == 500, "kurze Kurve verändert"
+        print("✓ Spitze erhalten, 100000 -> 1000 Punkte")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_nucleo_control():
+    """
+    Test: Nucleo-Kommandos, STATUS-, Event- und ADC-Strom über den Daemon;
+    das Erfassungsfenster folgt CONFIG und RETIME bis in den nächsten Lauf.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Daemon Nucleo-Steuerung ===")
+    daemon = LabDaemon(port=0, status_hz=20.0, window_fs=1e6)
+    daemon.start()
+    fake = FakeNucleo()
+    try:
+        daemon.nucleo_connect(ser=fake)
+        assert daemon._pending_window == tuple(window_for(fake.t1_us, fs=1e6)), "kein Fenster"
+        with DaemonClient(port=daemon.port) as c:
+            got = {"status": [], "event": [], "adc": []}
+            lock = threading.Lock()
+
+            def on_msg(topic, data):
+                with lock:
+                    got[topic].append(data)
+
+            c.subscribe(["status", "event", "adc"], on_msg)
+            ack = c.nucleo("configure", 150, 5, 0, arm=False)
+            assert ack["t1_us"] == 150 and fake.t1_us == 150, f"CONFIG: {ack}"
+            assert daemon._pending_window == tuple(window_for(150, fs=1e6)), "CONFIG ohne Fenster"
+            c.nucleo("retime", t1_us=1000)
+            win = window_for(1000, fs=1e6)
+            assert _wait_for(lambda: daemon._pending_window == tuple(win)), "RETIME ohne Fenster"
+            adc = c.nucleo("adc_stream", 1)
+            assert adc["decimation"] == 1 and daemon.adc_monitor.decimation == 1, f"ADC: {adc}"
+            fire = c.nucleo("fire", 2)
+            assert "cycles" in fire, f"FIRE: {fire}"
+            assert _wait_for(lambda: len(got["status"]) >= 2), "kein STATUS-Strom"
+            assert "state" in got["status"][-1], "STATUS ohne Felder"
+            assert _wait_for(lambda: len(got["adc"]) >= 2), "kein ADC-Strom"
+            assert got["adc"][-1]["pos"]["n"] == fake.adc_samples, f"ADC: {got['adc'][-1]}"
+
+            for bad in (("nucleo", dict(method="close")), ("gibtsnicht", {})):
+                try:
+                    c.request(bad[0], **bad[1])
+                    raise AssertionError(f"{bad[0]} nicht abgelehnt")
+                except DaemonError:
+                    pass
+            st = c.state()
+            assert st["nucleo"] and not st["pico_running"], f"state: {st}"
+            assert st["clients"][0]["topics"] == ["adc", "event", "status"], "Abo falsch"
+
+            # Fenster geht mit dem nächsten Start an den Erfassungsprozess
+            with tempfile.TemporaryDirectory() as tmpdir:
+                res = c.pico_start(dict(run_name="win", base_dir=tmpdir), n_pulses=1,
+                                   save_npz=False)
+                assert res["slot_samples"] == win.n_samples, f"Ring: {res}"
+                assert daemon._pending_window is None and daemon._probe.window == tuple(win)
+                assert _wait_for(lambda: not c.state()["pico_running"], 60.0), "Lauf hängt"
+        print(f"✓ CONFIG/FIRE über Daemon, {len(got['status'])} STATUS, "
+              f"{len(got['event'])} Events")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        daemon.shutdown()
+
+
+def test_pico_stream():
+    """
+    Test: Mock-Messung im Erfassungsprozess, zwei Clients erhalten Pulse und ESR/C;
+    ein zweiter Lauf nutzt denselben Prozess (offene Geräte-Session) und wendet die
+    Sensor-Korrektur auch auf die Live-Daten an.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Daemon Mess-Strom ===")
+    daemon = LabDaemon(port=0, param_interval_s=0.0, live_points=200)
+    daemon.start()
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir, \
+                DaemonClient(port=daemon.port) as gui, DaemonClient(port=daemon.port) as mon:
+            pulses, params, logs = [], [], []
+            gui.subscribe(["pulse"], lambda t, d: pulses.append(unpack_trace(d)))
+            mon.subscribe(["params", "log"],
+                          lambda t, d: (params if t == "params" else logs).append(d))
+
+            cfg = dict(run_name="daemon", base_dir=tmpdir, base_samples=1000, target_fs=1e6)
+            res = gui.pico_start(cfg, n_pulses=4, save_npz=False, bands=4, uncertainty=200)
+            assert res["slot_samples"] >= 1200, f"Ring zu klein: {res}"
+            try:
+                gui.pico_start(cfg, n_pulses=4)
+                raise AssertionError("zweiter Start nicht abgelehnt")
+            except DaemonError:
+                pass
+
+            assert _wait_for(lambda: any("beendet" in l["text"] for l in logs), 60.0), \
+                "Messung nicht beendet"
+            _wait_for(lambda: len(pulses) >= 4)     # Pulse kommen über den anderen Client
+            assert [p[0] for p in pulses] == [1, 2, 3, 4], f"Pulse: {[p[0] for p in pulses]}"
+            pid, t_u, u, t_i, i = pulses[-1]
+            assert len(u) <= 200 and len(t_u) == len(u) and np.max(np.abs(u)) > 1.0, \
+                "Kurve nicht dezimiert/leer"
+            assert [p["pulse_id"] for p in params] == [1, 2, 3, 4], f"Parameter: {params}"
+            assert all(np.isfinite([p["esr"], p["cap"]]).all() for p in params), "ESR/C ungültig"
+            assert all(len(p["bands"]["esr"]) == 4 for p in params), "ESR(f) fehlt"
+            assert all(p["ci"]["esr_ci"][0] < p["ci"]["esr_ci"][1] and p["ci"]["n_draws"] == 200
+                       for p in params), "Konfidenzintervall fehlt"
+            st = mon.state()
+            assert st["pulses"] == 4 and st["lost"] == 0 and not st["pico_running"], f"state: {st}"
+            assert st["filters"] is None, f"Filter ohne Konfiguration: {st['filters']}"
+
+            pid_acq = st["acq_pid"]
+            logs.clear()
+            pulses.clear()
+            try:
+                gui.pico_start(dict(run_name="x", base_dir=tmpdir, target_fs=2e6,
+                                    filters={"q": {"lowpass_hz": 1e5}}), n_pulses=1)
+                raise AssertionError("ungültiger Filter nicht abgelehnt")
+            except DaemonError:
+                pass
+            probe = daemon._probe                   # abgelehnter Start ändert den Spiegel nicht
+            assert (probe.run_name, probe.target_fs, probe.filters) == ("daemon", 1e6, None), \
+                f"Spiegel verändert: {probe.run_name}, {probe.target_fs}, {probe.filters}"
+            filters = {"i": {"lowpass_hz": 1e5, "n_taps": 51}}
+            gui.pico_start(dict(run_name="daemon2", base_dir=tmpdir, filters=filters),
+                           n_pulses=2, save_npz=False)
+            assert _wait_for(lambda: any("beendet" in l["text"] for l in logs), 60.0), \
+                "zweite Messung nicht beendet"
+            _wait_for(lambda: len(pulses) >= 2)     # Pulse kommen über den anderen Client
+            st = mon.state()
+            assert [p[0] for p in pulses] == [1, 2], f"Pulse: {[p[0] for p in pulses]}"
+            assert st["pulses"] == 2 and st["lost"] == 0, f"Zähler nicht zurückgesetzt: {st}"
+            assert pid_acq is not None and st["acq_pid"] == pid_acq, "neuer Erfassungsprozess"
+            assert not any("Erfassungsprozess gestartet" in l["text"] for l in logs)
+            # Live-Pfad korrigiert wie der Speicherpfad (Entwurf für die Rate des Rings)
+            meta = st["filters"]
+            assert meta is not None and set(meta) == {"i"}, f"Filter im Daemon: {meta}"
+            assert meta["i"]["lowpass_hz"] == 1e5 and meta["i"]["n_taps"] == 51, meta
+            assert abs(meta["i"]["fs"] - 1e6) < 1e3, f"Entwurf nicht für Ring-Rate: {meta}"
+        print(f"✓ {len(params)} ESR/C-Schätzungen, zweiter Lauf im selben Prozess "
+              f"({len(u)} Punkte je Kurve)")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        daemon.shutdown()
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_decimate_minmax())
+    results.append(test_nucleo_control())
+    results.append(test_pico_stream())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
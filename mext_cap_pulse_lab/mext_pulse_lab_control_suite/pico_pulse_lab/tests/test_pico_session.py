@@ -0,0 +1,248 @@
+"""
+Test-Funktionen für die Geräte-Session des ``PicoReader``.
+
+Diese Tests laufen gegen den Treiber-Simulator ``FakePs3000a`` und prüfen,
+dass das Gerät zwischen Messläufen offen bleibt (auch im langlebigen
+Erfassungsprozess des Daemons), nur geänderte Einstellungen gesendet werden
+und eine USB-Trennung während der Messung ohne Pulsverlust überbrückt wird.
+"""
+
+import os
+import queue
+import sys
+import tempfile
+import threading
+import time
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+import pico_pulse_lab.acquisition.picoscope_reader as pr
+from pico_pulse_lab.acquisition.pulse_ring import PulseRing
+from pico_pulse_lab.tests.fake_ps3000a import FakePs3000a
+
+
+def _run(reader, n_pulses: int = 3) -> list:
+    """Misst n Pulse ohne Speicherung und liefert die Puls-IDs."""
+    ids = []
+    reader.set_callback(lambda pid, t, u, i: ids.append(pid))
+    reader.start_measurement(n_pulses=n_pulses, save_csv=False, save_npz=False)
+    return ids
+
+
+def test_warm_restart():
+    """
+    Test: Zweiter Lauf ohne OpenUnit und Neukonfiguration, danach nur Deltas.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Warmstart der Geräte-Session ===")
+    fake = FakePs3000a(open_delay_s=0.3)
+    saved = fake.install(pr)
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            reader = pr.PicoReader()
+            reader.configure(run_name="s1", base_dir=tmpdir, base_samples=1000, target_fs=1e6)
+            assert _run(reader) == [1, 2, 3], "erster Lauf unvollständig"
+            cold = reader.first_arm_s
+            assert reader.get_status()["session_open"], "Session nach Lauf geschlossen"
+            assert fake.count("OpenUnit") == 1 and fake.count("CloseUnit") == 0, fake.calls
+
+            fake.calls.clear()
+            reader.configure(run_name="s2", base_dir=tmpdir, base_samples=1000, target_fs=1e6)
+            assert _run(reader) == [1, 2, 3], "zweiter Lauf unvollständig"
+            warm = reader.first_arm_s
+            assert reader.last_applied == [], f"unnötig gesendet: {reader.last_applied}"
+            for name in ("OpenUnit", "SetChannel", "GetTimebase2", "SetSimpleTrigger",
+                         "SetDataBuffer"):
+                assert fake.count(name) == 0, f"{name} im Warmstart"
+            assert cold >= 0.3 > warm, f"Start bis scharf: kalt {cold:.3f} s, warm {warm:.3f} s"
+
+            fake.calls.clear()
+            reader.configure(run_name="s3", base_dir=tmpdir, range_b="5V")
+            _run(reader, 1)
+            assert reader.last_applied == ["ch_b"], f"gesendet: {reader.last_applied}"
+            assert fake.count("SetChannel") == 1 and fake.channels[1][1] == \
+                fake.PS3000A_RANGE["PS3000A_5V"], "Kanal B nicht umgestellt"
+
+            reader.configure(run_name="s4", base_dir=tmpdir, base_samples=2000,
+                             trigger_level_v=-0.1)
+            _run(reader, 1)
+            assert reader.last_applied == ["timebase", "trigger", "buffers"], \
+                f"gesendet: {reader.last_applied}"
+
+            reader.close()
+            assert fake.count("CloseUnit") == 1 and not reader.get_status()["session_open"]
+        print(f"✓ Start bis scharf: kalt {cold * 1e3:.0f} ms, warm {warm * 1e3:.1f} ms")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        fake.uninstall(pr, saved)
+
+
+def test_usb_recovery():
+    """
+    Test: USB-Trennung mitten in der Messung und zwischen zwei Läufen.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: USB-Trennung ===")
+    fake = FakePs3000a()
+    saved = fake.install(pr)
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            reader = pr.PicoReader()
+            reader.configure(run_name="usb", base_dir=tmpdir, base_samples=1000, target_fs=1e6)
+            u_last = []
+            reader.set_callback(lambda pid, t, u, i: u_last.append((pid, np.max(u))))
+
+            fake.unplug_at_run_block = 3
+            reader.start_measurement(n_pulses=5, save_csv=False, save_npz=False)
+            assert [p for p, _ in u_last] == [1, 2, 3, 4, 5], f"Pulse: {u_last}"
+            assert u_last[-1][1] > 0.5, "nach Wiederherstellung keine Daten"
+            assert reader.reconnects == 1 and fake.count("OpenUnit") == 3, \
+                f"reconnects {reader.reconnects}, OpenUnit {fake.count('OpenUnit')}"
+            assert reader.last_applied == ["ch_a", "ch_b", "timebase", "trigger", "buffers"], \
+                "nach Wiederherstellung nicht voll konfiguriert"
+
+            # Trennung zwischen zwei Läufen: open() erkennt es über PingUnit
+            fake.unplug(reopen_failures=0)
+            assert _run(reader, 2) == [1, 2], "Lauf nach Trennung fehlgeschlagen"
+            assert fake.count("OpenUnit") == 4, f"OpenUnit {fake.count('OpenUnit')}"
+
+            # Gerät bleibt weg: Abbruch mit Fehlermeldung statt Endlosschleife
+            reader.recover_timeout_s = 0.5
+            fake.reopen_failures = 1000
+            fake.unplug_at_run_block = fake.run_blocks + 1
+            try:
+                _run(reader, 2)
+                raise AssertionError("RuntimeError erwartet")
+            except RuntimeError as e:
+                assert "nicht wieder erreichbar" in str(e), str(e)
+            assert not reader.is_running, "Reader hängt im Lauf"
+        print(f"✓ {len(u_last)} Pulse trotz Trennung, {reader.reconnects} Wiederherstellung(en)")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        fake.uninstall(pr, saved)
+
+
+def test_acquisition_worker():
+    """
+    Test: Erfassungsprozess des Daemons öffnet das Gerät einmal für alle Läufe.
+
+    Der Worker läuft hier in einem Thread (gleiche Schnittstelle wie im
+    Prozess), damit der Simulator die Treiberaufrufe mitzählt.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Langlebiger Erfassungsprozess ===")
+    fake = FakePs3000a(open_delay_s=0.1)
+    saved = fake.install(pr)
+    cmds, events, stop = queue.Queue(), queue.Queue(), threading.Event()
+    worker = threading.Thread(target=pr.acquisition_worker, args=(cmds, events, stop))
+    rings = [PulseRing.create(n_slots=8, slot_samples=1200),
+             PulseRing.create(n_slots=8, slot_samples=2400)]
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            worker.start()
+            runs = [(rings[0], dict(run_name="w1", base_dir=tmpdir, base_samples=1000,
+                                    target_fs=1e6), 3),
+                    (rings[0], dict(run_name="w2", base_dir=tmpdir), 2),
+                    (rings[1], dict(run_name="w3", base_dir=tmpdir, base_samples=2000), 2)]
+            for ring, cfg, n in runs:
+                cur = ring.cursor()
+                cmds.put((ring.name, cfg, n, dict(save_csv=False, save_npz=False)))
+                assert events.get(timeout=30.0) == ("done", cfg["run_name"], None)
+                ids = []
+                while (p := cur.poll()) is not None:
+                    ids.append(p.pulse_id)
+                assert ids == list(range(1, n + 1)), f"{cfg['run_name']}: {ids}"
+                p = None
+            assert fake.count("OpenUnit") == 1 and fake.count("CloseUnit") == 0, fake.calls
+
+            # Fehler im Lauf: Rückmeldung statt Prozessende, danach weiter nutzbar
+            cmds.put((rings[0].name, dict(run_name="bad", base_dir=tmpdir, gibtsnicht=1), 1, {}))
+            _, _, error = events.get(timeout=30.0)
+            assert error and "gibtsnicht" in error, error
+
+            # Fenster während des Laufs: gilt ab dem nächsten Block
+            cur = rings[1].cursor()
+            cmds.put((rings[1].name, dict(run_name="w4", base_dir=tmpdir), 6,
+                      dict(save_csv=False, save_npz=False, inter_pulse_delay_s=0.05)))
+            end = time.monotonic() + 30.0
+            while (first := cur.poll()) is None and time.monotonic() < end:
+                time.sleep(0.001)           # Ring ist bis zum Start noch geschlossen
+            assert first is not None and first.n_samples != 1000, "erster Puls fehlt"
+            cmds.put(("set_window", 1e6, 300, 700))
+            assert events.get(timeout=30.0) == ("done", "w4", None)
+            sizes = [(first.n_samples, first.pre_samples)]
+            while (p := cur.poll()) is not None:
+                sizes.append((p.n_samples, p.pre_samples))
+            p = first = None
+            assert len(sizes) == 6 and sizes[-1] == (1000, 300), f"Fenster: {sizes}"
+
+            cmds.put(None)
+            worker.join(10.0)
+            assert not worker.is_alive() and fake.count("CloseUnit") == 1, fake.calls
+        print("✓ 4 Läufe, 2 Ringe, 1x OpenUnit, Fenster im Lauf übernommen")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        if worker.is_alive():
+            cmds.put(None)
+            worker.join(10.0)
+        for ring in rings:
+            ring.close()
+        fake.uninstall(pr, saved)
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_warm_restart())
+    results.append(test_usb_recovery())
+    results.append(test_acquisition_worker())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,181 @@
+"""
+Test-Funktionen für die Ablaufsteuerung STM32 <-> PicoScope.
+
+Diese Tests verbinden den PulseController mit dem Firmware-Simulator
+``FakeNucleo`` und einem Reader-Stub, der die Block-Schleife des
+PicoReader nachbildet (Armen -> Callback -> Erfassung).
+"""
+
+import os
+import sys
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from pico_pulse_lab.control.stm32_uart import NucleoLink
+from pico_pulse_lab.control.pulse_controller import PulseController
+from pico_pulse_lab.tests.fake_nucleo import FakeNucleo
+
+
+class FakeReader:
+    """Reader-Stub: ein Puls pro Segment, sobald die Firmware Zyklen geliefert hat."""
+
+    def __init__(self, fake: FakeNucleo, extra_cycles=None):
+        self.fake = fake
+        self.extra_cycles = extra_cycles or {}   # pulse_id -> Zyklen, die "verloren gehen"
+        self.pulse_count = 0
+        self.pulse_id = 1
+        self.pre_samples = 10
+        self.dt = 1e-6
+        self.on_pulse_callback = None
+        self.on_armed_callback = None
+
+    def set_callback(self, cb):
+        self.on_pulse_callback = cb
+
+    def set_armed_callback(self, cb):
+        self.on_armed_callback = cb
+
+    def stop(self):
+        pass
+
+    def start_measurement(self, n_pulses, save_csv=False, save_npz=True,
+                          captures_per_arm=1, capture_timeout_s=None):
+        k = 0
+        while k < n_pulses:
+            n_seg = min(captures_per_arm, n_pulses - k)
+            before = self.fake.cycles
+            if self.on_armed_callback:
+                self.on_armed_callback(self.pulse_id, n_seg)
+            self.fake.tick()    # freilaufend: der erfasste Zyklus
+            if self.fake.cycles - before < n_seg:
+                raise TimeoutError("kein Trigger")
+            for _ in range(n_seg):
+                if self.on_pulse_callback:
+                    self.on_pulse_callback(self.pulse_id, None, None, None)
+                self.pulse_count += 1
+                self.pulse_id += 1
+                # Zyklen, die während Speicherung/Verarbeitung durchlaufen
+                self.fake.tick(self.extra_cycles.get(self.pulse_id - 1, 0))
+            k += n_seg
+
+
+def test_triggered_rapid_block():
+    """
+    Test: getriggerter Betrieb feuert genau so viele Pulse wie erfasst werden.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: PulseController getriggert (Rapid-Block) ===")
+    fake = FakeNucleo()
+    try:
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            reader = FakeReader(fake)
+            report = PulseController(nuc, reader).run_triggered(10, t1_us=100, t2_ms=5,
+                                                                pulses_per_arm=4)
+        assert report['captured'] == 10, f"captured falsch: {report}"
+        assert report['fired'] == 10 and report['missed'] == 0, f"Abgleich falsch: {report}"
+        fires = [f for f in fake.rx_frames if f[1] == 0x60 and (f[2] | f[3] << 8) > 0]
+        assert [f[2] for f in fires] == [4, 4, 2], "Rapid-Block-Aufteilung falsch"
+        print(f"✓ {report}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_free_running_reports_missed():
+    """
+    Test: freilaufender Betrieb meldet verpasste Pulse mit Position.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: PulseController freilaufend ===")
+    fake = FakeNucleo()
+    try:
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            # Nach Puls 2 laufen 2 Zyklen ungesehen durch, nach Puls 4 einer
+            reader = FakeReader(fake, extra_cycles={2: 2, 4: 1})
+            report = PulseController(nuc, reader).run_free(5, t1_us=100, t2_ms=5)
+        assert report['captured'] == 5, f"captured falsch: {report}"
+        assert report['missed'] == 3, f"missed falsch: {report}"
+        assert report['missed_at'] == [(3, 2), (5, 1)], f"missed_at falsch: {report}"
+        assert not fake.running, "Firmware nicht gestoppt"
+        print(f"✓ {report}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_triggered_fault_rejects():
+    """
+    Test: gesetzter Fehler-Latch -> FIRE abgelehnt, Abbruch statt Warten auf den Trigger.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: PulseController getriggert mit Fehler-Latch ===")
+    fake = FakeNucleo()
+    try:
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            fake.trip(0x01)
+            try:
+                PulseController(nuc, FakeReader(fake)).run_triggered(3, t1_us=100, t2_ms=5)
+                raise AssertionError("kein Abbruch trotz Fehler-Latch")
+            except RuntimeError as e:
+                msg = str(e)
+            assert "Schutz" in msg, f"falscher Fehler: {msg}"
+            try:
+                PulseController(nuc, FakeReader(fake)).run_free(3, t1_us=100, t2_ms=5)
+                raise AssertionError("freilaufend kein Abbruch trotz Fehler-Latch")
+            except RuntimeError as e:
+                assert "Schutz" in str(e), f"falscher Fehler: {e}"
+        assert fake.cycles == 0, f"Firmware hat gefeuert: {fake.cycles}"
+        print(f"✓ {msg}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+    results.append(test_triggered_rapid_block())
+    results.append(test_free_running_reports_missed())
+    results.append(test_triggered_fault_rejects())
+
+    # Zusammenfassung
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
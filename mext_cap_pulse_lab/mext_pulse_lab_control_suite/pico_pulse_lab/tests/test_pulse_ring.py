@@ -0,0 +1,178 @@
+"""
+Test-Funktionen für den Puls-Ring im Shared Memory.
+
+Diese Tests überprüfen Schreiben/Lesen ohne Kopie, das Erkennen
+überschriebener Slots und die Erfassung in einem eigenen Prozess
+(Mock-Modus des ``PicoReader``).
+"""
+
+import multiprocessing as mp
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from pico_pulse_lab.acquisition.pulse_ring import PulseRing, RingOverrun
+
+
+def _pulse(k: int, n: int = 1000) -> tuple:
+    """Synthetische Rohwerte für Puls k."""
+    x = np.arange(n, dtype=np.int16)
+    return (x + k).astype(np.int16), (-x - k).astype(np.int16)
+
+
+def test_publish_and_read():
+    """
+    Test: Pulse schreiben und von zwei Lesern ohne Kopie lesen.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Puls-Ring schreiben/lesen ===")
+    ring = PulseRing.create(n_slots=4, slot_samples=1000)
+    try:
+        other = PulseRing.attach(ring.name)
+        gui, storage = ring.cursor(), other.cursor()
+        assert gui.poll() is None, "leerer Ring liefert Puls"
+
+        for k in range(3):
+            ring.publish(10 + k, *_pulse(k, 800), dt=50e-9, scale_u=0.01, scale_i=0.002,
+                         pre_samples=100)
+        got = [storage.poll() for _ in range(3)]
+        assert [p.pulse_id for p in got] == [10, 11, 12], f"IDs: {[p.pulse_id for p in got]}"
+        p = got[1]
+        assert p.n_samples == 800 and np.array_equal(p.adc_u, _pulse(1, 800)[0]), "Rohwerte falsch"
+        assert np.shares_memory(p.adc_u, other._data), "Leser hat kopiert"
+        t, u, i = p.physical()
+        assert abs(t[0] + 100 * 50e-9) < 1e-15 and abs(u[5] - 6 * 0.01) < 1e-12, "Skalierung falsch"
+        assert abs(i[5] + 6 * 0.002) < 1e-12, "Skalierung Strom falsch"
+        assert gui.latest().pulse_id == 12 and gui.poll() is None, "latest() falsch"
+        assert storage.poll() is None and storage.lost == 0, "Leser verliert Pulse"
+        del got, p
+        other.close()
+        print("✓ 3 Pulse, zwei Leser, ohne Kopie")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        ring.close()
+
+
+def test_overrun():
+    """
+    Test: Langsamer Leser erkennt überschriebene Slots, der Schreiber blockiert nie.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Puls-Ring Überholen ===")
+    ring = PulseRing.create(n_slots=4, slot_samples=100)
+    try:
+        slow = ring.cursor(from_oldest=True)
+        ring.publish(1, *_pulse(1, 100), dt=1e-6, scale_u=1.0, scale_i=1.0)
+        held = slow.poll()
+        assert held.valid(), "frischer Puls ungültig"
+        for k in range(2, 11):
+            ring.publish(k, *_pulse(k, 100), dt=1e-6, scale_u=1.0, scale_i=1.0)
+        assert not held.valid(), "überschriebener Slot noch gültig"
+        try:
+            held.physical()
+            raise AssertionError("RingOverrun erwartet")
+        except RingOverrun:
+            pass
+
+        rest = []
+        while (p := slow.poll()) is not None:
+            rest.append(p.pulse_id)
+        assert rest == [8, 9, 10] and slow.lost == 6, f"gelesen {rest}, verloren {slow.lost}"
+        print(f"✓ {slow.lost} überholte Pulse erkannt, Rest {rest}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        held = None
+        ring.close()
+
+
+def test_acquisition_process():
+    """
+    Test: Erfassung (Mock) im eigenen Prozess, Leser im Testprozess.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Erfassung im eigenen Prozess ===")
+    from pico_pulse_lab.acquisition.picoscope_reader import acquisition_process
+
+    ring = PulseRing.create(n_slots=8, slot_samples=1200)
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            cur = ring.cursor()
+            ctx = mp.get_context("spawn")
+            proc = ctx.Process(target=acquisition_process,
+                               args=(ring.name, dict(run_name="ring", base_dir=tmpdir,
+                                                     base_samples=1000, target_fs=1e6), 5),
+                               kwargs=dict(save_csv=False, save_npz=False))
+            proc.start()
+            ids = []
+            while (p := cur.wait(timeout=30.0)) is not None:
+                t, u, i = p.physical()
+                assert len(t) == 1200 and np.max(np.abs(u)) > 1.0, "Mock-Puls leer"
+                ids.append(p.pulse_id)
+            proc.join(30.0)
+            assert proc.exitcode == 0, f"Prozess endete mit {proc.exitcode}"
+            assert ids == [1, 2, 3, 4, 5] and cur.lost == 0, f"IDs {ids}, verloren {cur.lost}"
+        print(f"✓ {len(ids)} Pulse aus dem Erfassungsprozess")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        p = None
+        ring.close()
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_publish_and_read())
+    results.append(test_overrun())
+    results.append(test_acquisition_process())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
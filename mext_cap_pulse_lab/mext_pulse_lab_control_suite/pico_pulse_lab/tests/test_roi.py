@@ -0,0 +1,152 @@
+"""
+Test-Funktionen für den ROI-Modus des ``PicoReader``.
+
+Diese Tests prüfen die Bereichssuche auf der Min/Max-Grobansicht und die
+Erfassung gegen den Treiber-Simulator ``FakePs3000a``: nur der Bereich um
+das Pulspaar wird übertragen und gespeichert, der Versatz steht in den
+Metadaten und im Zeitvektor.
+"""
+
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+import pico_pulse_lab.acquisition.picoscope_reader as pr
+from pico_pulse_lab.acquisition.pulse_ring import PulseRing
+from pico_pulse_lab.storage.npz_writer import load_meta_npz, load_pulse_npz
+from pico_pulse_lab.tests.fake_ps3000a import FakePs3000a
+
+
+def test_locate_roi():
+    """
+    Test: Bereichssuche auf der Grobansicht.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: ROI-Bereichssuche ===")
+    try:
+        env_max = np.full(100, 10, dtype=np.int16)
+        env_min = np.full(100, -10, dtype=np.int16)
+        env_max[40:45], env_min[45:50] = 5000, -5000
+        start, length = pr.locate_roi(env_max, env_min, ratio=100, n_samples=10_000,
+                                      pre_samples=4000, margin_samples=150)
+        assert (start, length) == (3850, 5000 - 3850 + 150), f"ROI {start}, {length}"
+
+        # Trigger-Position liegt immer im Bereich, Ränder am Fenster begrenzt
+        start, length = pr.locate_roi(env_max, env_min, 100, 10_000, pre_samples=2000,
+                                      margin_samples=10_000)
+        assert (start, length) == (0, 10_000), f"ROI {start}, {length}"
+
+        # Nur Rauschen: ganzes Fenster
+        start, length = pr.locate_roi(env_max[:40], env_min[:40], 100, 4000, 800, 150)
+        assert (start, length) == (0, 4000), "Rauschen als Puls erkannt"
+        print("✓ Pulsbereich, Trigger-Einschluss und Rauschen")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_roi_capture():
+    """
+    Test: ROI-Erfassung überträgt und speichert nur den Pulsbereich.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: ROI-Erfassung ===")
+    fake = FakePs3000a()
+    saved = fake.install(pr)
+    ring = PulseRing.create(n_slots=4, slot_samples=120_000)
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            reader = pr.PicoReader()
+            reader.configure(run_name="full", base_dir=tmpdir, base_samples=100_000,
+                             target_fs=12.5e6)
+            pre = int(reader.pretrig_ratio * reader.n_samples)
+            fake.pulse = (pre + 100, 4000)
+            reader.start_measurement(n_pulses=2, save_csv=False, save_npz=False)
+            full = fake.transferred
+
+            fake.transferred = 0
+            pulses = []
+            reader.configure(run_name="roi", base_dir=tmpdir, roi=True, roi_margin_s=50e-6)
+            reader.set_callback(lambda pid, t, u, i: pulses.append((t, u, i)))
+            reader.attach_ring(ring)
+            cur = ring.cursor()
+            reader.start_measurement(n_pulses=2, save_csv=False, save_npz=True,
+                                     captures_per_arm=2)
+            roi = fake.transferred
+            assert roi < 0.1 * full, f"übertragen {roi} statt {full}"
+
+            start, length = reader.roi_last
+            margin = int(50e-6 / reader.dt)
+            assert start <= pre - margin and start >= pre - margin - 256, f"Start {start}"
+            assert pre + 4100 + margin <= start + length <= pre + 4100 + margin + 256, \
+                f"Ende {start + length}"
+
+            t, u, i = pulses[-1]
+            assert len(t) == length and abs(t[0] - start * reader.dt) < 1e-12, "Zeitvektor"
+            assert np.max(u) > 0 and np.min(i) < 0, "Puls fehlt im Bereich"
+
+            meta = load_meta_npz(reader.npz_path)
+            assert meta["roi"]["margin_s"] == 50e-6, f"Meta: {meta.get('roi')}"
+            assert tuple(meta["roi_offsets"][2]) == (start, length), meta["roi_offsets"]
+            t_npz, _, _ = load_pulse_npz(reader.npz_path, 2)
+            assert len(t_npz) == length, "Speicherung nicht verkleinert"
+
+            view = cur.poll()
+            assert view.n_samples == length, "Ring: Länge"
+            t_ring, _, _ = view.physical()
+            assert abs(t_ring[pre - start]) < 1e-12, "Ring: Trigger nicht bei t = 0"
+            del view
+        print(f"✓ {roi} statt {full} Werte übertragen ({roi / full:.1%}), "
+              f"Bereich {start}..{start + length}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        fake.uninstall(pr, saved)
+        ring.close()
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_locate_roi())
+    results.append(test_roi_capture())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,185 @@
+"""
+Test-Funktionen für die Frequenzgang-Korrektur der Sensoren.
+
+Diese Tests prüfen das Overlap-Save-Filter gegen die direkte Faltung (als
+Block und als Datenstrom), die Entzerrung eines synthetischen Tastkopfs mit
+Tiefpass-Verhalten aus einer CSV-Frequenzgangdatei und die Einbindung in
+den ``PicoReader`` samt Metadaten (gegen ``FakePs3000a``).
+"""
+
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+import pico_pulse_lab.acquisition.picoscope_reader as pr
+from pico_pulse_lab.acquisition.pulse_ring import PulseRing
+from pico_pulse_lab.processing.sensor_filter import OverlapSave, design_correction
+from pico_pulse_lab.processing.synthetic import pulse_pair
+from pico_pulse_lab.storage.npz_writer import load_meta_npz, load_pulse_npz
+from pico_pulse_lab.tests.fake_ps3000a import FakePs3000a
+
+FS = 20e6
+
+
+def _write_lowpass_csv(path: str, fc: float) -> None:
+    """Frequenzgang eines RC-Tiefpasses als CSV (f_hz, mag_db, phase_deg)."""
+    f = np.linspace(0, FS / 2, 201)
+    h = 1 / (1 + 1j * f / fc)
+    with open(path, "w") as fh:
+        fh.write("f_hz,mag_db,phase_deg\n")
+        for fk, hk in zip(f, h):
+            fh.write(f"{fk},{20 * np.log10(abs(hk))},{np.degrees(np.angle(hk))}\n")
+
+
+def test_overlap_save():
+    """
+    Test: Overlap-Save entspricht der direkten Faltung, auch blockweise.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Overlap-Save ===")
+    try:
+        rng = np.random.default_rng(3)
+        x = rng.normal(size=50_000)
+        taps = rng.normal(size=63)
+        ref = np.convolve(x, taps)[:len(x)]
+
+        fir = OverlapSave(taps, block=1000)
+        assert np.allclose(fir.filter(x), ref, atol=1e-10), "Block"
+        stream = np.concatenate([fir.process(c) for c in np.array_split(x, 37)])
+        assert np.allclose(stream, ref, atol=1e-10), "Datenstrom"
+        assert len(fir._spectra) == 1, "Filterspektrum nicht wiederverwendet"
+
+        # Entwurf mit Verzögerungsausgleich: flacher Entwurf lässt das Signal durch
+        design = design_correction(FS)
+        assert design_correction(FS) is design, "Entwurf nicht zwischengespeichert"
+        y = OverlapSave(design).filter(x)
+        assert np.allclose(y[200:-200], x[200:-200], atol=0.02), "flacher Entwurf verändert"
+        print(f"✓ Abweichung zur Faltung {np.max(np.abs(stream - ref)):.1e}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_probe_correction():
+    """
+    Test: Entzerrung eines Tastkopfs mit 2-MHz-Tiefpass.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Tastkopf-Entzerrung ===")
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, "probe.csv")
+            _write_lowpass_csv(path, fc=2e6)
+
+            # Pulspaar mit Flanken von ~0.3 µs, 4000 Samples
+            x = pulse_pair(4000, 500, 1000, rise=6.0)
+            f = np.fft.rfftfreq(8192, 1 / FS)
+            measured = np.fft.irfft(np.fft.rfft(x, 8192) / (1 + 1j * f / 2e6), 8192)[:4000]
+
+            fir = OverlapSave(design_correction(FS, response=path, reg=1e-3))
+            corrected = fir.filter(measured)
+            err_meas = np.sqrt(np.mean((measured - x) ** 2))
+            err_corr = np.sqrt(np.mean((corrected - x)[100:-100] ** 2))
+            assert err_corr < 0.1 * err_meas, f"{err_corr:.4f} vs {err_meas:.4f}"
+            assert fir.meta["response"] == "probe.csv" and fir.meta["fs"] == FS
+        print(f"✓ RMS-Fehler {err_meas:.4f} -> {err_corr:.4f}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_reader_filters():
+    """
+    Test: Korrektur im PicoReader, Entwurf in den Metadaten, Ring unverändert.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Korrektur im PicoReader ===")
+    fake = FakePs3000a()
+    saved = fake.install(pr)
+    ring = PulseRing.create(n_slots=4, slot_samples=2000)
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            reader = pr.PicoReader()
+            reader.configure(run_name="raw", base_dir=tmpdir, base_samples=1000,
+                             target_fs=12.5e6)
+            reader.start_measurement(n_pulses=1, save_csv=False, save_npz=True)
+            _, _, i_raw = load_pulse_npz(reader.npz_path, 1)
+
+            reader.configure(run_name="corr", base_dir=tmpdir,
+                             filters={"i": {"lowpass_hz": 1e6, "n_taps": 101}})
+            reader.attach_ring(ring)
+            cur = ring.cursor()
+            reader.start_measurement(n_pulses=1, save_csv=False, save_npz=True)
+            _, _, i_corr = load_pulse_npz(reader.npz_path, 1)
+            meta = load_meta_npz(reader.npz_path)
+            assert meta["filters"]["i"]["lowpass_hz"] == 1e6, meta.get("filters")
+            assert meta["filters"]["i"]["n_taps"] == 101 and "u" not in meta["filters"]
+            assert not np.allclose(i_raw, i_corr) and np.allclose(i_raw[300:-300],
+                                                                  i_corr[300:-300], rtol=0.05)
+            _, _, i_ring = cur.poll().physical()
+            assert np.allclose(i_ring, i_raw), "Ring nicht roh"
+
+            reader.configure(run_name="off", base_dir=tmpdir, filters={})
+            reader.start_measurement(n_pulses=1, save_csv=False, save_npz=True)
+            assert load_meta_npz(reader.npz_path)["filters"] is None
+        print("✓ Strom gefiltert gespeichert, Ring roh, Entwurf in den Metadaten")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        fake.uninstall(pr, saved)
+        ring.close()
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_overlap_save())
+    results.append(test_probe_correction())
+    results.append(test_reader_filters())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
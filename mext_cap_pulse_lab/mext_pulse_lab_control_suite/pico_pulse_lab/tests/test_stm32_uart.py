@@ -0,0 +1,599 @@
+"""
+Test-Funktionen für die STM32-UART-Anbindung.
+
+Diese Tests laufen gegen den Firmware-Simulator ``FakeNucleo`` und
+überprüfen Framing, Demultiplexing von Text/Binärframes und die
+Zuordnung von Antworten zu ausstehenden Kommandos.
+"""
+
+import asyncio
+import os
+import sys
+import threading
+import time
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+from pico_pulse_lab.control.adc_record import AdcScale, decode_adc_record, encode_adc_record
+from pico_pulse_lab.control.event_log import EventDecoder, EventId
+from pico_pulse_lab.control.high_rate import COOL_US_PER_MS, HEAT_MAX_US, guard_after_ms, rate_grid
+from pico_pulse_lab.control.multichannel import t1_grid
+from pico_pulse_lab.control.stm32_uart import (PROT_CURRENT, PROT_F_OC, PROT_VOLTAGE, NucleoLink,
+                                               NucleoUART, T1_F_HW_SYNC, _build_frame)
+from pico_pulse_lab.control.telemetry import AdcMonitor, StatusPoller
+from pico_pulse_lab.control.waveform import BridgeState, Waveform, crc16, encode_wave_frames
+from pico_pulse_lab.tests.fake_nucleo import FakeNucleo
+
+
+def test_build_frame():
+    """
+    Test: Aufbau eines 5-Byte-Frames (LSB vor MSB).
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: _build_frame ===")
+    try:
+        frame = _build_frame(0x11, 1234, 0x01)
+        assert frame == bytes([0xFF, 0x11, 0xD2, 0x04, 0x01]), f"Frame falsch: {frame.hex()}"
+        print("✓ Test erfolgreich")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        return False
+
+
+def test_link_demux_and_readback():
+    """
+    Test: Textzeilen gehen an den Listener, READBACK-Frames an das Kommando.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: NucleoLink Demux + READBACK ===")
+    lines = []
+    got_line = threading.Event()
+
+    def on_line(text):
+        lines.append(text)
+        if text.startswith("CMD: READBACK T2"):
+            got_line.set()
+
+    fake = FakeNucleo()
+    try:
+        with NucleoLink(ser=fake, on_line=on_line, timeout=1.0) as nuc:
+            nuc.set_timer(1, 250).result(1.0)
+            nuc.set_timer(2, 40).result(1.0)
+            # Mehrere Kommandos gleichzeitig ausstehend
+            f1 = nuc.readback(1)
+            f2 = nuc.readback(2)
+            assert f1.result(1.0) == (250, 0), f"T1 falsch: {f1.result()}"
+            assert f2.result(1.0) == (40, 0), f"T2 falsch: {f2.result()}"
+            assert got_line.wait(1.0), "Textzeile nicht empfangen"
+        assert any(l.startswith("CMD: SET T1 OK") for l in lines), "SET-Zeile fehlt"
+        assert not any("\xff" in l for l in lines), "Binärdaten im Textstrom"
+        print(f"✓ {len(lines)} Textzeilen, READBACK korrekt zugeordnet")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_link_await_and_timeout():
+    """
+    Test: Antworten sind per ``await`` nutzbar, fehlende Antworten laufen ab.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: NucleoLink await + Timeout ===")
+    fake = FakeNucleo()
+    try:
+        with NucleoLink(ser=fake, timeout=0.2) as nuc:
+            async def run():
+                await nuc.set_timer(2, 500)
+                return await nuc.readback(2)
+            assert asyncio.run(run()) == (500, 0), "await READBACK falsch"
+
+            # Firmware antwortet nicht mehr -> TimeoutError
+            fake._handle = lambda frame: None
+            try:
+                nuc.readback(1).result(1.0)
+                raise AssertionError("kein Timeout")
+            except TimeoutError:
+                pass
+        print("✓ Test erfolgreich")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_configure_and_arm():
+    """
+    Test: CONFIG setzt alles in einem Round-Trip und liefert die begrenzten Werte.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: CONFIG (configure-and-arm) ===")
+    fake = FakeNucleo()
+    try:
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            ack = nuc.configure(5000, 20, 100, arm=True).result(1.0)
+            assert ack.t1_us == 1000 and ack.t2_ms == 20, f"Werte falsch: {ack}"
+            assert ack.pulse_count == 100 and ack.armed and ack.clamped, f"Status falsch: {ack}"
+            assert fake.running and fake.pulse_target == 100, "Firmware nicht gestartet"
+            assert len(fake.rx_frames) == 1, "mehr als ein Frame gesendet"
+
+            # Timer-Flags (HW-Sync) werden gespeichert und per READBACK gespiegelt
+            nuc.configure(200, 20, 0, arm=False, t1_flags=T1_F_HW_SYNC).result(1.0)
+            assert nuc.readback(1).result(1.0) == (200, T1_F_HW_SYNC), "T1-Flags fehlen"
+            nuc.set_timer(1, 300).result(1.0)
+            assert nuc.readback(1).result(1.0) == (300, 0), "SET setzt Flags nicht zurück"
+
+        # Synchrone API liest denselben ACK
+        fake = FakeNucleo(timeout=0.5)
+        nuc = NucleoUART.__new__(NucleoUART)
+        nuc.ser = fake
+        ack = nuc.configure(200, 50, 0, arm=False)
+        assert (ack.t1_us, ack.t2_ms, ack.armed, ack.clamped) == (200, 50, False, False), f"{ack}"
+        print(f"✓ ACK: {ack}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_status_poller():
+    """
+    Test: STATUS-Frame wird dekodiert und vom Poller zyklisch gelesen.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: STATUS + StatusPoller ===")
+    fake = FakeNucleo()
+    fake.rx_dropped, fake.overruns, fake.isr_latency_max, fake.isr_exec_max = 3, 1, 340, 170
+    try:
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            nuc.configure(100, 5, 10, arm=True).result(1.0)
+            fake.tick(4)
+            st = nuc.status(clear_peak=True).result(1.0)
+            assert st.running and st.cycles == 4 and st.remaining == 6, f"Zähler falsch: {st}"
+            assert (st.rx_dropped, st.overruns) == (3, 1), f"Diagnose falsch: {st}"
+            assert abs(st.isr_latency_us - 2.0) < 1e-9, f"Latenz falsch: {st.isr_latency_us}"
+            assert abs(st.isr_exec_us - 1.0) < 1e-9, f"ISR-Laufzeit falsch: {st.isr_exec_us}"
+            st2 = nuc.status().result(1.0)
+            assert st2.isr_latency_max == 0 and st2.isr_exec_max == 0, "Spitzenwerte nicht gelöscht"
+
+            poller = StatusPoller(nuc, rate_hz=100)
+            poller.start()
+            t_end = time.monotonic() + 1.0
+            while len(poller.history) < 5 and time.monotonic() < t_end:
+                time.sleep(0.01)
+            poller.stop()
+            assert len(poller.history) >= 5, f"zu wenige Snapshots: {len(poller.history)}"
+            assert poller.latest.cycles == 4 and poller.errors == 0, "Poller-Daten falsch"
+        print(f"✓ {st}, {len(poller.history)} Snapshots")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_event_log():
+    """
+    Test: Event-Frames werden dekodiert, Lücken und Zeitstempel-Überlauf erkannt.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Event-Log ===")
+
+    def frame(eid, seq, ts, a0=0, a1=0):
+        return (bytes([0xFF, 0x80, eid, seq]) + ts.to_bytes(4, "little")
+                + a0.to_bytes(4, "little") + a1.to_bytes(4, "little"))
+
+    try:
+        dec = EventDecoder()
+        ev = dec.decode(frame(EventId.CMD_SET, 254, 0xFFFFFF00, 2, 40))
+        assert ev.text == "CMD: SET T2 OK (period=40)", f"Text falsch: {ev.text}"
+        ev = dec.decode(frame(EventId.RX_FRAME, 0, 0x10, 0x00002811, 5))     # seq 255 fehlt
+        assert ev.text == "RX: FF 11 28 00 00", f"Text falsch: {ev.text}"
+        assert dec.lost == 1, f"Lücke nicht erkannt: {dec.lost}"
+        assert ev.t_us == (1 << 32) + 0x10, f"Überlauf nicht aufgelöst: {ev.t_us}"
+
+        # Über den Link: Events als Textzeilen und an Event-Listener
+        events = []
+        fake = FakeNucleo()
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            nuc.add_event_listener(events.append)
+            nuc.stop_timer(hard=True).result(1.0)
+            nuc.readback(1).result(1.0)
+            t_end = time.monotonic() + 1.0
+            while len(events) < 4 and time.monotonic() < t_end:
+                time.sleep(0.01)
+        assert [e.id for e in events] == [EventId.CMD_STOP, EventId.RX_FRAME,
+                                          EventId.CMD_RB, EventId.RX_FRAME], f"{events}"
+        assert events[0].text == "CMD: STOP (hard) OK", f"Text falsch: {events[0].text}"
+
+        # Synchrone API überspringt Events vor der Antwort
+        fake = FakeNucleo(timeout=0.5)
+        nuc = NucleoUART.__new__(NucleoUART)
+        nuc.ser = fake
+        fake._event(EventId.CMD_START, 0)
+        fake.write(_build_frame(0x40))
+        assert nuc._read_packet()[1] == 0x40, "Event nicht übersprungen"
+        print(f"✓ {len(events)} Events über den Link")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_adc_records():
+    """
+    Test: ADC-Messdaten je Pulspaar werden dekodiert, dezimiert und skaliert.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: ADC-Messdaten + AdcMonitor ===")
+    fake = FakeNucleo()
+    try:
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            scale = AdcScale(u_per_volt_in=100.0, a_per_volt_in=20.0, i_zero_v=1.65)
+            mon = AdcMonitor(nuc, scale)
+            assert AdcMonitor.decimation_for(t2_ms=5) == 4, "Dezimierung für 200 Hz falsch"
+            ack = mon.enable(2, timeout=1.0)
+            assert ack.ready and ack.on and ack.decimation == 2, f"ACK falsch: {ack}"
+
+            nuc.configure(100, 5, 0, arm=True).result(1.0)
+            fake.tick(6)
+            nuc.status().result(1.0)        # Reihenfolge: Datensätze liegen davor
+            assert mon.received == 3, f"Anzahl falsch: {mon.received}"
+            assert [r.cycle for _, r in mon.history] == [2, 4, 6], "Zyklen falsch"
+            rec = mon.latest
+            assert rec.pos.n == 35 and abs(rec.pos.u_mean - 3000 * 3.3 / 4095 * 100) < 1e-9
+            assert abs(rec.pos.i_peak - (3100 * 3.3 / 4095 - 1.65) * 20) < 1e-9, "I-Spitze falsch"
+            assert mon.lost_cycles == 0, "Dezimierung als Verlust gezählt"
+
+            mon.disable(timeout=1.0)
+            fake.tick(4)
+            nuc.status().result(1.0)
+            assert mon.received == 3, f"Datensätze nach dem Abschalten: {mon.received}"
+
+        raw = decode_adc_record(fake.adc_frame(70000))
+        assert decode_adc_record(encode_adc_record(raw)) == raw, "Roundtrip falsch"
+        assert raw.cycle == 70000 and raw.neg.i_max == 3100, f"Dekodierung falsch: {raw}"
+        print(f"✓ {mon.received} Datensätze, letzter Zyklus {rec.cycle}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_protection_fault():
+    """
+    Test: Schutz-Latch mit Zyklus in STATUS, Start-Sperre und Quittieren.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Schutz (PROT + Fehler-Latch) ===")
+    fake = FakeNucleo()
+    events = []
+    try:
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            nuc.add_event_listener(events.append)
+            scale = AdcScale(u_per_volt_in=100.0, a_per_volt_in=20.0, i_zero_v=1.65)
+            ack = nuc.protection(PROT_CURRENT, scale.raw_i(25.0)).result(1.0)
+            assert ack.threshold == round((25.0 / 20.0 + 1.65) / 3.3 * 4095), f"Schwelle: {ack}"
+            ack = nuc.protection(PROT_VOLTAGE, scale.raw_u(300.0)).result(1.0)
+            assert ack.threshold == 3723 and not ack.faulted, f"Schwelle U: {ack}"
+
+            nuc.configure(100, 5, 0, arm=True).result(1.0)
+            fake.tick(7)
+            fake.trip(PROT_F_OC, phase=2, still_active=True)
+            st = nuc.status().result(1.0)
+            assert st.faulted and not st.running, f"Fehler nicht gemeldet: {st}"
+            assert (st.fault_phase, st.fault_cycle) == (2, 7), f"Zyklus falsch: {st}"
+            assert st.fault_text == "Überstrom in Puls- von Zyklus 8", st.fault_text
+
+            cfg = nuc.configure(100, 5, 0, arm=True).result(1.0)
+            assert not cfg.armed and cfg.rejected, f"Start trotz Fehler: {cfg}"
+            fire = nuc.fire(1).result(1.0)
+            assert fire.rejected and not (fire.running or fire.busy), f"FIRE trotz Fehler: {fire}"
+            assert nuc.clear_fault().result(1.0).faulted, "Quittiert trotz anliegendem Komparator"
+            fake.comp_active = 0
+            assert not nuc.clear_fault().result(1.0).faulted, "Quittieren fehlgeschlagen"
+            cfg = nuc.configure(100, 5, 0, arm=True).result(1.0)
+            assert cfg.armed and not cfg.rejected, f"Start nach Quittieren: {cfg}"
+            nuc.status().result(1.0)
+        texts = [e.text for e in events]
+        assert "FAULT: over-current (cycles=7), bridge disabled" in texts, texts
+        assert "FAULT: cleared (over-current)" in texts, texts
+        print(f"✓ {st.fault_text}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_waveform_upload():
+    """
+    Test: Zustandsfolge aufbauen, hochladen (CRC), speichern/laden und abspielen.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: WAVE (Upload, Flash, Abspielen) ===")
+    fake = FakeNucleo()
+    events = []
+    try:
+        w = Waveform.burst(4, t_on_us=50, t_off_us=200.05)
+        assert [s.state for s in w] == [BridgeState.POS, BridgeState.ZERO_LOW, BridgeState.NEG,
+                                        BridgeState.ZERO_LOW, BridgeState.POS, BridgeState.ZERO_LOW,
+                                        BridgeState.NEG], "Burst-Folge falsch"
+        assert w.steps[0].ticks == 500 and w.steps[1].ticks == 2000, f"Ticks: {w.steps[:2]}"
+        long = Waveform().add(BridgeState.POS, 13107.3)          # > 2 x 6553.5 µs
+        assert [s.ticks for s in long] == [65535, 65535, 3], f"Teilung falsch: {long.steps}"
+        assert len(encode_wave_frames(w)) == 3
+
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            nuc.add_event_listener(events.append)
+            ack = nuc.wave_upload(w)
+            assert ack.length == 7 and ack.crc == crc16(w) and not ack.stored, f"Upload: {ack}"
+            assert nuc.wave_save().result(1.0).stored, "nicht gespeichert"
+
+            nuc.wave_upload(Waveform.ripple(10e3, periods=2, duty=0.6))
+            assert not nuc.wave_control(0).result(1.0).stored, "andere Tabelle als gespeichert"
+            ack = nuc.wave_load().result(1.0)
+            assert ack.stored and ack.crc == crc16(w), f"Laden: {ack}"
+
+            ack = nuc.wave_run(repeats=3).result(1.0)
+            assert not ack.rejected and not ack.running, f"Abspielen: {ack}"
+
+            fake.wave_hold = True
+            assert nuc.wave_run().result(1.0).running
+            assert nuc.status().result(1.0).wave_running
+            assert nuc.fire(1).result(1.0).busy, "FIRE während des Abspielens"
+            assert nuc.wave_control(0x01).result(1.0).rejected, "Leeren während des Abspielens"
+            ack = nuc.wave_stop().result(1.0)
+            assert not ack.running and ack.length == 7, f"Stopp: {ack}"
+            nuc.status().result(1.0)
+        texts = [e.text for e in events]
+        assert texts.count("WAVE: start (steps=7, repeats=3)") == 1, texts
+        assert "WAVE: done (passes=3)" in texts and "WAVE: aborted (passes=0)" in texts, texts
+        print(f"✓ {len(w)} Schritte, {w.duration_us:.1f} µs, CRC 0x{crc16(w):04X}")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_multi_channel():
+    """
+    Test: drei HRTIM-Kanäle mit eigenem T1/T2/Pulszahl, Sperre der Einzelbrücke, Verlassen.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Mehrkanalbetrieb (HRTIM) ===")
+    fake = FakeNucleo()
+    events = []
+    try:
+        t1, res = t1_grid(12_345_678)                  # 12.345678 µs
+        assert abs(t1 - 12_345_678) <= res / 2 and res < 1000, f"Raster: {t1} ps, {res:.1f} ps"
+        assert t1_grid(750_000_000)[1] < 25_000, "lange Pulse: Raster zu grob"
+        assert t1_grid(5e9)[0] <= 750_000_000, "T1 nicht begrenzt"
+
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            nuc.add_event_listener(events.append)
+            fake.chan_hold = True
+            acks = [nuc.configure_channel(ch, t1_us, t2, n).result(1.0)
+                    for ch, t1_us, t2, n in ((0, 12.345678, 5, 0), (1, 100.0, 20, 50), (2, 2.5, 1, 0))]
+            assert [a.channel for a in acks] == [0, 1, 2], acks
+            assert all(a.running and a.multi and not a.rejected for a in acks), acks
+            assert acks[0].t1_ps == t1 and acks[1].pulse_count == 50, acks
+            assert nuc.status().result(1.0).multi_active
+            assert nuc.fire(1).result(1.0).busy, "FIRE im Mehrkanalbetrieb"
+
+            st = nuc.channel_stop(1).result(1.0)
+            assert not st.running and st.multi and st.fired == 1, f"Stopp Kanal 1: {st}"
+            assert nuc.channel_control(2).result(1.0).running, "Kanal 2 läuft weiter"
+            assert nuc.channel_control(3).result(1.0).rejected, "Kanal 3 gibt es nicht"
+
+            fake.chan_hold = False
+            assert nuc.channel_start(1).result(1.0).fired == 50
+            nuc.multi_exit().result(1.0)
+            st = nuc.status().result(1.0)
+            assert not st.multi_active and st.state == 0, f"Verlassen: {st}"
+        texts = [e.text for e in events]
+        assert "CH1: stop (pulses=1)" in texts and "CH1: done (pulses=50)" in texts, texts
+        assert "CH0: stop (pulses=1)" in texts and "CH2: stop (pulses=1)" in texts, texts
+        print(f"✓ 3 Kanäle, T1 = {acks[0].t1_us:.6f} µs (Raster {res:.0f} ps)")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_live_retime():
+    """
+    Test: RETIME ändert T1/T2 ohne Stopp, die Umschaltung gilt ab dem gemeldeten Zyklus.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: RETIME (Umschaltung an der Zyklusgrenze) ===")
+    fake = FakeNucleo()
+    events = []
+    try:
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            nuc.add_event_listener(events.append)
+            nuc.configure(100, 10, 0, arm=True).result(1.0)
+            fake.tick(3)
+            ack = nuc.retime(t1_us=200).result(1.0)
+            assert ack.pending and not ack.clamped, f"Status falsch: {ack}"
+            assert (ack.t1_us, ack.t2_ms, ack.switch_cycle) == (200, 10, 4), f"{ack}"
+            assert fake.running, "Sequenz wurde angehalten"
+            assert nuc.readback(1).result(1.0)[0] == 100, "T1 vor der Zyklusgrenze umgeschaltet"
+
+            fake.tick(1)
+            assert nuc.readback(1).result(1.0)[0] == 200, "T1 nach der Zyklusgrenze alt"
+            ack = nuc.retime(t2_ms=20000).result(1.0)
+            assert ack.clamped and ack.t2_ms == 10000 and ack.t1_us == 200, f"{ack}"
+
+            nuc.stop(hard=True).result(1.0)         # Stopp übernimmt bereitliegende Werte
+            assert nuc.readback(2).result(1.0)[0] == 10000, "T2 beim Stopp verloren"
+            ack = nuc.retime(t1_us=50, t2_ms=5).result(1.0)
+            assert not ack.pending and ack.switch_cycle == fake.cycles, f"ohne Sequenz: {ack}"
+            assert (fake.t1_us, fake.t2_ms) == (50, 5), "ohne Sequenz nicht sofort übernommen"
+
+        rt = [e for e in events if e.id == EventId.RETIME]
+        assert [e.a0 for e in rt] == [4, 4, 4], f"Umschaltzyklen: {[e.a0 for e in rt]}"
+        assert rt[0].text == "RETIME: T1=200 us T2=10 ms (from cycle 4)", rt[0].text
+        print(f"✓ Umschaltung ab Zyklus {rt[0].a0}, ohne Stopp")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_high_rate():
+    """
+    Test: Schnellmodus mit 20 kHz, Pulszahl, Stopp und Wärmebudget (Guard).
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: RATE (Schnellmodus, Guard) ===")
+    fake = FakeNucleo()
+    events = []
+    try:
+        t1, per, clamped = rate_grid(5_000, 50_000)
+        assert not clamped and abs(t1 - 5_000) < 6 and abs(per - 50_000) < 6, f"{t1} {per}"
+        assert rate_grid(20_000, 50_000)[0] <= 12_500, "Tastgrad nicht begrenzt"
+        assert rate_grid(1_000, 5_000)[1] == 20_000, "Periode unter 20 µs nicht begrenzt"
+
+        with NucleoLink(ser=fake, timeout=1.0) as nuc:
+            nuc.add_event_listener(events.append)
+            ack = nuc.configure_rate(5.0, 20e3, 1000).result(1.0)
+            assert ack.running and not ack.clamped and not ack.rejected, f"{ack}"
+            assert abs(ack.rate_hz - 20e3) < 5 and abs(ack.duty - 0.2) < 1e-3, f"{ack}"
+            st = nuc.status().result(1.0)
+            assert st.rate_active and st.remaining == 1000, f"{st}"
+            assert nuc.fire(1).result(1.0).busy, "FIRE im Schnellmodus nicht abgelehnt"
+            fake.rate_elapse(60)                        # 1000 Pulspaare nach 50 ms
+            st = nuc.status().result(1.0)
+            assert not st.rate_active and st.cycles == 1000, f"{st}"
+
+            ack = nuc.configure_rate(12.5, 20e3).result(1.0)   # endlos, 50 % Tastgrad
+            assert ack.running and ack.pulse_count == 0, f"{ack}"
+            fake.rate_elapse(10)
+            nuc.stop(hard=True).result(1.0)
+            assert not nuc.status().result(1.0).rate_active, "STOP beendet den Schnellmodus nicht"
+
+            nuc.configure_rate(12.5, 20e3).result(1.0)
+            fake.rate_elapse(int(guard_after_ms(ack.t1_ns, ack.period_ns, fake.rate_heat)) + 2)
+            ack = nuc.configure_rate(12.5, 20e3).result(1.0)
+            assert ack.guard and ack.rejected and not ack.running, f"Guard: {ack}"
+            assert fake.rate_heat > HEAT_MAX_US, "Guard ohne erschöpftes Budget"
+            fake.rate_elapse((fake.rate_heat - HEAT_MAX_US // 2) // COOL_US_PER_MS + 1)
+            ack = nuc.configure_rate(2.0, 10e3, 100).result(1.0)
+            assert ack.running and not ack.guard, f"nach Abkühlen: {ack}"
+
+        done = [e for e in events if e.id == EventId.RATE_DONE]
+        assert [e.a1 for e in done] == [0, 1, 2], f"Endegründe: {[(e.a0, e.a1) for e in done]}"
+        assert done[0].text == "RATE: done (pulses=1000)", done[0].text
+        print(f"✓ {ack.rate_hz / 1e3:.0f} kHz, Guard nach {done[2].a0} Pulspaaren")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+    results.append(test_build_frame())
+    results.append(test_link_demux_and_readback())
+    results.append(test_link_await_and_timeout())
+    results.append(test_configure_and_arm())
+    results.append(test_status_poller())
+    results.append(test_event_log())
+    results.append(test_adc_records())
+    results.append(test_protection_fault())
+    results.append(test_waveform_upload())
+    results.append(test_multi_channel())
+    results.append(test_live_retime())
+    results.append(test_high_rate())
+
+    # Zusammenfassung
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,178 @@
+"""
+Test-Funktionen für die Monte-Carlo-Unsicherheit von ESR und C.
+
+Diese Tests prüfen die geschlossene Lösung gegen ``estimate_cap_params``,
+die Streuung der Frequenzbereichs-Ziehungen gegen eine direkte Simulation
+im Zeitbereich und die Auswertung eines ganzen Messlaufs (``FakePs3000a``,
+Fehlermodell aus den Metadaten).
+"""
+
+import os
+import sys
+import tempfile
+
+import numpy as np
+
+# Pfad für Import hinzufügen
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+import pico_pulse_lab.acquisition.picoscope_reader as pr
+from pico_pulse_lab.processing.cap_params import estimate_cap_params
+from pico_pulse_lab.processing.uncertainty import (ErrorModel, monte_carlo, monte_carlo_npz,
+                                                   pulse_spectrum, solve_rc)
+from pico_pulse_lab.processing.synthetic import pulse_pair
+from pico_pulse_lab.storage.npz_writer import get_all_pulse_ids, load_meta_npz
+from pico_pulse_lab.tests.fake_ps3000a import FakePs3000a
+
+N = 2000
+DT = 50e-9
+ERRORS = ErrorModel(u_lsb=0.4, i_lsb=0.8, u_gain_tol=0.02, i_gain_tol=0.01)
+
+
+def _pulse() -> tuple:
+    """Pulspaar ±100 A durch 20 mΩ und 100 µF: (t, u, i)."""
+    t = np.arange(N) * DT
+    i = pulse_pair(N, 200, 600, amp=100)
+    u = 0.02 * i + np.cumsum(i) * DT / 100e-6
+    return t, u, i
+
+
+def test_solve_rc():
+    """
+    Test: Geschlossene Lösung entspricht estimate_cap_params.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Geschlossene Lösung ===")
+    try:
+        rng = np.random.default_rng(1)
+        t, u, i = _pulse()
+        u = u + rng.normal(0, 0.5, N)
+        omega, U, I, _ = pulse_spectrum(t, u, i)
+        esr, cap = solve_rc(omega, U, I)
+        esr_ref, cap_ref = estimate_cap_params(t, u, i)
+        assert np.isclose(esr, esr_ref, rtol=1e-9) and np.isclose(cap, cap_ref, rtol=1e-9), \
+            (esr, esr_ref, cap, cap_ref)
+        print(f"✓ ESR {esr * 1e3:.4f} mΩ, C {cap * 1e6:.4f} µF wie estimate_cap_params")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_against_time_domain():
+    """
+    Test: Streuung aus dem Spektrum entspricht der Simulation im Zeitbereich.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Monte-Carlo gegen Zeitbereich ===")
+    try:
+        rng = np.random.default_rng(2)
+        t, u, i = _pulse()
+        # Zeitbereich: Quantisierungsfehler ±LSB/2 und Faktoren, je Ziehung neu geschätzt
+        ref = []
+        for _ in range(400):
+            gu = 1 + rng.uniform(-ERRORS.u_gain_tol, ERRORS.u_gain_tol)
+            gi = 1 + rng.uniform(-ERRORS.i_gain_tol, ERRORS.i_gain_tol)
+            uq = gu * (u + rng.uniform(-0.5, 0.5, N) * ERRORS.u_lsb)
+            iq = gi * (i + rng.uniform(-0.5, 0.5, N) * ERRORS.i_lsb)
+            ref.append(estimate_cap_params(t, uq, iq))
+        ref = np.array(ref)
+
+        r = monte_carlo(t, u, i, ERRORS, n_draws=4000, rng=rng)
+        for name, std, std_ref in (("ESR", r.esr_std, ref[:, 0].std()),
+                                   ("C", r.cap_std, ref[:, 1].std())):
+            assert abs(std / std_ref - 1) < 0.15, f"{name}: {std:.3e} vs {std_ref:.3e}"
+        assert r.esr_ci[0] < r.esr < r.esr_ci[1] and r.cap_ci[0] < r.cap < r.cap_ci[1]
+
+        # Nur Quantisierung, 16 gemittelte Pulse: Streuung sinkt um 4
+        quant = ERRORS._replace(u_gain_tol=0.0, i_gain_tol=0.0)
+        s1 = monte_carlo(t, u, i, quant, n_draws=4000, rng=rng).cap_std
+        s16 = monte_carlo(t, u, i, quant, n_draws=4000, n_avg=16, rng=rng).cap_std
+        assert abs(s1 / s16 - 4) < 0.4, f"{s1 / s16:.2f}"
+        print(f"✓ σ(ESR) {r.esr_std * 1e3:.3f} mΩ (Zeitbereich {ref[:, 0].std() * 1e3:.3f}), "
+              f"σ(C) {r.cap_std * 1e6:.3f} µF (Zeitbereich {ref[:, 1].std() * 1e6:.3f})")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+
+def test_run_batch():
+    """
+    Test: Alle Pulse eines Messlaufs, Fehlermodell aus den Metadaten.
+
+    Returns
+    -------
+    bool
+        True wenn Test erfolgreich, False sonst.
+    """
+    print("\n=== Test: Messlauf im Stapel ===")
+    fake = FakePs3000a()
+    saved = fake.install(pr)
+    try:
+        with tempfile.TemporaryDirectory() as tmpdir:
+            reader = pr.PicoReader()
+            reader.configure(run_name="mc", base_dir=tmpdir, base_samples=1000,
+                             target_fs=12.5e6, u_probe_attenuation=50.0)
+            reader.start_measurement(n_pulses=3, save_csv=False, save_npz=True)
+            meta = load_meta_npz(reader.npz_path)
+            errors = ErrorModel.from_meta(meta)
+            assert meta["ch_a"]["u_probe_attenuation"] == 50.0
+            assert np.isclose(errors.u_lsb, 2 * meta["ch_a"]["v_range"] * 50.0 / 256)
+
+            res = monte_carlo_npz(reader.npz_path, n_draws=200)
+            assert list(res["pulse_id"]) == get_all_pulse_ids(reader.npz_path)[1:]
+            assert np.all(res["esr_lo"] <= res["esr"]) and np.all(res["esr"] <= res["esr_hi"])
+            assert np.all(res["cap_std"] > 0)
+            again = monte_carlo_npz(reader.npz_path, n_draws=200)
+            assert np.array_equal(res["cap_lo"], again["cap_lo"]), "nicht reproduzierbar"
+        print(f"✓ {len(res['pulse_id'])} Pulse, ESR-Intervall "
+              f"[{res['esr_lo'][0]:.4g}, {res['esr_hi'][0]:.4g}] Ω")
+        return True
+    except Exception as e:
+        print(f"✗ Test fehlgeschlagen: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+    finally:
+        fake.uninstall(pr, saved)
+
+
+def run_all_tests():
+    """
+    Führt alle Tests aus.
+
+    Returns
+    -------
+    bool
+        True wenn alle Tests erfolgreich, False sonst.
+    """
+    results = []
+
+    results.append(test_solve_rc())
+    results.append(test_against_time_domain())
+    results.append(test_run_batch())
+
+    print("\n=== Test-Zusammenfassung ===")
+    passed = sum(results)
+    total = len(results)
+    print(f"Bestanden: {passed}/{total}")
+
+    return all(results)
+
+
+if __name__ == "__main__":
+    success = run_all_tests()
+    sys.exit(0 if success else 1)